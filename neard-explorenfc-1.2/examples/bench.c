@@ -0,0 +1,253 @@
+/*
+*         Copyright (c), NXP Semiconductors Gratkorn / Austria
+*
+*                     (C)NXP Semiconductors
+*       All rights are reserved. Reproduction in whole or in part is
+*      prohibited without the written consent of the copyright owner.
+*  NXP reserves the right to make changes without notice at any time.
+* NXP makes no warranty, expressed, implied or statutory, including but
+* not limited to any implied warranty of merchantability or fitness for any
+*particular purpose, or that the use will not infringe any third party patent,
+* copyright or trademark. NXP must not be liable for any loss or damage
+*                          arising from its use.
+*/
+/*
+ * \file bench.c
+ * HAL event dispatch microbenchmark
+ *
+ * Drives the HAL with the simulated reader and reports, for the events
+ * (mode, polling, tag found, tag lost) passed from the HAL thread to the main
+ * loop, the delay between posting and dispatching a tag detection and the
+ * number of allocations per event made by each thread.
+ *
+ * g_mem_set_vtable() is a no-op in current GLib, so allocations are counted by
+ * wrapping malloc(), calloc() and realloc() themselves.
+ */
+
+#include <glib.h>
+#include <glib-object.h>
+#include <glib/gprintf.h>
+#include <glib/gstdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "hal.h"
+
+#define BENCH_DEFAULT_TAPS 100
+#define BENCH_DEFAULT_INTERVAL 700 //Milliseconds between two taps, more than a presence check so that no tap is skipped
+#define BENCH_HOLD 50 //Milliseconds a tag stays in the field
+#define BENCH_RESTART_PERIOD 5 //Milliseconds between two attempts to resume polling
+
+//Allocation counters
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t count, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+
+static gint counting = FALSE;
+static __thread gboolean mainThread = FALSE;
+static gint mainAllocations = 0;
+static gint halAllocations = 0;
+static __thread gboolean benchAllocation = FALSE; //Made by the benchmark itself, not counted
+
+static inline void bench_count_allocation()
+{
+	if( g_atomic_int_get(&counting) && !benchAllocation )
+	{
+		g_atomic_int_inc(mainThread ? &mainAllocations : &halAllocations);
+	}
+}
+
+void* malloc(size_t size)
+{
+	bench_count_allocation();
+	return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size)
+{
+	bench_count_allocation();
+	return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size)
+{
+	bench_count_allocation();
+	return __libc_realloc(ptr, size);
+}
+
+struct bench
+{
+	guint taps; //To run
+	guint detected;
+	guint lost;
+	guint64 events;
+	guint64 latencyTotal;
+	guint64 latencyMax;
+	gboolean polling;
+	gboolean done;
+};
+typedef struct bench bench_t;
+
+static bench_t bench;
+
+static void bench_count_event()
+{
+	if( g_atomic_int_get(&counting) )
+	{
+		bench.events++;
+	}
+}
+
+static void on_mode_changed(hal_t* pHal, GObject* pAdapterObject, nfc_mode_t mode)
+{
+	bench_count_event();
+}
+
+static void on_polling_changed(hal_t* pHal, GObject* pAdapterObject, gboolean polling)
+{
+	bench_count_event();
+	bench.polling = polling;
+}
+
+static void on_tag_detected(hal_t* pHal, GObject* pAdapterObject, guint tagId)
+{
+	//Count from the first detection, once the HAL is up and running, which is not measured itself
+	bench.detected++;
+	if( bench.detected == 1 )
+	{
+		g_atomic_int_set(&counting, TRUE);
+		return;
+	}
+	bench.events++;
+
+	gint64 latency = hal_tag_get_timing(pHal, tagId, nfc_tag_timing_dispatched) - hal_tag_get_timing(pHal, tagId, nfc_tag_timing_posted);
+	bench.latencyTotal += latency;
+	if( (guint64)latency > bench.latencyMax )
+	{
+		bench.latencyMax = latency;
+	}
+}
+
+//The HAL ignores the request while it still considers the tag present, so retry until it polls again
+static gboolean bench_restart_polling(gpointer pData)
+{
+	if( bench.polling || bench.done )
+	{
+		return G_SOURCE_REMOVE;
+	}
+
+	hal_adapter_polling_loop_start((hal_t*)pData, nfc_mode_initiator);
+	return G_SOURCE_CONTINUE;
+}
+
+static void on_tag_lost(hal_t* pHal, GObject* pAdapterObject, guint tagId)
+{
+	bench_count_event();
+	bench.lost++;
+	if( bench.lost == bench.taps )
+	{
+		g_atomic_int_set(&counting, FALSE);
+		bench.done = TRUE;
+		return;
+	}
+
+	//Polling stops when a tag is found, resume it as the adapter does
+	benchAllocation = TRUE;
+	g_timeout_add(BENCH_RESTART_PERIOD, bench_restart_polling, pHal);
+	benchAllocation = FALSE;
+}
+
+static void on_device_event(hal_t* pHal, GObject* pAdapterObject, guint deviceId)
+{
+	bench_count_event();
+}
+
+static void on_provisioning_result(hal_t* pHal, GObject* pAdapterObject, const nfc_provisioning_result_t* pResult)
+{
+	bench_count_event();
+}
+
+int main(int argc, char** argv)
+{
+	gint taps = BENCH_DEFAULT_TAPS;
+	gint interval = BENCH_DEFAULT_INTERVAL;
+
+	GOptionEntry entries[] =
+	{
+		{ "taps", 't', 0, G_OPTION_ARG_INT, &taps, "Number of taps to simulate", "N" },
+		{ "interval", 'i', 0, G_OPTION_ARG_INT, &interval, "Milliseconds between two taps", "MS" },
+		{ NULL }
+	};
+
+	GError* pError = NULL;
+	GOptionContext* pContext = g_option_context_new("- measure HAL event dispatch");
+	g_option_context_add_main_entries(pContext, entries, NULL);
+	if( !g_option_context_parse(pContext, &argc, &argv, &pError) )
+	{
+		g_printerr("%s\r\n", pError->message);
+		g_error_free(pError);
+		g_option_context_free(pContext);
+		return 1;
+	}
+	g_option_context_free(pContext);
+
+	if( (taps < 2) || (interval <= BENCH_HOLD) )
+	{
+		g_printerr("At least 2 taps, more than %d ms apart\r\n", BENCH_HOLD);
+		return 1;
+	}
+
+	mainThread = TRUE;
+	memset(&bench, 0, sizeof(bench));
+	bench.taps = taps;
+
+	//One Type 2 tag carrying a URI, presented until enough taps were seen (slots missed while not polling are skipped)
+	gchar* scriptFile = g_build_filename(g_get_tmp_dir(), "explorenfc-bench.conf", NULL);
+	gchar* script = g_strdup_printf("[Simulator]\nInterval = %d\nHold = %d\nRepeat = 0\n\n"
+			"[Tag bench]\nType = 2\nUid = 04:A2:3B:12:5C:80:80\nNdef = D1010B5503676F6F676C652E636F6D\n",
+			interval, BENCH_HOLD);
+	if( !g_file_set_contents(scriptFile, script, -1, &pError) )
+	{
+		g_printerr("Could not write %s: %s\r\n", scriptFile, pError->message);
+		g_error_free(pError);
+		return 1;
+	}
+	g_free(script);
+
+	GMainContext* pMainContext = g_main_context_default();
+	GObject* pAdapterObject = g_object_new(G_TYPE_OBJECT, NULL);
+
+	hal_t* pHal = hal_impl_new();
+	if( (hal_impl_use_simulator(pHal, scriptFile) != 0) || (hal_impl_init(pHal, pMainContext) != 0) )
+	{
+		g_printerr("Could not start the simulated reader\r\n");
+		return 1;
+	}
+	hal_adapter_register(pHal, pAdapterObject, on_mode_changed, on_polling_changed, on_tag_detected, on_tag_lost,
+			on_device_event, on_device_event, on_device_event, on_provisioning_result);
+
+	hal_adapter_polling_loop_start(pHal, nfc_mode_initiator);
+	while( !bench.done )
+	{
+		g_main_context_iteration(pMainContext, TRUE);
+	}
+
+	hal_adapter_unregister(pHal, pAdapterObject);
+	hal_impl_free(pHal);
+	g_object_unref(pAdapterObject);
+	g_unlink(scriptFile);
+	g_free(scriptFile);
+
+	//The first detection is not counted
+	guint detections = bench.detected - 1;
+	g_printf("%u taps, %u measured, %" G_GUINT64_FORMAT " events\r\n", bench.taps, detections, bench.events);
+	g_printf("Detection dispatch latency: %.1f us average, %" G_GUINT64_FORMAT " us max\r\n",
+			(gdouble)bench.latencyTotal / detections, bench.latencyMax);
+	g_printf("Allocations per event: %.2f in the main thread, %.2f in the HAL thread\r\n",
+			(gdouble)mainAllocations / bench.events, (gdouble)halAllocations / bench.events);
+	g_printf("Allocations per tap: %.2f in the main thread, %.2f in the HAL thread\r\n",
+			(gdouble)mainAllocations / detections, (gdouble)halAllocations / detections);
+
+	return 0;
+}
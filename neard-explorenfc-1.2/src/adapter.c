@@ -18,12 +18,19 @@
 #include "record-container.h"
 #include "tag.h"
 #include "device.h"
+#include "ndef.h"
+#include "event-socket.h"
 
 #include <glib.h>
 #include <glib/gprintf.h>
 #include <gio/gio.h>
+#include <string.h>
 
 #define DEFAULT_POLLING_MODE nfc_mode_initiator
+#define STATISTICS_UPDATE_INTERVAL 1000 //Statistics property published at most once per interval (ms)
+
+//Statistics key prefixes, indexed by nfc_command_t
+static const gchar* commandNames[NFC_COMMAND_COUNT] = {"StartPollLoop", "StopPollLoop", "Write", "StartProvisioning", "StopProvisioning", "SetPowered"};
 
 #include "hal.h"
 
@@ -33,6 +40,9 @@ static void adapter_init(Adapter* pAdapter);
 static void adapter_dispose(GObject* pGObject);
 static void adapter_update_tag_list(Adapter* pAdapter);
 static void adapter_update_device_list(Adapter* pAdapter);
+static void adapter_update_statistics(Adapter* pAdapter);
+static void adapter_schedule_statistics(Adapter* pAdapter);
+static void adapter_update_status_page(Adapter* pAdapter);
 
 //GObject implementation
 G_DEFINE_TYPE (Adapter, adapter, G_TYPE_OBJECT)
@@ -55,11 +65,14 @@ void adapter_init(Adapter* pAdapter)
 	pAdapter->adapterId = 0;
 	pAdapter->objectPath = NULL;
 	pAdapter->pDaemon = NULL;
+	pAdapter->pHal = NULL;
 	pAdapter->pNeardAdapter = NULL;
 	pAdapter->pObjectSkeleton = NULL;
 
 	pAdapter->pTagTable = g_hash_table_new(g_direct_hash, g_direct_equal);
 	pAdapter->pDeviceTable = g_hash_table_new(g_direct_hash, g_direct_equal);
+	g_queue_init(&pAdapter->retainedTags);
+	pAdapter->pStatusPage = NULL;
 }
 
 void adapter_dispose(GObject* pGObject)
@@ -119,11 +132,149 @@ void adapter_update_device_list(Adapter* pAdapter)
 	neard_adapter_set_devices(pAdapter->pNeardAdapter, objectPaths);
 }
 
+void adapter_update_statistics(Adapter* pAdapter)
+{
+	nfc_statistics_t statistics;
+	hal_adapter_get_statistics(pAdapter->pHal, &statistics);
+
+	GVariantBuilder variantBld;
+	g_variant_builder_init(&variantBld, G_VARIANT_TYPE("a{st}"));
+
+	g_variant_builder_add(&variantBld, "{st}", "CacheHits", statistics.cacheHits);
+	g_variant_builder_add(&variantBld, "{st}", "CacheMisses", statistics.cacheMisses);
+	g_variant_builder_add(&variantBld, "{st}", "CacheEvictions", statistics.cacheEvictions);
+	g_variant_builder_add(&variantBld, "{st}", "CacheEntries", (guint64)statistics.cacheEntries);
+	g_variant_builder_add(&variantBld, "{st}", "EventsDispatched", statistics.eventsDispatched);
+	g_variant_builder_add(&variantBld, "{st}", "EventLatencyTotal", statistics.eventLatencyTotal);
+	g_variant_builder_add(&variantBld, "{st}", "EventLatencyMax", statistics.eventLatencyMax);
+	g_variant_builder_add(&variantBld, "{st}", "ProvisionedTags", statistics.provisionedTags);
+	g_variant_builder_add(&variantBld, "{st}", "ProvisioningFailures", statistics.provisioningFailures);
+	g_variant_builder_add(&variantBld, "{st}", "BytesWritten", statistics.bytesWritten);
+	g_variant_builder_add(&variantBld, "{st}", "BytesSent", statistics.bytesSent);
+	g_variant_builder_add(&variantBld, "{st}", "TagsLost", statistics.tagsLost);
+	g_variant_builder_add(&variantBld, "{st}", "PresenceChecks", statistics.presenceChecks);
+	g_variant_builder_add(&variantBld, "{st}", "LostLatencyTotal", statistics.lostLatencyTotal);
+	g_variant_builder_add(&variantBld, "{st}", "LostLatencyMax", statistics.lostLatencyMax);
+	g_variant_builder_add(&variantBld, "{st}", "Detections", statistics.detections);
+	g_variant_builder_add(&variantBld, "{st}", "PollCycles", statistics.pollCycles);
+	g_variant_builder_add(&variantBld, "{st}", "DetectionLatencyTotal", statistics.detectionLatencyTotal);
+	g_variant_builder_add(&variantBld, "{st}", "DetectionLatencyMax", statistics.detectionLatencyMax);
+	g_variant_builder_add(&variantBld, "{st}", "CpuTime", statistics.cpuTime);
+	for(guint i = 0; i < NFC_COMMAND_COUNT; i++)
+	{
+		gchar key[64];
+		g_snprintf(key, sizeof(key), "%sCommands", commandNames[i]);
+		g_variant_builder_add(&variantBld, "{st}", key, statistics.commands[i].count);
+		g_snprintf(key, sizeof(key), "%sLatencyTotal", commandNames[i]);
+		g_variant_builder_add(&variantBld, "{st}", key, statistics.commands[i].latencyTotal);
+		g_snprintf(key, sizeof(key), "%sLatencyMax", commandNames[i]);
+		g_variant_builder_add(&variantBld, "{st}", key, statistics.commands[i].latencyMax);
+	}
+	g_variant_builder_add(&variantBld, "{st}", "Preemptions", statistics.preemptions);
+
+	neard_adapter_set_statistics(pAdapter->pNeardAdapter, g_variant_builder_end(&variantBld));
+}
+
+//Rewritten as a whole, the page is small and changes at most a few times per tag
+static gboolean adapter_statistics_timeout(gpointer pUserData)
+{
+	Adapter* pAdapter = ADAPTER(pUserData);
+	pAdapter->statisticsSourceId = 0;
+	adapter_update_statistics(pAdapter);
+	return G_SOURCE_REMOVE;
+}
+
+//Counters move with every tag, each change would be a PropertiesChanged broadcast of the whole dictionary
+void adapter_schedule_statistics(Adapter* pAdapter)
+{
+	if(pAdapter->statisticsSourceId == 0)
+	{
+		pAdapter->statisticsSourceId = g_timeout_add(STATISTICS_UPDATE_INTERVAL, adapter_statistics_timeout, pAdapter);
+	}
+}
+
+void adapter_update_status_page(Adapter* pAdapter)
+{
+	if(pAdapter->pStatusPage == NULL)
+	{
+		return;
+	}
+
+	nfc_statistics_t statistics;
+	hal_adapter_get_statistics(pAdapter->pHal, &statistics);
+
+	status_page_data_t* pData = status_page_begin(pAdapter->pStatusPage);
+
+	pData->mode = hal_adapter_get_mode(pAdapter->pHal);
+	pData->polling = hal_adapter_is_polling(pAdapter->pHal) ? 1 : 0;
+	pData->powered = neard_adapter_get_powered(pAdapter->pNeardAdapter) ? 1 : 0;
+	pData->lastEvent = g_get_monotonic_time();
+
+	pData->detections = statistics.detections;
+	pData->tagsLost = statistics.tagsLost;
+	pData->pollCycles = statistics.pollCycles;
+	pData->presenceChecks = statistics.presenceChecks;
+	pData->eventsDispatched = statistics.eventsDispatched;
+	pData->cacheHits = statistics.cacheHits;
+	pData->cacheMisses = statistics.cacheMisses;
+	pData->detectionLatencyMax = statistics.detectionLatencyMax;
+	pData->cpuTime = statistics.cpuTime;
+
+	GHashTableIter iter;
+	gpointer pKey;
+	gpointer pValue;
+	guint count = 0;
+	g_hash_table_iter_init(&iter, pAdapter->pTagTable);
+	while(g_hash_table_iter_next(&iter, &pKey, &pValue))
+	{
+		Tag* pTag = (Tag*) pValue;
+		if(count < STATUS_PAGE_MAX_TAGS)
+		{
+			status_page_tag_t* pPageTag = &pData->tags[count];
+			memset(pPageTag, 0, sizeof(status_page_tag_t));
+			pPageTag->tagId = pTag->tagId;
+			pPageTag->type = pTag->pSnapshot->type;
+			pPageTag->uidLength = tag_get_uid(pTag, pPageTag->uid);
+		}
+		count++;
+	}
+	pData->tagCount = count;
+	if(count < STATUS_PAGE_MAX_TAGS)
+	{
+		memset(&pData->tags[count], 0, (STATUS_PAGE_MAX_TAGS - count) * sizeof(status_page_tag_t));
+	}
+
+	count = 0;
+	g_hash_table_iter_init(&iter, pAdapter->pDeviceTable);
+	while(g_hash_table_iter_next(&iter, &pKey, &pValue))
+	{
+		if(count < STATUS_PAGE_MAX_DEVICES)
+		{
+			pData->devices[count] = ((Device*) pValue)->deviceId;
+		}
+		count++;
+	}
+	pData->deviceCount = count;
+	for(guint i = count; i < STATUS_PAGE_MAX_DEVICES; i++)
+	{
+		pData->devices[i] = 0;
+	}
+
+	status_page_end(pAdapter->pStatusPage);
+}
+
 //DBUS commands handlers
 static gboolean on_start_polling_loop (NeardAdapter *pInterfaceSkeleton, GDBusMethodInvocation *pInvocation,
                 const gchar* mode, gpointer pUserData);
 static gboolean on_stop_polling_loop (NeardAdapter *pInterfaceSkeleton, GDBusMethodInvocation *pInvocation,
                 gpointer pUserData);
+static gboolean on_start_provisioning (NeardAdapter *pInterfaceSkeleton, GDBusMethodInvocation *pInvocation,
+                GVariant* options, gpointer pUserData);
+static gboolean on_stop_provisioning (NeardAdapter *pInterfaceSkeleton, GDBusMethodInvocation *pInvocation,
+                gpointer pUserData);
+static gboolean on_get_tag_snapshot (NeardAdapter *pInterfaceSkeleton, GDBusMethodInvocation *pInvocation,
+                const gchar* tag, gpointer pUserData);
+static void on_powered_changed (GObject* pObject, GParamSpec* pSpec, gpointer pUserData);
 
 //Callbacks from HAL
 static void adapter_hal_on_mode_changed_cb(hal_t* pHal, GObject* pAdapterObject, nfc_mode_t mode);
@@ -133,23 +284,24 @@ static void adapter_hal_on_tag_lost_cb(hal_t* pHal, GObject* pAdapterObject, gui
 static void adapter_hal_on_device_detected_cb(hal_t* pHal, GObject* pAdapterObject, guint deviceId);
 static void adapter_hal_on_device_ndef_received_cb(hal_t* pHal, GObject* pAdapterObject, guint deviceId);
 static void adapter_hal_on_device_lost_cb(hal_t* pHal, GObject* pAdapterObject, guint deviceId);
+static void adapter_hal_on_provisioning_result_cb(hal_t* pHal, GObject* pAdapterObject, const nfc_provisioning_result_t* pResult);
 
 static const gchar* adapterProtocols[] = {"Felica", "MIFARE", "Jewel", "ISO-DEP", "NFC-DEP", NULL};
 
-Adapter* adapter_new()
+Adapter* adapter_new(hal_t* pHal, guint adapterId)
 {
 	Adapter* pAdapter = g_object_new(TYPE_ADAPTER, NULL);
+	pAdapter->pHal = pHal;
+	pAdapter->adapterId = adapterId;
 	return pAdapter;
 }
 
-void adapter_register(Adapter* pAdapter, DBusDaemon* pDBusDaemon, guint adapterId)
+void adapter_register(Adapter* pAdapter, DBusDaemon* pDBusDaemon)
 {
 	pAdapter->pDaemon = pDBusDaemon;
 	g_object_ref(pDBusDaemon);
 
-	pAdapter->adapterId = adapterId;
-
-	pAdapter->objectPath = g_strdup_printf(DBUS_COMMON_OBJECT_PATH DBUS_ADAPTER_OBJECT_PATH, adapterId);
+	pAdapter->objectPath = g_strdup_printf(DBUS_COMMON_OBJECT_PATH DBUS_ADAPTER_OBJECT_PATH, pAdapter->adapterId);
 	g_info("Adapter at %s\n", pAdapter->objectPath);
 
 	pAdapter->pObjectSkeleton = neard_object_skeleton_new(pAdapter->objectPath);
@@ -161,6 +313,12 @@ void adapter_register(Adapter* pAdapter, DBusDaemon* pDBusDaemon, guint adapterI
 			G_CALLBACK (on_start_polling_loop), pAdapter);
 	g_signal_connect(pAdapter->pNeardAdapter, "handle-stop-poll-loop",
 				G_CALLBACK (on_stop_polling_loop), pAdapter);
+	g_signal_connect(pAdapter->pNeardAdapter, "handle-start-provisioning",
+				G_CALLBACK (on_start_provisioning), pAdapter);
+	g_signal_connect(pAdapter->pNeardAdapter, "handle-stop-provisioning",
+				G_CALLBACK (on_stop_provisioning), pAdapter);
+	g_signal_connect(pAdapter->pNeardAdapter, "handle-get-tag-snapshot",
+				G_CALLBACK (on_get_tag_snapshot), pAdapter);
 
 	//Set properties
     neard_adapter_set_name(pAdapter->pNeardAdapter, pAdapter->objectPath);
@@ -169,26 +327,95 @@ void adapter_register(Adapter* pAdapter, DBusDaemon* pDBusDaemon, guint adapterI
 	neard_adapter_set_powered(pAdapter->pNeardAdapter, TRUE);
 	neard_adapter_set_protocols(pAdapter->pNeardAdapter, adapterProtocols);
 	neard_adapter_set_tags(pAdapter->pNeardAdapter, NULL);
+	adapter_update_statistics(pAdapter);
+
+	//Powered is writable, watch for changes once set
+	g_signal_connect(pAdapter->pNeardAdapter, "notify::powered",
+				G_CALLBACK (on_powered_changed), pAdapter);
 
 	//Export
-	g_dbus_object_manager_server_export( pAdapter->pDaemon->pObjectManagerServer, G_DBUS_OBJECT_SKELETON(pAdapter->pObjectSkeleton) );
+	dbus_daemon_export( pAdapter->pDaemon, G_DBUS_OBJECT_SKELETON(pAdapter->pObjectSkeleton) );
 
 	//Register callbacks
-	hal_adapter_register(pAdapter->pDaemon->pHal, G_OBJECT(pAdapter),
+	hal_adapter_register(pAdapter->pHal, G_OBJECT(pAdapter),
 			adapter_hal_on_mode_changed_cb, adapter_hal_on_polling_changed_cb,
 			adapter_hal_on_tag_detected_cb, adapter_hal_on_tag_lost_cb,
-			adapter_hal_on_device_detected_cb, adapter_hal_on_device_ndef_received_cb, adapter_hal_on_device_lost_cb);
+			adapter_hal_on_device_detected_cb, adapter_hal_on_device_ndef_received_cb, adapter_hal_on_device_lost_cb,
+			adapter_hal_on_provisioning_result_cb);
+
+	if(pAdapter->pDaemon->statusPageDirectory != NULL)
+	{
+		gchar* path = g_strdup_printf("%s/nfc%u", pAdapter->pDaemon->statusPageDirectory, pAdapter->adapterId);
+		pAdapter->pStatusPage = status_page_new(path, pAdapter->adapterId);
+		g_free(path);
+		adapter_update_status_page(pAdapter);
+	}
 
 	if(pAdapter->pDaemon->constantPoll)
 	{
-		hal_adapter_polling_loop_start(pAdapter->pDaemon->pHal, DEFAULT_POLLING_MODE);
+		hal_adapter_polling_loop_start(pAdapter->pHal, DEFAULT_POLLING_MODE);
+	}
+}
+
+//Take a retained tag back, if there is one at that path
+static Tag* adapter_take_retained_tag(Adapter* pAdapter, const gchar* objectPath)
+{
+	for(GList* pItem = pAdapter->retainedTags.head; pItem != NULL; pItem = g_list_next(pItem))
+	{
+		Tag* pTag = (Tag*) pItem->data;
+		if( !g_strcmp0(RECORD_CONTAINER(pTag)->objectPath, objectPath) )
+		{
+			g_queue_delete_link(&pAdapter->retainedTags, pItem);
+			return pTag;
+		}
+	}
+
+	return NULL;
+}
+
+static void adapter_drop_retained_tag(Tag* pTag)
+{
+	tag_unregister(pTag);
+	g_object_unref(pTag);
+}
+
+Tag* adapter_lookup_tag(Adapter* pAdapter, const gchar* objectPath)
+{
+	GHashTableIter iter;
+	guint* pTagId;
+	Tag* pTag;
+
+	g_hash_table_iter_init (&iter, pAdapter->pTagTable);
+	while (g_hash_table_iter_next(&iter, (gpointer*)&pTagId, (gpointer*)&pTag))
+	{
+		if( !g_strcmp0(RECORD_CONTAINER(pTag)->objectPath, objectPath) )
+		{
+			return pTag;
+		}
 	}
+
+	return NULL;
 }
 
 void adapter_unregister(Adapter* pAdapter)
 {
+	//Nobody is left to report to
+	hal_adapter_provisioning_stop(pAdapter->pHal);
+
 	//Unregister callbacks
-	hal_adapter_unregister(pAdapter->pDaemon->pHal, G_OBJECT(pAdapter));
+	hal_adapter_unregister(pAdapter->pHal, G_OBJECT(pAdapter));
+
+	if(pAdapter->statisticsSourceId != 0)
+	{
+		g_source_remove(pAdapter->statisticsSourceId);
+		pAdapter->statisticsSourceId = 0;
+	}
+
+	if(pAdapter->pStatusPage != NULL)
+	{
+		status_page_free(pAdapter->pStatusPage);
+		pAdapter->pStatusPage = NULL;
+	}
 
 	//Remove all tags
 	//g_mutex_lock(&pAdapter->tagTableMutex);
@@ -200,6 +427,7 @@ void adapter_unregister(Adapter* pAdapter)
 	g_hash_table_iter_init (&iter, pAdapter->pTagTable);
 	while (g_hash_table_iter_next(&iter, (gpointer*)&pTagId, (gpointer*)&pTag))
 	{
+		dbus_daemon_notify_subscribers_lost(pAdapter->pDaemon, RECORD_CONTAINER(pTag)->objectPath);
 		tag_unregister(pTag);
 
 		//Remove from table
@@ -209,9 +437,16 @@ void adapter_unregister(Adapter* pAdapter)
 		g_object_unref(pTag);
 	}
 
+	//Tags which left earlier
+	Tag* pRetainedTag;
+	while( (pRetainedTag = g_queue_pop_head(&pAdapter->retainedTags)) != NULL )
+	{
+		adapter_drop_retained_tag(pRetainedTag);
+	}
+
 
 	//Disconnect signals
-	g_dbus_object_manager_server_unexport( pAdapter->pDaemon->pObjectManagerServer, pAdapter->objectPath );
+	dbus_daemon_unexport( pAdapter->pDaemon, pAdapter->objectPath );
 
 	g_object_unref(pAdapter->pNeardAdapter);
 	g_object_unref(pAdapter->pObjectSkeleton);
@@ -249,9 +484,15 @@ gboolean on_start_polling_loop (NeardAdapter *pInterfaceSkeleton, GDBusMethodInv
 		m = nfc_mode_initiator;
 	}
 
+	if( !neard_adapter_get_powered(pInterfaceSkeleton) )
+	{
+		g_dbus_method_invocation_return_dbus_error(pInvocation, DBUS_ERROR_NOT_READY, "Adapter is powered off");
+		return TRUE;
+	}
+
 	g_info("Start polling loop in %s mode\n", mode);
 
-	hal_adapter_polling_loop_start(pAdapter->pDaemon->pHal, m);
+	hal_adapter_polling_loop_start(pAdapter->pHal, m);
 
 	neard_adapter_complete_start_poll_loop(pInterfaceSkeleton, pInvocation);
 
@@ -265,13 +506,195 @@ gboolean on_stop_polling_loop (NeardAdapter *pInterfaceSkeleton, GDBusMethodInvo
 
 	g_info("Stop polling loop");
 
-	hal_adapter_polling_loop_stop(pAdapter->pDaemon->pHal);
+	hal_adapter_polling_loop_stop(pAdapter->pHal);
 
 	neard_adapter_complete_stop_poll_loop(pInterfaceSkeleton, pInvocation);
 
 	return TRUE;
 }
 
+//Provisioning template: string values of the record may contain {uid} and {seq}
+static gchar* adapter_provisioning_expand(const gchar* str, const gchar* uidStr, const gchar* seqStr)
+{
+	gchar** tokens = g_strsplit(str, "{uid}", -1);
+	gchar* tmp = g_strjoinv(uidStr, tokens);
+	g_strfreev(tokens);
+
+	tokens = g_strsplit(tmp, "{seq}", -1);
+	gchar* expanded = g_strjoinv(seqStr, tokens);
+	g_strfreev(tokens);
+	g_free(tmp);
+
+	return expanded;
+}
+
+//Called from the HAL thread, only touches the (immutable) template
+static GBytes* adapter_provisioning_render(const guint8* uid, gsize uidLength, guint64 sequence, gpointer pUserData)
+{
+	GVariant* pTemplate = (GVariant*) pUserData;
+
+	GString* uidStr = g_string_new(NULL);
+	for(gsize i = 0; i < uidLength; i++)
+	{
+		g_string_append_printf(uidStr, "%02X", uid[i]);
+	}
+	gchar* seqStr = g_strdup_printf("%" G_GUINT64_FORMAT, sequence);
+
+	GVariantBuilder variantBld;
+	g_variant_builder_init(&variantBld, G_VARIANT_TYPE("a{sv}"));
+
+	GVariantIter iter;
+	const gchar* key;
+	GVariant* pValue;
+	g_variant_iter_init(&iter, pTemplate);
+	while( g_variant_iter_next(&iter, "{&sv}", &key, &pValue) )
+	{
+		if( g_variant_is_of_type(pValue, G_VARIANT_TYPE_STRING) )
+		{
+			gchar* expanded = adapter_provisioning_expand(g_variant_get_string(pValue, NULL), uidStr->str, seqStr);
+			g_variant_builder_add(&variantBld, "{sv}", key, g_variant_new_take_string(expanded));
+		}
+		else
+		{
+			g_variant_builder_add(&variantBld, "{sv}", key, pValue);
+		}
+		g_variant_unref(pValue);
+	}
+
+	GVariant* pRecordVariant = g_variant_ref_sink(g_variant_builder_end(&variantBld));
+	g_string_free(uidStr, TRUE);
+	g_free(seqStr);
+
+	NdefRecord* pNdefRecord = ndef_record_from_dictionary(pRecordVariant);
+	g_variant_unref(pRecordVariant);
+	if( pNdefRecord == NULL )
+	{
+		return NULL;
+	}
+
+	//Create a 1-long list
+	GList* pList = g_list_append(NULL, pNdefRecord);
+
+	guint8* buffer = NULL;
+	gsize bufferLength = 0;
+	ndef_message_generate(pList, &buffer, &bufferLength);
+
+	g_list_free(pList);
+	g_object_unref(pNdefRecord);
+
+	if( buffer == NULL )
+	{
+		return NULL;
+	}
+
+	return g_bytes_new_take(buffer, bufferLength);
+}
+
+gboolean on_start_provisioning (NeardAdapter *pInterfaceSkeleton, GDBusMethodInvocation *pInvocation,
+                GVariant* options, gpointer pUserData)
+{
+	Adapter* pAdapter = ADAPTER(pUserData);
+
+	if( !neard_adapter_get_powered(pInterfaceSkeleton) )
+	{
+		g_dbus_method_invocation_return_dbus_error(pInvocation, DBUS_ERROR_NOT_READY, "Adapter is powered off");
+		return TRUE;
+	}
+
+	GVariant* pTemplate = g_variant_lookup_value(options, "Record", G_VARIANT_TYPE_VARDICT);
+	if( pTemplate == NULL )
+	{
+		g_dbus_method_invocation_return_dbus_error(pInvocation, DBUS_ERROR_INVALID_ARGUMENTS, "Missing record");
+		return TRUE;
+	}
+
+	nfc_provisioning_params_t params;
+	params.renderCb = adapter_provisioning_render;
+	params.pRenderData = pTemplate;
+	params.renderDataDestroy = (GDestroyNotify) g_variant_unref;
+	params.verify = TRUE;
+	params.lock = FALSE;
+	params.sequenceStart = 0;
+	g_variant_lookup(options, "Verify", "b", &params.verify);
+	g_variant_lookup(options, "Lock", "b", &params.lock);
+	g_variant_lookup(options, "SequenceStart", "t", &params.sequenceStart);
+
+	//Catch mistakes now rather than on every tag
+	const guint8 uid[7] = {0};
+	GBytes* pBytes = adapter_provisioning_render(uid, sizeof(uid), params.sequenceStart, pTemplate);
+	if( pBytes == NULL )
+	{
+		g_variant_unref(pTemplate);
+		g_dbus_method_invocation_return_dbus_error(pInvocation, DBUS_ERROR_INVALID_ARGUMENTS, "Invalid record");
+		return TRUE;
+	}
+	g_bytes_unref(pBytes);
+
+	//The HAL thread owns the template from now on
+	if( !hal_adapter_provisioning_start(pAdapter->pHal, &params) )
+	{
+		g_variant_unref(pTemplate);
+		g_dbus_method_invocation_return_dbus_error(pInvocation, DBUS_ERROR_IN_PROGRESS, "Too many pending operations");
+		return TRUE;
+	}
+
+	g_info("Start provisioning");
+
+	neard_adapter_complete_start_provisioning(pInterfaceSkeleton, pInvocation);
+
+	return TRUE;
+}
+
+gboolean on_stop_provisioning (NeardAdapter *pInterfaceSkeleton, GDBusMethodInvocation *pInvocation,
+                gpointer pUserData)
+{
+	Adapter* pAdapter = ADAPTER(pUserData);
+
+	g_info("Stop provisioning");
+
+	hal_adapter_provisioning_stop(pAdapter->pHal);
+
+	neard_adapter_complete_stop_provisioning(pInterfaceSkeleton, pInvocation);
+
+	return TRUE;
+}
+
+gboolean on_get_tag_snapshot (NeardAdapter *pInterfaceSkeleton, GDBusMethodInvocation *pInvocation,
+                const gchar* tag, gpointer pUserData)
+{
+	Adapter* pAdapter = ADAPTER(pUserData);
+
+	Tag* pTag = adapter_lookup_tag(pAdapter, tag);
+	if( pTag == NULL )
+	{
+		g_dbus_method_invocation_return_dbus_error(pInvocation, DBUS_ERROR_DOES_NOT_EXIST, "No such tag in the field");
+		return TRUE;
+	}
+
+	neard_adapter_complete_get_tag_snapshot(pInterfaceSkeleton, pInvocation, tag_get_snapshot_dictionary(pTag));
+
+	return TRUE;
+}
+
+void on_powered_changed (GObject* pObject, GParamSpec* pSpec, gpointer pUserData)
+{
+	Adapter* pAdapter = ADAPTER(pUserData);
+
+	gboolean powered = neard_adapter_get_powered(pAdapter->pNeardAdapter);
+
+	g_info("Power %s", powered?"on":"off");
+
+	//Polling stops with the RF field, and resumes only if it is constant
+	hal_adapter_set_powered(pAdapter->pHal, powered);
+	if( powered && pAdapter->pDaemon->constantPoll )
+	{
+		hal_adapter_polling_loop_start(pAdapter->pHal, DEFAULT_POLLING_MODE);
+	}
+
+	adapter_schedule_statistics(pAdapter);
+	adapter_update_status_page(pAdapter);
+}
+
 //Callbacks
 void adapter_hal_on_mode_changed_cb(hal_t* pHal, GObject* pAdapterObject, nfc_mode_t mode)
 {
@@ -292,25 +715,46 @@ void adapter_hal_on_mode_changed_cb(hal_t* pHal, GObject* pAdapterObject, nfc_mo
 		break;
 	}
 	neard_adapter_set_mode(pAdapter->pNeardAdapter, str);
+	adapter_update_status_page(pAdapter);
 }
 
 void adapter_hal_on_polling_changed_cb(hal_t* pHal, GObject* pAdapterObject, gboolean polling)
 {
 	Adapter* pAdapter = ADAPTER(pAdapterObject);
 	neard_adapter_set_polling(pAdapter->pNeardAdapter, polling);
+	adapter_update_status_page(pAdapter);
 }
 
 void adapter_hal_on_tag_detected_cb(hal_t* pHal, GObject* pAdapterObject, guint tagId)
 {
 	Adapter* pAdapter = ADAPTER(pAdapterObject);
 
-	//Instantiate and register a new tag
-	Tag* pTag = tag_new();
-
 	//Make sure we keep a reference to the HAL impl of tag
 	hal_tag_ref(pHal, tagId);
 
-	tag_register(pTag, pAdapter, tagId);
+	//Local listeners first, they do not wait for the D-Bus objects
+	if(pAdapter->pDaemon->pEventSocket != NULL)
+	{
+		const nfc_tag_snapshot_t* pSnapshot = hal_tag_get_snapshot(pHal, tagId);
+		event_socket_tag_found(pAdapter->pDaemon->pEventSocket, pAdapter->adapterId, pSnapshot);
+		hal_tag_snapshot_unref(pSnapshot);
+	}
+
+	//A tag seen recently comes back with its objects, otherwise instantiate and register a new tag
+	gboolean stablePath;
+	gchar* objectPath = tag_object_path_new(pAdapter, tagId, &stablePath);
+	Tag* pTag = stablePath ? adapter_take_retained_tag(pAdapter, objectPath) : NULL;
+	g_free(objectPath);
+
+	if(pTag != NULL)
+	{
+		tag_resume(pTag, tagId);
+	}
+	else
+	{
+		pTag = tag_new();
+		tag_register(pTag, pAdapter, tagId);
+	}
 
 	g_info("New tag %s", RECORD_CONTAINER(pTag)->objectPath);
 
@@ -320,10 +764,20 @@ void adapter_hal_on_tag_detected_cb(hal_t* pHal, GObject* pAdapterObject, guint
 	//g_mutex_unlock(&pAdapter->tagTableMutex);
 
 	adapter_update_tag_list(pAdapter);
+	adapter_schedule_statistics(pAdapter);
+	adapter_update_status_page(pAdapter);
 
 	//Send signal
 	//KLUDGE: NeardAL generates this signal internally (diverges from spec)
 	//neard_adapter_emit_tag_found(pAdapter->pNeardAdapter, RECORD_CONTAINER(pTag)->objectPath);
+
+	//Everything about the tag in one message, saves clients a round trip per record
+	GVariant* pSnapshot = g_variant_ref_sink(tag_get_snapshot_dictionary(pTag));
+	neard_adapter_emit_tag_read(pAdapter->pNeardAdapter, RECORD_CONTAINER(pTag)->objectPath, pSnapshot);
+
+	//Subscribers only get the tags they asked for
+	dbus_daemon_notify_subscribers(pAdapter->pDaemon, RECORD_CONTAINER(pTag)->objectPath, pSnapshot);
+	g_variant_unref(pSnapshot);
 }
 
 void adapter_hal_on_tag_lost_cb(hal_t* pHal, GObject* pAdapterObject, guint tagId)
@@ -336,7 +790,13 @@ void adapter_hal_on_tag_lost_cb(hal_t* pHal, GObject* pAdapterObject, guint tagI
 
 	g_hash_table_remove(pAdapter->pTagTable, GUINT_TO_POINTER(tagId));
 
+	if(pAdapter->pDaemon->pEventSocket != NULL)
+	{
+		event_socket_tag_lost(pAdapter->pDaemon->pEventSocket, pAdapter->adapterId, tagId);
+	}
+
 	adapter_update_tag_list(pAdapter);
+	adapter_update_status_page(pAdapter);
 
 	//KLUDGE: NeardAL generates this signal internally (diverges from spec)
 	//Send signal
@@ -344,18 +804,34 @@ void adapter_hal_on_tag_lost_cb(hal_t* pHal, GObject* pAdapterObject, guint tagI
 
 	g_info("Lost tag %s", RECORD_CONTAINER(pTag)->objectPath);
 
-	tag_unregister(pTag);
+	//Subscribers which were told about the tag are told it left
+	dbus_daemon_notify_subscribers_lost(pAdapter->pDaemon, RECORD_CONTAINER(pTag)->objectPath);
 
-	//Free tag
-	g_object_unref(pTag);
+	//Keep the objects of a tag with a stable path, in case it comes back
+	if( pTag->stablePath && (pAdapter->pDaemon->retainedTags > 0) )
+	{
+		tag_retain(pTag);
+		g_queue_push_tail(&pAdapter->retainedTags, pTag);
+		while( g_queue_get_length(&pAdapter->retainedTags) > pAdapter->pDaemon->retainedTags )
+		{
+			adapter_drop_retained_tag(g_queue_pop_head(&pAdapter->retainedTags));
+		}
+	}
+	else
+	{
+		tag_unregister(pTag);
+
+		//Free tag
+		g_object_unref(pTag);
+	}
 
 	//Deref HAL impl of tag
 	hal_tag_unref(pHal, tagId);
 
 	//Check if we should restart polling
-	if(pAdapter->pDaemon->constantPoll)
+	if(pAdapter->pDaemon->constantPoll && neard_adapter_get_powered(pAdapter->pNeardAdapter))
 	{
-		hal_adapter_polling_loop_start(pAdapter->pDaemon->pHal, DEFAULT_POLLING_MODE);//nfc_mode_initiator);
+		hal_adapter_polling_loop_start(pAdapter->pHal, DEFAULT_POLLING_MODE);//nfc_mode_initiator);
 		g_info("Restarting polling loop");
 	}
 }
@@ -370,6 +846,11 @@ void adapter_hal_on_device_detected_cb(hal_t* pHal, GObject* pAdapterObject, gui
 	//Make sure we keep a reference to the HAL impl of tag
 	hal_device_ref(pHal, deviceId);
 
+	if(pAdapter->pDaemon->pEventSocket != NULL)
+	{
+		event_socket_device_found(pAdapter->pDaemon->pEventSocket, pAdapter->adapterId, deviceId);
+	}
+
 	device_register(pDevice, pAdapter, deviceId);
 
 	g_info("New device %s", RECORD_CONTAINER(pDevice)->objectPath);
@@ -377,6 +858,7 @@ void adapter_hal_on_device_detected_cb(hal_t* pHal, GObject* pAdapterObject, gui
 	g_hash_table_insert(pAdapter->pDeviceTable, GUINT_TO_POINTER(pDevice->deviceId), pDevice);
 
 	adapter_update_tag_list(pAdapter);
+	adapter_update_status_page(pAdapter);
 
 	//Send signal
 	//KLUDGE: NeardAL generates this signal internally (diverges from spec)
@@ -391,6 +873,13 @@ void adapter_hal_on_device_ndef_received_cb(hal_t* pHal, GObject* pAdapterObject
 	Device* pDevice = g_hash_table_lookup(pAdapter->pDeviceTable, GUINT_TO_POINTER(deviceId));
 	g_assert_nonnull(pDevice);
 
+	if(pAdapter->pDaemon->pEventSocket != NULL)
+	{
+		const nfc_device_snapshot_t* pSnapshot = hal_device_get_snapshot(pHal, deviceId);
+		event_socket_device_ndef(pAdapter->pDaemon->pEventSocket, pAdapter->adapterId, pSnapshot);
+		hal_device_snapshot_unref(pSnapshot);
+	}
+
 	device_populate_records(pDevice);
 }
 
@@ -404,7 +893,13 @@ void adapter_hal_on_device_lost_cb(hal_t* pHal, GObject* pAdapterObject, guint d
 
 	g_hash_table_remove(pAdapter->pDeviceTable, GUINT_TO_POINTER(deviceId));
 
+	if(pAdapter->pDaemon->pEventSocket != NULL)
+	{
+		event_socket_device_lost(pAdapter->pDaemon->pEventSocket, pAdapter->adapterId, deviceId);
+	}
+
 	adapter_update_device_list(pAdapter);
+	adapter_update_status_page(pAdapter);
 
 	//KLUDGE: NeardAL generates this signal internally (diverges from spec)
 	//Send signal
@@ -421,9 +916,64 @@ void adapter_hal_on_device_lost_cb(hal_t* pHal, GObject* pAdapterObject, guint d
 	hal_device_unref(pHal, deviceId);
 	//Check if we should restart polling
 
-	if(pAdapter->pDaemon->constantPoll)
+	if(pAdapter->pDaemon->constantPoll && neard_adapter_get_powered(pAdapter->pNeardAdapter))
 	{
-		hal_adapter_polling_loop_start(pAdapter->pDaemon->pHal, DEFAULT_POLLING_MODE);
+		hal_adapter_polling_loop_start(pAdapter->pHal, DEFAULT_POLLING_MODE);
 		g_info("Restarting polling loop");
 	}
 }
+
+void adapter_hal_on_provisioning_result_cb(hal_t* pHal, GObject* pAdapterObject, const nfc_provisioning_result_t* pResult)
+{
+	Adapter* pAdapter = ADAPTER(pAdapterObject);
+
+	const gchar* result;
+	switch(pResult->result)
+	{
+	case nfc_tag_write_success:
+		result = "Success";
+		break;
+	case nfc_tag_write_not_connected:
+		result = "NotConnected";
+		break;
+	case nfc_tag_write_read_only:
+		result = "ReadOnly";
+		break;
+	case nfc_tag_write_verify_failed:
+		result = "VerifyFailed";
+		break;
+	case nfc_tag_write_busy:
+		result = "Busy";
+		break;
+	case nfc_tag_write_lock_failed:
+		result = "LockFailed";
+		break;
+	case nfc_tag_write_failed:
+	default:
+		result = "Failed";
+		break;
+	}
+
+	gdouble tagsPerMinute = 0;
+	if( pResult->elapsed > 0 )
+	{
+		tagsPerMinute = (gdouble)pResult->provisioned * 60e6 / (gdouble)pResult->elapsed;
+	}
+
+	GVariantBuilder variantBld;
+	g_variant_builder_init(&variantBld, G_VARIANT_TYPE("a{sv}"));
+	g_variant_builder_add(&variantBld, "{sv}", "Uid", g_variant_new_fixed_array(G_VARIANT_TYPE_BYTE,
+			pResult->uid, pResult->uidLength, sizeof(guint8)));
+	g_variant_builder_add(&variantBld, "{sv}", "Sequence", g_variant_new_uint64(pResult->sequence));
+	g_variant_builder_add(&variantBld, "{sv}", "Result", g_variant_new_string(result));
+	g_variant_builder_add(&variantBld, "{sv}", "Duration", g_variant_new_uint64(pResult->duration));
+	g_variant_builder_add(&variantBld, "{sv}", "BytesSent", g_variant_new_uint64(pResult->bytesSent));
+	g_variant_builder_add(&variantBld, "{sv}", "Provisioned", g_variant_new_uint64(pResult->provisioned));
+	g_variant_builder_add(&variantBld, "{sv}", "TagsPerMinute", g_variant_new_double(tagsPerMinute));
+
+	neard_adapter_emit_provisioning_result(pAdapter->pNeardAdapter, g_variant_builder_end(&variantBld));
+
+	adapter_schedule_statistics(pAdapter);
+
+	g_info("Tag %" G_GUINT64_FORMAT " provisioned: %s (%" G_GINT64_FORMAT " us)", pResult->sequence, result, pResult->duration);
+}
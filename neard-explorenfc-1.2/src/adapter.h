@@ -28,10 +28,15 @@
 #include <gio/gio.h>
 
 #include "generated-code.h"
+#include "hal.h"
+#include "status-page.h"
 
 struct dbus_daemon;
 typedef struct dbus_daemon DBusDaemon;
 
+struct tag;
+typedef struct tag Tag;
+
 #define TYPE_ADAPTER   (adapter_get_type               ())
 #define ADAPTER(obj)   (G_TYPE_CHECK_INSTANCE_CAST ((obj), TYPE_ADAPTER, Adapter))
 #define ADAPTER_CLASS(cls)     (G_TYPE_CHECK_CLASS_CAST    ((cls), TYPE_ADAPTER, AdapterClass))
@@ -44,6 +49,7 @@ struct adapter
 {
 	GObject parentInstance; ///< GObject instance
 	DBusDaemon* pDaemon; ///< Reference to containing DBusDaemon
+	hal_t* pHal; ///< HAL driving this adapter's reader
 
 	guint adapterId; ///< Adapter ID
 	NeardObjectSkeleton* pObjectSkeleton; ///< DBUS Object Skeleton
@@ -52,6 +58,9 @@ struct adapter
 
 	GHashTable* pTagTable; ///< Table of tags
 	GHashTable* pDeviceTable; ///< Table of devices
+	GQueue retainedTags; ///< Tags which left the field but keep their records, oldest first
+	status_page_t* pStatusPage; ///< Status page, NULL if not published
+	guint statisticsSourceId; ///< Pending update of the Statistics property, 0 if none
 };
 typedef struct adapter Adapter; ///< Adapter
 
@@ -62,7 +71,7 @@ struct adapter_class
 {
 	GObjectClass parentClass; ///< Parent GObjectClass
 
-	void (*adapter_register)(Adapter* pAdapter, DBusDaemon* pDBusDaemon, guint adapterId); ///< Register method
+	void (*adapter_register)(Adapter* pAdapter, DBusDaemon* pDBusDaemon); ///< Register method
 	void (*adapter_unregister)(Adapter* pAdapter); ///< Unregister method
 };
 typedef struct adapter_class AdapterClass; ///< Adapter class
@@ -80,16 +89,24 @@ enum adapter_mode
 typedef enum adapter_mode adapter_mode_t; ///< Adapter mode
 
 /** Create a new Adapter instance
+ * \param pHal hal_t instance driving the adapter's reader
+ * \param adapterId id to give the adapter (object path will be /org/neard/nfc[adapterId])
  * \return new Adapter instance
  */
-Adapter* adapter_new();
+Adapter* adapter_new(hal_t* pHal, guint adapterId);
 
 /** Register the adapter on the following DBusDaemon
  * \param pAdapter Adapter to register
  * \param pDBusDaemon DBusDaemon on which to register
- * \param adapterId id to give the adapter (object path will be /org/neard/nfc[adapterId])
  */
-void adapter_register(Adapter* pAdapter, DBusDaemon* pDBusDaemon, guint adapterId);
+void adapter_register(Adapter* pAdapter, DBusDaemon* pDBusDaemon);
+
+/** Find one of the adapter's tags by object path
+ * \param pAdapter Adapter to search
+ * \param objectPath object path of the tag
+ * \return Tag instance (not referenced), NULL if none
+ */
+Tag* adapter_lookup_tag(Adapter* pAdapter, const gchar* objectPath);
 
 /** Unregister the adapter from DBusDaemon
  * \param pAdapter Adapter to unregister
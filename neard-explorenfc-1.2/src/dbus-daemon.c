@@ -17,22 +17,25 @@
 #include "dbus-parameters.h"
 #include "ndef.h"
 #include "handover-agent.h"
+#include "tag.h"
 
 #include <glib.h>
+#include <glib/gstdio.h>
 #include <gio/gio.h>
 #include "string.h"
 
-#define ADAPTER_ID 0 //For now, only one adapter
-
 //Local functions prototypes
 static void dbus_daemon_class_init (DBusDaemonClass* pDBusDaemonClass);
 static void dbus_daemon_init(DBusDaemon* pDBusDaemon);
 static void dbus_daemon_dispose(GObject* pGObject);
-static void dbus_daemon_start(DBusDaemon* pDBusDaemon, hal_t* pHal);
+static void dbus_daemon_start(DBusDaemon* pDBusDaemon, hal_t** ppHals, const guint* adapterIds, guint adapterCount);
 
 static void on_bus_acquired (GDBusConnection* pConnection, const gchar* name, gpointer user_data);
 static void on_name_acquired (GDBusConnection* pConnection, const gchar* name, gpointer user_data);
 static void on_name_lost (GDBusConnection* pConnection, const gchar* name, gpointer user_data);
+static GDBusMessage* dbus_daemon_records_filter(GDBusConnection* pConnection, GDBusMessage* pMessage, gboolean incoming, gpointer user_data);
+static void dbus_daemon_server_start(DBusDaemon* pDBusDaemon);
+static void dbus_daemon_server_stop(DBusDaemon* pDBusDaemon);
 
 //GObject implementation
 G_DEFINE_TYPE(DBusDaemon, dbus_daemon, G_TYPE_OBJECT)
@@ -51,10 +54,20 @@ void dbus_daemon_class_init (DBusDaemonClass* pDBusDaemonClass)
 
 void dbus_daemon_init(DBusDaemon* pDBusDaemon)
 {
-	pDBusDaemon->pHal = NULL;
 	pDBusDaemon->pObjectManagerServer = NULL;
 
 	pDBusDaemon->constantPoll = FALSE;
+	pDBusDaemon->lazyRecords = FALSE;
+	pDBusDaemon->uidObjectPaths = FALSE;
+	pDBusDaemon->retainedTags = 0;
+	pDBusDaemon->recordsFilterId = 0;
+	pDBusDaemon->pEventSocket = NULL;
+	pDBusDaemon->statusPageDirectory = NULL;
+	pDBusDaemon->peerSocketPath = NULL;
+	pDBusDaemon->pServer = NULL;
+	pDBusDaemon->pPeers = NULL;
+	pDBusDaemon->pSubscriptions = NULL;
+	pDBusDaemon->nextSubscriptionId = 1;
 
 	pDBusDaemon->pNeardManager = NULL;
 	pDBusDaemon->pManagerObjectSkeleton = NULL;
@@ -63,7 +76,7 @@ void dbus_daemon_init(DBusDaemon* pDBusDaemon)
 	pDBusDaemon->pAgentManagerObjectSkeleton = NULL;
 
 	pDBusDaemon->ownerId = 0;
-	pDBusDaemon->pAdapter = NULL;
+	pDBusDaemon->pAdapters = g_ptr_array_new_with_free_func(g_object_unref);
 	pDBusDaemon->pAgentTable = g_hash_table_new(g_direct_hash, g_direct_equal);
 	pDBusDaemon->pConnection = NULL;
 
@@ -79,9 +92,19 @@ void dbus_daemon_dispose(GObject* pGObject)
 		g_bus_unown_name(pDBusDaemon->ownerId);
 		pDBusDaemon->ownerId = 0;
 	}
+	if(pDBusDaemon->recordsFilterId != 0)
+	{
+		g_dbus_connection_remove_filter(pDBusDaemon->pConnection, pDBusDaemon->recordsFilterId);
+		pDBusDaemon->recordsFilterId = 0;
+	}
+	dbus_daemon_server_stop(pDBusDaemon);
+	g_list_free_full(pDBusDaemon->pSubscriptions, (GDestroyNotify)subscription_free);
+	pDBusDaemon->pSubscriptions = NULL;
+	g_free(pDBusDaemon->peerSocketPath);
+	pDBusDaemon->peerSocketPath = NULL;
 	g_clear_object(&pDBusDaemon->pObjectManagerServer);
 	g_clear_object(&pDBusDaemon->pConnection);
-	g_clear_object(&pDBusDaemon->pAdapter);
+	g_clear_pointer(&pDBusDaemon->pAdapters, g_ptr_array_unref);
 	g_hash_table_destroy(pDBusDaemon->pAgentTable);
 	g_clear_object(&pDBusDaemon->pNeardManager);
 	g_clear_object(&pDBusDaemon->pManagerObjectSkeleton);
@@ -89,6 +112,8 @@ void dbus_daemon_dispose(GObject* pGObject)
 	g_clear_object(&pDBusDaemon->pAgentManagerObjectSkeleton);
 	g_main_loop_unref(pDBusDaemon->pMainLoop);
 	pDBusDaemon->pMainLoop = NULL;
+	g_free(pDBusDaemon->statusPageDirectory);
+	pDBusDaemon->statusPageDirectory = NULL;
 	G_OBJECT_CLASS (dbus_daemon_parent_class)->dispose(pGObject);
 }
 
@@ -115,14 +140,18 @@ static gboolean on_register_handover_agent (NeardManager *pInterfaceSkeleton, GD
 				const gchar *objectPath, const gchar* type, gpointer pUserData);
 static gboolean on_unregister_handover_agent (NeardManager *pInterfaceSkeleton, GDBusMethodInvocation *pInvocation,
 				const gchar *objectPath, const gchar* type, gpointer pUserData);
+static gboolean on_subscribe (NeardManager *pInterfaceSkeleton, GDBusMethodInvocation *pInvocation,
+				GVariant* pFilter, gpointer pUserData);
+static gboolean on_unsubscribe (NeardManager *pInterfaceSkeleton, GDBusMethodInvocation *pInvocation,
+				guint subscriptionId, gpointer pUserData);
 
 //Constructor shortcut
-DBusDaemon* dbus_daemon_new(hal_t* pHal, GMainLoop* pMainLoop)
+DBusDaemon* dbus_daemon_new(hal_t** ppHals, const guint* adapterIds, guint adapterCount, GMainLoop* pMainLoop)
 {
 	DBusDaemon* pDBusDaemon = g_object_new(TYPE_DBUS_DAEMON, NULL);
 	pDBusDaemon->pMainLoop = pMainLoop;
 	g_main_loop_ref(pDBusDaemon->pMainLoop);
-	dbus_daemon_start(pDBusDaemon, pHal);
+	dbus_daemon_start(pDBusDaemon, ppHals, adapterIds, adapterCount);
 	return pDBusDaemon;
 }
 
@@ -138,17 +167,29 @@ struct _GDBusObjectManagerServerPrivate
   guint manager_reg_id;
 };
 
-//Methods
-void dbus_daemon_start(DBusDaemon* pDBusDaemon, hal_t* pHal)
+//The manager at / also reports the objects right under it
+static GDBusObjectManagerServer* dbus_daemon_object_manager_new()
 {
-	pDBusDaemon->pHal = pHal;
+	GDBusObjectManagerServer* pObjectManagerServer = g_dbus_object_manager_server_new(DBUS_ROOT_OBJECT_PATH);
 
-	pDBusDaemon->pObjectManagerServer = g_dbus_object_manager_server_new(DBUS_ROOT_OBJECT_PATH);
+	g_mutex_lock (&pObjectManagerServer->priv->lock);
+	g_free(pObjectManagerServer->priv->object_path_ending_in_slash);
+	pObjectManagerServer->priv->object_path_ending_in_slash = g_strdup_printf(DBUS_ROOT_OBJECT_PATH);
+    g_mutex_unlock (&pObjectManagerServer->priv->lock);
 
-	g_mutex_lock (&pDBusDaemon->pObjectManagerServer->priv->lock);
-	g_free(pDBusDaemon->pObjectManagerServer->priv->object_path_ending_in_slash);
-	pDBusDaemon->pObjectManagerServer->priv->object_path_ending_in_slash = g_strdup_printf(DBUS_ROOT_OBJECT_PATH);
-    g_mutex_unlock (&pDBusDaemon->pObjectManagerServer->priv->lock);
+	return pObjectManagerServer;
+}
+
+//Methods
+void dbus_daemon_start(DBusDaemon* pDBusDaemon, hal_t** ppHals, const guint* adapterIds, guint adapterCount)
+{
+	//Adapters are only registered once the bus is acquired
+	for(guint i = 0; i < adapterCount; i++)
+	{
+		g_ptr_array_add(pDBusDaemon->pAdapters, adapter_new(ppHals[i], adapterIds[i]));
+	}
+
+	pDBusDaemon->pObjectManagerServer = dbus_daemon_object_manager_new();
 
 	pDBusDaemon->ownerId = g_bus_own_name(
 			G_BUS_TYPE_SYSTEM,
@@ -184,6 +225,220 @@ void dbus_daemon_set_constant_poll(DBusDaemon* pDBusDaemon, gboolean constantPol
 	pDBusDaemon->constantPoll = constantPoll;
 }
 
+void dbus_daemon_set_lazy_records(DBusDaemon* pDBusDaemon, gboolean lazyRecords)
+{
+	pDBusDaemon->lazyRecords = lazyRecords;
+}
+
+void dbus_daemon_set_object_paths(DBusDaemon* pDBusDaemon, gboolean uidObjectPaths, guint retainedTags)
+{
+	pDBusDaemon->uidObjectPaths = uidObjectPaths;
+	pDBusDaemon->retainedTags = uidObjectPaths ? retainedTags : 0;
+}
+
+void dbus_daemon_set_event_socket(DBusDaemon* pDBusDaemon, event_socket_t* pEventSocket)
+{
+	pDBusDaemon->pEventSocket = pEventSocket;
+}
+
+void dbus_daemon_set_status_page_directory(DBusDaemon* pDBusDaemon, const gchar* directory)
+{
+	g_free(pDBusDaemon->statusPageDirectory);
+	pDBusDaemon->statusPageDirectory = g_strdup(directory);
+}
+
+void dbus_daemon_set_peer_socket(DBusDaemon* pDBusDaemon, const gchar* path)
+{
+	g_free(pDBusDaemon->peerSocketPath);
+	pDBusDaemon->peerSocketPath = g_strdup(path);
+}
+
+//Direct connection, served by its own object manager which shares the bus' skeletons
+struct dbus_daemon_peer
+{
+	DBusDaemon* pDBusDaemon;
+	GDBusConnection* pConnection;
+	GDBusObjectManagerServer* pObjectManagerServer;
+	guint recordsFilterId;
+};
+typedef struct dbus_daemon_peer dbus_daemon_peer_t;
+
+void dbus_daemon_export(DBusDaemon* pDBusDaemon, GDBusObjectSkeleton* pObjectSkeleton)
+{
+	g_dbus_object_manager_server_export(pDBusDaemon->pObjectManagerServer, pObjectSkeleton);
+
+	//Skeletons emit their signals on every connection they are exported on
+	for(GList* pItem = pDBusDaemon->pPeers; pItem != NULL; pItem = g_list_next(pItem))
+	{
+		g_dbus_object_manager_server_export(((dbus_daemon_peer_t*) pItem->data)->pObjectManagerServer, pObjectSkeleton);
+	}
+}
+
+void dbus_daemon_unexport(DBusDaemon* pDBusDaemon, const gchar* objectPath)
+{
+	g_dbus_object_manager_server_unexport(pDBusDaemon->pObjectManagerServer, objectPath);
+
+	for(GList* pItem = pDBusDaemon->pPeers; pItem != NULL; pItem = g_list_next(pItem))
+	{
+		g_dbus_object_manager_server_unexport(((dbus_daemon_peer_t*) pItem->data)->pObjectManagerServer, objectPath);
+	}
+}
+
+//Subscriptions end with the connection or bus name of their subscriber
+static void dbus_daemon_drop_subscriptions(DBusDaemon* pDBusDaemon, GDBusConnection* pConnection, const gchar* sender)
+{
+	GList* pItem = pDBusDaemon->pSubscriptions;
+	while(pItem != NULL)
+	{
+		GList* pNext = g_list_next(pItem);
+		subscription_t* pSubscription = (subscription_t*) pItem->data;
+		if( (pSubscription->pConnection == pConnection) && ((sender == NULL) || !g_strcmp0(pSubscription->sender, sender)) )
+		{
+			pDBusDaemon->pSubscriptions = g_list_delete_link(pDBusDaemon->pSubscriptions, pItem);
+			subscription_free(pSubscription);
+		}
+		pItem = pNext;
+	}
+}
+
+static void dbus_daemon_on_subscriber_vanished(GDBusConnection* pConnection, const gchar* name, gpointer pUserData)
+{
+	g_debug("Subscriber %s vanished", name);
+	dbus_daemon_drop_subscriptions(DBUS_DAEMON(pUserData), pConnection, name);
+}
+
+void dbus_daemon_notify_subscribers(DBusDaemon* pDBusDaemon, const gchar* objectPath, GVariant* pSnapshot)
+{
+	for(GList* pItem = pDBusDaemon->pSubscriptions; pItem != NULL; pItem = g_list_next(pItem))
+	{
+		subscription_t* pSubscription = (subscription_t*) pItem->data;
+		if( subscription_match(pSubscription, pSnapshot) )
+		{
+			subscription_notify(pSubscription, objectPath, pSnapshot);
+		}
+	}
+}
+
+void dbus_daemon_notify_subscribers_lost(DBusDaemon* pDBusDaemon, const gchar* objectPath)
+{
+	for(GList* pItem = pDBusDaemon->pSubscriptions; pItem != NULL; pItem = g_list_next(pItem))
+	{
+		subscription_notify_unmatched((subscription_t*) pItem->data, objectPath);
+	}
+}
+
+static void dbus_daemon_peer_free(dbus_daemon_peer_t* pPeer)
+{
+	DBusDaemon* pDBusDaemon = pPeer->pDBusDaemon;
+	pDBusDaemon->pPeers = g_list_remove(pDBusDaemon->pPeers, pPeer);
+
+	dbus_daemon_drop_subscriptions(pDBusDaemon, pPeer->pConnection, NULL);
+
+	g_signal_handlers_disconnect_by_data(pPeer->pConnection, pPeer);
+	if(pPeer->recordsFilterId != 0)
+	{
+		g_dbus_connection_remove_filter(pPeer->pConnection, pPeer->recordsFilterId);
+	}
+
+	//Unexports the objects from this connection only
+	g_dbus_object_manager_server_set_connection(pPeer->pObjectManagerServer, NULL);
+	g_object_unref(pPeer->pObjectManagerServer);
+
+	g_dbus_connection_close(pPeer->pConnection, NULL, NULL, NULL);
+	g_object_unref(pPeer->pConnection);
+	g_free(pPeer);
+}
+
+static void dbus_daemon_on_peer_closed(GDBusConnection* pConnection, gboolean remotePeerVanished, GError* pError, gpointer pUserData)
+{
+	g_debug("Peer disconnected");
+	dbus_daemon_peer_free((dbus_daemon_peer_t*) pUserData);
+}
+
+static gboolean dbus_daemon_on_new_connection(GDBusServer* pServer, GDBusConnection* pConnection, gpointer pUserData)
+{
+	DBusDaemon* pDBusDaemon = DBUS_DAEMON(pUserData);
+
+	dbus_daemon_peer_t* pPeer = g_malloc(sizeof(dbus_daemon_peer_t));
+	pPeer->pDBusDaemon = pDBusDaemon;
+	pPeer->pConnection = g_object_ref(pConnection);
+	pPeer->pObjectManagerServer = dbus_daemon_object_manager_new();
+	pPeer->recordsFilterId = 0;
+
+	//Same tree as on the bus
+	GList* pObjects = g_dbus_object_manager_get_objects(G_DBUS_OBJECT_MANAGER(pDBusDaemon->pObjectManagerServer));
+	for(GList* pItem = pObjects; pItem != NULL; pItem = g_list_next(pItem))
+	{
+		g_dbus_object_manager_server_export(pPeer->pObjectManagerServer, G_DBUS_OBJECT_SKELETON(pItem->data));
+	}
+	g_list_free_full(pObjects, g_object_unref);
+	g_dbus_object_manager_server_set_connection(pPeer->pObjectManagerServer, pConnection);
+
+	if(pDBusDaemon->lazyRecords)
+	{
+		pPeer->recordsFilterId = g_dbus_connection_add_filter(pConnection, dbus_daemon_records_filter, pDBusDaemon, NULL);
+	}
+
+	g_signal_connect(pConnection, "closed", G_CALLBACK(dbus_daemon_on_peer_closed), pPeer);
+	pDBusDaemon->pPeers = g_list_prepend(pDBusDaemon->pPeers, pPeer);
+
+	g_debug("Peer connected");
+
+	return TRUE;
+}
+
+void dbus_daemon_server_start(DBusDaemon* pDBusDaemon)
+{
+	if(pDBusDaemon->peerSocketPath == NULL)
+	{
+		return;
+	}
+
+	//Left over by a previous instance
+	gchar* dir = g_path_get_dirname(pDBusDaemon->peerSocketPath);
+	g_mkdir_with_parents(dir, 0755);
+	g_free(dir);
+	g_unlink(pDBusDaemon->peerSocketPath);
+
+	gchar* escapedPath = g_dbus_address_escape_value(pDBusDaemon->peerSocketPath);
+	gchar* address = g_strdup_printf("unix:path=%s", escapedPath);
+	gchar* guid = g_dbus_generate_guid();
+	GError* pError = NULL;
+	pDBusDaemon->pServer = g_dbus_server_new_sync(address, G_DBUS_SERVER_FLAGS_NONE, guid, NULL, NULL, &pError);
+	g_free(guid);
+	g_free(address);
+	g_free(escapedPath);
+
+	if(pDBusDaemon->pServer == NULL)
+	{
+		g_warning("Could not listen for peers on %s: %s", pDBusDaemon->peerSocketPath, pError->message);
+		g_error_free(pError);
+		return;
+	}
+
+	g_signal_connect(pDBusDaemon->pServer, "new-connection", G_CALLBACK(dbus_daemon_on_new_connection), pDBusDaemon);
+	g_dbus_server_start(pDBusDaemon->pServer);
+
+	g_info("Serving peers on %s", pDBusDaemon->peerSocketPath);
+}
+
+void dbus_daemon_server_stop(DBusDaemon* pDBusDaemon)
+{
+	if(pDBusDaemon->pServer == NULL)
+	{
+		return;
+	}
+
+	g_dbus_server_stop(pDBusDaemon->pServer);
+	g_clear_object(&pDBusDaemon->pServer);
+	g_unlink(pDBusDaemon->peerSocketPath);
+
+	while(pDBusDaemon->pPeers != NULL)
+	{
+		dbus_daemon_peer_free((dbus_daemon_peer_t*) pDBusDaemon->pPeers->data);
+	}
+}
+
 //Local functions
 void on_bus_acquired (GDBusConnection* pConnection, const gchar* name, gpointer user_data)
 {
@@ -204,8 +459,10 @@ void on_bus_acquired (GDBusConnection* pConnection, const gchar* name, gpointer
 	neard_object_skeleton_set_agent_manager(pDBusDaemon->pAgentManagerObjectSkeleton, pDBusDaemon->pNeardAgentManager);
 
 	//Register objects
-	pDBusDaemon->pAdapter = adapter_new();
-	adapter_register(pDBusDaemon->pAdapter, pDBusDaemon, ADAPTER_ID);
+	for(guint i = 0; i < pDBusDaemon->pAdapters->len; i++)
+	{
+		adapter_register(g_ptr_array_index(pDBusDaemon->pAdapters, i), pDBusDaemon);
+	}
 
 	//Connect signals
 	g_signal_connect(pDBusDaemon->pNeardManager, "handle-register-handover-agent",
@@ -213,19 +470,38 @@ void on_bus_acquired (GDBusConnection* pConnection, const gchar* name, gpointer
 	g_signal_connect(pDBusDaemon->pNeardManager, "handle-unregister-handover-agent",
 				G_CALLBACK (on_unregister_handover_agent), pDBusDaemon);
 
+	g_signal_connect(pDBusDaemon->pNeardManager, "handle-subscribe",
+			G_CALLBACK (on_subscribe), pDBusDaemon);
+	g_signal_connect(pDBusDaemon->pNeardManager, "handle-unsubscribe",
+			G_CALLBACK (on_unsubscribe), pDBusDaemon);
+
 	g_signal_connect(pDBusDaemon->pNeardAgentManager, "handle-register-handover-agent",
 			G_CALLBACK (on_register_handover_agent), pDBusDaemon);
 	g_signal_connect(pDBusDaemon->pNeardAgentManager, "handle-unregister-handover-agent",
 				G_CALLBACK (on_unregister_handover_agent), pDBusDaemon);
 
 	//Set properties
-	const char* adapters[] = { g_strdup(pDBusDaemon->pAdapter->objectPath), NULL };
+	const gchar** adapters = g_new0(const gchar*, pDBusDaemon->pAdapters->len + 1);
+	for(guint i = 0; i < pDBusDaemon->pAdapters->len; i++)
+	{
+		adapters[i] = ((Adapter*)g_ptr_array_index(pDBusDaemon->pAdapters, i))->objectPath;
+	}
 	neard_manager_set_adapters(pDBusDaemon->pNeardManager, adapters);
+	g_free(adapters);
 
 	//Export objects
 	g_dbus_object_manager_server_export( pDBusDaemon->pObjectManagerServer, G_DBUS_OBJECT_SKELETON(pDBusDaemon->pManagerObjectSkeleton) );
 	g_dbus_object_manager_server_export( pDBusDaemon->pObjectManagerServer, G_DBUS_OBJECT_SKELETON(pDBusDaemon->pAgentManagerObjectSkeleton) );
 	g_dbus_object_manager_server_set_connection(pDBusDaemon->pObjectManagerServer, pConnection);
+
+	//Records of new tags are exported on first access
+	if(pDBusDaemon->lazyRecords)
+	{
+		pDBusDaemon->recordsFilterId = g_dbus_connection_add_filter(pConnection, dbus_daemon_records_filter, pDBusDaemon, NULL);
+	}
+
+	//Peers get the tree once it is complete
+	dbus_daemon_server_start(pDBusDaemon);
 }
 
 void on_name_acquired (GDBusConnection* pConnection, const gchar* name, gpointer user_data)
@@ -240,11 +516,20 @@ void on_name_lost (GDBusConnection* pConnection, const gchar* name, gpointer use
 	//If pConnection == NULL it means we could not obtain the name, otherwise we lost an existing connection
 	if(pConnection != NULL)
 	{
+		//Peers go first, they only mirror the bus
+		dbus_daemon_server_stop(pDBusDaemon);
+
+		g_list_free_full(pDBusDaemon->pSubscriptions, (GDestroyNotify)subscription_free);
+		pDBusDaemon->pSubscriptions = NULL;
+
 		//Unregister objects
-		adapter_unregister(pDBusDaemon->pAdapter);
+		for(guint i = 0; i < pDBusDaemon->pAdapters->len; i++)
+		{
+			adapter_unregister(g_ptr_array_index(pDBusDaemon->pAdapters, i));
+		}
 
-		//Delete adapter
-		g_clear_object(&pDBusDaemon->pAdapter);
+		//Delete adapters
+		g_ptr_array_set_size(pDBusDaemon->pAdapters, 0);
 
 		//Delete handover agents (if present)
 		GHashTableIter iter;
@@ -273,6 +558,11 @@ void on_name_lost (GDBusConnection* pConnection, const gchar* name, gpointer use
 		g_clear_object(&pDBusDaemon->pAgentManagerObjectSkeleton);
 
 		//Lose connection details
+		if(pDBusDaemon->recordsFilterId != 0)
+		{
+			g_dbus_connection_remove_filter(pDBusDaemon->pConnection, pDBusDaemon->recordsFilterId);
+			pDBusDaemon->recordsFilterId = 0;
+		}
 		g_clear_object(&pDBusDaemon->pConnection);
 	}
 	else
@@ -285,6 +575,87 @@ void on_name_lost (GDBusConnection* pConnection, const gchar* name, gpointer use
 	g_main_loop_quit(pDBusDaemon->pMainLoop);
 }
 
+//Access to the records of a tag, handled in the main loop
+struct dbus_daemon_records_access
+{
+	DBusDaemon* pDBusDaemon;
+	gchar* objectPath;
+};
+typedef struct dbus_daemon_records_access dbus_daemon_records_access_t;
+
+static gboolean dbus_daemon_on_records_access(gpointer pUserData)
+{
+	dbus_daemon_records_access_t* pAccess = (dbus_daemon_records_access_t*) pUserData;
+
+	if(pAccess->pDBusDaemon->pAdapters != NULL)
+	{
+		for(guint i = 0; i < pAccess->pDBusDaemon->pAdapters->len; i++)
+		{
+			Tag* pTag = adapter_lookup_tag(g_ptr_array_index(pAccess->pDBusDaemon->pAdapters, i), pAccess->objectPath);
+			if(pTag != NULL)
+			{
+				tag_export_records(pTag);
+				break;
+			}
+		}
+	}
+
+	g_object_unref(pAccess->pDBusDaemon);
+	g_free(pAccess->objectPath);
+	g_free(pAccess);
+
+	return G_SOURCE_REMOVE;
+}
+
+//Runs in GDBus' worker thread, before the call is dispatched to the main loop
+GDBusMessage* dbus_daemon_records_filter(GDBusConnection* pConnection, GDBusMessage* pMessage, gboolean incoming, gpointer user_data)
+{
+	if( !incoming || (g_dbus_message_get_message_type(pMessage) != G_DBUS_MESSAGE_TYPE_METHOD_CALL) )
+	{
+		return pMessage;
+	}
+
+	const gchar* objectPath = g_dbus_message_get_path(pMessage);
+	const gchar* interface = g_dbus_message_get_interface(pMessage);
+	const gchar* member = g_dbus_message_get_member(pMessage);
+	if( (objectPath == NULL) || !g_str_has_prefix(objectPath, DBUS_COMMON_OBJECT_PATH "/") )
+	{
+		return pMessage;
+	}
+
+	//Reading the tag's properties or introspecting it gives the records away
+	gboolean access = FALSE;
+	if( !g_strcmp0(interface, "org.freedesktop.DBus.Properties") && (!g_strcmp0(member, "Get") || !g_strcmp0(member, "GetAll")) )
+	{
+		GVariant* pBody = g_dbus_message_get_body(pMessage);
+		const gchar* propertiesInterface = NULL;
+		if( (pBody != NULL) && (g_variant_n_children(pBody) > 0) )
+		{
+			g_variant_get_child(pBody, 0, "&s", &propertiesInterface);
+		}
+		access = !g_strcmp0(propertiesInterface, "org.neard.Tag");
+	}
+	else if( !g_strcmp0(interface, "org.freedesktop.DBus.Introspectable") )
+	{
+		access = TRUE;
+	}
+
+	if(access)
+	{
+		//The call itself is dispatched to the main loop after this, by which time the records are there
+		dbus_daemon_records_access_t* pAccess = g_malloc(sizeof(dbus_daemon_records_access_t));
+		pAccess->pDBusDaemon = g_object_ref(DBUS_DAEMON(user_data));
+		pAccess->objectPath = g_strdup(objectPath);
+		GSource* pSource = g_idle_source_new();
+		g_source_set_priority(pSource, G_PRIORITY_DEFAULT);
+		g_source_set_callback(pSource, dbus_daemon_on_records_access, pAccess, NULL);
+		g_source_attach(pSource, g_main_loop_get_context(pAccess->pDBusDaemon->pMainLoop));
+		g_source_unref(pSource);
+	}
+
+	return pMessage;
+}
+
 gboolean on_register_handover_agent (NeardManager *pInterfaceSkeleton, GDBusMethodInvocation *pInvocation,
 				const gchar *objectPath, const gchar* type, gpointer pUserData)
 {
@@ -292,6 +663,13 @@ gboolean on_register_handover_agent (NeardManager *pInterfaceSkeleton, GDBusMeth
 
 	g_info("Agent (%s) at %s", type, objectPath);
 
+	//Agents are called back over the bus
+	if(g_dbus_method_invocation_get_connection(pInvocation) != pDBusDaemon->pConnection)
+	{
+		g_dbus_method_invocation_return_dbus_error(pInvocation, DBUS_ERROR_NOT_SUPPORTED, "Agents must register over the system bus");
+		return TRUE;
+	}
+
 	const gchar* sender = g_dbus_method_invocation_get_sender(pInvocation);
 
 	handover_agent_type_t handoverAgentType;
@@ -378,3 +756,61 @@ gboolean on_unregister_handover_agent (NeardManager *pInterfaceSkeleton, GDBusMe
 
 	return TRUE;
 }
+
+gboolean on_subscribe (NeardManager *pInterfaceSkeleton, GDBusMethodInvocation *pInvocation,
+				GVariant* pFilter, gpointer pUserData)
+{
+	DBusDaemon* pDBusDaemon = DBUS_DAEMON(pUserData);
+
+	GDBusConnection* pConnection = g_dbus_method_invocation_get_connection(pInvocation);
+	const gchar* sender = g_dbus_method_invocation_get_sender(pInvocation);
+
+	subscription_t* pSubscription = subscription_new(pDBusDaemon->nextSubscriptionId, pConnection, sender, pFilter);
+	if( pSubscription == NULL )
+	{
+		g_dbus_method_invocation_return_dbus_error(pInvocation, DBUS_ERROR_INVALID_ARGUMENTS, "Invalid filter");
+		return TRUE;
+	}
+	pDBusDaemon->nextSubscriptionId++;
+
+	//Direct peers are dropped with their connection
+	if( sender != NULL )
+	{
+		pSubscription->watchId = g_bus_watch_name_on_connection(pConnection, sender, G_BUS_NAME_WATCHER_FLAGS_NONE,
+				NULL, dbus_daemon_on_subscriber_vanished, pDBusDaemon, NULL);
+	}
+
+	pDBusDaemon->pSubscriptions = g_list_append(pDBusDaemon->pSubscriptions, pSubscription);
+
+	g_info("Subscription %u for %s", pSubscription->id, (sender != NULL) ? sender : "peer");
+
+	neard_manager_complete_subscribe(pInterfaceSkeleton, pInvocation, pSubscription->id);
+
+	return TRUE;
+}
+
+gboolean on_unsubscribe (NeardManager *pInterfaceSkeleton, GDBusMethodInvocation *pInvocation,
+				guint subscriptionId, gpointer pUserData)
+{
+	DBusDaemon* pDBusDaemon = DBUS_DAEMON(pUserData);
+
+	GDBusConnection* pConnection = g_dbus_method_invocation_get_connection(pInvocation);
+	const gchar* sender = g_dbus_method_invocation_get_sender(pInvocation);
+
+	//Only the subscriber can cancel its subscriptions
+	for(GList* pItem = pDBusDaemon->pSubscriptions; pItem != NULL; pItem = g_list_next(pItem))
+	{
+		subscription_t* pSubscription = (subscription_t*) pItem->data;
+		if( (pSubscription->id == subscriptionId) && (pSubscription->pConnection == pConnection)
+				&& !g_strcmp0(pSubscription->sender, sender) )
+		{
+			pDBusDaemon->pSubscriptions = g_list_delete_link(pDBusDaemon->pSubscriptions, pItem);
+			subscription_free(pSubscription);
+			neard_manager_complete_unsubscribe(pInterfaceSkeleton, pInvocation);
+			return TRUE;
+		}
+	}
+
+	g_dbus_method_invocation_return_dbus_error(pInvocation, DBUS_ERROR_DOES_NOT_EXIST, "No such subscription");
+	return TRUE;
+}
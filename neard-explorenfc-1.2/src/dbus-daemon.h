@@ -28,6 +28,8 @@
 #include "adapter.h"
 #include "handover-agent.h"
 #include "hal.h"
+#include "event-socket.h"
+#include "subscription.h"
 
 #include "generated-code.h"
 
@@ -53,6 +55,17 @@ struct dbus_daemon
 	GDBusObjectManagerServer* pObjectManagerServer; ///< DBus Object manager
 
 	gboolean constantPoll; ///< Constant poll parameter
+	gboolean lazyRecords; ///< Lazy records parameter
+	gboolean uidObjectPaths; ///< Tag object paths derived from UIDs
+	guint retainedTags; ///< Number of tags which keep their objects once lost, per adapter
+	guint recordsFilterId; ///< Filter catching the first access to records, 0 if not installed
+	event_socket_t* pEventSocket; ///< Local event stream, NULL if disabled
+	gchar* statusPageDirectory; ///< Directory of the adapters' status pages, NULL if not published
+	gchar* peerSocketPath; ///< Unix socket on which peers connect directly, NULL if disabled
+	GDBusServer* pServer; ///< Server accepting direct connections, NULL if not running
+	GList* pPeers; ///< Direct connections, each served by its own object manager
+	GList* pSubscriptions; ///< Subscriptions set with Manager.Subscribe (subscription_t)
+	guint nextSubscriptionId; ///< ID of the next subscription
 
 	//Manager (at /)
 	NeardObjectSkeleton* pManagerObjectSkeleton; ///< Manager (/): DBus Object Skeleton
@@ -63,12 +76,9 @@ struct dbus_daemon
 	NeardAgentManager* pNeardAgentManager; ///< Agent manager (/org/neard/): DBus manager interface
 
 	//Modules
-	Adapter* pAdapter; ///< Reference Adapter
+	GPtrArray* pAdapters; ///< Adapters, one per reader
 	GHashTable* pAgentTable; ///< Table of Handover agents
 
-	//Pointer to hal
-	hal_t* pHal; ///< Reference to HAL
-
 	//Pointer to GMainLoop*
 	GMainLoop* pMainLoop;
 };
@@ -81,7 +91,7 @@ struct dbus_daemon_class
 {
 	GObjectClass parentClass; ///< Parent GObjectClass
 
-	void (*dbus_daemon_start)(DBusDaemon* pDBusDaemon, hal_t* pHal); ///< Start method
+	void (*dbus_daemon_start)(DBusDaemon* pDBusDaemon, hal_t** ppHals, const guint* adapterIds, guint adapterCount); ///< Start method
 };
 typedef struct dbus_daemon_class DBusDaemonClass; ///< DBus Daemon class
 
@@ -91,12 +101,14 @@ typedef struct dbus_daemon_class DBusDaemonClass; ///< DBus Daemon class
 GType dbus_daemon_get_type (void);
 
 /** Create a new DBusDaemon instance
- * Try to get ownership of bus, set reference to HAL - if fails the instance will be destroyed
- * \param pHal hal_t instance
+ * Try to get ownership of bus, create one adapter per HAL - if fails the instance will be destroyed
+ * \param ppHals hal_t instances, one per reader
+ * \param adapterIds id of the adapter driven by each HAL (object path will be /org/neard/nfc[adapterId])
+ * \param adapterCount number of HALs
  * \param pMainLoop main loop on which this daemon is running
  * \return new DBusDaemon instance
  */
-DBusDaemon* dbus_daemon_new(hal_t* pHal, GMainLoop* pMainLoop);
+DBusDaemon* dbus_daemon_new(hal_t** ppHals, const guint* adapterIds, guint adapterCount, GMainLoop* pMainLoop);
 
 /** Set constant poll
  * Set whether polling should be restarted when a tag/device is lost
@@ -105,6 +117,71 @@ DBusDaemon* dbus_daemon_new(hal_t* pHal, GMainLoop* pMainLoop);
  */
 void dbus_daemon_set_constant_poll(DBusDaemon* pDBusDaemon, gboolean constantPoll);
 
+/** Set lazy records
+ * Set whether the records of a tag are only exported when a client first accesses them
+ * Must be called before the main loop runs
+ * \param pDBusDaemon DBus Daemon instance
+ * \param lazyRecords TRUE to enable, FALSE to disable
+ */
+void dbus_daemon_set_lazy_records(DBusDaemon* pDBusDaemon, gboolean lazyRecords);
+
+/** Set object paths scheme
+ * Must be called before the main loop runs
+ * \param pDBusDaemon DBus Daemon instance
+ * \param uidObjectPaths TRUE to derive tag object paths from UIDs, FALSE to use ids
+ * \param retainedTags with UID-derived paths, number of lost tags which keep their objects per adapter, so that they can be reused if the tags come back
+ */
+void dbus_daemon_set_object_paths(DBusDaemon* pDBusDaemon, gboolean uidObjectPaths, guint retainedTags);
+
+/** Set event socket
+ * Tag and device events are also streamed to local clients of this socket
+ * \param pDBusDaemon DBus Daemon instance
+ * \param pEventSocket event socket (owned by the caller, must outlive the daemon), NULL to disable
+ */
+void dbus_daemon_set_event_socket(DBusDaemon* pDBusDaemon, event_socket_t* pEventSocket);
+
+/** Set status page directory
+ * Each adapter publishes its state in [directory]/nfc[adapterId]
+ * Must be called before the main loop runs
+ * \param pDBusDaemon DBus Daemon instance
+ * \param directory directory of the status pages (on a tmpfs such as /run), NULL to disable
+ */
+void dbus_daemon_set_status_page_directory(DBusDaemon* pDBusDaemon, const gchar* directory);
+
+/** Set peer-to-peer socket
+ * The object tree is also served to clients connecting directly to this socket, without
+ * going through the bus. Access is only restricted by the socket's file permissions.
+ * Must be called before the main loop runs
+ * \param pDBusDaemon DBus Daemon instance
+ * \param path path of the Unix socket, NULL to disable
+ */
+void dbus_daemon_set_peer_socket(DBusDaemon* pDBusDaemon, const gchar* path);
+
+/** Export an object on the bus and to direct peers
+ * \param pDBusDaemon DBus Daemon instance
+ * \param pObjectSkeleton object to export
+ */
+void dbus_daemon_export(DBusDaemon* pDBusDaemon, GDBusObjectSkeleton* pObjectSkeleton);
+
+/** Stop exporting an object
+ * \param pDBusDaemon DBus Daemon instance
+ * \param objectPath object path of the object
+ */
+void dbus_daemon_unexport(DBusDaemon* pDBusDaemon, const gchar* objectPath);
+
+/** Signal a tag to the subscribers whose filter it matches
+ * \param pDBusDaemon DBus Daemon instance
+ * \param objectPath object path of the tag
+ * \param pSnapshot snapshot of the tag, as carried by the TagRead signal
+ */
+void dbus_daemon_notify_subscribers(DBusDaemon* pDBusDaemon, const gchar* objectPath, GVariant* pSnapshot);
+
+/** Signal a lost tag to the subscribers it was signalled to
+ * \param pDBusDaemon DBus Daemon instance
+ * \param objectPath object path of the tag
+ */
+void dbus_daemon_notify_subscribers_lost(DBusDaemon* pDBusDaemon, const gchar* objectPath);
+
 /** Check NDEF record and pass it to agents if appropriate
  * \param pDBusDaemon DBus Daemon instance
  * \param pNdefRecord record to check
@@ -23,10 +23,15 @@
 #define DBUS_ADAPTER_OBJECT_PATH "/nfc%d"
 #define DBUS_DEVICE_OBJECT_PATH "/device%d"
 #define DBUS_TAG_OBJECT_PATH "/tag%d"
+#define DBUS_TAG_UID_OBJECT_PATH "/tag_" //Followed by the UID in hexadecimal
 #define DBUS_RECORD_OBJECT_PATH "/record%d"
 
 #define DBUS_ADAPTER_INTERFACE_NAME "org.neard.Adapter"
 #define DBUS_TAG_INTERFACE_NAME "org.neard.Tag"
+#define DBUS_MANAGER_INTERFACE_NAME "org.neard.Manager"
+
+#define DBUS_MANAGER_SIGNAL_TAG_MATCHED "TagMatched"
+#define DBUS_MANAGER_SIGNAL_TAG_UNMATCHED "TagUnmatched"
 
 #define DBUS_ADAPTER_METHOD_START_POLLING_LOOP "StartPollLoop"
 #define DBUS_ADAPTER_METHOD_STOP_POLLING_LOOP "StopPollLoop"
@@ -37,5 +42,11 @@
 #define DBUS_ADAPTER_PROPERTY_PROTOCOLS		"Protocols"
 
 #define DBUS_ERROR_NOT_SUPPORTED "org.neard.Error.NotSupported"
+#define DBUS_ERROR_FAILED "org.neard.Error.Failed"
+#define DBUS_ERROR_INVALID_ARGUMENTS "org.neard.Error.InvalidArguments"
+#define DBUS_ERROR_PERMISSION_DENIED "org.neard.Error.PermissionDenied"
+#define DBUS_ERROR_DOES_NOT_EXIST "org.neard.Error.DoesNotExist"
+#define DBUS_ERROR_IN_PROGRESS "org.neard.Error.InProgress"
+#define DBUS_ERROR_NOT_READY "org.neard.Error.NotReady"
 
 #endif /* DBUS_PARAMETERS_H_ */
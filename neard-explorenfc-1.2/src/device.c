@@ -107,20 +107,23 @@ void device_register(Device* pDevice, Adapter* pAdapter, guint deviceId)
 	neard_device_set_adapter(pDevice->pNeardDevice, pAdapter->objectPath);
 
 	//Export
-	g_dbus_object_manager_server_export( RECORD_CONTAINER(pDevice)->pAdapter->pDaemon->pObjectManagerServer, G_DBUS_OBJECT_SKELETON(pDevice->pObjectSkeleton) );
+	dbus_daemon_export( RECORD_CONTAINER(pDevice)->pAdapter->pDaemon, G_DBUS_OBJECT_SKELETON(pDevice->pObjectSkeleton) );
 }
 
 void device_populate_records(Device* pDevice)
 {
 	//Get NDEF
-	guint8* buffer = NULL;
-	gsize bufferLength = 0;
-	hal_device_get_ndef(RECORD_CONTAINER(pDevice)->pAdapter->pDaemon->pHal, pDevice->deviceId, &buffer, &bufferLength);
+	const nfc_device_snapshot_t* pSnapshot = hal_device_get_snapshot(RECORD_CONTAINER(pDevice)->pAdapter->pHal, pDevice->deviceId);
 
-	if(buffer != NULL)
+	if(pSnapshot->pNdef != NULL)
 	{
-		GList* pList = ndef_message_parse(buffer, bufferLength);
-		pDevice->pRawNDEF = g_bytes_new_take(buffer, bufferLength); //buffer is now owned by pRawNDEF
+		if( pDevice->pRawNDEF != NULL )
+		{
+			g_bytes_unref(pDevice->pRawNDEF);
+		}
+		//Same buffer as the HAL's, records and RawNDEF share it
+		pDevice->pRawNDEF = g_bytes_ref(pSnapshot->pNdef);
+		GList* pList = ndef_message_parse(pDevice->pRawNDEF);
 		gsize length = g_list_length(pList);
 
 		const gchar* objectPaths[length + 1];
@@ -158,11 +161,13 @@ void device_populate_records(Device* pDevice)
 
 		neard_device_set_records(pDevice->pNeardDevice, objectPaths);
 	}
+
+	hal_device_snapshot_unref(pSnapshot);
 }
 
 void device_unregister(Device* pDevice)
 {
-	g_dbus_object_manager_server_unexport( RECORD_CONTAINER(pDevice)->pAdapter->pDaemon->pObjectManagerServer, RECORD_CONTAINER(pDevice)->objectPath );
+	dbus_daemon_unexport( RECORD_CONTAINER(pDevice)->pAdapter->pDaemon, RECORD_CONTAINER(pDevice)->objectPath );
 
 	GHashTableIter iter;
 	guint* pRecordId;
@@ -215,7 +220,7 @@ gboolean on_push (NeardDevice *pInterfaceSkeleton, GDBusMethodInvocation *pInvoc
 	guint8* buffer = NULL;
 	gsize bufferLength = 0;
 	ndef_message_generate(pList, &buffer, &bufferLength);
-	hal_device_push_ndef(RECORD_CONTAINER(pDevice)->pAdapter->pDaemon->pHal, pDevice->deviceId, buffer, bufferLength);
+	hal_device_push_ndef(RECORD_CONTAINER(pDevice)->pAdapter->pHal, pDevice->deviceId, buffer, bufferLength);
 
 	g_list_free(pList);
 
@@ -248,7 +253,7 @@ gboolean on_get_raw_ndef (NeardDevice *pInterfaceSkeleton, GDBusMethodInvocation
 
 	neard_device_complete_get_raw_ndef(pInterfaceSkeleton, pInvocation, pNdefVariant);
 
-	g_object_unref(pNdefVariant);
+	//The floating variant was consumed by the reply, which references pRawNDEF without copying it
 	g_bytes_unref(pRawNDEF);
 
 	return TRUE;
@@ -0,0 +1,514 @@
+/*
+*         Copyright (c), NXP Semiconductors Gratkorn / Austria
+*
+*                     (C)NXP Semiconductors
+*       All rights are reserved. Reproduction in whole or in part is
+*      prohibited without the written consent of the copyright owner.
+*  NXP reserves the right to make changes without notice at any time.
+* NXP makes no warranty, expressed, implied or statutory, including but
+* not limited to any implied warranty of merchantability or fitness for any
+*particular purpose, or that the use will not infringe any third party patent,
+* copyright or trademark. NXP must not be liable for any loss or damage
+*                          arising from its use.
+*/
+/**
+ * \file event-socket.c
+ * Local event stream: events are framed once and sent to every interested client without
+ * blocking, straight from the adapter callbacks
+ */
+
+#include "event-socket.h"
+#include "ndef.h"
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <gio/gio.h>
+#include <gio/gunixsocketaddress.h>
+#include <string.h>
+
+#define EVENT_SOCKET_RECEIVE_SIZE 256
+#define EVENT_SOCKET_MAX_UID_LENGTH 10
+
+//Key of a tag or device in the table of found events sent to a client
+#define EVENT_SOCKET_KEY(device, adapterId, id) GUINT_TO_POINTER( ((device) ? 0x80000000u : 0) | (((adapterId) & 0x7FFF) << 16) | ((id) & 0xFFFF) )
+
+struct event_socket_client
+{
+	event_socket_t* pEventSocket;
+	GSocket* pSocket;
+	GSource* pSource;
+
+	//Filters
+	guint32 events; //Mask of 1 << event_socket_event_t
+	guint32 recordTypes; //Mask of 1 << ndef_record_type_t, 0 for any
+	GPtrArray* pUids; //GBytes, empty for any
+
+	GHashTable* pFound; //Tags and devices whose found event was sent
+	guint32 dropped; //Packets dropped since the last one sent
+};
+typedef struct event_socket_client event_socket_client_t;
+
+struct event_socket
+{
+	gchar* path;
+	GSocket* pSocket;
+	GSource* pSource;
+	GList* pClients;
+};
+
+//What found events are filtered on
+struct event_socket_match
+{
+	const guint8* uid;
+	gsize uidLength;
+	guint32 recordTypes; //Mask of 1 << ndef_record_type_t
+};
+typedef struct event_socket_match event_socket_match_t;
+
+static void event_socket_client_free(event_socket_client_t* pClient)
+{
+	pClient->pEventSocket->pClients = g_list_remove(pClient->pEventSocket->pClients, pClient);
+
+	g_source_destroy(pClient->pSource);
+	g_source_unref(pClient->pSource);
+	g_socket_close(pClient->pSocket, NULL);
+	g_object_unref(pClient->pSocket);
+	g_ptr_array_unref(pClient->pUids);
+	g_hash_table_destroy(pClient->pFound);
+	g_free(pClient);
+}
+
+static void event_socket_client_subscribe(event_socket_client_t* pClient, const guint8* data, gsize length)
+{
+	event_socket_header_t header;
+	if( length < sizeof(header) )
+	{
+		return;
+	}
+	memcpy(&header, data, sizeof(header));
+	if( (header.version != EVENT_SOCKET_VERSION) || (header.event != event_socket_event_subscribe) )
+	{
+		g_debug("Ignoring unknown request from event socket client");
+		return;
+	}
+
+	//Filters are replaced as a whole
+	pClient->events = G_MAXUINT32;
+	pClient->recordTypes = 0;
+	g_ptr_array_set_size(pClient->pUids, 0);
+
+	gsize offset = sizeof(header);
+	while( offset + sizeof(event_socket_field_t) <= length )
+	{
+		event_socket_field_t field;
+		memcpy(&field, data + offset, sizeof(field));
+		offset += sizeof(field);
+		if( offset + field.length > length )
+		{
+			break;
+		}
+		const guint8* value = data + offset;
+		offset += field.length;
+
+		switch(field.type)
+		{
+		case event_socket_field_events:
+			if( field.length == sizeof(guint32) )
+			{
+				memcpy(&pClient->events, value, sizeof(guint32));
+			}
+			break;
+		case event_socket_field_record_type:
+			if( (field.length == 1) && (value[0] < 32) )
+			{
+				pClient->recordTypes |= 1u << value[0];
+			}
+			break;
+		case event_socket_field_uid:
+			if( (field.length > 0) && (field.length <= EVENT_SOCKET_MAX_UID_LENGTH) )
+			{
+				g_ptr_array_add(pClient->pUids, g_bytes_new(value, field.length));
+			}
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+static gboolean event_socket_on_client_io(GSocket* pSocket, GIOCondition condition, gpointer pUserData)
+{
+	event_socket_client_t* pClient = (event_socket_client_t*) pUserData;
+
+	if( condition & G_IO_IN )
+	{
+		guint8 buffer[EVENT_SOCKET_RECEIVE_SIZE];
+		gssize length = g_socket_receive(pSocket, (gchar*)buffer, sizeof(buffer), NULL, NULL);
+		if( length > 0 )
+		{
+			event_socket_client_subscribe(pClient, buffer, length);
+			return G_SOURCE_CONTINUE;
+		}
+	}
+
+	//Closed or failed
+	g_debug("Event socket client disconnected");
+	event_socket_client_free(pClient);
+	return G_SOURCE_REMOVE;
+}
+
+static gboolean event_socket_on_accept(GSocket* pSocket, GIOCondition condition, gpointer pUserData)
+{
+	event_socket_t* pEventSocket = (event_socket_t*) pUserData;
+
+	GSocket* pClientSocket = g_socket_accept(pSocket, NULL, NULL);
+	if( pClientSocket == NULL )
+	{
+		return G_SOURCE_CONTINUE;
+	}
+
+	//Events are dropped rather than waiting for a slow client
+	g_socket_set_blocking(pClientSocket, FALSE);
+
+	event_socket_client_t* pClient = g_malloc(sizeof(event_socket_client_t));
+	pClient->pEventSocket = pEventSocket;
+	pClient->pSocket = pClientSocket;
+	pClient->events = G_MAXUINT32;
+	pClient->recordTypes = 0;
+	pClient->pUids = g_ptr_array_new_with_free_func((GDestroyNotify)g_bytes_unref);
+	pClient->pFound = g_hash_table_new(g_direct_hash, g_direct_equal);
+	pClient->dropped = 0;
+
+	pClient->pSource = g_socket_create_source(pClientSocket, G_IO_IN | G_IO_HUP | G_IO_ERR, NULL);
+	g_source_set_callback(pClient->pSource, (GSourceFunc)event_socket_on_client_io, pClient, NULL);
+	g_source_attach(pClient->pSource, NULL);
+
+	pEventSocket->pClients = g_list_prepend(pEventSocket->pClients, pClient);
+
+	g_debug("Event socket client connected");
+
+	return G_SOURCE_CONTINUE;
+}
+
+event_socket_t* event_socket_new(const gchar* path)
+{
+	GError* pError = NULL;
+
+	GSocket* pSocket = g_socket_new(G_SOCKET_FAMILY_UNIX, G_SOCKET_TYPE_SEQPACKET, G_SOCKET_PROTOCOL_DEFAULT, &pError);
+	if( pSocket == NULL )
+	{
+		g_warning("Could not create event socket: %s", pError->message);
+		g_error_free(pError);
+		return NULL;
+	}
+
+	//Left over by a previous instance
+	gchar* dir = g_path_get_dirname(path);
+	g_mkdir_with_parents(dir, 0755);
+	g_free(dir);
+	g_unlink(path);
+
+	GSocketAddress* pAddress = g_unix_socket_address_new(path);
+	gboolean listening = g_socket_bind(pSocket, pAddress, FALSE, &pError) && g_socket_listen(pSocket, &pError);
+	g_object_unref(pAddress);
+	if( !listening )
+	{
+		g_warning("Could not listen on event socket %s: %s", path, pError->message);
+		g_error_free(pError);
+		g_object_unref(pSocket);
+		return NULL;
+	}
+	g_socket_set_blocking(pSocket, FALSE);
+
+	event_socket_t* pEventSocket = g_malloc(sizeof(event_socket_t));
+	pEventSocket->path = g_strdup(path);
+	pEventSocket->pSocket = pSocket;
+	pEventSocket->pClients = NULL;
+
+	pEventSocket->pSource = g_socket_create_source(pSocket, G_IO_IN, NULL);
+	g_source_set_callback(pEventSocket->pSource, (GSourceFunc)event_socket_on_accept, pEventSocket, NULL);
+	g_source_attach(pEventSocket->pSource, NULL);
+
+	return pEventSocket;
+}
+
+void event_socket_free(event_socket_t* pEventSocket)
+{
+	while( pEventSocket->pClients != NULL )
+	{
+		event_socket_client_free((event_socket_client_t*) pEventSocket->pClients->data);
+	}
+
+	g_source_destroy(pEventSocket->pSource);
+	g_source_unref(pEventSocket->pSource);
+	g_socket_close(pEventSocket->pSocket, NULL);
+	g_object_unref(pEventSocket->pSocket);
+	g_unlink(pEventSocket->path);
+	g_free(pEventSocket->path);
+	g_free(pEventSocket);
+}
+
+//Packet building
+static GByteArray* event_socket_packet_new(event_socket_event_t event, guint adapterId, guint id)
+{
+	event_socket_header_t header;
+	header.version = EVENT_SOCKET_VERSION;
+	header.event = event;
+	header.adapterId = adapterId;
+	header.id = id;
+	header.timestamp = g_get_monotonic_time();
+
+	GByteArray* pPacket = g_byte_array_sized_new(sizeof(header));
+	g_byte_array_append(pPacket, (const guint8*)&header, sizeof(header));
+	return pPacket;
+}
+
+static void event_socket_packet_add(GByteArray* pPacket, event_socket_field_type_t type, const void* value, gsize length)
+{
+	event_socket_field_t field;
+	field.type = type;
+	field.reserved = 0;
+	field.length = MIN(length, G_MAXUINT16);
+
+	g_byte_array_append(pPacket, (const guint8*)&field, sizeof(field));
+	g_byte_array_append(pPacket, value, field.length);
+}
+
+static void event_socket_packet_add_string(GByteArray* pPacket, event_socket_field_type_t type, const gchar* str)
+{
+	if( str != NULL )
+	{
+		event_socket_packet_add(pPacket, type, str, strlen(str));
+	}
+}
+
+//Append the records of a message, returns the mask of their types
+static guint32 event_socket_packet_add_records(GByteArray* pPacket, GBytes* pNdef)
+{
+	guint32 recordTypes = 0;
+
+	if( pNdef == NULL )
+	{
+		return 0;
+	}
+
+	GList* pList = ndef_message_parse(pNdef);
+	for(GList* pItem = pList; pItem != NULL; pItem = g_list_next(pItem))
+	{
+		NdefRecord* pNdefRecord = (NdefRecord*) pItem->data;
+
+		guint8 type = pNdefRecord->type;
+		recordTypes |= 1u << type;
+
+		event_socket_packet_add(pPacket, event_socket_field_record, &type, sizeof(type));
+		event_socket_packet_add_string(pPacket, event_socket_field_uri, pNdefRecord->uri);
+		event_socket_packet_add_string(pPacket, event_socket_field_representation, pNdefRecord->representation);
+		event_socket_packet_add_string(pPacket, event_socket_field_language, pNdefRecord->language);
+		event_socket_packet_add_string(pPacket, event_socket_field_mime_type, pNdefRecord->mimeType);
+		event_socket_packet_add_string(pPacket, event_socket_field_action, pNdefRecord->action);
+		event_socket_packet_add_string(pPacket, event_socket_field_android_package, pNdefRecord->androidPackage);
+		if( pNdefRecord->mimePayload != NULL )
+		{
+			gsize length;
+			const guint8* payload = g_bytes_get_data(pNdefRecord->mimePayload, &length);
+			event_socket_packet_add(pPacket, event_socket_field_payload, payload, length);
+		}
+
+		g_object_unref(G_OBJECT(pNdefRecord));
+	}
+	g_list_free(pList);
+
+	return recordTypes;
+}
+
+//Sending
+static gboolean event_socket_client_try_send(event_socket_client_t* pClient, const guint8* data, gsize length)
+{
+	GError* pError = NULL;
+	if( g_socket_send_with_blocking(pClient->pSocket, (const gchar*)data, length, FALSE, NULL, &pError) >= 0 )
+	{
+		return TRUE;
+	}
+
+	//A client which went away is cleaned up once its source reports it
+	if( !g_error_matches(pError, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK) )
+	{
+		g_debug("Could not send event: %s", pError->message);
+	}
+	g_error_free(pError);
+	return FALSE;
+}
+
+static gboolean event_socket_client_send(event_socket_client_t* pClient, GByteArray* pPacket)
+{
+	//Losses are reported once, ahead of the first packet which goes through
+	if( pClient->dropped > 0 )
+	{
+		GByteArray* pOverrun = event_socket_packet_new(event_socket_event_overrun, 0, 0);
+		event_socket_packet_add(pOverrun, event_socket_field_count, &pClient->dropped, sizeof(pClient->dropped));
+		gboolean sent = event_socket_client_try_send(pClient, pOverrun->data, pOverrun->len);
+		g_byte_array_unref(pOverrun);
+		if( !sent )
+		{
+			pClient->dropped++;
+			return FALSE;
+		}
+		pClient->dropped = 0;
+	}
+
+	if( !event_socket_client_try_send(pClient, pPacket->data, pPacket->len) )
+	{
+		pClient->dropped++;
+		return FALSE;
+	}
+	return TRUE;
+}
+
+static gboolean event_socket_client_matches(event_socket_client_t* pClient, event_socket_event_t event, const event_socket_match_t* pMatch)
+{
+	if( !(pClient->events & (1u << event)) )
+	{
+		return FALSE;
+	}
+
+	if( (pClient->recordTypes != 0) && (event != event_socket_event_device_found) && !(pClient->recordTypes & pMatch->recordTypes) )
+	{
+		return FALSE;
+	}
+
+	if( pClient->pUids->len > 0 )
+	{
+		for(guint i = 0; i < pClient->pUids->len; i++)
+		{
+			gsize uidLength;
+			const guint8* uid = g_bytes_get_data(g_ptr_array_index(pClient->pUids, i), &uidLength);
+			if( (uidLength == pMatch->uidLength) && (memcmp(uid, pMatch->uid, uidLength) == 0) )
+			{
+				return TRUE;
+			}
+		}
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+//Found events go to the clients whose filters match, lost events to the ones which got the found event
+static void event_socket_dispatch_found(event_socket_t* pEventSocket, GByteArray* pPacket, event_socket_event_t event,
+		const event_socket_match_t* pMatch, gpointer key)
+{
+	for(GList* pItem = pEventSocket->pClients; pItem != NULL; pItem = g_list_next(pItem))
+	{
+		event_socket_client_t* pClient = (event_socket_client_t*) pItem->data;
+		if( event_socket_client_matches(pClient, event, pMatch) && event_socket_client_send(pClient, pPacket) && (key != NULL) )
+		{
+			g_hash_table_add(pClient->pFound, key);
+		}
+	}
+}
+
+static void event_socket_dispatch_lost(event_socket_t* pEventSocket, GByteArray* pPacket, event_socket_event_t event, gpointer key)
+{
+	for(GList* pItem = pEventSocket->pClients; pItem != NULL; pItem = g_list_next(pItem))
+	{
+		event_socket_client_t* pClient = (event_socket_client_t*) pItem->data;
+		if( g_hash_table_remove(pClient->pFound, key) && (pClient->events & (1u << event)) )
+		{
+			event_socket_client_send(pClient, pPacket);
+		}
+	}
+}
+
+void event_socket_tag_found(event_socket_t* pEventSocket, guint adapterId, const nfc_tag_snapshot_t* pSnapshot)
+{
+	if( pEventSocket->pClients == NULL )
+	{
+		return;
+	}
+
+	GByteArray* pPacket = event_socket_packet_new(event_socket_event_tag_found, adapterId, pSnapshot->tagId);
+
+	//Felica cards are identified by their IDm
+	event_socket_match_t match;
+	guint8 idm[sizeof(pSnapshot->manufacturer) + sizeof(pSnapshot->cid)];
+	if( (pSnapshot->uidLength == 0) && pSnapshot->felica )
+	{
+		memcpy(idm, pSnapshot->manufacturer, sizeof(pSnapshot->manufacturer));
+		memcpy(idm + sizeof(pSnapshot->manufacturer), pSnapshot->cid, sizeof(pSnapshot->cid));
+		match.uid = idm;
+		match.uidLength = sizeof(idm);
+	}
+	else
+	{
+		match.uid = pSnapshot->uid;
+		match.uidLength = pSnapshot->uidLength;
+	}
+	if( match.uidLength > 0 )
+	{
+		event_socket_packet_add(pPacket, event_socket_field_uid, match.uid, match.uidLength);
+	}
+
+	guint8 type = pSnapshot->type;
+	event_socket_packet_add(pPacket, event_socket_field_tag_type, &type, sizeof(type));
+
+	match.recordTypes = event_socket_packet_add_records(pPacket, pSnapshot->pNdef);
+
+	event_socket_dispatch_found(pEventSocket, pPacket, event_socket_event_tag_found, &match,
+			EVENT_SOCKET_KEY(FALSE, adapterId, pSnapshot->tagId));
+	g_byte_array_unref(pPacket);
+}
+
+void event_socket_tag_lost(event_socket_t* pEventSocket, guint adapterId, guint tagId)
+{
+	if( pEventSocket->pClients == NULL )
+	{
+		return;
+	}
+
+	GByteArray* pPacket = event_socket_packet_new(event_socket_event_tag_lost, adapterId, tagId);
+	event_socket_dispatch_lost(pEventSocket, pPacket, event_socket_event_tag_lost, EVENT_SOCKET_KEY(FALSE, adapterId, tagId));
+	g_byte_array_unref(pPacket);
+}
+
+void event_socket_device_found(event_socket_t* pEventSocket, guint adapterId, guint deviceId)
+{
+	if( pEventSocket->pClients == NULL )
+	{
+		return;
+	}
+
+	//Devices have no UID
+	event_socket_match_t match = { NULL, 0, 0 };
+
+	GByteArray* pPacket = event_socket_packet_new(event_socket_event_device_found, adapterId, deviceId);
+	event_socket_dispatch_found(pEventSocket, pPacket, event_socket_event_device_found, &match,
+			EVENT_SOCKET_KEY(TRUE, adapterId, deviceId));
+	g_byte_array_unref(pPacket);
+}
+
+void event_socket_device_ndef(event_socket_t* pEventSocket, guint adapterId, const nfc_device_snapshot_t* pSnapshot)
+{
+	if( pEventSocket->pClients == NULL )
+	{
+		return;
+	}
+
+	event_socket_match_t match = { NULL, 0, 0 };
+
+	GByteArray* pPacket = event_socket_packet_new(event_socket_event_device_ndef, adapterId, pSnapshot->deviceId);
+	match.recordTypes = event_socket_packet_add_records(pPacket, pSnapshot->pNdef);
+	event_socket_dispatch_found(pEventSocket, pPacket, event_socket_event_device_ndef, &match, NULL);
+	g_byte_array_unref(pPacket);
+}
+
+void event_socket_device_lost(event_socket_t* pEventSocket, guint adapterId, guint deviceId)
+{
+	if( pEventSocket->pClients == NULL )
+	{
+		return;
+	}
+
+	GByteArray* pPacket = event_socket_packet_new(event_socket_event_device_lost, adapterId, deviceId);
+	event_socket_dispatch_lost(pEventSocket, pPacket, event_socket_event_device_lost, EVENT_SOCKET_KEY(TRUE, adapterId, deviceId));
+	g_byte_array_unref(pPacket);
+}
@@ -0,0 +1,158 @@
+/*
+*         Copyright (c), NXP Semiconductors Gratkorn / Austria
+*
+*                     (C)NXP Semiconductors
+*       All rights are reserved. Reproduction in whole or in part is
+*      prohibited without the written consent of the copyright owner.
+*  NXP reserves the right to make changes without notice at any time.
+* NXP makes no warranty, expressed, implied or statutory, including but
+* not limited to any implied warranty of merchantability or fitness for any
+*particular purpose, or that the use will not infringe any third party patent,
+* copyright or trademark. NXP must not be liable for any loss or damage
+*                          arising from its use.
+*/
+/**
+ * \file event-socket.h
+ */
+/** \defgroup EventSocketGp Event Socket
+ * Local stream of tag and device events over a SOCK_SEQPACKET Unix socket
+ *
+ * Every packet sent by the daemon is one event: an event_socket_header_t followed by
+ * fields, each an event_socket_field_t followed by its value. Integers are in host order.
+ * Record fields (URI, text...) describe the last record field that came before them.
+ *
+ * Clients may send an event_socket_header_t with event set to event_socket_event_subscribe
+ * followed by filter fields: event_socket_field_events (guint32 mask of 1 << event),
+ * event_socket_field_record_type (guint8, repeatable) and event_socket_field_uid
+ * (repeatable). Found events are only sent if they match every kind of filter given, lost
+ * events only for the tags and devices whose found event was sent.
+ *
+ * The daemon never waits for a client: packets which do not fit in its socket buffer are
+ * dropped, and the next packet which does is preceded by an event_socket_event_overrun
+ * event with the number of packets lost (event_socket_field_count).
+ *  @{
+ */
+
+#ifndef EVENT_SOCKET_H_
+#define EVENT_SOCKET_H_
+
+#include <glib.h>
+
+#include "hal.h"
+
+#define EVENT_SOCKET_VERSION 1 ///< Version of the packet format
+
+/** Event
+ *
+ */
+enum event_socket_event
+{
+	event_socket_event_tag_found = 1, ///< Tag found and read
+	event_socket_event_tag_lost = 2, ///< Tag lost
+	event_socket_event_device_found = 3, ///< Device found
+	event_socket_event_device_ndef = 4, ///< NDEF message received from device
+	event_socket_event_device_lost = 5, ///< Device lost
+	event_socket_event_overrun = 6, ///< Packets were dropped
+	event_socket_event_subscribe = 128, ///< Sent by clients: set filters
+};
+typedef enum event_socket_event event_socket_event_t; ///< Event
+
+/** Field type
+ *
+ */
+enum event_socket_field_type
+{
+	event_socket_field_uid = 1, ///< Tag UID (or Felica IDm)
+	event_socket_field_tag_type = 2, ///< Tag type, guint8 (nfc_tag_type_t)
+	event_socket_field_record = 3, ///< Start of a record, guint8 record type (ndef_record_type_t)
+	event_socket_field_uri = 4, ///< Record URI
+	event_socket_field_representation = 5, ///< Record text
+	event_socket_field_language = 6, ///< Record language
+	event_socket_field_mime_type = 7, ///< Record MIME type
+	event_socket_field_payload = 8, ///< Record MIME payload
+	event_socket_field_action = 9, ///< Record action
+	event_socket_field_android_package = 10, ///< Record Android package
+	event_socket_field_count = 11, ///< Number of packets dropped, guint32
+	event_socket_field_events = 12, ///< Subscription: mask of events, guint32
+	event_socket_field_record_type = 13, ///< Subscription: record type, guint8 (ndef_record_type_t)
+};
+typedef enum event_socket_field_type event_socket_field_type_t; ///< Field type
+
+/** Packet header
+ *
+ */
+struct event_socket_header
+{
+	guint8 version; ///< EVENT_SOCKET_VERSION
+	guint8 event; ///< Event (event_socket_event_t)
+	guint16 adapterId; ///< Adapter ID (object path /org/neard/nfc[adapterId])
+	guint32 id; ///< Tag or device ID
+	guint64 timestamp; ///< CLOCK_MONOTONIC time of the event, in microseconds
+};
+typedef struct event_socket_header event_socket_header_t; ///< Packet header
+
+/** Field header
+ *
+ */
+struct event_socket_field
+{
+	guint8 type; ///< Field type (event_socket_field_type_t)
+	guint8 reserved; ///< Set to 0
+	guint16 length; ///< Length of the value which follows
+};
+typedef struct event_socket_field event_socket_field_t; ///< Field header
+
+struct event_socket;
+typedef struct event_socket event_socket_t; ///< Event socket
+
+/** Create the socket and start accepting clients in the default main context
+ * \param path file system path of the socket, replaced if it exists
+ * \return new event socket, NULL on failure
+ */
+event_socket_t* event_socket_new(const gchar* path);
+
+/** Disconnect clients and remove the socket
+ * \param pEventSocket event socket
+ */
+void event_socket_free(event_socket_t* pEventSocket);
+
+/** Send a tag found event
+ * \param pEventSocket event socket
+ * \param adapterId adapter ID
+ * \param pSnapshot snapshot of the tag
+ */
+void event_socket_tag_found(event_socket_t* pEventSocket, guint adapterId, const nfc_tag_snapshot_t* pSnapshot);
+
+/** Send a tag lost event
+ * \param pEventSocket event socket
+ * \param adapterId adapter ID
+ * \param tagId id of tag
+ */
+void event_socket_tag_lost(event_socket_t* pEventSocket, guint adapterId, guint tagId);
+
+/** Send a device found event
+ * \param pEventSocket event socket
+ * \param adapterId adapter ID
+ * \param deviceId id of device
+ */
+void event_socket_device_found(event_socket_t* pEventSocket, guint adapterId, guint deviceId);
+
+/** Send a device NDEF message event
+ * \param pEventSocket event socket
+ * \param adapterId adapter ID
+ * \param pSnapshot snapshot of the device
+ */
+void event_socket_device_ndef(event_socket_t* pEventSocket, guint adapterId, const nfc_device_snapshot_t* pSnapshot);
+
+/** Send a device lost event
+ * \param pEventSocket event socket
+ * \param adapterId adapter ID
+ * \param deviceId id of device
+ */
+void event_socket_device_lost(event_socket_t* pEventSocket, guint adapterId, guint deviceId);
+
+#endif /* EVENT_SOCKET_H_ */
+
+/**
+ * @}
+ * */
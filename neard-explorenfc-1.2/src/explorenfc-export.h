@@ -0,0 +1,31 @@
+/*
+*         Copyright (c), NXP Semiconductors Gratkorn / Austria
+*
+*                     (C)NXP Semiconductors
+*       All rights are reserved. Reproduction in whole or in part is
+*      prohibited without the written consent of the copyright owner.
+*  NXP reserves the right to make changes without notice at any time.
+* NXP makes no warranty, expressed, implied or statutory, including but
+* not limited to any implied warranty of merchantability or fitness for any
+*particular purpose, or that the use will not infringe any third party patent,
+* copyright or trademark. NXP must not be liable for any loss or damage
+*                          arising from its use.
+*/
+/**
+ * \file explorenfc-export.h
+ */
+/** \addtogroup HalGp
+ *  @{
+ */
+
+#ifndef EXPLORENFC_EXPORT_H_
+#define EXPLORENFC_EXPORT_H_
+
+/** Marks the functions of the libexplorenfc API, everything else is built hidden */
+#define EXPLORENFC_API __attribute__((visibility("default")))
+
+#endif /* EXPLORENFC_EXPORT_H_ */
+
+/**
+ * @}
+ * */
@@ -206,10 +206,103 @@ static const _ExtendedGDBusMethodInfo _neard_adapter_method_info_stop_poll_loop
   FALSE
 };
 
+static const _ExtendedGDBusArgInfo _neard_adapter_method_info_start_provisioning_IN_ARG_options =
+{
+  {
+    -1,
+    (gchar *) "options",
+    (gchar *) "a{sv}",
+    NULL
+  },
+  FALSE
+};
+
+static const _ExtendedGDBusArgInfo * const _neard_adapter_method_info_start_provisioning_IN_ARG_pointers[] =
+{
+  &_neard_adapter_method_info_start_provisioning_IN_ARG_options,
+  NULL
+};
+
+static const _ExtendedGDBusMethodInfo _neard_adapter_method_info_start_provisioning =
+{
+  {
+    -1,
+    (gchar *) "StartProvisioning",
+    (GDBusArgInfo **) &_neard_adapter_method_info_start_provisioning_IN_ARG_pointers,
+    NULL,
+    NULL
+  },
+  "handle-start-provisioning",
+  FALSE
+};
+
+static const _ExtendedGDBusMethodInfo _neard_adapter_method_info_stop_provisioning =
+{
+  {
+    -1,
+    (gchar *) "StopProvisioning",
+    NULL,
+    NULL,
+    NULL
+  },
+  "handle-stop-provisioning",
+  FALSE
+};
+
+static const _ExtendedGDBusArgInfo _neard_adapter_method_info_get_tag_snapshot_IN_ARG_tag =
+{
+  {
+    -1,
+    (gchar *) "tag",
+    (gchar *) "o",
+    NULL
+  },
+  FALSE
+};
+
+static const _ExtendedGDBusArgInfo * const _neard_adapter_method_info_get_tag_snapshot_IN_ARG_pointers[] =
+{
+  &_neard_adapter_method_info_get_tag_snapshot_IN_ARG_tag,
+  NULL
+};
+
+static const _ExtendedGDBusArgInfo _neard_adapter_method_info_get_tag_snapshot_OUT_ARG_snapshot =
+{
+  {
+    -1,
+    (gchar *) "snapshot",
+    (gchar *) "a{sv}",
+    NULL
+  },
+  FALSE
+};
+
+static const _ExtendedGDBusArgInfo * const _neard_adapter_method_info_get_tag_snapshot_OUT_ARG_pointers[] =
+{
+  &_neard_adapter_method_info_get_tag_snapshot_OUT_ARG_snapshot,
+  NULL
+};
+
+static const _ExtendedGDBusMethodInfo _neard_adapter_method_info_get_tag_snapshot =
+{
+  {
+    -1,
+    (gchar *) "GetTagSnapshot",
+    (GDBusArgInfo **) &_neard_adapter_method_info_get_tag_snapshot_IN_ARG_pointers,
+    (GDBusArgInfo **) &_neard_adapter_method_info_get_tag_snapshot_OUT_ARG_pointers,
+    NULL
+  },
+  "handle-get-tag-snapshot",
+  FALSE
+};
+
 static const _ExtendedGDBusMethodInfo * const _neard_adapter_method_info_pointers[] =
 {
   &_neard_adapter_method_info_start_poll_loop,
   &_neard_adapter_method_info_stop_poll_loop,
+  &_neard_adapter_method_info_start_provisioning,
+  &_neard_adapter_method_info_stop_provisioning,
+  &_neard_adapter_method_info_get_tag_snapshot,
   NULL
 };
 
@@ -269,10 +362,80 @@ static const _ExtendedGDBusSignalInfo _neard_adapter_signal_info_tag_lost =
   "tag-lost"
 };
 
+static const _ExtendedGDBusArgInfo _neard_adapter_signal_info_provisioning_result_ARG_result =
+{
+  {
+    -1,
+    (gchar *) "result",
+    (gchar *) "a{sv}",
+    NULL
+  },
+  FALSE
+};
+
+static const _ExtendedGDBusArgInfo * const _neard_adapter_signal_info_provisioning_result_ARG_pointers[] =
+{
+  &_neard_adapter_signal_info_provisioning_result_ARG_result,
+  NULL
+};
+
+static const _ExtendedGDBusSignalInfo _neard_adapter_signal_info_provisioning_result =
+{
+  {
+    -1,
+    (gchar *) "ProvisioningResult",
+    (GDBusArgInfo **) &_neard_adapter_signal_info_provisioning_result_ARG_pointers,
+    NULL
+  },
+  "provisioning-result"
+};
+
+static const _ExtendedGDBusArgInfo _neard_adapter_signal_info_tag_read_ARG_tag =
+{
+  {
+    -1,
+    (gchar *) "tag",
+    (gchar *) "o",
+    NULL
+  },
+  FALSE
+};
+
+static const _ExtendedGDBusArgInfo _neard_adapter_signal_info_tag_read_ARG_snapshot =
+{
+  {
+    -1,
+    (gchar *) "snapshot",
+    (gchar *) "a{sv}",
+    NULL
+  },
+  FALSE
+};
+
+static const _ExtendedGDBusArgInfo * const _neard_adapter_signal_info_tag_read_ARG_pointers[] =
+{
+  &_neard_adapter_signal_info_tag_read_ARG_tag,
+  &_neard_adapter_signal_info_tag_read_ARG_snapshot,
+  NULL
+};
+
+static const _ExtendedGDBusSignalInfo _neard_adapter_signal_info_tag_read =
+{
+  {
+    -1,
+    (gchar *) "TagRead",
+    (GDBusArgInfo **) &_neard_adapter_signal_info_tag_read_ARG_pointers,
+    NULL
+  },
+  "tag-read"
+};
+
 static const _ExtendedGDBusSignalInfo * const _neard_adapter_signal_info_pointers[] =
 {
   &_neard_adapter_signal_info_tag_found,
   &_neard_adapter_signal_info_tag_lost,
+  &_neard_adapter_signal_info_provisioning_result,
+  &_neard_adapter_signal_info_tag_read,
   NULL
 };
 
@@ -367,6 +530,19 @@ static const _ExtendedGDBusPropertyInfo _neard_adapter_property_info_devices =
   FALSE
 };
 
+static const _ExtendedGDBusPropertyInfo _neard_adapter_property_info_statistics =
+{
+  {
+    -1,
+    (gchar *) "Statistics",
+    (gchar *) "a{st}",
+    G_DBUS_PROPERTY_INFO_FLAGS_READABLE,
+    NULL
+  },
+  "statistics",
+  TRUE
+};
+
 static const _ExtendedGDBusPropertyInfo * const _neard_adapter_property_info_pointers[] =
 {
   &_neard_adapter_property_info_name,
@@ -376,6 +552,7 @@ static const _ExtendedGDBusPropertyInfo * const _neard_adapter_property_info_poi
   &_neard_adapter_property_info_protocols,
   &_neard_adapter_property_info_tags,
   &_neard_adapter_property_info_devices,
+  &_neard_adapter_property_info_statistics,
   NULL
 };
 
@@ -426,6 +603,7 @@ neard_adapter_override_properties (GObjectClass *klass, guint property_id_begin)
   g_object_class_override_property (klass, property_id_begin++, "protocols");
   g_object_class_override_property (klass, property_id_begin++, "tags");
   g_object_class_override_property (klass, property_id_begin++, "devices");
+  g_object_class_override_property (klass, property_id_begin++, "statistics");
   return property_id_begin - 1;
 }
 
@@ -440,17 +618,23 @@ neard_adapter_override_properties (GObjectClass *klass, guint property_id_begin)
 /**
  * NeardAdapterIface:
  * @parent_iface: The parent interface.
+ * @handle_get_tag_snapshot: Handler for the #NeardAdapter::handle-get-tag-snapshot signal.
  * @handle_start_poll_loop: Handler for the #NeardAdapter::handle-start-poll-loop signal.
+ * @handle_start_provisioning: Handler for the #NeardAdapter::handle-start-provisioning signal.
  * @handle_stop_poll_loop: Handler for the #NeardAdapter::handle-stop-poll-loop signal.
+ * @handle_stop_provisioning: Handler for the #NeardAdapter::handle-stop-provisioning signal.
  * @get_devices: Getter for the #NeardAdapter:devices property.
  * @get_mode: Getter for the #NeardAdapter:mode property.
  * @get_name: Getter for the #NeardAdapter:name property.
  * @get_polling: Getter for the #NeardAdapter:polling property.
  * @get_powered: Getter for the #NeardAdapter:powered property.
  * @get_protocols: Getter for the #NeardAdapter:protocols property.
+ * @get_statistics: Getter for the #NeardAdapter:statistics property.
  * @get_tags: Getter for the #NeardAdapter:tags property.
+ * @provisioning_result: Handler for the #NeardAdapter::provisioning-result signal.
  * @tag_found: Handler for the #NeardAdapter::tag-found signal.
  * @tag_lost: Handler for the #NeardAdapter::tag-lost signal.
+ * @tag_read: Handler for the #NeardAdapter::tag-read signal.
  *
  * Virtual table for the D-Bus interface <link linkend="gdbus-interface-org-neard-Adapter.top_of_page">org.neard.Adapter</link>.
  */
@@ -507,6 +691,74 @@ neard_adapter_default_init (NeardAdapterIface *iface)
     1,
     G_TYPE_DBUS_METHOD_INVOCATION);
 
+  /**
+   * NeardAdapter::handle-start-provisioning:
+   * @object: A #NeardAdapter.
+   * @invocation: A #GDBusMethodInvocation.
+   * @arg_options: Argument passed by remote caller.
+   *
+   * Signal emitted when a remote caller is invoking the <link linkend="gdbus-method-org-neard-Adapter.StartProvisioning">StartProvisioning()</link> D-Bus method.
+   *
+   * If a signal handler returns %TRUE, it means the signal handler will handle the invocation (e.g. take a reference to @invocation and eventually call neard_adapter_complete_start_provisioning() or e.g. g_dbus_method_invocation_return_error() on it) and no order signal handlers will run. If no signal handler handles the invocation, the %G_DBUS_ERROR_UNKNOWN_METHOD error is returned.
+   *
+   * Returns: %TRUE if the invocation was handled, %FALSE to let other signal handlers run.
+   */
+  g_signal_new ("handle-start-provisioning",
+    G_TYPE_FROM_INTERFACE (iface),
+    G_SIGNAL_RUN_LAST,
+    G_STRUCT_OFFSET (NeardAdapterIface, handle_start_provisioning),
+    g_signal_accumulator_true_handled,
+    NULL,
+    g_cclosure_marshal_generic,
+    G_TYPE_BOOLEAN,
+    2,
+    G_TYPE_DBUS_METHOD_INVOCATION, G_TYPE_VARIANT);
+
+  /**
+   * NeardAdapter::handle-stop-provisioning:
+   * @object: A #NeardAdapter.
+   * @invocation: A #GDBusMethodInvocation.
+   *
+   * Signal emitted when a remote caller is invoking the <link linkend="gdbus-method-org-neard-Adapter.StopProvisioning">StopProvisioning()</link> D-Bus method.
+   *
+   * If a signal handler returns %TRUE, it means the signal handler will handle the invocation (e.g. take a reference to @invocation and eventually call neard_adapter_complete_stop_provisioning() or e.g. g_dbus_method_invocation_return_error() on it) and no order signal handlers will run. If no signal handler handles the invocation, the %G_DBUS_ERROR_UNKNOWN_METHOD error is returned.
+   *
+   * Returns: %TRUE if the invocation was handled, %FALSE to let other signal handlers run.
+   */
+  g_signal_new ("handle-stop-provisioning",
+    G_TYPE_FROM_INTERFACE (iface),
+    G_SIGNAL_RUN_LAST,
+    G_STRUCT_OFFSET (NeardAdapterIface, handle_stop_provisioning),
+    g_signal_accumulator_true_handled,
+    NULL,
+    g_cclosure_marshal_generic,
+    G_TYPE_BOOLEAN,
+    1,
+    G_TYPE_DBUS_METHOD_INVOCATION);
+
+  /**
+   * NeardAdapter::handle-get-tag-snapshot:
+   * @object: A #NeardAdapter.
+   * @invocation: A #GDBusMethodInvocation.
+   * @arg_tag: Argument passed by remote caller.
+   *
+   * Signal emitted when a remote caller is invoking the <link linkend="gdbus-method-org-neard-Adapter.GetTagSnapshot">GetTagSnapshot()</link> D-Bus method.
+   *
+   * If a signal handler returns %TRUE, it means the signal handler will handle the invocation (e.g. take a reference to @invocation and eventually call neard_adapter_complete_get_tag_snapshot() or e.g. g_dbus_method_invocation_return_error() on it) and no order signal handlers will run. If no signal handler handles the invocation, the %G_DBUS_ERROR_UNKNOWN_METHOD error is returned.
+   *
+   * Returns: %TRUE if the invocation was handled, %FALSE to let other signal handlers run.
+   */
+  g_signal_new ("handle-get-tag-snapshot",
+    G_TYPE_FROM_INTERFACE (iface),
+    G_SIGNAL_RUN_LAST,
+    G_STRUCT_OFFSET (NeardAdapterIface, handle_get_tag_snapshot),
+    g_signal_accumulator_true_handled,
+    NULL,
+    g_cclosure_marshal_generic,
+    G_TYPE_BOOLEAN,
+    2,
+    G_TYPE_DBUS_METHOD_INVOCATION, G_TYPE_STRING);
+
   /* GObject signals for received D-Bus signals: */
   /**
    * NeardAdapter::tag-found:
@@ -546,6 +798,45 @@ neard_adapter_default_init (NeardAdapterIface *iface)
     G_TYPE_NONE,
     1, G_TYPE_STRING);
 
+  /**
+   * NeardAdapter::provisioning-result:
+   * @object: A #NeardAdapter.
+   * @arg_result: Argument.
+   *
+   * On the client-side, this signal is emitted whenever the D-Bus signal <link linkend="gdbus-signal-org-neard-Adapter.ProvisioningResult">"ProvisioningResult"</link> is received.
+   *
+   * On the service-side, this signal can be used with e.g. g_signal_emit_by_name() to make the object emit the D-Bus signal.
+   */
+  g_signal_new ("provisioning-result",
+    G_TYPE_FROM_INTERFACE (iface),
+    G_SIGNAL_RUN_LAST,
+    G_STRUCT_OFFSET (NeardAdapterIface, provisioning_result),
+    NULL,
+    NULL,
+    g_cclosure_marshal_generic,
+    G_TYPE_NONE,
+    1, G_TYPE_VARIANT);
+
+  /**
+   * NeardAdapter::tag-read:
+   * @object: A #NeardAdapter.
+   * @arg_tag: Argument.
+   * @arg_snapshot: Argument.
+   *
+   * On the client-side, this signal is emitted whenever the D-Bus signal <link linkend="gdbus-signal-org-neard-Adapter.TagRead">"TagRead"</link> is received.
+   *
+   * On the service-side, this signal can be used with e.g. g_signal_emit_by_name() to make the object emit the D-Bus signal.
+   */
+  g_signal_new ("tag-read",
+    G_TYPE_FROM_INTERFACE (iface),
+    G_SIGNAL_RUN_LAST,
+    G_STRUCT_OFFSET (NeardAdapterIface, tag_read),
+    NULL,
+    NULL,
+    g_cclosure_marshal_generic,
+    G_TYPE_NONE,
+    2, G_TYPE_STRING, G_TYPE_VARIANT);
+
   /* GObject properties for D-Bus properties: */
   /**
    * NeardAdapter:name:
@@ -610,6 +901,15 @@ neard_adapter_default_init (NeardAdapterIface *iface)
    */
   g_object_interface_install_property (iface,
     g_param_spec_boxed ("devices", "Devices", "Devices", G_TYPE_STRV, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * NeardAdapter:statistics:
+   *
+   * Represents the D-Bus property <link linkend="gdbus-property-org-neard-Adapter.Statistics">"Statistics"</link>.
+   *
+   * Since the D-Bus property for this #GObject property is readable but not writable, it is meaningful to read from it on both the client- and service-side. It is only meaningful, however, to write to it on the service-side.
+   */
+  g_object_interface_install_property (iface,
+    g_param_spec_variant ("statistics", "Statistics", "Statistics", G_VARIANT_TYPE ("a{st}"), NULL, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 }
 
 /**
@@ -929,6 +1229,57 @@ neard_adapter_set_devices (NeardAdapter *object, const gchar *const *value)
   g_object_set (G_OBJECT (object), "devices", value, NULL);
 }
 
+/**
+ * neard_adapter_get_statistics: (skip)
+ * @object: A #NeardAdapter.
+ *
+ * Gets the value of the <link linkend="gdbus-property-org-neard-Adapter.Statistics">"Statistics"</link> D-Bus property.
+ *
+ * Since this D-Bus property is readable, it is meaningful to use this function on both the client- and service-side.
+ *
+ * <warning>The returned value is only valid until the property changes so on the client-side it is only safe to use this function on the thread where @object was constructed. Use neard_adapter_dup_statistics() if on another thread.</warning>
+ *
+ * Returns: (transfer none): The property value or %NULL if the property is not set. Do not free the returned value, it belongs to @object.
+ */
+GVariant *
+neard_adapter_get_statistics (NeardAdapter *object)
+{
+  return NEARD_ADAPTER_GET_IFACE (object)->get_statistics (object);
+}
+
+/**
+ * neard_adapter_dup_statistics: (skip)
+ * @object: A #NeardAdapter.
+ *
+ * Gets a copy of the <link linkend="gdbus-property-org-neard-Adapter.Statistics">"Statistics"</link> D-Bus property.
+ *
+ * Since this D-Bus property is readable, it is meaningful to use this function on both the client- and service-side.
+ *
+ * Returns: (transfer full): The property value or %NULL if the property is not set. The returned value should be freed with g_variant_unref().
+ */
+GVariant *
+neard_adapter_dup_statistics (NeardAdapter *object)
+{
+  GVariant *value;
+  g_object_get (G_OBJECT (object), "statistics", &value, NULL);
+  return value;
+}
+
+/**
+ * neard_adapter_set_statistics: (skip)
+ * @object: A #NeardAdapter.
+ * @value: The value to set.
+ *
+ * Sets the <link linkend="gdbus-property-org-neard-Adapter.Statistics">"Statistics"</link> D-Bus property to @value.
+ *
+ * Since this D-Bus property is not writable, it is only meaningful to use this function on the service-side.
+ */
+void
+neard_adapter_set_statistics (NeardAdapter *object, GVariant *value)
+{
+  g_object_set (G_OBJECT (object), "statistics", value, NULL);
+}
+
 /**
  * neard_adapter_emit_tag_found:
  * @object: A #NeardAdapter.
@@ -960,15 +1311,47 @@ neard_adapter_emit_tag_lost (
 }
 
 /**
- * neard_adapter_call_start_poll_loop:
- * @proxy: A #NeardAdapterProxy.
- * @arg_name: Argument to pass with the method invocation.
- * @cancellable: (allow-none): A #GCancellable or %NULL.
- * @callback: A #GAsyncReadyCallback to call when the request is satisfied or %NULL.
- * @user_data: User data to pass to @callback.
+ * neard_adapter_emit_provisioning_result:
+ * @object: A #NeardAdapter.
+ * @arg_result: Argument to pass with the signal.
  *
- * Asynchronously invokes the <link linkend="gdbus-method-org-neard-Adapter.StartPollLoop">StartPollLoop()</link> D-Bus method on @proxy.
- * When the operation is finished, @callback will be invoked in the <link linkend="g-main-context-push-thread-default">thread-default main loop</link> of the thread you are calling this method from.
+ * Emits the <link linkend="gdbus-signal-org-neard-Adapter.ProvisioningResult">"ProvisioningResult"</link> D-Bus signal.
+ */
+void
+neard_adapter_emit_provisioning_result (
+    NeardAdapter *object,
+    GVariant *arg_result)
+{
+  g_signal_emit_by_name (object, "provisioning-result", arg_result);
+}
+
+/**
+ * neard_adapter_emit_tag_read:
+ * @object: A #NeardAdapter.
+ * @arg_tag: Argument to pass with the signal.
+ * @arg_snapshot: Argument to pass with the signal.
+ *
+ * Emits the <link linkend="gdbus-signal-org-neard-Adapter.TagRead">"TagRead"</link> D-Bus signal.
+ */
+void
+neard_adapter_emit_tag_read (
+    NeardAdapter *object,
+    const gchar *arg_tag,
+    GVariant *arg_snapshot)
+{
+  g_signal_emit_by_name (object, "tag-read", arg_tag, arg_snapshot);
+}
+
+/**
+ * neard_adapter_call_start_poll_loop:
+ * @proxy: A #NeardAdapterProxy.
+ * @arg_name: Argument to pass with the method invocation.
+ * @cancellable: (allow-none): A #GCancellable or %NULL.
+ * @callback: A #GAsyncReadyCallback to call when the request is satisfied or %NULL.
+ * @user_data: User data to pass to @callback.
+ *
+ * Asynchronously invokes the <link linkend="gdbus-method-org-neard-Adapter.StartPollLoop">StartPollLoop()</link> D-Bus method on @proxy.
+ * When the operation is finished, @callback will be invoked in the <link linkend="g-main-context-push-thread-default">thread-default main loop</link> of the thread you are calling this method from.
  * You can then call neard_adapter_call_start_poll_loop_finish() to get the result of the operation.
  *
  * See neard_adapter_call_start_poll_loop_sync() for the synchronous, blocking version of this method.
@@ -1150,16 +1533,346 @@ _out:
 }
 
 /**
- * neard_adapter_complete_start_poll_loop:
+ * neard_adapter_call_start_provisioning:
+ * @proxy: A #NeardAdapterProxy.
+ * @arg_options: Argument to pass with the method invocation.
+ * @cancellable: (allow-none): A #GCancellable or %NULL.
+ * @callback: A #GAsyncReadyCallback to call when the request is satisfied or %NULL.
+ * @user_data: User data to pass to @callback.
+ *
+ * Asynchronously invokes the <link linkend="gdbus-method-org-neard-Adapter.StartProvisioning">StartProvisioning()</link> D-Bus method on @proxy.
+ * When the operation is finished, @callback will be invoked in the <link linkend="g-main-context-push-thread-default">thread-default main loop</link> of the thread you are calling this method from.
+ * You can then call neard_adapter_call_start_provisioning_finish() to get the result of the operation.
+ *
+ * See neard_adapter_call_start_provisioning_sync() for the synchronous, blocking version of this method.
+ */
+void
+neard_adapter_call_start_provisioning (
+    NeardAdapter *proxy,
+    GVariant *arg_options,
+    GCancellable *cancellable,
+    GAsyncReadyCallback callback,
+    gpointer user_data)
+{
+  g_dbus_proxy_call (G_DBUS_PROXY (proxy),
+    "StartProvisioning",
+    g_variant_new ("(@a{sv})",
+                   arg_options),
+    G_DBUS_CALL_FLAGS_NONE,
+    -1,
+    cancellable,
+    callback,
+    user_data);
+}
+
+/**
+ * neard_adapter_call_start_provisioning_finish:
+ * @proxy: A #NeardAdapterProxy.
+ * @res: The #GAsyncResult obtained from the #GAsyncReadyCallback passed to neard_adapter_call_start_provisioning().
+ * @error: Return location for error or %NULL.
+ *
+ * Finishes an operation started with neard_adapter_call_start_provisioning().
+ *
+ * Returns: (skip): %TRUE if the call succeded, %FALSE if @error is set.
+ */
+gboolean
+neard_adapter_call_start_provisioning_finish (
+    NeardAdapter *proxy,
+    GAsyncResult *res,
+    GError **error)
+{
+  GVariant *_ret;
+  _ret = g_dbus_proxy_call_finish (G_DBUS_PROXY (proxy), res, error);
+  if (_ret == NULL)
+    goto _out;
+  g_variant_get (_ret,
+                 "()");
+  g_variant_unref (_ret);
+_out:
+  return _ret != NULL;
+}
+
+/**
+ * neard_adapter_call_start_provisioning_sync:
+ * @proxy: A #NeardAdapterProxy.
+ * @arg_options: Argument to pass with the method invocation.
+ * @cancellable: (allow-none): A #GCancellable or %NULL.
+ * @error: Return location for error or %NULL.
+ *
+ * Synchronously invokes the <link linkend="gdbus-method-org-neard-Adapter.StartProvisioning">StartProvisioning()</link> D-Bus method on @proxy. The calling thread is blocked until a reply is received.
+ *
+ * See neard_adapter_call_start_provisioning() for the asynchronous version of this method.
+ *
+ * Returns: (skip): %TRUE if the call succeded, %FALSE if @error is set.
+ */
+gboolean
+neard_adapter_call_start_provisioning_sync (
+    NeardAdapter *proxy,
+    GVariant *arg_options,
+    GCancellable *cancellable,
+    GError **error)
+{
+  GVariant *_ret;
+  _ret = g_dbus_proxy_call_sync (G_DBUS_PROXY (proxy),
+    "StartProvisioning",
+    g_variant_new ("(@a{sv})",
+                   arg_options),
+    G_DBUS_CALL_FLAGS_NONE,
+    -1,
+    cancellable,
+    error);
+  if (_ret == NULL)
+    goto _out;
+  g_variant_get (_ret,
+                 "()");
+  g_variant_unref (_ret);
+_out:
+  return _ret != NULL;
+}
+
+/**
+ * neard_adapter_call_stop_provisioning:
+ * @proxy: A #NeardAdapterProxy.
+ * @cancellable: (allow-none): A #GCancellable or %NULL.
+ * @callback: A #GAsyncReadyCallback to call when the request is satisfied or %NULL.
+ * @user_data: User data to pass to @callback.
+ *
+ * Asynchronously invokes the <link linkend="gdbus-method-org-neard-Adapter.StopProvisioning">StopProvisioning()</link> D-Bus method on @proxy.
+ * When the operation is finished, @callback will be invoked in the <link linkend="g-main-context-push-thread-default">thread-default main loop</link> of the thread you are calling this method from.
+ * You can then call neard_adapter_call_stop_provisioning_finish() to get the result of the operation.
+ *
+ * See neard_adapter_call_stop_provisioning_sync() for the synchronous, blocking version of this method.
+ */
+void
+neard_adapter_call_stop_provisioning (
+    NeardAdapter *proxy,
+    GCancellable *cancellable,
+    GAsyncReadyCallback callback,
+    gpointer user_data)
+{
+  g_dbus_proxy_call (G_DBUS_PROXY (proxy),
+    "StopProvisioning",
+    g_variant_new ("()"),
+    G_DBUS_CALL_FLAGS_NONE,
+    -1,
+    cancellable,
+    callback,
+    user_data);
+}
+
+/**
+ * neard_adapter_call_stop_provisioning_finish:
+ * @proxy: A #NeardAdapterProxy.
+ * @res: The #GAsyncResult obtained from the #GAsyncReadyCallback passed to neard_adapter_call_stop_provisioning().
+ * @error: Return location for error or %NULL.
+ *
+ * Finishes an operation started with neard_adapter_call_stop_provisioning().
+ *
+ * Returns: (skip): %TRUE if the call succeded, %FALSE if @error is set.
+ */
+gboolean
+neard_adapter_call_stop_provisioning_finish (
+    NeardAdapter *proxy,
+    GAsyncResult *res,
+    GError **error)
+{
+  GVariant *_ret;
+  _ret = g_dbus_proxy_call_finish (G_DBUS_PROXY (proxy), res, error);
+  if (_ret == NULL)
+    goto _out;
+  g_variant_get (_ret,
+                 "()");
+  g_variant_unref (_ret);
+_out:
+  return _ret != NULL;
+}
+
+/**
+ * neard_adapter_call_stop_provisioning_sync:
+ * @proxy: A #NeardAdapterProxy.
+ * @cancellable: (allow-none): A #GCancellable or %NULL.
+ * @error: Return location for error or %NULL.
+ *
+ * Synchronously invokes the <link linkend="gdbus-method-org-neard-Adapter.StopProvisioning">StopProvisioning()</link> D-Bus method on @proxy. The calling thread is blocked until a reply is received.
+ *
+ * See neard_adapter_call_stop_provisioning() for the asynchronous version of this method.
+ *
+ * Returns: (skip): %TRUE if the call succeded, %FALSE if @error is set.
+ */
+gboolean
+neard_adapter_call_stop_provisioning_sync (
+    NeardAdapter *proxy,
+    GCancellable *cancellable,
+    GError **error)
+{
+  GVariant *_ret;
+  _ret = g_dbus_proxy_call_sync (G_DBUS_PROXY (proxy),
+    "StopProvisioning",
+    g_variant_new ("()"),
+    G_DBUS_CALL_FLAGS_NONE,
+    -1,
+    cancellable,
+    error);
+  if (_ret == NULL)
+    goto _out;
+  g_variant_get (_ret,
+                 "()");
+  g_variant_unref (_ret);
+_out:
+  return _ret != NULL;
+}
+
+/**
+ * neard_adapter_call_get_tag_snapshot:
+ * @proxy: A #NeardAdapterProxy.
+ * @arg_tag: Argument to pass with the method invocation.
+ * @cancellable: (allow-none): A #GCancellable or %NULL.
+ * @callback: A #GAsyncReadyCallback to call when the request is satisfied or %NULL.
+ * @user_data: User data to pass to @callback.
+ *
+ * Asynchronously invokes the <link linkend="gdbus-method-org-neard-Adapter.GetTagSnapshot">GetTagSnapshot()</link> D-Bus method on @proxy.
+ * When the operation is finished, @callback will be invoked in the <link linkend="g-main-context-push-thread-default">thread-default main loop</link> of the thread you are calling this method from.
+ * You can then call neard_adapter_call_get_tag_snapshot_finish() to get the result of the operation.
+ *
+ * See neard_adapter_call_get_tag_snapshot_sync() for the synchronous, blocking version of this method.
+ */
+void
+neard_adapter_call_get_tag_snapshot (
+    NeardAdapter *proxy,
+    const gchar *arg_tag,
+    GCancellable *cancellable,
+    GAsyncReadyCallback callback,
+    gpointer user_data)
+{
+  g_dbus_proxy_call (G_DBUS_PROXY (proxy),
+    "GetTagSnapshot",
+    g_variant_new ("(o)",
+                   arg_tag),
+    G_DBUS_CALL_FLAGS_NONE,
+    -1,
+    cancellable,
+    callback,
+    user_data);
+}
+
+/**
+ * neard_adapter_call_get_tag_snapshot_finish:
+ * @proxy: A #NeardAdapterProxy.
+ * @out_snapshot: (out): Return location for return parameter or %NULL to ignore.
+ * @res: The #GAsyncResult obtained from the #GAsyncReadyCallback passed to neard_adapter_call_get_tag_snapshot().
+ * @error: Return location for error or %NULL.
+ *
+ * Finishes an operation started with neard_adapter_call_get_tag_snapshot().
+ *
+ * Returns: (skip): %TRUE if the call succeded, %FALSE if @error is set.
+ */
+gboolean
+neard_adapter_call_get_tag_snapshot_finish (
+    NeardAdapter *proxy,
+    GVariant **out_snapshot,
+    GAsyncResult *res,
+    GError **error)
+{
+  GVariant *_ret;
+  _ret = g_dbus_proxy_call_finish (G_DBUS_PROXY (proxy), res, error);
+  if (_ret == NULL)
+    goto _out;
+  g_variant_get (_ret,
+                 "(@a{sv})",
+                 out_snapshot);
+  g_variant_unref (_ret);
+_out:
+  return _ret != NULL;
+}
+
+/**
+ * neard_adapter_call_get_tag_snapshot_sync:
+ * @proxy: A #NeardAdapterProxy.
+ * @arg_tag: Argument to pass with the method invocation.
+ * @out_snapshot: (out): Return location for return parameter or %NULL to ignore.
+ * @cancellable: (allow-none): A #GCancellable or %NULL.
+ * @error: Return location for error or %NULL.
+ *
+ * Synchronously invokes the <link linkend="gdbus-method-org-neard-Adapter.GetTagSnapshot">GetTagSnapshot()</link> D-Bus method on @proxy. The calling thread is blocked until a reply is received.
+ *
+ * See neard_adapter_call_get_tag_snapshot() for the asynchronous version of this method.
+ *
+ * Returns: (skip): %TRUE if the call succeded, %FALSE if @error is set.
+ */
+gboolean
+neard_adapter_call_get_tag_snapshot_sync (
+    NeardAdapter *proxy,
+    const gchar *arg_tag,
+    GVariant **out_snapshot,
+    GCancellable *cancellable,
+    GError **error)
+{
+  GVariant *_ret;
+  _ret = g_dbus_proxy_call_sync (G_DBUS_PROXY (proxy),
+    "GetTagSnapshot",
+    g_variant_new ("(o)",
+                   arg_tag),
+    G_DBUS_CALL_FLAGS_NONE,
+    -1,
+    cancellable,
+    error);
+  if (_ret == NULL)
+    goto _out;
+  g_variant_get (_ret,
+                 "(@a{sv})",
+                 out_snapshot);
+  g_variant_unref (_ret);
+_out:
+  return _ret != NULL;
+}
+
+/**
+ * neard_adapter_complete_start_poll_loop:
+ * @object: A #NeardAdapter.
+ * @invocation: (transfer full): A #GDBusMethodInvocation.
+ *
+ * Helper function used in service implementations to finish handling invocations of the <link linkend="gdbus-method-org-neard-Adapter.StartPollLoop">StartPollLoop()</link> D-Bus method. If you instead want to finish handling an invocation by returning an error, use g_dbus_method_invocation_return_error() or similar.
+ *
+ * This method will free @invocation, you cannot use it afterwards.
+ */
+void
+neard_adapter_complete_start_poll_loop (
+    NeardAdapter *object,
+    GDBusMethodInvocation *invocation)
+{
+  g_dbus_method_invocation_return_value (invocation,
+    g_variant_new ("()"));
+}
+
+/**
+ * neard_adapter_complete_stop_poll_loop:
+ * @object: A #NeardAdapter.
+ * @invocation: (transfer full): A #GDBusMethodInvocation.
+ *
+ * Helper function used in service implementations to finish handling invocations of the <link linkend="gdbus-method-org-neard-Adapter.StopPollLoop">StopPollLoop()</link> D-Bus method. If you instead want to finish handling an invocation by returning an error, use g_dbus_method_invocation_return_error() or similar.
+ *
+ * This method will free @invocation, you cannot use it afterwards.
+ */
+void
+neard_adapter_complete_stop_poll_loop (
+    NeardAdapter *object,
+    GDBusMethodInvocation *invocation)
+{
+  g_dbus_method_invocation_return_value (invocation,
+    g_variant_new ("()"));
+}
+
+/**
+ * neard_adapter_complete_start_provisioning:
  * @object: A #NeardAdapter.
  * @invocation: (transfer full): A #GDBusMethodInvocation.
  *
- * Helper function used in service implementations to finish handling invocations of the <link linkend="gdbus-method-org-neard-Adapter.StartPollLoop">StartPollLoop()</link> D-Bus method. If you instead want to finish handling an invocation by returning an error, use g_dbus_method_invocation_return_error() or similar.
+ * Helper function used in service implementations to finish handling invocations of the <link linkend="gdbus-method-org-neard-Adapter.StartProvisioning">StartProvisioning()</link> D-Bus method. If you instead want to finish handling an invocation by returning an error, use g_dbus_method_invocation_return_error() or similar.
  *
  * This method will free @invocation, you cannot use it afterwards.
  */
 void
-neard_adapter_complete_start_poll_loop (
+neard_adapter_complete_start_provisioning (
     NeardAdapter *object,
     GDBusMethodInvocation *invocation)
 {
@@ -1168,16 +1881,16 @@ neard_adapter_complete_start_poll_loop (
 }
 
 /**
- * neard_adapter_complete_stop_poll_loop:
+ * neard_adapter_complete_stop_provisioning:
  * @object: A #NeardAdapter.
  * @invocation: (transfer full): A #GDBusMethodInvocation.
  *
- * Helper function used in service implementations to finish handling invocations of the <link linkend="gdbus-method-org-neard-Adapter.StopPollLoop">StopPollLoop()</link> D-Bus method. If you instead want to finish handling an invocation by returning an error, use g_dbus_method_invocation_return_error() or similar.
+ * Helper function used in service implementations to finish handling invocations of the <link linkend="gdbus-method-org-neard-Adapter.StopProvisioning">StopProvisioning()</link> D-Bus method. If you instead want to finish handling an invocation by returning an error, use g_dbus_method_invocation_return_error() or similar.
  *
  * This method will free @invocation, you cannot use it afterwards.
  */
 void
-neard_adapter_complete_stop_poll_loop (
+neard_adapter_complete_stop_provisioning (
     NeardAdapter *object,
     GDBusMethodInvocation *invocation)
 {
@@ -1185,6 +1898,27 @@ neard_adapter_complete_stop_poll_loop (
     g_variant_new ("()"));
 }
 
+/**
+ * neard_adapter_complete_get_tag_snapshot:
+ * @object: A #NeardAdapter.
+ * @invocation: (transfer full): A #GDBusMethodInvocation.
+ * @snapshot: Parameter to return.
+ *
+ * Helper function used in service implementations to finish handling invocations of the <link linkend="gdbus-method-org-neard-Adapter.GetTagSnapshot">GetTagSnapshot()</link> D-Bus method. If you instead want to finish handling an invocation by returning an error, use g_dbus_method_invocation_return_error() or similar.
+ *
+ * This method will free @invocation, you cannot use it afterwards.
+ */
+void
+neard_adapter_complete_get_tag_snapshot (
+    NeardAdapter *object,
+    GDBusMethodInvocation *invocation,
+    GVariant *snapshot)
+{
+  g_dbus_method_invocation_return_value (invocation,
+    g_variant_new ("(@a{sv})",
+                   snapshot));
+}
+
 /* ------------------------------------------------------------------------ */
 
 /**
@@ -1233,7 +1967,7 @@ neard_adapter_proxy_get_property (GObject      *object,
 {
   const _ExtendedGDBusPropertyInfo *info;
   GVariant *variant;
-  g_assert (prop_id != 0 && prop_id - 1 < 7);
+  g_assert (prop_id != 0 && prop_id - 1 < 8);
   info = _neard_adapter_property_info_pointers[prop_id - 1];
   variant = g_dbus_proxy_get_cached_property (G_DBUS_PROXY (object), info->parent_struct.name);
   if (info->use_gvariant)
@@ -1280,7 +2014,7 @@ neard_adapter_proxy_set_property (GObject      *object,
 {
   const _ExtendedGDBusPropertyInfo *info;
   GVariant *variant;
-  g_assert (prop_id != 0 && prop_id - 1 < 7);
+  g_assert (prop_id != 0 && prop_id - 1 < 8);
   info = _neard_adapter_property_info_pointers[prop_id - 1];
   variant = g_dbus_gvalue_to_gvariant (value, G_VARIANT_TYPE (info->parent_struct.signature));
   g_dbus_proxy_call (G_DBUS_PROXY (object),
@@ -1471,6 +2205,19 @@ neard_adapter_proxy_get_devices (NeardAdapter *object)
   return value;
 }
 
+static GVariant *
+neard_adapter_proxy_get_statistics (NeardAdapter *object)
+{
+  NeardAdapterProxy *proxy = NEARD_ADAPTER_PROXY (object);
+  GVariant *variant;
+  GVariant *value = NULL;
+  variant = g_dbus_proxy_get_cached_property (G_DBUS_PROXY (proxy), "Statistics");
+  value = variant;
+  if (variant != NULL)
+    g_variant_unref (variant);
+  return value;
+}
+
 static void
 neard_adapter_proxy_init (NeardAdapterProxy *proxy)
 {
@@ -1515,6 +2262,7 @@ neard_adapter_proxy_iface_init (NeardAdapterIface *iface)
   iface->get_protocols = neard_adapter_proxy_get_protocols;
   iface->get_tags = neard_adapter_proxy_get_tags;
   iface->get_devices = neard_adapter_proxy_get_devices;
+  iface->get_statistics = neard_adapter_proxy_get_statistics;
 }
 
 /**
@@ -1973,6 +2721,56 @@ _neard_adapter_on_signal_tag_lost (
   g_list_free_full (connections, g_object_unref);
 }
 
+static void
+_neard_adapter_on_signal_provisioning_result (
+    NeardAdapter *object,
+    GVariant *arg_result)
+{
+  NeardAdapterSkeleton *skeleton = NEARD_ADAPTER_SKELETON (object);
+
+  GList      *connections, *l;
+  GVariant   *signal_variant;
+  connections = g_dbus_interface_skeleton_get_connections (G_DBUS_INTERFACE_SKELETON (skeleton));
+
+  signal_variant = g_variant_ref_sink (g_variant_new ("(@a{sv})",
+                   arg_result));
+  for (l = connections; l != NULL; l = l->next)
+    {
+      GDBusConnection *connection = l->data;
+      g_dbus_connection_emit_signal (connection,
+        NULL, g_dbus_interface_skeleton_get_object_path (G_DBUS_INTERFACE_SKELETON (skeleton)), "org.neard.Adapter", "ProvisioningResult",
+        signal_variant, NULL);
+    }
+  g_variant_unref (signal_variant);
+  g_list_free_full (connections, g_object_unref);
+}
+
+static void
+_neard_adapter_on_signal_tag_read (
+    NeardAdapter *object,
+    const gchar *arg_tag,
+    GVariant *arg_snapshot)
+{
+  NeardAdapterSkeleton *skeleton = NEARD_ADAPTER_SKELETON (object);
+
+  GList      *connections, *l;
+  GVariant   *signal_variant;
+  connections = g_dbus_interface_skeleton_get_connections (G_DBUS_INTERFACE_SKELETON (skeleton));
+
+  signal_variant = g_variant_ref_sink (g_variant_new ("(o@a{sv})",
+                   arg_tag,
+                   arg_snapshot));
+  for (l = connections; l != NULL; l = l->next)
+    {
+      GDBusConnection *connection = l->data;
+      g_dbus_connection_emit_signal (connection,
+        NULL, g_dbus_interface_skeleton_get_object_path (G_DBUS_INTERFACE_SKELETON (skeleton)), "org.neard.Adapter", "TagRead",
+        signal_variant, NULL);
+    }
+  g_variant_unref (signal_variant);
+  g_list_free_full (connections, g_object_unref);
+}
+
 static void neard_adapter_skeleton_iface_init (NeardAdapterIface *iface);
 #if GLIB_VERSION_MAX_ALLOWED >= GLIB_VERSION_2_38
 G_DEFINE_TYPE_WITH_CODE (NeardAdapterSkeleton, neard_adapter_skeleton, G_TYPE_DBUS_INTERFACE_SKELETON,
@@ -1989,7 +2787,7 @@ neard_adapter_skeleton_finalize (GObject *object)
 {
   NeardAdapterSkeleton *skeleton = NEARD_ADAPTER_SKELETON (object);
   guint n;
-  for (n = 0; n < 7; n++)
+  for (n = 0; n < 8; n++)
     g_value_unset (&skeleton->priv->properties[n]);
   g_free (skeleton->priv->properties);
   g_list_free_full (skeleton->priv->changed_properties, (GDestroyNotify) _changed_property_free);
@@ -2007,7 +2805,7 @@ neard_adapter_skeleton_get_property (GObject      *object,
   GParamSpec   *pspec G_GNUC_UNUSED)
 {
   NeardAdapterSkeleton *skeleton = NEARD_ADAPTER_SKELETON (object);
-  g_assert (prop_id != 0 && prop_id - 1 < 7);
+  g_assert (prop_id != 0 && prop_id - 1 < 8);
   g_mutex_lock (&skeleton->priv->lock);
   g_value_copy (&skeleton->priv->properties[prop_id - 1], value);
   g_mutex_unlock (&skeleton->priv->lock);
@@ -2124,7 +2922,7 @@ neard_adapter_skeleton_set_property (GObject      *object,
   GParamSpec   *pspec)
 {
   NeardAdapterSkeleton *skeleton = NEARD_ADAPTER_SKELETON (object);
-  g_assert (prop_id != 0 && prop_id - 1 < 7);
+  g_assert (prop_id != 0 && prop_id - 1 < 8);
   g_mutex_lock (&skeleton->priv->lock);
   g_object_freeze_notify (object);
   if (!_g_value_equal (value, &skeleton->priv->properties[prop_id - 1]))
@@ -2149,7 +2947,7 @@ neard_adapter_skeleton_init (NeardAdapterSkeleton *skeleton)
 
   g_mutex_init (&skeleton->priv->lock);
   skeleton->priv->context = g_main_context_ref_thread_default ();
-  skeleton->priv->properties = g_new0 (GValue, 7);
+  skeleton->priv->properties = g_new0 (GValue, 8);
   g_value_init (&skeleton->priv->properties[0], G_TYPE_STRING);
   g_value_init (&skeleton->priv->properties[1], G_TYPE_STRING);
   g_value_init (&skeleton->priv->properties[2], G_TYPE_BOOLEAN);
@@ -2157,6 +2955,7 @@ neard_adapter_skeleton_init (NeardAdapterSkeleton *skeleton)
   g_value_init (&skeleton->priv->properties[4], G_TYPE_STRV);
   g_value_init (&skeleton->priv->properties[5], G_TYPE_STRV);
   g_value_init (&skeleton->priv->properties[6], G_TYPE_STRV);
+  g_value_init (&skeleton->priv->properties[7], G_TYPE_VARIANT);
 }
 
 static const gchar *
@@ -2236,6 +3035,17 @@ neard_adapter_skeleton_get_devices (NeardAdapter *object)
   return value;
 }
 
+static GVariant *
+neard_adapter_skeleton_get_statistics (NeardAdapter *object)
+{
+  NeardAdapterSkeleton *skeleton = NEARD_ADAPTER_SKELETON (object);
+  GVariant *value;
+  g_mutex_lock (&skeleton->priv->lock);
+  value = g_value_get_variant (&(skeleton->priv->properties[7]));
+  g_mutex_unlock (&skeleton->priv->lock);
+  return value;
+}
+
 static void
 neard_adapter_skeleton_class_init (NeardAdapterSkeletonClass *klass)
 {
@@ -2267,6 +3077,8 @@ neard_adapter_skeleton_iface_init (NeardAdapterIface *iface)
 {
   iface->tag_found = _neard_adapter_on_signal_tag_found;
   iface->tag_lost = _neard_adapter_on_signal_tag_lost;
+  iface->provisioning_result = _neard_adapter_on_signal_provisioning_result;
+  iface->tag_read = _neard_adapter_on_signal_tag_read;
   iface->get_name = neard_adapter_skeleton_get_name;
   iface->get_mode = neard_adapter_skeleton_get_mode;
   iface->get_powered = neard_adapter_skeleton_get_powered;
@@ -2274,6 +3086,7 @@ neard_adapter_skeleton_iface_init (NeardAdapterIface *iface)
   iface->get_protocols = neard_adapter_skeleton_get_protocols;
   iface->get_tags = neard_adapter_skeleton_get_tags;
   iface->get_devices = neard_adapter_skeleton_get_devices;
+  iface->get_statistics = neard_adapter_skeleton_get_statistics;
 }
 
 /**
@@ -4737,12 +5550,91 @@ static const _ExtendedGDBusMethodInfo _neard_manager_method_info_unregister_ndef
   FALSE
 };
 
+static const _ExtendedGDBusArgInfo _neard_manager_method_info_subscribe_IN_ARG_filter =
+{
+  {
+    -1,
+    (gchar *) "filter",
+    (gchar *) "a{sv}",
+    NULL
+  },
+  FALSE
+};
+
+static const _ExtendedGDBusArgInfo * const _neard_manager_method_info_subscribe_IN_ARG_pointers[] =
+{
+  &_neard_manager_method_info_subscribe_IN_ARG_filter,
+  NULL
+};
+
+static const _ExtendedGDBusArgInfo _neard_manager_method_info_subscribe_OUT_ARG_subscription =
+{
+  {
+    -1,
+    (gchar *) "subscription",
+    (gchar *) "u",
+    NULL
+  },
+  FALSE
+};
+
+static const _ExtendedGDBusArgInfo * const _neard_manager_method_info_subscribe_OUT_ARG_pointers[] =
+{
+  &_neard_manager_method_info_subscribe_OUT_ARG_subscription,
+  NULL
+};
+
+static const _ExtendedGDBusMethodInfo _neard_manager_method_info_subscribe =
+{
+  {
+    -1,
+    (gchar *) "Subscribe",
+    (GDBusArgInfo **) &_neard_manager_method_info_subscribe_IN_ARG_pointers,
+    (GDBusArgInfo **) &_neard_manager_method_info_subscribe_OUT_ARG_pointers,
+    NULL
+  },
+  "handle-subscribe",
+  FALSE
+};
+
+static const _ExtendedGDBusArgInfo _neard_manager_method_info_unsubscribe_IN_ARG_subscription =
+{
+  {
+    -1,
+    (gchar *) "subscription",
+    (gchar *) "u",
+    NULL
+  },
+  FALSE
+};
+
+static const _ExtendedGDBusArgInfo * const _neard_manager_method_info_unsubscribe_IN_ARG_pointers[] =
+{
+  &_neard_manager_method_info_unsubscribe_IN_ARG_subscription,
+  NULL
+};
+
+static const _ExtendedGDBusMethodInfo _neard_manager_method_info_unsubscribe =
+{
+  {
+    -1,
+    (gchar *) "Unsubscribe",
+    (GDBusArgInfo **) &_neard_manager_method_info_unsubscribe_IN_ARG_pointers,
+    NULL,
+    NULL
+  },
+  "handle-unsubscribe",
+  FALSE
+};
+
 static const _ExtendedGDBusMethodInfo * const _neard_manager_method_info_pointers[] =
 {
   &_neard_manager_method_info_register_handover_agent,
   &_neard_manager_method_info_unregister_handover_agent,
   &_neard_manager_method_info_register_ndefagent,
   &_neard_manager_method_info_unregister_ndefagent,
+  &_neard_manager_method_info_subscribe,
+  &_neard_manager_method_info_unsubscribe,
   NULL
 };
 
@@ -4842,11 +5734,105 @@ static const _ExtendedGDBusSignalInfo _neard_manager_signal_info_adapter_removed
   "adapter-removed"
 };
 
+static const _ExtendedGDBusArgInfo _neard_manager_signal_info_tag_matched_ARG_subscription =
+{
+  {
+    -1,
+    (gchar *) "subscription",
+    (gchar *) "u",
+    NULL
+  },
+  FALSE
+};
+
+static const _ExtendedGDBusArgInfo _neard_manager_signal_info_tag_matched_ARG_tag =
+{
+  {
+    -1,
+    (gchar *) "tag",
+    (gchar *) "o",
+    NULL
+  },
+  FALSE
+};
+
+static const _ExtendedGDBusArgInfo _neard_manager_signal_info_tag_matched_ARG_snapshot =
+{
+  {
+    -1,
+    (gchar *) "snapshot",
+    (gchar *) "a{sv}",
+    NULL
+  },
+  FALSE
+};
+
+static const _ExtendedGDBusArgInfo * const _neard_manager_signal_info_tag_matched_ARG_pointers[] =
+{
+  &_neard_manager_signal_info_tag_matched_ARG_subscription,
+  &_neard_manager_signal_info_tag_matched_ARG_tag,
+  &_neard_manager_signal_info_tag_matched_ARG_snapshot,
+  NULL
+};
+
+static const _ExtendedGDBusSignalInfo _neard_manager_signal_info_tag_matched =
+{
+  {
+    -1,
+    (gchar *) "TagMatched",
+    (GDBusArgInfo **) &_neard_manager_signal_info_tag_matched_ARG_pointers,
+    NULL
+  },
+  "tag-matched"
+};
+
+static const _ExtendedGDBusArgInfo _neard_manager_signal_info_tag_unmatched_ARG_subscription =
+{
+  {
+    -1,
+    (gchar *) "subscription",
+    (gchar *) "u",
+    NULL
+  },
+  FALSE
+};
+
+static const _ExtendedGDBusArgInfo _neard_manager_signal_info_tag_unmatched_ARG_tag =
+{
+  {
+    -1,
+    (gchar *) "tag",
+    (gchar *) "o",
+    NULL
+  },
+  FALSE
+};
+
+static const _ExtendedGDBusArgInfo * const _neard_manager_signal_info_tag_unmatched_ARG_pointers[] =
+{
+  &_neard_manager_signal_info_tag_unmatched_ARG_subscription,
+  &_neard_manager_signal_info_tag_unmatched_ARG_tag,
+  NULL
+};
+
+static const _ExtendedGDBusSignalInfo _neard_manager_signal_info_tag_unmatched =
+{
+  {
+    -1,
+    (gchar *) "TagUnmatched",
+    (GDBusArgInfo **) &_neard_manager_signal_info_tag_unmatched_ARG_pointers,
+    NULL
+  },
+  "tag-unmatched"
+};
+
 static const _ExtendedGDBusSignalInfo * const _neard_manager_signal_info_pointers[] =
 {
   &_neard_manager_signal_info_property_changed,
   &_neard_manager_signal_info_adapter_added,
   &_neard_manager_signal_info_adapter_removed,
+  &_neard_manager_signal_info_tag_matched,
+  &_neard_manager_signal_info_tag_unmatched,
   NULL
 };
 
@@ -4926,12 +5912,16 @@ neard_manager_override_properties (GObjectClass *klass, guint property_id_begin)
  * @parent_iface: The parent interface.
  * @handle_register_handover_agent: Handler for the #NeardManager::handle-register-handover-agent signal.
  * @handle_register_ndefagent: Handler for the #NeardManager::handle-register-ndefagent signal.
+ * @handle_subscribe: Handler for the #NeardManager::handle-subscribe signal.
  * @handle_unregister_handover_agent: Handler for the #NeardManager::handle-unregister-handover-agent signal.
  * @handle_unregister_ndefagent: Handler for the #NeardManager::handle-unregister-ndefagent signal.
+ * @handle_unsubscribe: Handler for the #NeardManager::handle-unsubscribe signal.
  * @get_adapters: Getter for the #NeardManager:adapters property.
  * @adapter_added: Handler for the #NeardManager::adapter-added signal.
  * @adapter_removed: Handler for the #NeardManager::adapter-removed signal.
  * @property_changed: Handler for the #NeardManager::property-changed signal.
+ * @tag_matched: Handler for the #NeardManager::tag-matched signal.
+ * @tag_unmatched: Handler for the #NeardManager::tag-unmatched signal.
  *
  * Virtual table for the D-Bus interface <link linkend="gdbus-interface-org-neard-Manager.top_of_page">org.neard.Manager</link>.
  */
@@ -4980,10 +5970,58 @@ neard_manager_default_init (NeardManagerIface *iface)
    *
    * Returns: %TRUE if the invocation was handled, %FALSE to let other signal handlers run.
    */
-  g_signal_new ("handle-unregister-handover-agent",
+  g_signal_new ("handle-unregister-handover-agent",
+    G_TYPE_FROM_INTERFACE (iface),
+    G_SIGNAL_RUN_LAST,
+    G_STRUCT_OFFSET (NeardManagerIface, handle_unregister_handover_agent),
+    g_signal_accumulator_true_handled,
+    NULL,
+    g_cclosure_marshal_generic,
+    G_TYPE_BOOLEAN,
+    3,
+    G_TYPE_DBUS_METHOD_INVOCATION, G_TYPE_STRING, G_TYPE_STRING);
+
+  /**
+   * NeardManager::handle-register-ndefagent:
+   * @object: A #NeardManager.
+   * @invocation: A #GDBusMethodInvocation.
+   * @arg_path: Argument passed by remote caller.
+   * @arg_type: Argument passed by remote caller.
+   *
+   * Signal emitted when a remote caller is invoking the <link linkend="gdbus-method-org-neard-Manager.RegisterNDEFAgent">RegisterNDEFAgent()</link> D-Bus method.
+   *
+   * If a signal handler returns %TRUE, it means the signal handler will handle the invocation (e.g. take a reference to @invocation and eventually call neard_manager_complete_register_ndefagent() or e.g. g_dbus_method_invocation_return_error() on it) and no order signal handlers will run. If no signal handler handles the invocation, the %G_DBUS_ERROR_UNKNOWN_METHOD error is returned.
+   *
+   * Returns: %TRUE if the invocation was handled, %FALSE to let other signal handlers run.
+   */
+  g_signal_new ("handle-register-ndefagent",
+    G_TYPE_FROM_INTERFACE (iface),
+    G_SIGNAL_RUN_LAST,
+    G_STRUCT_OFFSET (NeardManagerIface, handle_register_ndefagent),
+    g_signal_accumulator_true_handled,
+    NULL,
+    g_cclosure_marshal_generic,
+    G_TYPE_BOOLEAN,
+    3,
+    G_TYPE_DBUS_METHOD_INVOCATION, G_TYPE_STRING, G_TYPE_STRING);
+
+  /**
+   * NeardManager::handle-unregister-ndefagent:
+   * @object: A #NeardManager.
+   * @invocation: A #GDBusMethodInvocation.
+   * @arg_path: Argument passed by remote caller.
+   * @arg_type: Argument passed by remote caller.
+   *
+   * Signal emitted when a remote caller is invoking the <link linkend="gdbus-method-org-neard-Manager.UnregisterNDEFAgent">UnregisterNDEFAgent()</link> D-Bus method.
+   *
+   * If a signal handler returns %TRUE, it means the signal handler will handle the invocation (e.g. take a reference to @invocation and eventually call neard_manager_complete_unregister_ndefagent() or e.g. g_dbus_method_invocation_return_error() on it) and no order signal handlers will run. If no signal handler handles the invocation, the %G_DBUS_ERROR_UNKNOWN_METHOD error is returned.
+   *
+   * Returns: %TRUE if the invocation was handled, %FALSE to let other signal handlers run.
+   */
+  g_signal_new ("handle-unregister-ndefagent",
     G_TYPE_FROM_INTERFACE (iface),
     G_SIGNAL_RUN_LAST,
-    G_STRUCT_OFFSET (NeardManagerIface, handle_unregister_handover_agent),
+    G_STRUCT_OFFSET (NeardManagerIface, handle_unregister_ndefagent),
     g_signal_accumulator_true_handled,
     NULL,
     g_cclosure_marshal_generic,
@@ -4992,52 +6030,50 @@ neard_manager_default_init (NeardManagerIface *iface)
     G_TYPE_DBUS_METHOD_INVOCATION, G_TYPE_STRING, G_TYPE_STRING);
 
   /**
-   * NeardManager::handle-register-ndefagent:
+   * NeardManager::handle-subscribe:
    * @object: A #NeardManager.
    * @invocation: A #GDBusMethodInvocation.
-   * @arg_path: Argument passed by remote caller.
-   * @arg_type: Argument passed by remote caller.
+   * @arg_filter: Argument passed by remote caller.
    *
-   * Signal emitted when a remote caller is invoking the <link linkend="gdbus-method-org-neard-Manager.RegisterNDEFAgent">RegisterNDEFAgent()</link> D-Bus method.
+   * Signal emitted when a remote caller is invoking the <link linkend="gdbus-method-org-neard-Manager.Subscribe">Subscribe()</link> D-Bus method.
    *
-   * If a signal handler returns %TRUE, it means the signal handler will handle the invocation (e.g. take a reference to @invocation and eventually call neard_manager_complete_register_ndefagent() or e.g. g_dbus_method_invocation_return_error() on it) and no order signal handlers will run. If no signal handler handles the invocation, the %G_DBUS_ERROR_UNKNOWN_METHOD error is returned.
+   * If a signal handler returns %TRUE, it means the signal handler will handle the invocation (e.g. take a reference to @invocation and eventually call neard_manager_complete_subscribe() or e.g. g_dbus_method_invocation_return_error() on it) and no order signal handlers will run. If no signal handler handles the invocation, the %G_DBUS_ERROR_UNKNOWN_METHOD error is returned.
    *
    * Returns: %TRUE if the invocation was handled, %FALSE to let other signal handlers run.
    */
-  g_signal_new ("handle-register-ndefagent",
+  g_signal_new ("handle-subscribe",
     G_TYPE_FROM_INTERFACE (iface),
     G_SIGNAL_RUN_LAST,
-    G_STRUCT_OFFSET (NeardManagerIface, handle_register_ndefagent),
+    G_STRUCT_OFFSET (NeardManagerIface, handle_subscribe),
     g_signal_accumulator_true_handled,
     NULL,
     g_cclosure_marshal_generic,
     G_TYPE_BOOLEAN,
-    3,
-    G_TYPE_DBUS_METHOD_INVOCATION, G_TYPE_STRING, G_TYPE_STRING);
+    2,
+    G_TYPE_DBUS_METHOD_INVOCATION, G_TYPE_VARIANT);
 
   /**
-   * NeardManager::handle-unregister-ndefagent:
+   * NeardManager::handle-unsubscribe:
    * @object: A #NeardManager.
    * @invocation: A #GDBusMethodInvocation.
-   * @arg_path: Argument passed by remote caller.
-   * @arg_type: Argument passed by remote caller.
+   * @arg_subscription: Argument passed by remote caller.
    *
-   * Signal emitted when a remote caller is invoking the <link linkend="gdbus-method-org-neard-Manager.UnregisterNDEFAgent">UnregisterNDEFAgent()</link> D-Bus method.
+   * Signal emitted when a remote caller is invoking the <link linkend="gdbus-method-org-neard-Manager.Unsubscribe">Unsubscribe()</link> D-Bus method.
    *
-   * If a signal handler returns %TRUE, it means the signal handler will handle the invocation (e.g. take a reference to @invocation and eventually call neard_manager_complete_unregister_ndefagent() or e.g. g_dbus_method_invocation_return_error() on it) and no order signal handlers will run. If no signal handler handles the invocation, the %G_DBUS_ERROR_UNKNOWN_METHOD error is returned.
+   * If a signal handler returns %TRUE, it means the signal handler will handle the invocation (e.g. take a reference to @invocation and eventually call neard_manager_complete_unsubscribe() or e.g. g_dbus_method_invocation_return_error() on it) and no order signal handlers will run. If no signal handler handles the invocation, the %G_DBUS_ERROR_UNKNOWN_METHOD error is returned.
    *
    * Returns: %TRUE if the invocation was handled, %FALSE to let other signal handlers run.
    */
-  g_signal_new ("handle-unregister-ndefagent",
+  g_signal_new ("handle-unsubscribe",
     G_TYPE_FROM_INTERFACE (iface),
     G_SIGNAL_RUN_LAST,
-    G_STRUCT_OFFSET (NeardManagerIface, handle_unregister_ndefagent),
+    G_STRUCT_OFFSET (NeardManagerIface, handle_unsubscribe),
     g_signal_accumulator_true_handled,
     NULL,
     g_cclosure_marshal_generic,
     G_TYPE_BOOLEAN,
-    3,
-    G_TYPE_DBUS_METHOD_INVOCATION, G_TYPE_STRING, G_TYPE_STRING);
+    2,
+    G_TYPE_DBUS_METHOD_INVOCATION, G_TYPE_UINT);
 
   /* GObject signals for received D-Bus signals: */
   /**
@@ -5098,6 +6134,47 @@ neard_manager_default_init (NeardManagerIface *iface)
     G_TYPE_NONE,
     1, G_TYPE_STRING);
 
+  /**
+   * NeardManager::tag-matched:
+   * @object: A #NeardManager.
+   * @arg_subscription: Argument.
+   * @arg_tag: Argument.
+   * @arg_snapshot: Argument.
+   *
+   * On the client-side, this signal is emitted whenever the D-Bus signal <link linkend="gdbus-signal-org-neard-Manager.TagMatched">"TagMatched"</link> is received.
+   *
+   * On the service-side, this signal can be used with e.g. g_signal_emit_by_name() to make the object emit the D-Bus signal.
+   */
+  g_signal_new ("tag-matched",
+    G_TYPE_FROM_INTERFACE (iface),
+    G_SIGNAL_RUN_LAST,
+    G_STRUCT_OFFSET (NeardManagerIface, tag_matched),
+    NULL,
+    NULL,
+    g_cclosure_marshal_generic,
+    G_TYPE_NONE,
+    3, G_TYPE_UINT, G_TYPE_STRING, G_TYPE_VARIANT);
+
+  /**
+   * NeardManager::tag-unmatched:
+   * @object: A #NeardManager.
+   * @arg_subscription: Argument.
+   * @arg_tag: Argument.
+   *
+   * On the client-side, this signal is emitted whenever the D-Bus signal <link linkend="gdbus-signal-org-neard-Manager.TagUnmatched">"TagUnmatched"</link> is received.
+   *
+   * On the service-side, this signal can be used with e.g. g_signal_emit_by_name() to make the object emit the D-Bus signal.
+   */
+  g_signal_new ("tag-unmatched",
+    G_TYPE_FROM_INTERFACE (iface),
+    G_SIGNAL_RUN_LAST,
+    G_STRUCT_OFFSET (NeardManagerIface, tag_unmatched),
+    NULL,
+    NULL,
+    g_cclosure_marshal_generic,
+    G_TYPE_NONE,
+    2, G_TYPE_UINT, G_TYPE_STRING);
+
   /* GObject properties for D-Bus properties: */
   /**
    * NeardManager:adapters:
@@ -5208,6 +6285,42 @@ neard_manager_emit_adapter_removed (
   g_signal_emit_by_name (object, "adapter-removed", arg_adapter);
 }
 
+/**
+ * neard_manager_emit_tag_matched:
+ * @object: A #NeardManager.
+ * @arg_subscription: Argument to pass with the signal.
+ * @arg_tag: Argument to pass with the signal.
+ * @arg_snapshot: Argument to pass with the signal.
+ *
+ * Emits the <link linkend="gdbus-signal-org-neard-Manager.TagMatched">"TagMatched"</link> D-Bus signal.
+ */
+void
+neard_manager_emit_tag_matched (
+    NeardManager *object,
+    guint arg_subscription,
+    const gchar *arg_tag,
+    GVariant *arg_snapshot)
+{
+  g_signal_emit_by_name (object, "tag-matched", arg_subscription, arg_tag, arg_snapshot);
+}
+
+/**
+ * neard_manager_emit_tag_unmatched:
+ * @object: A #NeardManager.
+ * @arg_subscription: Argument to pass with the signal.
+ * @arg_tag: Argument to pass with the signal.
+ *
+ * Emits the <link linkend="gdbus-signal-org-neard-Manager.TagUnmatched">"TagUnmatched"</link> D-Bus signal.
+ */
+void
+neard_manager_emit_tag_unmatched (
+    NeardManager *object,
+    guint arg_subscription,
+    const gchar *arg_tag)
+{
+  g_signal_emit_by_name (object, "tag-unmatched", arg_subscription, arg_tag);
+}
+
 /**
  * neard_manager_call_register_handover_agent:
  * @proxy: A #NeardManagerProxy.
@@ -5624,6 +6737,208 @@ _out:
   return _ret != NULL;
 }
 
+/**
+ * neard_manager_call_subscribe:
+ * @proxy: A #NeardManagerProxy.
+ * @arg_filter: Argument to pass with the method invocation.
+ * @cancellable: (allow-none): A #GCancellable or %NULL.
+ * @callback: A #GAsyncReadyCallback to call when the request is satisfied or %NULL.
+ * @user_data: User data to pass to @callback.
+ *
+ * Asynchronously invokes the <link linkend="gdbus-method-org-neard-Manager.Subscribe">Subscribe()</link> D-Bus method on @proxy.
+ * When the operation is finished, @callback will be invoked in the <link linkend="g-main-context-push-thread-default">thread-default main loop</link> of the thread you are calling this method from.
+ * You can then call neard_manager_call_subscribe_finish() to get the result of the operation.
+ *
+ * See neard_manager_call_subscribe_sync() for the synchronous, blocking version of this method.
+ */
+void
+neard_manager_call_subscribe (
+    NeardManager *proxy,
+    GVariant *arg_filter,
+    GCancellable *cancellable,
+    GAsyncReadyCallback callback,
+    gpointer user_data)
+{
+  g_dbus_proxy_call (G_DBUS_PROXY (proxy),
+    "Subscribe",
+    g_variant_new ("(@a{sv})",
+                   arg_filter),
+    G_DBUS_CALL_FLAGS_NONE,
+    -1,
+    cancellable,
+    callback,
+    user_data);
+}
+
+/**
+ * neard_manager_call_subscribe_finish:
+ * @proxy: A #NeardManagerProxy.
+ * @out_subscription: (out): Return location for return parameter or %NULL to ignore.
+ * @res: The #GAsyncResult obtained from the #GAsyncReadyCallback passed to neard_manager_call_subscribe().
+ * @error: Return location for error or %NULL.
+ *
+ * Finishes an operation started with neard_manager_call_subscribe().
+ *
+ * Returns: (skip): %TRUE if the call succeded, %FALSE if @error is set.
+ */
+gboolean
+neard_manager_call_subscribe_finish (
+    NeardManager *proxy,
+    guint *out_subscription,
+    GAsyncResult *res,
+    GError **error)
+{
+  GVariant *_ret;
+  _ret = g_dbus_proxy_call_finish (G_DBUS_PROXY (proxy), res, error);
+  if (_ret == NULL)
+    goto _out;
+  g_variant_get (_ret,
+                 "(u)",
+                 out_subscription);
+  g_variant_unref (_ret);
+_out:
+  return _ret != NULL;
+}
+
+/**
+ * neard_manager_call_subscribe_sync:
+ * @proxy: A #NeardManagerProxy.
+ * @arg_filter: Argument to pass with the method invocation.
+ * @out_subscription: (out): Return location for return parameter or %NULL to ignore.
+ * @cancellable: (allow-none): A #GCancellable or %NULL.
+ * @error: Return location for error or %NULL.
+ *
+ * Synchronously invokes the <link linkend="gdbus-method-org-neard-Manager.Subscribe">Subscribe()</link> D-Bus method on @proxy. The calling thread is blocked until a reply is received.
+ *
+ * See neard_manager_call_subscribe() for the asynchronous version of this method.
+ *
+ * Returns: (skip): %TRUE if the call succeded, %FALSE if @error is set.
+ */
+gboolean
+neard_manager_call_subscribe_sync (
+    NeardManager *proxy,
+    GVariant *arg_filter,
+    guint *out_subscription,
+    GCancellable *cancellable,
+    GError **error)
+{
+  GVariant *_ret;
+  _ret = g_dbus_proxy_call_sync (G_DBUS_PROXY (proxy),
+    "Subscribe",
+    g_variant_new ("(@a{sv})",
+                   arg_filter),
+    G_DBUS_CALL_FLAGS_NONE,
+    -1,
+    cancellable,
+    error);
+  if (_ret == NULL)
+    goto _out;
+  g_variant_get (_ret,
+                 "(u)",
+                 out_subscription);
+  g_variant_unref (_ret);
+_out:
+  return _ret != NULL;
+}
+
+/**
+ * neard_manager_call_unsubscribe:
+ * @proxy: A #NeardManagerProxy.
+ * @arg_subscription: Argument to pass with the method invocation.
+ * @cancellable: (allow-none): A #GCancellable or %NULL.
+ * @callback: A #GAsyncReadyCallback to call when the request is satisfied or %NULL.
+ * @user_data: User data to pass to @callback.
+ *
+ * Asynchronously invokes the <link linkend="gdbus-method-org-neard-Manager.Unsubscribe">Unsubscribe()</link> D-Bus method on @proxy.
+ * When the operation is finished, @callback will be invoked in the <link linkend="g-main-context-push-thread-default">thread-default main loop</link> of the thread you are calling this method from.
+ * You can then call neard_manager_call_unsubscribe_finish() to get the result of the operation.
+ *
+ * See neard_manager_call_unsubscribe_sync() for the synchronous, blocking version of this method.
+ */
+void
+neard_manager_call_unsubscribe (
+    NeardManager *proxy,
+    guint arg_subscription,
+    GCancellable *cancellable,
+    GAsyncReadyCallback callback,
+    gpointer user_data)
+{
+  g_dbus_proxy_call (G_DBUS_PROXY (proxy),
+    "Unsubscribe",
+    g_variant_new ("(u)",
+                   arg_subscription),
+    G_DBUS_CALL_FLAGS_NONE,
+    -1,
+    cancellable,
+    callback,
+    user_data);
+}
+
+/**
+ * neard_manager_call_unsubscribe_finish:
+ * @proxy: A #NeardManagerProxy.
+ * @res: The #GAsyncResult obtained from the #GAsyncReadyCallback passed to neard_manager_call_unsubscribe().
+ * @error: Return location for error or %NULL.
+ *
+ * Finishes an operation started with neard_manager_call_unsubscribe().
+ *
+ * Returns: (skip): %TRUE if the call succeded, %FALSE if @error is set.
+ */
+gboolean
+neard_manager_call_unsubscribe_finish (
+    NeardManager *proxy,
+    GAsyncResult *res,
+    GError **error)
+{
+  GVariant *_ret;
+  _ret = g_dbus_proxy_call_finish (G_DBUS_PROXY (proxy), res, error);
+  if (_ret == NULL)
+    goto _out;
+  g_variant_get (_ret,
+                 "()");
+  g_variant_unref (_ret);
+_out:
+  return _ret != NULL;
+}
+
+/**
+ * neard_manager_call_unsubscribe_sync:
+ * @proxy: A #NeardManagerProxy.
+ * @arg_subscription: Argument to pass with the method invocation.
+ * @cancellable: (allow-none): A #GCancellable or %NULL.
+ * @error: Return location for error or %NULL.
+ *
+ * Synchronously invokes the <link linkend="gdbus-method-org-neard-Manager.Unsubscribe">Unsubscribe()</link> D-Bus method on @proxy. The calling thread is blocked until a reply is received.
+ *
+ * See neard_manager_call_unsubscribe() for the asynchronous version of this method.
+ *
+ * Returns: (skip): %TRUE if the call succeded, %FALSE if @error is set.
+ */
+gboolean
+neard_manager_call_unsubscribe_sync (
+    NeardManager *proxy,
+    guint arg_subscription,
+    GCancellable *cancellable,
+    GError **error)
+{
+  GVariant *_ret;
+  _ret = g_dbus_proxy_call_sync (G_DBUS_PROXY (proxy),
+    "Unsubscribe",
+    g_variant_new ("(u)",
+                   arg_subscription),
+    G_DBUS_CALL_FLAGS_NONE,
+    -1,
+    cancellable,
+    error);
+  if (_ret == NULL)
+    goto _out;
+  g_variant_get (_ret,
+                 "()");
+  g_variant_unref (_ret);
+_out:
+  return _ret != NULL;
+}
+
 /**
  * neard_manager_complete_register_handover_agent:
  * @object: A #NeardManager.
@@ -5634,7 +6949,43 @@ _out:
  * This method will free @invocation, you cannot use it afterwards.
  */
 void
-neard_manager_complete_register_handover_agent (
+neard_manager_complete_register_handover_agent (
+    NeardManager *object,
+    GDBusMethodInvocation *invocation)
+{
+  g_dbus_method_invocation_return_value (invocation,
+    g_variant_new ("()"));
+}
+
+/**
+ * neard_manager_complete_unregister_handover_agent:
+ * @object: A #NeardManager.
+ * @invocation: (transfer full): A #GDBusMethodInvocation.
+ *
+ * Helper function used in service implementations to finish handling invocations of the <link linkend="gdbus-method-org-neard-Manager.UnregisterHandoverAgent">UnregisterHandoverAgent()</link> D-Bus method. If you instead want to finish handling an invocation by returning an error, use g_dbus_method_invocation_return_error() or similar.
+ *
+ * This method will free @invocation, you cannot use it afterwards.
+ */
+void
+neard_manager_complete_unregister_handover_agent (
+    NeardManager *object,
+    GDBusMethodInvocation *invocation)
+{
+  g_dbus_method_invocation_return_value (invocation,
+    g_variant_new ("()"));
+}
+
+/**
+ * neard_manager_complete_register_ndefagent:
+ * @object: A #NeardManager.
+ * @invocation: (transfer full): A #GDBusMethodInvocation.
+ *
+ * Helper function used in service implementations to finish handling invocations of the <link linkend="gdbus-method-org-neard-Manager.RegisterNDEFAgent">RegisterNDEFAgent()</link> D-Bus method. If you instead want to finish handling an invocation by returning an error, use g_dbus_method_invocation_return_error() or similar.
+ *
+ * This method will free @invocation, you cannot use it afterwards.
+ */
+void
+neard_manager_complete_register_ndefagent (
     NeardManager *object,
     GDBusMethodInvocation *invocation)
 {
@@ -5643,16 +6994,16 @@ neard_manager_complete_register_handover_agent (
 }
 
 /**
- * neard_manager_complete_unregister_handover_agent:
+ * neard_manager_complete_unregister_ndefagent:
  * @object: A #NeardManager.
  * @invocation: (transfer full): A #GDBusMethodInvocation.
  *
- * Helper function used in service implementations to finish handling invocations of the <link linkend="gdbus-method-org-neard-Manager.UnregisterHandoverAgent">UnregisterHandoverAgent()</link> D-Bus method. If you instead want to finish handling an invocation by returning an error, use g_dbus_method_invocation_return_error() or similar.
+ * Helper function used in service implementations to finish handling invocations of the <link linkend="gdbus-method-org-neard-Manager.UnregisterNDEFAgent">UnregisterNDEFAgent()</link> D-Bus method. If you instead want to finish handling an invocation by returning an error, use g_dbus_method_invocation_return_error() or similar.
  *
  * This method will free @invocation, you cannot use it afterwards.
  */
 void
-neard_manager_complete_unregister_handover_agent (
+neard_manager_complete_unregister_ndefagent (
     NeardManager *object,
     GDBusMethodInvocation *invocation)
 {
@@ -5661,34 +7012,37 @@ neard_manager_complete_unregister_handover_agent (
 }
 
 /**
- * neard_manager_complete_register_ndefagent:
+ * neard_manager_complete_subscribe:
  * @object: A #NeardManager.
  * @invocation: (transfer full): A #GDBusMethodInvocation.
+ * @subscription: Parameter to return.
  *
- * Helper function used in service implementations to finish handling invocations of the <link linkend="gdbus-method-org-neard-Manager.RegisterNDEFAgent">RegisterNDEFAgent()</link> D-Bus method. If you instead want to finish handling an invocation by returning an error, use g_dbus_method_invocation_return_error() or similar.
+ * Helper function used in service implementations to finish handling invocations of the <link linkend="gdbus-method-org-neard-Manager.Subscribe">Subscribe()</link> D-Bus method. If you instead want to finish handling an invocation by returning an error, use g_dbus_method_invocation_return_error() or similar.
  *
  * This method will free @invocation, you cannot use it afterwards.
  */
 void
-neard_manager_complete_register_ndefagent (
+neard_manager_complete_subscribe (
     NeardManager *object,
-    GDBusMethodInvocation *invocation)
+    GDBusMethodInvocation *invocation,
+    guint subscription)
 {
   g_dbus_method_invocation_return_value (invocation,
-    g_variant_new ("()"));
+    g_variant_new ("(u)",
+                   subscription));
 }
 
 /**
- * neard_manager_complete_unregister_ndefagent:
+ * neard_manager_complete_unsubscribe:
  * @object: A #NeardManager.
  * @invocation: (transfer full): A #GDBusMethodInvocation.
  *
- * Helper function used in service implementations to finish handling invocations of the <link linkend="gdbus-method-org-neard-Manager.UnregisterNDEFAgent">UnregisterNDEFAgent()</link> D-Bus method. If you instead want to finish handling an invocation by returning an error, use g_dbus_method_invocation_return_error() or similar.
+ * Helper function used in service implementations to finish handling invocations of the <link linkend="gdbus-method-org-neard-Manager.Unsubscribe">Unsubscribe()</link> D-Bus method. If you instead want to finish handling an invocation by returning an error, use g_dbus_method_invocation_return_error() or similar.
  *
  * This method will free @invocation, you cannot use it afterwards.
  */
 void
-neard_manager_complete_unregister_ndefagent (
+neard_manager_complete_unsubscribe (
     NeardManager *object,
     GDBusMethodInvocation *invocation)
 {
@@ -6410,6 +7764,60 @@ _neard_manager_on_signal_adapter_removed (
   g_list_free_full (connections, g_object_unref);
 }
 
+static void
+_neard_manager_on_signal_tag_matched (
+    NeardManager *object,
+    guint arg_subscription,
+    const gchar *arg_tag,
+    GVariant *arg_snapshot)
+{
+  NeardManagerSkeleton *skeleton = NEARD_MANAGER_SKELETON (object);
+
+  GList      *connections, *l;
+  GVariant   *signal_variant;
+  connections = g_dbus_interface_skeleton_get_connections (G_DBUS_INTERFACE_SKELETON (skeleton));
+
+  signal_variant = g_variant_ref_sink (g_variant_new ("(uo@a{sv})",
+                   arg_subscription,
+                   arg_tag,
+                   arg_snapshot));
+  for (l = connections; l != NULL; l = l->next)
+    {
+      GDBusConnection *connection = l->data;
+      g_dbus_connection_emit_signal (connection,
+        NULL, g_dbus_interface_skeleton_get_object_path (G_DBUS_INTERFACE_SKELETON (skeleton)), "org.neard.Manager", "TagMatched",
+        signal_variant, NULL);
+    }
+  g_variant_unref (signal_variant);
+  g_list_free_full (connections, g_object_unref);
+}
+
+static void
+_neard_manager_on_signal_tag_unmatched (
+    NeardManager *object,
+    guint arg_subscription,
+    const gchar *arg_tag)
+{
+  NeardManagerSkeleton *skeleton = NEARD_MANAGER_SKELETON (object);
+
+  GList      *connections, *l;
+  GVariant   *signal_variant;
+  connections = g_dbus_interface_skeleton_get_connections (G_DBUS_INTERFACE_SKELETON (skeleton));
+
+  signal_variant = g_variant_ref_sink (g_variant_new ("(uo)",
+                   arg_subscription,
+                   arg_tag));
+  for (l = connections; l != NULL; l = l->next)
+    {
+      GDBusConnection *connection = l->data;
+      g_dbus_connection_emit_signal (connection,
+        NULL, g_dbus_interface_skeleton_get_object_path (G_DBUS_INTERFACE_SKELETON (skeleton)), "org.neard.Manager", "TagUnmatched",
+        signal_variant, NULL);
+    }
+  g_variant_unref (signal_variant);
+  g_list_free_full (connections, g_object_unref);
+}
+
 static void neard_manager_skeleton_iface_init (NeardManagerIface *iface);
 #if GLIB_VERSION_MAX_ALLOWED >= GLIB_VERSION_2_38
 G_DEFINE_TYPE_WITH_CODE (NeardManagerSkeleton, neard_manager_skeleton, G_TYPE_DBUS_INTERFACE_SKELETON,
@@ -6633,6 +8041,8 @@ neard_manager_skeleton_iface_init (NeardManagerIface *iface)
   iface->property_changed = _neard_manager_on_signal_property_changed;
   iface->adapter_added = _neard_manager_on_signal_adapter_added;
   iface->adapter_removed = _neard_manager_on_signal_adapter_removed;
+  iface->tag_matched = _neard_manager_on_signal_tag_matched;
+  iface->tag_unmatched = _neard_manager_on_signal_tag_unmatched;
   iface->get_adapters = neard_manager_skeleton_get_adapters;
 }
 
@@ -8200,10 +9610,41 @@ static const _ExtendedGDBusMethodInfo _neard_tag_method_info_get_raw_ndef =
   FALSE
 };
 
+static const _ExtendedGDBusArgInfo _neard_tag_method_info_get_records_OUT_ARG_records =
+{
+  {
+    -1,
+    (gchar *) "records",
+    (gchar *) "ao",
+    NULL
+  },
+  FALSE
+};
+
+static const _ExtendedGDBusArgInfo * const _neard_tag_method_info_get_records_OUT_ARG_pointers[] =
+{
+  &_neard_tag_method_info_get_records_OUT_ARG_records,
+  NULL
+};
+
+static const _ExtendedGDBusMethodInfo _neard_tag_method_info_get_records =
+{
+  {
+    -1,
+    (gchar *) "GetRecords",
+    NULL,
+    (GDBusArgInfo **) &_neard_tag_method_info_get_records_OUT_ARG_pointers,
+    NULL
+  },
+  "handle-get-records",
+  FALSE
+};
+
 static const _ExtendedGDBusMethodInfo * const _neard_tag_method_info_pointers[] =
 {
   &_neard_tag_method_info_write,
   &_neard_tag_method_info_get_raw_ndef,
+  &_neard_tag_method_info_get_records,
   NULL
 };
 
@@ -8376,6 +9817,19 @@ static const _ExtendedGDBusPropertyInfo _neard_tag_property_info_felica_max_resp
   TRUE
 };
 
+static const _ExtendedGDBusPropertyInfo _neard_tag_property_info_timings =
+{
+  {
+    -1,
+    (gchar *) "Timings",
+    (gchar *) "a{st}",
+    G_DBUS_PROPERTY_INFO_FLAGS_READABLE,
+    NULL
+  },
+  "timings",
+  TRUE
+};
+
 static const _ExtendedGDBusPropertyInfo * const _neard_tag_property_info_pointers[] =
 {
   &_neard_tag_property_info_name,
@@ -8391,6 +9845,7 @@ static const _ExtendedGDBusPropertyInfo * const _neard_tag_property_info_pointer
   &_neard_tag_property_info_felica_cid,
   &_neard_tag_property_info_felica_ic,
   &_neard_tag_property_info_felica_max_resp_times,
+  &_neard_tag_property_info_timings,
   NULL
 };
 
@@ -8447,6 +9902,7 @@ neard_tag_override_properties (GObjectClass *klass, guint property_id_begin)
   g_object_class_override_property (klass, property_id_begin++, "felica-cid");
   g_object_class_override_property (klass, property_id_begin++, "felica-ic");
   g_object_class_override_property (klass, property_id_begin++, "felica-max-resp-times");
+  g_object_class_override_property (klass, property_id_begin++, "timings");
   return property_id_begin - 1;
 }
 
@@ -8462,6 +9918,7 @@ neard_tag_override_properties (GObjectClass *klass, guint property_id_begin)
  * NeardTagIface:
  * @parent_iface: The parent interface.
  * @handle_get_raw_ndef: Handler for the #NeardTag::handle-get-raw-ndef signal.
+ * @handle_get_records: Handler for the #NeardTag::handle-get-records signal.
  * @handle_write: Handler for the #NeardTag::handle-write signal.
  * @get_adapter: Getter for the #NeardTag:adapter property.
  * @get_felica_cid: Getter for the #NeardTag:felica-cid property.
@@ -8475,6 +9932,7 @@ neard_tag_override_properties (GObjectClass *klass, guint property_id_begin)
  * @get_protocol: Getter for the #NeardTag:protocol property.
  * @get_read_only: Getter for the #NeardTag:read-only property.
  * @get_records: Getter for the #NeardTag:records property.
+ * @get_timings: Getter for the #NeardTag:timings property.
  * @get_type_: Getter for the #NeardTag:type property.
  *
  * Virtual table for the D-Bus interface <link linkend="gdbus-interface-org-neard-Tag.top_of_page">org.neard.Tag</link>.
@@ -8532,6 +9990,28 @@ neard_tag_default_init (NeardTagIface *iface)
     1,
     G_TYPE_DBUS_METHOD_INVOCATION);
 
+  /**
+   * NeardTag::handle-get-records:
+   * @object: A #NeardTag.
+   * @invocation: A #GDBusMethodInvocation.
+   *
+   * Signal emitted when a remote caller is invoking the <link linkend="gdbus-method-org-neard-Tag.GetRecords">GetRecords()</link> D-Bus method.
+   *
+   * If a signal handler returns %TRUE, it means the signal handler will handle the invocation (e.g. take a reference to @invocation and eventually call neard_tag_complete_get_records() or e.g. g_dbus_method_invocation_return_error() on it) and no order signal handlers will run. If no signal handler handles the invocation, the %G_DBUS_ERROR_UNKNOWN_METHOD error is returned.
+   *
+   * Returns: %TRUE if the invocation was handled, %FALSE to let other signal handlers run.
+   */
+  g_signal_new ("handle-get-records",
+    G_TYPE_FROM_INTERFACE (iface),
+    G_SIGNAL_RUN_LAST,
+    G_STRUCT_OFFSET (NeardTagIface, handle_get_records),
+    g_signal_accumulator_true_handled,
+    NULL,
+    g_cclosure_marshal_generic,
+    G_TYPE_BOOLEAN,
+    1,
+    G_TYPE_DBUS_METHOD_INVOCATION);
+
   /* GObject properties for D-Bus properties: */
   /**
    * NeardTag:name:
@@ -8650,6 +10130,15 @@ neard_tag_default_init (NeardTagIface *iface)
    */
   g_object_interface_install_property (iface,
     g_param_spec_variant ("felica-max-resp-times", "FelicaMaxRespTimes", "FelicaMaxRespTimes", G_VARIANT_TYPE ("ay"), NULL, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * NeardTag:timings:
+   *
+   * Represents the D-Bus property <link linkend="gdbus-property-org-neard-Tag.Timings">"Timings"</link>.
+   *
+   * Since the D-Bus property for this #GObject property is readable but not writable, it is meaningful to read from it on both the client- and service-side. It is only meaningful, however, to write to it on the service-side.
+   */
+  g_object_interface_install_property (iface,
+    g_param_spec_variant ("timings", "Timings", "Timings", G_VARIANT_TYPE ("a{st}"), NULL, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 }
 
 /**
@@ -9295,6 +10784,57 @@ neard_tag_set_felica_max_resp_times (NeardTag *object, GVariant *value)
   g_object_set (G_OBJECT (object), "felica-max-resp-times", value, NULL);
 }
 
+/**
+ * neard_tag_get_timings: (skip)
+ * @object: A #NeardTag.
+ *
+ * Gets the value of the <link linkend="gdbus-property-org-neard-Tag.Timings">"Timings"</link> D-Bus property.
+ *
+ * Since this D-Bus property is readable, it is meaningful to use this function on both the client- and service-side.
+ *
+ * <warning>The returned value is only valid until the property changes so on the client-side it is only safe to use this function on the thread where @object was constructed. Use neard_tag_dup_timings() if on another thread.</warning>
+ *
+ * Returns: (transfer none): The property value or %NULL if the property is not set. Do not free the returned value, it belongs to @object.
+ */
+GVariant *
+neard_tag_get_timings (NeardTag *object)
+{
+  return NEARD_TAG_GET_IFACE (object)->get_timings (object);
+}
+
+/**
+ * neard_tag_dup_timings: (skip)
+ * @object: A #NeardTag.
+ *
+ * Gets a copy of the <link linkend="gdbus-property-org-neard-Tag.Timings">"Timings"</link> D-Bus property.
+ *
+ * Since this D-Bus property is readable, it is meaningful to use this function on both the client- and service-side.
+ *
+ * Returns: (transfer full): The property value or %NULL if the property is not set. The returned value should be freed with g_variant_unref().
+ */
+GVariant *
+neard_tag_dup_timings (NeardTag *object)
+{
+  GVariant *value;
+  g_object_get (G_OBJECT (object), "timings", &value, NULL);
+  return value;
+}
+
+/**
+ * neard_tag_set_timings: (skip)
+ * @object: A #NeardTag.
+ * @value: The value to set.
+ *
+ * Sets the <link linkend="gdbus-property-org-neard-Tag.Timings">"Timings"</link> D-Bus property to @value.
+ *
+ * Since this D-Bus property is not writable, it is only meaningful to use this function on the service-side.
+ */
+void
+neard_tag_set_timings (NeardTag *object, GVariant *value)
+{
+  g_object_set (G_OBJECT (object), "timings", value, NULL);
+}
+
 /**
  * neard_tag_call_write:
  * @proxy: A #NeardTagProxy.
@@ -9491,6 +11031,104 @@ _out:
   return _ret != NULL;
 }
 
+/**
+ * neard_tag_call_get_records:
+ * @proxy: A #NeardTagProxy.
+ * @cancellable: (allow-none): A #GCancellable or %NULL.
+ * @callback: A #GAsyncReadyCallback to call when the request is satisfied or %NULL.
+ * @user_data: User data to pass to @callback.
+ *
+ * Asynchronously invokes the <link linkend="gdbus-method-org-neard-Tag.GetRecords">GetRecords()</link> D-Bus method on @proxy.
+ * When the operation is finished, @callback will be invoked in the <link linkend="g-main-context-push-thread-default">thread-default main loop</link> of the thread you are calling this method from.
+ * You can then call neard_tag_call_get_records_finish() to get the result of the operation.
+ *
+ * See neard_tag_call_get_records_sync() for the synchronous, blocking version of this method.
+ */
+void
+neard_tag_call_get_records (
+    NeardTag *proxy,
+    GCancellable *cancellable,
+    GAsyncReadyCallback callback,
+    gpointer user_data)
+{
+  g_dbus_proxy_call (G_DBUS_PROXY (proxy),
+    "GetRecords",
+    g_variant_new ("()"),
+    G_DBUS_CALL_FLAGS_NONE,
+    -1,
+    cancellable,
+    callback,
+    user_data);
+}
+
+/**
+ * neard_tag_call_get_records_finish:
+ * @proxy: A #NeardTagProxy.
+ * @out_records: (out): Return location for return parameter or %NULL to ignore.
+ * @res: The #GAsyncResult obtained from the #GAsyncReadyCallback passed to neard_tag_call_get_records().
+ * @error: Return location for error or %NULL.
+ *
+ * Finishes an operation started with neard_tag_call_get_records().
+ *
+ * Returns: (skip): %TRUE if the call succeded, %FALSE if @error is set.
+ */
+gboolean
+neard_tag_call_get_records_finish (
+    NeardTag *proxy,
+    gchar ***out_records,
+    GAsyncResult *res,
+    GError **error)
+{
+  GVariant *_ret;
+  _ret = g_dbus_proxy_call_finish (G_DBUS_PROXY (proxy), res, error);
+  if (_ret == NULL)
+    goto _out;
+  g_variant_get (_ret,
+                 "(^ao)",
+                 out_records);
+  g_variant_unref (_ret);
+_out:
+  return _ret != NULL;
+}
+
+/**
+ * neard_tag_call_get_records_sync:
+ * @proxy: A #NeardTagProxy.
+ * @out_records: (out): Return location for return parameter or %NULL to ignore.
+ * @cancellable: (allow-none): A #GCancellable or %NULL.
+ * @error: Return location for error or %NULL.
+ *
+ * Synchronously invokes the <link linkend="gdbus-method-org-neard-Tag.GetRecords">GetRecords()</link> D-Bus method on @proxy. The calling thread is blocked until a reply is received.
+ *
+ * See neard_tag_call_get_records() for the asynchronous version of this method.
+ *
+ * Returns: (skip): %TRUE if the call succeded, %FALSE if @error is set.
+ */
+gboolean
+neard_tag_call_get_records_sync (
+    NeardTag *proxy,
+    gchar ***out_records,
+    GCancellable *cancellable,
+    GError **error)
+{
+  GVariant *_ret;
+  _ret = g_dbus_proxy_call_sync (G_DBUS_PROXY (proxy),
+    "GetRecords",
+    g_variant_new ("()"),
+    G_DBUS_CALL_FLAGS_NONE,
+    -1,
+    cancellable,
+    error);
+  if (_ret == NULL)
+    goto _out;
+  g_variant_get (_ret,
+                 "(^ao)",
+                 out_records);
+  g_variant_unref (_ret);
+_out:
+  return _ret != NULL;
+}
+
 /**
  * neard_tag_complete_write:
  * @object: A #NeardTag.
@@ -9530,6 +11168,27 @@ neard_tag_complete_get_raw_ndef (
                    NDEF));
 }
 
+/**
+ * neard_tag_complete_get_records:
+ * @object: A #NeardTag.
+ * @invocation: (transfer full): A #GDBusMethodInvocation.
+ * @records: Parameter to return.
+ *
+ * Helper function used in service implementations to finish handling invocations of the <link linkend="gdbus-method-org-neard-Tag.GetRecords">GetRecords()</link> D-Bus method. If you instead want to finish handling an invocation by returning an error, use g_dbus_method_invocation_return_error() or similar.
+ *
+ * This method will free @invocation, you cannot use it afterwards.
+ */
+void
+neard_tag_complete_get_records (
+    NeardTag *object,
+    GDBusMethodInvocation *invocation,
+    const gchar *const *records)
+{
+  g_dbus_method_invocation_return_value (invocation,
+    g_variant_new ("(^ao)",
+                   records));
+}
+
 /* ------------------------------------------------------------------------ */
 
 /**
@@ -9578,7 +11237,7 @@ neard_tag_proxy_get_property (GObject      *object,
 {
   const _ExtendedGDBusPropertyInfo *info;
   GVariant *variant;
-  g_assert (prop_id != 0 && prop_id - 1 < 13);
+  g_assert (prop_id != 0 && prop_id - 1 < 14);
   info = _neard_tag_property_info_pointers[prop_id - 1];
   variant = g_dbus_proxy_get_cached_property (G_DBUS_PROXY (object), info->parent_struct.name);
   if (info->use_gvariant)
@@ -9625,7 +11284,7 @@ neard_tag_proxy_set_property (GObject      *object,
 {
   const _ExtendedGDBusPropertyInfo *info;
   GVariant *variant;
-  g_assert (prop_id != 0 && prop_id - 1 < 13);
+  g_assert (prop_id != 0 && prop_id - 1 < 14);
   info = _neard_tag_property_info_pointers[prop_id - 1];
   variant = g_dbus_gvalue_to_gvariant (value, G_VARIANT_TYPE (info->parent_struct.signature));
   g_dbus_proxy_call (G_DBUS_PROXY (object),
@@ -9888,6 +11547,19 @@ neard_tag_proxy_get_felica_max_resp_times (NeardTag *object)
   return value;
 }
 
+static GVariant *
+neard_tag_proxy_get_timings (NeardTag *object)
+{
+  NeardTagProxy *proxy = NEARD_TAG_PROXY (object);
+  GVariant *variant;
+  GVariant *value = NULL;
+  variant = g_dbus_proxy_get_cached_property (G_DBUS_PROXY (proxy), "Timings");
+  value = variant;
+  if (variant != NULL)
+    g_variant_unref (variant);
+  return value;
+}
+
 static void
 neard_tag_proxy_init (NeardTagProxy *proxy)
 {
@@ -9938,6 +11610,7 @@ neard_tag_proxy_iface_init (NeardTagIface *iface)
   iface->get_felica_cid = neard_tag_proxy_get_felica_cid;
   iface->get_felica_ic = neard_tag_proxy_get_felica_ic;
   iface->get_felica_max_resp_times = neard_tag_proxy_get_felica_max_resp_times;
+  iface->get_timings = neard_tag_proxy_get_timings;
 }
 
 /**
@@ -10364,7 +12037,7 @@ neard_tag_skeleton_finalize (GObject *object)
 {
   NeardTagSkeleton *skeleton = NEARD_TAG_SKELETON (object);
   guint n;
-  for (n = 0; n < 13; n++)
+  for (n = 0; n < 14; n++)
     g_value_unset (&skeleton->priv->properties[n]);
   g_free (skeleton->priv->properties);
   g_list_free_full (skeleton->priv->changed_properties, (GDestroyNotify) _changed_property_free);
@@ -10382,7 +12055,7 @@ neard_tag_skeleton_get_property (GObject      *object,
   GParamSpec   *pspec G_GNUC_UNUSED)
 {
   NeardTagSkeleton *skeleton = NEARD_TAG_SKELETON (object);
-  g_assert (prop_id != 0 && prop_id - 1 < 13);
+  g_assert (prop_id != 0 && prop_id - 1 < 14);
   g_mutex_lock (&skeleton->priv->lock);
   g_value_copy (&skeleton->priv->properties[prop_id - 1], value);
   g_mutex_unlock (&skeleton->priv->lock);
@@ -10499,7 +12172,7 @@ neard_tag_skeleton_set_property (GObject      *object,
   GParamSpec   *pspec)
 {
   NeardTagSkeleton *skeleton = NEARD_TAG_SKELETON (object);
-  g_assert (prop_id != 0 && prop_id - 1 < 13);
+  g_assert (prop_id != 0 && prop_id - 1 < 14);
   g_mutex_lock (&skeleton->priv->lock);
   g_object_freeze_notify (object);
   if (!_g_value_equal (value, &skeleton->priv->properties[prop_id - 1]))
@@ -10524,7 +12197,7 @@ neard_tag_skeleton_init (NeardTagSkeleton *skeleton)
 
   g_mutex_init (&skeleton->priv->lock);
   skeleton->priv->context = g_main_context_ref_thread_default ();
-  skeleton->priv->properties = g_new0 (GValue, 13);
+  skeleton->priv->properties = g_new0 (GValue, 14);
   g_value_init (&skeleton->priv->properties[0], G_TYPE_STRING);
   g_value_init (&skeleton->priv->properties[1], G_TYPE_STRING);
   g_value_init (&skeleton->priv->properties[2], G_TYPE_STRING);
@@ -10538,6 +12211,7 @@ neard_tag_skeleton_init (NeardTagSkeleton *skeleton)
   g_value_init (&skeleton->priv->properties[10], G_TYPE_VARIANT);
   g_value_init (&skeleton->priv->properties[11], G_TYPE_VARIANT);
   g_value_init (&skeleton->priv->properties[12], G_TYPE_VARIANT);
+  g_value_init (&skeleton->priv->properties[13], G_TYPE_VARIANT);
 }
 
 static const gchar *
@@ -10683,6 +12357,17 @@ neard_tag_skeleton_get_felica_max_resp_times (NeardTag *object)
   return value;
 }
 
+static GVariant *
+neard_tag_skeleton_get_timings (NeardTag *object)
+{
+  NeardTagSkeleton *skeleton = NEARD_TAG_SKELETON (object);
+  GVariant *value;
+  g_mutex_lock (&skeleton->priv->lock);
+  value = g_value_get_variant (&(skeleton->priv->properties[13]));
+  g_mutex_unlock (&skeleton->priv->lock);
+  return value;
+}
+
 static void
 neard_tag_skeleton_class_init (NeardTagSkeletonClass *klass)
 {
@@ -10725,6 +12410,7 @@ neard_tag_skeleton_iface_init (NeardTagIface *iface)
   iface->get_felica_cid = neard_tag_skeleton_get_felica_cid;
   iface->get_felica_ic = neard_tag_skeleton_get_felica_ic;
   iface->get_felica_max_resp_times = neard_tag_skeleton_get_felica_max_resp_times;
+  iface->get_timings = neard_tag_skeleton_get_timings;
 }
 
 /**
@@ -30,15 +30,29 @@ struct _NeardAdapterIface
 
 
 
+  gboolean (*handle_get_tag_snapshot) (
+    NeardAdapter *object,
+    GDBusMethodInvocation *invocation,
+    const gchar *arg_tag);
+
   gboolean (*handle_start_poll_loop) (
     NeardAdapter *object,
     GDBusMethodInvocation *invocation,
     const gchar *arg_name);
 
+  gboolean (*handle_start_provisioning) (
+    NeardAdapter *object,
+    GDBusMethodInvocation *invocation,
+    GVariant *arg_options);
+
   gboolean (*handle_stop_poll_loop) (
     NeardAdapter *object,
     GDBusMethodInvocation *invocation);
 
+  gboolean (*handle_stop_provisioning) (
+    NeardAdapter *object,
+    GDBusMethodInvocation *invocation);
+
   const gchar *const * (*get_devices) (NeardAdapter *object);
 
   const gchar * (*get_mode) (NeardAdapter *object);
@@ -51,12 +65,23 @@ struct _NeardAdapterIface
 
   const gchar *const * (*get_protocols) (NeardAdapter *object);
 
+  GVariant * (*get_statistics) (NeardAdapter *object);
+
   const gchar *const * (*get_tags) (NeardAdapter *object);
 
+  void (*provisioning_result) (
+    NeardAdapter *object,
+    GVariant *arg_result);
+
   void (*tag_found) (
     NeardAdapter *object,
     const gchar *arg_address);
 
+  void (*tag_read) (
+    NeardAdapter *object,
+    const gchar *arg_tag,
+    GVariant *arg_snapshot);
+
   void (*tag_lost) (
     NeardAdapter *object,
     const gchar *arg_address);
@@ -78,6 +103,19 @@ void neard_adapter_complete_stop_poll_loop (
     NeardAdapter *object,
     GDBusMethodInvocation *invocation);
 
+void neard_adapter_complete_start_provisioning (
+    NeardAdapter *object,
+    GDBusMethodInvocation *invocation);
+
+void neard_adapter_complete_stop_provisioning (
+    NeardAdapter *object,
+    GDBusMethodInvocation *invocation);
+
+void neard_adapter_complete_get_tag_snapshot (
+    NeardAdapter *object,
+    GDBusMethodInvocation *invocation,
+    GVariant *snapshot);
+
 
 
 /* D-Bus signal emissions functions: */
@@ -89,6 +127,15 @@ void neard_adapter_emit_tag_lost (
     NeardAdapter *object,
     const gchar *arg_address);
 
+void neard_adapter_emit_provisioning_result (
+    NeardAdapter *object,
+    GVariant *arg_result);
+
+void neard_adapter_emit_tag_read (
+    NeardAdapter *object,
+    const gchar *arg_tag,
+    GVariant *arg_snapshot);
+
 
 
 /* D-Bus method calls: */
@@ -126,6 +173,60 @@ gboolean neard_adapter_call_stop_poll_loop_sync (
     GCancellable *cancellable,
     GError **error);
 
+void neard_adapter_call_start_provisioning (
+    NeardAdapter *proxy,
+    GVariant *arg_options,
+    GCancellable *cancellable,
+    GAsyncReadyCallback callback,
+    gpointer user_data);
+
+gboolean neard_adapter_call_start_provisioning_finish (
+    NeardAdapter *proxy,
+    GAsyncResult *res,
+    GError **error);
+
+gboolean neard_adapter_call_start_provisioning_sync (
+    NeardAdapter *proxy,
+    GVariant *arg_options,
+    GCancellable *cancellable,
+    GError **error);
+
+void neard_adapter_call_stop_provisioning (
+    NeardAdapter *proxy,
+    GCancellable *cancellable,
+    GAsyncReadyCallback callback,
+    gpointer user_data);
+
+gboolean neard_adapter_call_stop_provisioning_finish (
+    NeardAdapter *proxy,
+    GAsyncResult *res,
+    GError **error);
+
+gboolean neard_adapter_call_stop_provisioning_sync (
+    NeardAdapter *proxy,
+    GCancellable *cancellable,
+    GError **error);
+
+void neard_adapter_call_get_tag_snapshot (
+    NeardAdapter *proxy,
+    const gchar *arg_tag,
+    GCancellable *cancellable,
+    GAsyncReadyCallback callback,
+    gpointer user_data);
+
+gboolean neard_adapter_call_get_tag_snapshot_finish (
+    NeardAdapter *proxy,
+    GVariant **out_snapshot,
+    GAsyncResult *res,
+    GError **error);
+
+gboolean neard_adapter_call_get_tag_snapshot_sync (
+    NeardAdapter *proxy,
+    const gchar *arg_tag,
+    GVariant **out_snapshot,
+    GCancellable *cancellable,
+    GError **error);
+
 
 
 /* D-Bus property accessors: */
@@ -155,6 +256,10 @@ const gchar *const *neard_adapter_get_devices (NeardAdapter *object);
 gchar **neard_adapter_dup_devices (NeardAdapter *object);
 void neard_adapter_set_devices (NeardAdapter *object, const gchar *const *value);
 
+GVariant *neard_adapter_get_statistics (NeardAdapter *object);
+GVariant *neard_adapter_dup_statistics (NeardAdapter *object);
+void neard_adapter_set_statistics (NeardAdapter *object, GVariant *value);
+
 
 /* ---- */
 
@@ -666,6 +771,11 @@ struct _NeardManagerIface
     const gchar *arg_path,
     const gchar *arg_type);
 
+  gboolean (*handle_subscribe) (
+    NeardManager *object,
+    GDBusMethodInvocation *invocation,
+    GVariant *arg_filter);
+
   gboolean (*handle_unregister_handover_agent) (
     NeardManager *object,
     GDBusMethodInvocation *invocation,
@@ -678,6 +788,11 @@ struct _NeardManagerIface
     const gchar *arg_path,
     const gchar *arg_type);
 
+  gboolean (*handle_unsubscribe) (
+    NeardManager *object,
+    GDBusMethodInvocation *invocation,
+    guint arg_subscription);
+
   const gchar *const * (*get_adapters) (NeardManager *object);
 
   void (*adapter_added) (
@@ -688,6 +803,17 @@ struct _NeardManagerIface
     NeardManager *object,
     const gchar *arg_adapter);
 
+  void (*tag_matched) (
+    NeardManager *object,
+    guint arg_subscription,
+    const gchar *arg_tag,
+    GVariant *arg_snapshot);
+
+  void (*tag_unmatched) (
+    NeardManager *object,
+    guint arg_subscription,
+    const gchar *arg_tag);
+
   void (*property_changed) (
     NeardManager *object,
     const gchar *arg_name,
@@ -718,6 +844,15 @@ void neard_manager_complete_unregister_ndefagent (
     NeardManager *object,
     GDBusMethodInvocation *invocation);
 
+void neard_manager_complete_subscribe (
+    NeardManager *object,
+    GDBusMethodInvocation *invocation,
+    guint subscription);
+
+void neard_manager_complete_unsubscribe (
+    NeardManager *object,
+    GDBusMethodInvocation *invocation);
+
 
 
 /* D-Bus signal emissions functions: */
@@ -734,6 +869,17 @@ void neard_manager_emit_adapter_removed (
     NeardManager *object,
     const gchar *arg_adapter);
 
+void neard_manager_emit_tag_matched (
+    NeardManager *object,
+    guint arg_subscription,
+    const gchar *arg_tag,
+    GVariant *arg_snapshot);
+
+void neard_manager_emit_tag_unmatched (
+    NeardManager *object,
+    guint arg_subscription,
+    const gchar *arg_tag);
+
 
 
 /* D-Bus method calls: */
@@ -817,6 +963,44 @@ gboolean neard_manager_call_unregister_ndefagent_sync (
     GCancellable *cancellable,
     GError **error);
 
+void neard_manager_call_subscribe (
+    NeardManager *proxy,
+    GVariant *arg_filter,
+    GCancellable *cancellable,
+    GAsyncReadyCallback callback,
+    gpointer user_data);
+
+gboolean neard_manager_call_subscribe_finish (
+    NeardManager *proxy,
+    guint *out_subscription,
+    GAsyncResult *res,
+    GError **error);
+
+gboolean neard_manager_call_subscribe_sync (
+    NeardManager *proxy,
+    GVariant *arg_filter,
+    guint *out_subscription,
+    GCancellable *cancellable,
+    GError **error);
+
+void neard_manager_call_unsubscribe (
+    NeardManager *proxy,
+    guint arg_subscription,
+    GCancellable *cancellable,
+    GAsyncReadyCallback callback,
+    gpointer user_data);
+
+gboolean neard_manager_call_unsubscribe_finish (
+    NeardManager *proxy,
+    GAsyncResult *res,
+    GError **error);
+
+gboolean neard_manager_call_unsubscribe_sync (
+    NeardManager *proxy,
+    guint arg_subscription,
+    GCancellable *cancellable,
+    GError **error);
+
 
 
 /* D-Bus property accessors: */
@@ -1188,6 +1372,10 @@ struct _NeardTagIface
     NeardTag *object,
     GDBusMethodInvocation *invocation);
 
+  gboolean (*handle_get_records) (
+    NeardTag *object,
+    GDBusMethodInvocation *invocation);
+
   gboolean (*handle_write) (
     NeardTag *object,
     GDBusMethodInvocation *invocation,
@@ -1217,6 +1405,8 @@ struct _NeardTagIface
 
   const gchar *const * (*get_records) (NeardTag *object);
 
+  GVariant * (*get_timings) (NeardTag *object);
+
   const gchar * (*get_type_) (NeardTag *object);
 
 };
@@ -1237,6 +1427,11 @@ void neard_tag_complete_get_raw_ndef (
     GDBusMethodInvocation *invocation,
     GVariant *NDEF);
 
+void neard_tag_complete_get_records (
+    NeardTag *object,
+    GDBusMethodInvocation *invocation,
+    const gchar *const *records);
+
 
 
 /* D-Bus method calls: */
@@ -1276,6 +1471,24 @@ gboolean neard_tag_call_get_raw_ndef_sync (
     GCancellable *cancellable,
     GError **error);
 
+void neard_tag_call_get_records (
+    NeardTag *proxy,
+    GCancellable *cancellable,
+    GAsyncReadyCallback callback,
+    gpointer user_data);
+
+gboolean neard_tag_call_get_records_finish (
+    NeardTag *proxy,
+    gchar ***out_records,
+    GAsyncResult *res,
+    GError **error);
+
+gboolean neard_tag_call_get_records_sync (
+    NeardTag *proxy,
+    gchar ***out_records,
+    GCancellable *cancellable,
+    GError **error);
+
 
 
 /* D-Bus property accessors: */
@@ -1330,6 +1543,10 @@ GVariant *neard_tag_get_felica_max_resp_times (NeardTag *object);
 GVariant *neard_tag_dup_felica_max_resp_times (NeardTag *object);
 void neard_tag_set_felica_max_resp_times (NeardTag *object, GVariant *value);
 
+GVariant *neard_tag_get_timings (NeardTag *object);
+GVariant *neard_tag_dup_timings (NeardTag *object);
+void neard_tag_set_timings (NeardTag *object, GVariant *value);
+
 
 /* ---- */
 
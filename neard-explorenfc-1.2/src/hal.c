@@ -15,8 +15,6 @@
 #include "hal.h"
 #include "hal_internal.h"
 
-#include "dbus-parameters.h"
-#include "tag.h"
 
 #include <unistd.h>
 #include <glib.h>
@@ -41,6 +39,19 @@ static const uint8_t   bTo = 8;
 /* Set LRT value to 3. AS LLCP mandates that LRT value to be 3. */
 static const uint8_t   bLrt = 3;
 
+//Dispatches callbacks posted by the HAL in the remote context
+struct hal_impl_cb_source
+{
+	GSource source;
+	hal_impl_t* pHal;
+};
+typedef struct hal_impl_cb_source hal_impl_cb_source_t;
+
+static GSourceFuncs hal_impl_cb_source_funcs;
+
+//The explore board's BAL, reset line and OSAL are process-wide: only one HAL can drive the reader
+static guint hal_impl_rdlib_instances = 0;
+
 //All these commands called from external (main) thread
 hal_t* hal_impl_new()
 {
@@ -48,9 +59,162 @@ hal_t* hal_impl_new()
 
 	pHal->init = FALSE;
 
+	//Use the NXP Reader Library by default
+	pHal->pBackend = &hal_impl_backend_rdlib;
+	pHal->pBackendData = NULL;
+
+	pHal->pCache = NULL;
+
+	//Default presence check schedule
+	for(guint i = 0; i < NFC_TAG_TYPE_COUNT; i++)
+	{
+		pHal->presenceCheck.interval[i] = HAL_TAG_PRESENCE_CHECK_INTERVAL;
+	}
+	pHal->presenceCheck.adaptive = FALSE;
+	pHal->presenceCheck.minInterval = HAL_TAG_PRESENCE_CHECK_MIN_INTERVAL;
+
+	pHal->pollInterval = HAL_POLLING_LOOP_INTERVAL;
+	pHal->maxTags = 1;
+
 	return (hal_t*)pHal;
 }
 
+int hal_impl_use_simulator(hal_t* pHal, const gchar* scriptFile)
+{
+	hal_impl_t* pHalImpl = (hal_impl_t*)pHal;
+
+	if( pHalImpl->init == TRUE )
+	{
+		g_warning("Backend cannot be changed once HAL is initialized");
+		return 1;
+	}
+
+	gpointer pSim = sim_load(scriptFile);
+	if( pSim == NULL )
+	{
+		return 1;
+	}
+
+	pHalImpl->pBackend = &hal_impl_backend_sim;
+	pHalImpl->pBackendData = pSim;
+
+	return 0;
+}
+
+int hal_impl_set_cache(hal_t* pHal, guint size, nfc_cache_validation_t validation)
+{
+	hal_impl_t* pHalImpl = (hal_impl_t*)pHal;
+
+	if( pHalImpl->init == TRUE )
+	{
+		g_warning("Cache cannot be configured once HAL is initialized");
+		return 1;
+	}
+
+	if( pHalImpl->pCache != NULL )
+	{
+		hal_impl_cache_free(pHalImpl->pCache);
+		pHalImpl->pCache = NULL;
+	}
+
+	if( size > 0 )
+	{
+		pHalImpl->pCache = hal_impl_cache_new(size, validation);
+	}
+
+	return 0;
+}
+
+int hal_impl_set_cache_file(hal_t* pHal, const gchar* path, gsize maxSize)
+{
+	hal_impl_t* pHalImpl = (hal_impl_t*)pHal;
+
+	if( pHalImpl->init == TRUE )
+	{
+		g_warning("Cache cannot be configured once HAL is initialized");
+		return 1;
+	}
+
+	if( pHalImpl->pCache == NULL )
+	{
+		g_warning("Cache is disabled, not using cache file %s", path);
+		return 1;
+	}
+
+	if( !hal_impl_cache_attach_file(pHalImpl->pCache, path, maxSize) )
+	{
+		return 1;
+	}
+
+	return 0;
+}
+
+int hal_impl_set_presence_check(hal_t* pHal, const nfc_presence_check_params_t* pParams)
+{
+	hal_impl_t* pHalImpl = (hal_impl_t*)pHal;
+
+	if( pHalImpl->init == TRUE )
+	{
+		g_warning("Presence check cannot be configured once HAL is initialized");
+		return 1;
+	}
+
+	for(guint i = 0; i < NFC_TAG_TYPE_COUNT; i++)
+	{
+		if( pParams->interval[i] == 0 )
+		{
+			g_warning("Presence check interval must not be 0");
+			return 1;
+		}
+	}
+
+	pHalImpl->presenceCheck = *pParams;
+
+	//Checking continuously would starve the command queue
+	if( pHalImpl->presenceCheck.minInterval == 0 )
+	{
+		pHalImpl->presenceCheck.minInterval = 1;
+	}
+
+	return 0;
+}
+
+int hal_impl_set_poll_interval(hal_t* pHal, guint interval)
+{
+	hal_impl_t* pHalImpl = (hal_impl_t*)pHal;
+
+	if( pHalImpl->init == TRUE )
+	{
+		g_warning("Polling interval cannot be configured once HAL is initialized");
+		return 1;
+	}
+
+	pHalImpl->pollInterval = interval;
+
+	return 0;
+}
+
+int hal_impl_set_max_tags(hal_t* pHal, guint maxTags)
+{
+	hal_impl_t* pHalImpl = (hal_impl_t*)pHal;
+
+	if( pHalImpl->init == TRUE )
+	{
+		g_warning("Maximum number of tags cannot be configured once HAL is initialized");
+		return 1;
+	}
+
+	if( (maxTags == 0) || (maxTags > HAL_MAX_TAGS) )
+	{
+		g_warning("Maximum number of tags must be between 1 and %d", HAL_MAX_TAGS);
+		return 1;
+	}
+
+	pHalImpl->maxTags = maxTags;
+
+	return 0;
+}
+
 int hal_impl_init(hal_t* pHal, GMainContext* pGMainContext)
 {
     phStatus_t  status;
@@ -62,13 +226,50 @@ int hal_impl_init(hal_t* pHal, GMainContext* pGMainContext)
     	return 0;
     }
 
+    if( pHalImpl->pBackend == &hal_impl_backend_rdlib )
+    {
+    	if( hal_impl_rdlib_instances > 0 )
+    	{
+    		g_warning("The reader is already driven by another HAL");
+    		return 1;
+    	}
+    	hal_impl_rdlib_instances++;
+    }
+
     pHalImpl->pRemoteMainContext = pGMainContext;
 
     //Take a ref on the remote main context
     g_main_context_ref(pHalImpl->pRemoteMainContext);
 
     //Create queues
-    pHalImpl->pHalQueue = g_async_queue_new();
+    hal_impl_ring_init(&pHalImpl->commands.ring, HAL_CMD_RING_SIZE, sizeof(hal_impl_cmd_info_t));
+    pHalImpl->commands.notifyFd = hal_impl_notifier_new();
+    pHalImpl->commands.urgent = 0;
+    g_mutex_init(&pHalImpl->commands.preemptMutex);
+    pHalImpl->commands.preemptible = FALSE;
+    pHalImpl->commands.preempted = FALSE;
+    memset(pHalImpl->commands.stats, 0, sizeof(pHalImpl->commands.stats));
+    pHalImpl->commands.preemptions = 0;
+
+    hal_impl_ring_init(&pHalImpl->callbacks.hal.ring, HAL_CB_RING_SIZE, sizeof(hal_impl_cb_batch_t));
+    pHalImpl->callbacks.hal.batch.count = 0;
+    pHalImpl->callbacks.hal.batching = FALSE;
+    hal_impl_ring_init(&pHalImpl->callbacks.snep.ring, HAL_CB_RING_SIZE, sizeof(hal_impl_cb_batch_t));
+    pHalImpl->callbacks.snep.batch.count = 0;
+    pHalImpl->callbacks.snep.batching = FALSE;
+    pHalImpl->callbacks.seq = 0;
+    pHalImpl->callbacks.dispatched = 0;
+    pHalImpl->callbacks.latencyTotal = 0;
+    pHalImpl->callbacks.latencyMax = 0;
+    pHalImpl->callbacks.notifyFd = hal_impl_notifier_new();
+
+    //Callbacks are dispatched when the eventfd becomes readable
+    pHalImpl->callbacks.pSource = g_source_new(&hal_impl_cb_source_funcs, sizeof(hal_impl_cb_source_t));
+    ((hal_impl_cb_source_t*)pHalImpl->callbacks.pSource)->pHal = pHalImpl;
+    g_source_add_unix_fd(pHalImpl->callbacks.pSource, pHalImpl->callbacks.notifyFd, G_IO_IN);
+    g_source_set_name(pHalImpl->callbacks.pSource, "NFC HAL callbacks");
+    g_source_attach(pHalImpl->callbacks.pSource, pHalImpl->pRemoteMainContext);
+
     pHalImpl->pSnepQueue = g_async_queue_new();
 
     //Init callbacks
@@ -78,6 +279,7 @@ int hal_impl_init(hal_t* pHal, GMainContext* pGMainContext)
     pHalImpl->adapter.onTagLostCb = NULL;
     pHalImpl->adapter.onDeviceDetectedCb = NULL;
     pHalImpl->adapter.onDeviceLostCb = NULL;
+    pHalImpl->adapter.onProvisioningResultCb = NULL;
     pHalImpl->adapter.pAdapterObject = NULL;
     g_rec_mutex_init(&pHalImpl->adapter.mutex);
 
@@ -91,12 +293,21 @@ int hal_impl_init(hal_t* pHal, GMainContext* pGMainContext)
     pHalImpl->session.currentTagId = 0;
     pHalImpl->session.polling = FALSE;
     pHalImpl->session.tagOrDevicePresent = FALSE;
-
-    pHalImpl->pTagTable = g_hash_table_new(g_direct_hash, g_direct_equal);
-    g_mutex_init(&pHalImpl->tagTableMutex);
-
-    pHalImpl->pDeviceTable = g_hash_table_new(g_direct_hash, g_direct_equal);
-    g_mutex_init(&pHalImpl->deviceTableMutex);
+    pHalImpl->session.pollCycles = 0;
+    pHalImpl->session.lastPollStart = 0;
+    pHalImpl->session.powered = TRUE;
+    pHalImpl->session.tagCount = 0;
+    g_atomic_int_set(&pHalImpl->cpu.valid, FALSE);
+
+    //Init provisioning mode
+    memset(&pHalImpl->provisioning, 0, sizeof(pHalImpl->provisioning));
+    pHalImpl->writes.bytesWritten = 0;
+    pHalImpl->writes.bytesSent = 0;
+    memset(&pHalImpl->lost, 0, sizeof(pHalImpl->lost));
+    memset(&pHalImpl->detection, 0, sizeof(pHalImpl->detection));
+
+    hal_impl_registry_init(&pHalImpl->tags, sizeof(hal_impl_tag_t), hal_impl_tag_clear);
+    hal_impl_registry_init(&pHalImpl->devices, sizeof(hal_impl_device_t), hal_impl_device_clear);
 
     pHalImpl->init = TRUE;
     pHalImpl->joining = FALSE;
@@ -114,21 +325,44 @@ void hal_impl_free(hal_t* pHal)
 
 	if( pHalImpl->init == TRUE )
 	{
-		//Stop polling loop
-	    hal_impl_cmd_info_t* pCmdInfo = g_malloc(sizeof(hal_impl_cmd_info_t));
-	    pCmdInfo->type = HAL_CMD_JOIN;
-		hal_impl_call_cmd(pHalImpl, pCmdInfo);
+		//Stop polling loop, the thread could not be joined if the command was dropped
+	    hal_impl_cmd_info_t cmdInfo;
+	    cmdInfo.type = HAL_CMD_JOIN;
+		while( !hal_impl_call_cmd(pHalImpl, &cmdInfo) )
+		{
+			g_usleep(1000);
+		}
 
 		//Join thread
 		g_thread_join(pHalImpl->pThread); //This dereferences the thread as well
 
+		//Stop dispatching callbacks, pending ones are dropped with the registries
+		g_source_destroy(pHalImpl->callbacks.pSource);
+		g_source_unref(pHalImpl->callbacks.pSource);
+		g_main_context_unref(pHalImpl->pRemoteMainContext);
+
 		//Delete queues
-    	g_async_queue_unref(pHalImpl->pHalQueue);
+		hal_impl_ring_clear(&pHalImpl->commands.ring);
+		hal_impl_notifier_free(pHalImpl->commands.notifyFd);
+		g_mutex_clear(&pHalImpl->commands.preemptMutex);
+		hal_impl_ring_clear(&pHalImpl->callbacks.hal.ring);
+		hal_impl_ring_clear(&pHalImpl->callbacks.snep.ring);
+		hal_impl_notifier_free(pHalImpl->callbacks.notifyFd);
     	g_async_queue_unref(pHalImpl->pSnepQueue);
 
-		//Free tables
-		g_hash_table_destroy(pHalImpl->pTagTable);
-		g_hash_table_destroy(pHalImpl->pDeviceTable);
+		//Free registries
+		hal_impl_registry_clear(&pHalImpl->tags);
+		hal_impl_registry_clear(&pHalImpl->devices);
+
+		if( pHalImpl->pBackend == &hal_impl_backend_rdlib )
+		{
+			hal_impl_rdlib_instances--;
+		}
+	}
+
+	if( pHalImpl->pCache != NULL )
+	{
+		hal_impl_cache_free(pHalImpl->pCache);
 	}
 
 	g_free(pHal);
@@ -141,7 +375,8 @@ void hal_adapter_register(hal_t* pHal, GObject* pAdapterObject,
 		hal_adapter_on_tag_lost_cb_t onTagLostCb,
 		hal_adapter_on_device_detected_cb_t onDeviceDetectedCb,
 		hal_adapter_on_device_ndef_received_cb_t onDeviceNDEFReceivedCb,
-		hal_adapter_on_device_lost_cb_t onDeviceLostCb
+		hal_adapter_on_device_lost_cb_t onDeviceLostCb,
+		hal_adapter_on_provisioning_result_cb_t onProvisioningResultCb
 		)
 {
 	hal_impl_t* pHalImpl = (hal_impl_t*)pHal;
@@ -156,6 +391,7 @@ void hal_adapter_register(hal_t* pHal, GObject* pAdapterObject,
     pHalImpl->adapter.onDeviceDetectedCb = onDeviceDetectedCb;
     pHalImpl->adapter.onDeviceNDEFReceivedCb = onDeviceNDEFReceivedCb;
     pHalImpl->adapter.onDeviceLostCb = onDeviceLostCb;
+    pHalImpl->adapter.onProvisioningResultCb = onProvisioningResultCb;
     pHalImpl->adapter.pAdapterObject = pAdapterObject;
 
     //Get a reference on pAdapterObject
@@ -181,6 +417,7 @@ void hal_adapter_unregister(hal_t* pHal, GObject* pAdapterObject)
     pHalImpl->adapter.onTagLostCb = NULL;
     pHalImpl->adapter.onDeviceDetectedCb = NULL;
     pHalImpl->adapter.onDeviceLostCb = NULL;
+    pHalImpl->adapter.onProvisioningResultCb = NULL;
     pHalImpl->adapter.pAdapterObject = NULL;
 
 	//Release mutex
@@ -191,19 +428,48 @@ void hal_adapter_polling_loop_start(hal_t* pHal, nfc_mode_t mode)
 {
     hal_impl_t* pHalImpl = (hal_impl_t*)pHal;
 
-    hal_impl_cmd_info_t* pCmdInfo = g_malloc(sizeof(hal_impl_cmd_info_t));
-    pCmdInfo->type = HAL_CMD_POLLING_LOOP_START;
-    pCmdInfo->mode = mode;
-	hal_impl_call_cmd(pHalImpl, pCmdInfo);
+    hal_impl_cmd_info_t cmdInfo;
+    cmdInfo.type = HAL_CMD_POLLING_LOOP_START;
+    cmdInfo.mode = mode;
+	hal_impl_call_cmd(pHalImpl, &cmdInfo);
 }
 
 void hal_adapter_polling_loop_stop(hal_t* pHal)
 {
     hal_impl_t* pHalImpl = (hal_impl_t*)pHal;
 
-    hal_impl_cmd_info_t* pCmdInfo = g_malloc(sizeof(hal_impl_cmd_info_t));
-    pCmdInfo->type = HAL_CMD_POLLING_LOOP_STOP;
-	hal_impl_call_cmd(pHalImpl, pCmdInfo);
+    hal_impl_cmd_info_t cmdInfo;
+    cmdInfo.type = HAL_CMD_POLLING_LOOP_STOP;
+	hal_impl_call_cmd(pHalImpl, &cmdInfo);
+}
+
+gboolean hal_adapter_provisioning_start(hal_t* pHal, const nfc_provisioning_params_t* pParams)
+{
+    hal_impl_t* pHalImpl = (hal_impl_t*)pHal;
+
+    hal_impl_cmd_info_t cmdInfo;
+    cmdInfo.type = HAL_CMD_PROVISIONING_START;
+    cmdInfo.provisioning = *pParams;
+	return hal_impl_call_cmd(pHalImpl, &cmdInfo);
+}
+
+void hal_adapter_provisioning_stop(hal_t* pHal)
+{
+    hal_impl_t* pHalImpl = (hal_impl_t*)pHal;
+
+    hal_impl_cmd_info_t cmdInfo;
+    cmdInfo.type = HAL_CMD_PROVISIONING_STOP;
+	hal_impl_call_cmd(pHalImpl, &cmdInfo);
+}
+
+void hal_adapter_set_powered(hal_t* pHal, gboolean powered)
+{
+    hal_impl_t* pHalImpl = (hal_impl_t*)pHal;
+
+    hal_impl_cmd_info_t cmdInfo;
+    cmdInfo.type = HAL_CMD_SET_POWERED;
+    cmdInfo.powered = powered;
+	hal_impl_call_cmd(pHalImpl, &cmdInfo);
 }
 
 nfc_mode_t hal_adapter_get_mode(hal_t* pHal)
@@ -230,17 +496,68 @@ gboolean hal_adapter_is_polling(hal_t* pHal)
 	return polling;
 }
 
+void hal_adapter_get_statistics(hal_t* pHal, nfc_statistics_t* pStatistics)
+{
+	hal_impl_t* pHalImpl = (hal_impl_t*)pHal;
+
+	memset(pStatistics, 0, sizeof(nfc_statistics_t));
+
+	if( pHalImpl->pCache != NULL )
+	{
+		hal_impl_cache_get_statistics(pHalImpl->pCache, pStatistics);
+	}
+
+	//Updated by the main thread, which is the one calling this
+	pStatistics->eventsDispatched = pHalImpl->callbacks.dispatched;
+	pStatistics->eventLatencyTotal = pHalImpl->callbacks.latencyTotal;
+	pStatistics->eventLatencyMax = pHalImpl->callbacks.latencyMax;
+	pStatistics->provisionedTags = pHalImpl->provisioning.provisionedTags;
+	pStatistics->provisioningFailures = pHalImpl->provisioning.failures;
+	pStatistics->bytesWritten = pHalImpl->writes.bytesWritten;
+	pStatistics->bytesSent = pHalImpl->writes.bytesSent;
+	pStatistics->tagsLost = pHalImpl->lost.count;
+	pStatistics->presenceChecks = pHalImpl->lost.checks;
+	pStatistics->lostLatencyTotal = pHalImpl->lost.latencyTotal;
+	pStatistics->lostLatencyMax = pHalImpl->lost.latencyMax;
+	pStatistics->detections = pHalImpl->detection.count;
+	pStatistics->pollCycles = pHalImpl->detection.cycles;
+	pStatistics->detectionLatencyTotal = pHalImpl->detection.latencyTotal;
+	pStatistics->detectionLatencyMax = pHalImpl->detection.latencyMax;
+	for(guint i = 0; i < NFC_COMMAND_COUNT; i++)
+	{
+		pStatistics->commands[i].count = pHalImpl->commands.stats[i].count;
+		pStatistics->commands[i].latencyTotal = pHalImpl->commands.stats[i].latencyTotal;
+		pStatistics->commands[i].latencyMax = pHalImpl->commands.stats[i].latencyMax;
+	}
+	pStatistics->preemptions = pHalImpl->commands.preemptions;
+
+	//The HAL thread's clock can be read from any thread
+	struct timespec cpuTime;
+	if( g_atomic_int_get(&pHalImpl->cpu.valid) && (clock_gettime(pHalImpl->cpu.clock, &cpuTime) == 0) )
+	{
+		pStatistics->cpuTime = (guint64)cpuTime.tv_sec * G_USEC_PER_SEC + cpuTime.tv_nsec / 1000;
+	}
+}
+
 //All these commands called from our own polling loop
 void hal_impl_polling_loop_start(hal_impl_t* pHalImpl, nfc_mode_t mode)
 {
+	if( !pHalImpl->session.powered )
+	{
+		g_warning("Adapter is powered off, not starting polling loop");
+		return;
+	}
+
 	if( !pHalImpl->session.polling && !pHalImpl->session.tagOrDevicePresent )
 	{
 		//Configure polling loop
-		phStatus_t status = rdlib_loop_setup(pHalImpl, mode);
+		phStatus_t status = pHalImpl->pBackend->loop_setup(pHalImpl, mode);
 		if( status == PH_ERR_SUCCESS )
 		{
 			//Start polling loop
 			pHalImpl->session.polling = TRUE;
+			pHalImpl->session.pollCycles = 0;
+			pHalImpl->session.lastPollStart = g_get_monotonic_time();
 
 			//Say we are polling
 			hal_impl_update_polling(pHalImpl, TRUE);
@@ -267,25 +584,56 @@ gboolean hal_impl_polling_loop_iteration_fn(hal_impl_t* pHalImpl)
 {
 	hal_impl_nfc_type_t nfcType;
 
-    //Poll
-	phStatus_t status = rdlib_loop_iteration(pHalImpl, &nfcType);
+    //Poll, unless an urgent command is waiting
+	pHalImpl->session.discoveryStart = g_get_monotonic_time();
+	if( !hal_impl_preemptible_begin(pHalImpl) )
+	{
+		return TRUE;
+	}
+	phStatus_t status = pHalImpl->pBackend->loop_iteration(pHalImpl, &nfcType);
+	pHalImpl->session.discoveryEnd = g_get_monotonic_time();
+	if( hal_impl_preemptible_end(pHalImpl) )
+	{
+		//Run the command first, a tag which was being activated is found again by the next cycle
+		return TRUE;
+	}
+	pHalImpl->session.pollCycles++;
+
+	//Several tags may share the field, a session reads and watches all of them
+	if( (status == PH_ERR_SUCCESS) && HAL_IMPL_NFC_TYPE_IS_TAG(nfcType) && hal_impl_session_enabled(pHalImpl) )
+	{
+		if( hal_impl_session_run(pHalImpl, nfcType) )
+		{
+			return FALSE;
+		}
+		status = PH_ERR_FAILED;
+	}
 
 	if(status == PH_ERR_SUCCESS)
 	{
+		//Detection, polling and mode changes reach the adapter together
+		hal_impl_batch_begin(pHalImpl);
+
 		if( HAL_IMPL_NFC_TYPE_IS_TAG(nfcType) )
 		{
 			//Create tag
 			status = hal_impl_tag_new(pHalImpl, nfcType, &pHalImpl->session.currentTagId);
 
-			//Read NDEF
-			if(status == PH_ERR_SUCCESS)
+			//In provisioning mode the tag is programmed right away and never advertised
+			if( (status == PH_ERR_SUCCESS) && pHalImpl->provisioning.active )
 			{
-				//Try to read tag
-				rdlib_tag_ndef_read(pHalImpl, pHalImpl->session.currentTagId);
+				hal_impl_batch_end(pHalImpl);
+				hal_impl_provisioning_tag(pHalImpl, pHalImpl->session.currentTagId);
+				return FALSE;
 			}
 
 			if(status == PH_ERR_SUCCESS)
 			{
+				hal_impl_tag_read(pHalImpl, pHalImpl->session.currentTagId);
+
+				//Freeze what the main thread will need, so that it does not have to query the tag field by field
+				hal_impl_tag_take_snapshot(pHalImpl, pHalImpl->session.currentTagId);
+
 				//Advertise NFC tag to adapter
 				hal_impl_call_adapter_on_tag_detected(pHalImpl, pHalImpl->session.currentTagId);
 				pHalImpl->session.tagOrDevicePresent = TRUE;
@@ -324,44 +672,30 @@ gboolean hal_impl_polling_loop_iteration_fn(hal_impl_t* pHalImpl)
 				hal_impl_update_mode(pHalImpl, nfc_mode_target);
 			}
 
+			hal_impl_batch_end(pHalImpl);
+
 			if( HAL_IMPL_NFC_TYPE_IS_TAG(nfcType) )
 			{
-				//Check presence every 200ms and wait for command
+				//Check presence on the configured schedule and wait for command
+				hal_impl_tag_presence_begin(pHalImpl, nfcType);
 				do
 				{
-					hal_impl_process_queue(pHalImpl, HAL_TAG_PRESENCE_CHECK_INTERVAL);
-				} while( hal_impl_tag_present_fn(pHalImpl) );
+					hal_impl_process_queue(pHalImpl, pHalImpl->session.presenceInterval);
+				} while( pHalImpl->session.powered && !pHalImpl->joining && hal_impl_tag_present_fn(pHalImpl) );
+
+				//Powered off or shutting down while the tag was in the field
+				if( pHalImpl->session.tagOrDevicePresent )
+				{
+					hal_impl_tag_lost(pHalImpl, g_get_monotonic_time());
+				}
 			}
 			else
 			{
-				if( HAL_IMPL_NFC_DEVICE_TYPE_IS_INITIATOR(nfcType) )
+				//Run the P2P session until the peer leaves or an urgent command comes in
+				if( hal_impl_preemptible_begin(pHalImpl) )
 				{
-		            uint16_t      wGeneralBytesLength;
-		            uint8_t     * pGeneralBytes;
-		            status = phpalI18092mT_Activate(&pHalImpl->rdlib.palI18092mT,
-		            	pHalImpl->rdlib.discLoop.sTargetParams.pRxBuffer,
-		            	pHalImpl->rdlib.discLoop.sTargetParams.wRxBufferLen,
-		            	pHalImpl->rdlib.aAtrRes,
-		            	pHalImpl->rdlib.wAtrResLength,
-		                &pGeneralBytes,
-		                &wGeneralBytesLength
-		                );
-		            CHECK_STATUS(status);
-
-					/* Activate LLCP with the received ATR_RES in target mode. */
-					status = rdlib_llcp_execute(pHalImpl, pGeneralBytes, wGeneralBytesLength, PHLN_LLCP_TARGET);
-					CHECK_STATUS(status);
-				}
-				else
-				{
-					/* Get the ATR_RES length. */
-					uint16_t wGtLength = 0;
-					status = phacDiscLoop_GetConfig(&pHalImpl->rdlib.discLoop, PHAC_DISCLOOP_CONFIG_TYPEF_P2P_ATR_RES_LEN, &wGtLength);
-					CHECK_STATUS(status);
-
-					/* Activate LLCP with the received ATR_RES in initiator mode. */
-					status = rdlib_llcp_execute(pHalImpl, &pHalImpl->rdlib.aAtrRes[PHLN_LLCP_ATR_RES_MIN_LEN], (wGtLength - PHLN_LLCP_ATR_RES_MIN_LEN), PHLN_LLCP_INITIATOR);
-					CHECK_STATUS(status);
+					pHalImpl->pBackend->device_execute(pHalImpl, nfcType);
+					hal_impl_preemptible_end(pHalImpl);
 				}
 
 				hal_impl_device_lost(pHalImpl);
@@ -369,35 +703,172 @@ gboolean hal_impl_polling_loop_iteration_fn(hal_impl_t* pHalImpl)
 
 			return FALSE;
 		}
+
+		hal_impl_batch_end(pHalImpl);
 	}
 
+	//Nothing found, a tag arriving now is found by the next cycle
+	pHalImpl->session.lastPollStart = pHalImpl->session.discoveryStart;
+
 	return TRUE;
 }
 
-gboolean hal_impl_tag_present_fn(hal_impl_t* pHalImpl)
+void hal_impl_polling_loop_idle(hal_impl_t* pHalImpl)
 {
-    //Check tag presence
-	phStatus_t status = rdlib_tag_presence_check(pHalImpl, pHalImpl->session.currentTagId);
-	if(status != PH_ERR_SUCCESS)
+	//No need to keep the field on until the next cycle
+	if( pHalImpl->pBackend->field_off != NULL )
+	{
+		pHalImpl->pBackend->field_off(pHalImpl);
+	}
+
+	//Keep serving commands meanwhile, they may stop polling
+	gint64 next = pHalImpl->session.discoveryStart + (gint64)pHalImpl->pollInterval * 1000;
+	gint64 now = g_get_monotonic_time();
+	while( pHalImpl->session.polling && (now < next) )
+	{
+		hal_impl_process_queue(pHalImpl, (guint32)((next - now + 999) / 1000));
+		now = g_get_monotonic_time();
+	}
+}
+
+void hal_impl_set_powered(hal_impl_t* pHalImpl, gboolean powered)
+{
+	if( pHalImpl->session.powered == powered )
+	{
+		return;
+	}
+
+	pHalImpl->session.powered = powered;
+
+	if( !powered )
 	{
-		//If tag lost
-		//Set tag as disconnected and unref it
-		hal_impl_tag_disconnected(pHalImpl, pHalImpl->session.currentTagId);
-		hal_tag_unref((hal_t*)pHalImpl, pHalImpl->session.currentTagId);
+		//A tag still in the field is dropped by the presence check loop, a P2P session ends with the peer
+		hal_impl_polling_loop_stop(pHalImpl);
+
+		if( pHalImpl->pBackend->field_off != NULL )
+		{
+			pHalImpl->pBackend->field_off(pHalImpl);
+		}
+	}
 
-		hal_impl_update_mode(pHalImpl, nfc_mode_idle);
+	g_info("Adapter powered %s", powered?"on":"off");
+}
+
+void hal_impl_tag_read(hal_impl_t* pHalImpl, guint tagId)
+{
+	//Read NDEF, unless the cache already knows this tag
+	if( hal_impl_cache_lookup(pHalImpl, tagId) )
+	{
+		return;
+	}
+
+	//Try to read tag
+	hal_tag_set_timing((hal_t*)pHalImpl, tagId, nfc_tag_timing_read_start);
+	phStatus_t readStatus = pHalImpl->pBackend->tag_ndef_read(pHalImpl, tagId);
+	hal_tag_set_timing((hal_t*)pHalImpl, tagId, nfc_tag_timing_read_end);
+
+	if( readStatus == PH_ERR_SUCCESS )
+	{
+		hal_impl_cache_store(pHalImpl, tagId);
+	}
+}
+
+void hal_impl_tag_presence_begin(hal_impl_t* pHalImpl, hal_impl_nfc_type_t nfcType)
+{
+	nfc_tag_type_t type;
+	switch(nfcType)
+	{
+	case hal_impl_nfc_tag_type_1:
+		type = nfc_tag_type_1;
+		break;
+	case hal_impl_nfc_tag_type_2:
+		type = nfc_tag_type_2;
+		break;
+	case hal_impl_nfc_tag_type_3:
+		type = nfc_tag_type_3;
+		break;
+	case hal_impl_nfc_tag_type_4a:
+	default:
+		type = nfc_tag_type_4;
+		break;
+	}
+
+	pHalImpl->session.presenceMaxInterval = pHalImpl->presenceCheck.interval[type];
+	if( pHalImpl->presenceCheck.adaptive )
+	{
+		pHalImpl->session.presenceInterval = MIN(pHalImpl->presenceCheck.minInterval, pHalImpl->session.presenceMaxInterval);
+	}
+	else
+	{
+		pHalImpl->session.presenceInterval = pHalImpl->session.presenceMaxInterval;
+	}
+	pHalImpl->session.lastSeen = g_get_monotonic_time();
+	pHalImpl->session.presenceChecks = 0;
+}
 
-		pHalImpl->session.tagOrDevicePresent = FALSE;
+gboolean hal_impl_tag_present_fn(hal_impl_t* pHalImpl)
+{
+    //Check tag presence
+	phStatus_t status = pHalImpl->pBackend->tag_presence_check(pHalImpl, pHalImpl->session.currentTagId);
+	gint64 now = g_get_monotonic_time();
+	pHalImpl->session.presenceChecks++;
 
-		//Callback to adapter
-		hal_impl_call_adapter_on_tag_lost(pHalImpl, pHalImpl->session.currentTagId);
+	if(status == PH_ERR_SUCCESS)
+	{
+		pHalImpl->session.lastSeen = now;
 
+		//Back off while the tag stays put
+		if( pHalImpl->presenceCheck.adaptive )
+		{
+			pHalImpl->session.presenceInterval = MIN(pHalImpl->session.presenceInterval * 2, pHalImpl->session.presenceMaxInterval);
+		}
+	}
+	else
+	{
+		hal_impl_tag_lost(pHalImpl, now);
 		return FALSE;
 	}
 
 	return TRUE;
 }
 
+void hal_impl_tag_lost(hal_impl_t* pHalImpl, gint64 now)
+{
+	//If tag lost
+	//Set tag as disconnected and unref it
+	hal_impl_tag_disconnected(pHalImpl, pHalImpl->session.currentTagId);
+	hal_tag_unref((hal_t*)pHalImpl, pHalImpl->session.currentTagId);
+
+	hal_impl_batch_begin(pHalImpl);
+	hal_impl_update_mode(pHalImpl, nfc_mode_idle);
+
+	pHalImpl->session.tagOrDevicePresent = FALSE;
+
+	//Callback to adapter
+	gint64 latency = hal_impl_tag_lost_latency(pHalImpl, now);
+	g_debug("Tag lost after %" G_GUINT64_FORMAT " presence checks, detected within %" G_GINT64_FORMAT " us",
+			pHalImpl->session.presenceChecks, latency);
+	hal_impl_call_adapter_on_tag_lost(pHalImpl, pHalImpl->session.currentTagId,
+			latency, pHalImpl->session.presenceChecks);
+	hal_impl_batch_end(pHalImpl);
+}
+
+//Time between the tag leaving the field and the presence check noticing it
+//Only the backend may know when it left, otherwise the time since the last successful check is an upper bound
+gint64 hal_impl_tag_lost_latency(hal_impl_t* pHalImpl, gint64 now)
+{
+	if( pHalImpl->pBackend->tag_departure != NULL )
+	{
+		gint64 departure = pHalImpl->pBackend->tag_departure(pHalImpl);
+		if( (departure > 0) && (departure >= pHalImpl->session.lastSeen) && (departure <= now) )
+		{
+			return now - departure;
+		}
+	}
+
+	return now - pHalImpl->session.lastSeen;
+}
+
 
 void hal_impl_device_lost(hal_impl_t* pHal)
 {
@@ -408,18 +879,25 @@ void hal_impl_device_lost(hal_impl_t* pHal)
 	hal_impl_device_disconnected(pHal, pHal->session.currentDeviceId);
 	hal_device_unref((hal_t*)pHal, pHal->session.currentDeviceId);
 
+	hal_impl_batch_begin(pHal);
 	hal_impl_update_mode(pHal, nfc_mode_idle);
 
 	pHal->session.tagOrDevicePresent = FALSE;
 
 	//Callback to adapter
 	hal_impl_call_adapter_on_device_lost(pHal, pHal->session.currentDeviceId);
+	hal_impl_batch_end(pHal);
 }
 
 phStatus_t rdlib_init(hal_impl_t* pHal)
 {
     phStatus_t  status;
 
+	//No tag in the field yet
+	memset(&pHal->rdlib.image, 0, sizeof(pHal->rdlib.image));
+	pHal->rdlib.targetCount = 0;
+	pHal->rdlib.activeIndex = 0;
+
 	/* Set the interface link for the internal chip communication */
 	Set_Interface_Link();
 
@@ -563,6 +1041,7 @@ phStatus_t rdlib_init(hal_impl_t* pHal)
 void rdlib_close(hal_impl_t* pHal)
 {
 	rdlib_snep_close(pHal);
+	rdlib_tag_image_clear(pHal);
 
 	Cleanup_Interrupt();
 	Cleanup_Interface_Link();
@@ -597,12 +1076,15 @@ phStatus_t rdlib_loop_setup(hal_impl_t* pHal, nfc_mode_t pollingMode)
 	        PHAC_DISCLOOP_POS_BIT_MASK_B | PHAC_DISCLOOP_POS_BIT_MASK_F212 | PHAC_DISCLOOP_POS_BIT_MASK_F424));
 	    CHECK_SUCCESS(status);
 
+	    //Resolve as many tags as a session can hold
+	    uint16_t wDeviceLimit = MIN(pHal->maxTags, PHAC_DISCLOOP_CFG_MAX_CARDS_SUPPORTED);
+
 	    /* Passive CON_DEVICE limit for Type A. */
-	    status = phacDiscLoop_SetConfig(psDiscLoop, PHAC_DISCLOOP_CONFIG_TYPEA_DEVICE_LIMIT, 1);
+	    status = phacDiscLoop_SetConfig(psDiscLoop, PHAC_DISCLOOP_CONFIG_TYPEA_DEVICE_LIMIT, wDeviceLimit);
 	    CHECK_SUCCESS(status);
 
 	    /* Passive CON_DEVICE limit for Type F. */
-	    status = phacDiscLoop_SetConfig(psDiscLoop, PHAC_DISCLOOP_CONFIG_TYPEF_DEVICE_LIMIT, 1);
+	    status = phacDiscLoop_SetConfig(psDiscLoop, PHAC_DISCLOOP_CONFIG_TYPEF_DEVICE_LIMIT, wDeviceLimit);
 	    CHECK_SUCCESS(status);
 	}
 	else
@@ -684,6 +1166,118 @@ phStatus_t rdlib_loop_setup(hal_impl_t* pHal, nfc_mode_t pollingMode)
 	return PH_ERR_SUCCESS;
 }
 
+phStatus_t rdlib_device_execute(hal_impl_t* pHal, hal_impl_nfc_type_t nfcType)
+{
+	phStatus_t status;
+
+	if( HAL_IMPL_NFC_DEVICE_TYPE_IS_INITIATOR(nfcType) )
+	{
+		uint16_t      wGeneralBytesLength;
+		uint8_t     * pGeneralBytes;
+		status = phpalI18092mT_Activate(&pHal->rdlib.palI18092mT,
+			pHal->rdlib.discLoop.sTargetParams.pRxBuffer,
+			pHal->rdlib.discLoop.sTargetParams.wRxBufferLen,
+			pHal->rdlib.aAtrRes,
+			pHal->rdlib.wAtrResLength,
+			&pGeneralBytes,
+			&wGeneralBytesLength
+			);
+		CHECK_STATUS(status);
+
+		/* Activate LLCP with the received ATR_RES in target mode. */
+		status = rdlib_llcp_execute(pHal, pGeneralBytes, wGeneralBytesLength, PHLN_LLCP_TARGET);
+		CHECK_STATUS(status);
+	}
+	else
+	{
+		/* Get the ATR_RES length. */
+		uint16_t wGtLength = 0;
+		status = phacDiscLoop_GetConfig(&pHal->rdlib.discLoop, PHAC_DISCLOOP_CONFIG_TYPEF_P2P_ATR_RES_LEN, &wGtLength);
+		CHECK_STATUS(status);
+
+		/* Activate LLCP with the received ATR_RES in initiator mode. */
+		status = rdlib_llcp_execute(pHal, &pHal->rdlib.aAtrRes[PHLN_LLCP_ATR_RES_MIN_LEN], (wGtLength - PHLN_LLCP_ATR_RES_MIN_LEN), PHLN_LLCP_INITIATOR);
+		CHECK_STATUS(status);
+	}
+
+	return status;
+}
+
+//Remember every tag resolved by the discovery loop, before one of them is activated
+static void rdlib_loop_snapshot(hal_impl_t* pHal, uint16_t wTagsDetected)
+{
+	phacDiscLoop_Sw_DataParams_t* psDiscLoop = &pHal->rdlib.discLoop;
+
+	pHal->rdlib.targetCount = 0;
+	pHal->rdlib.activeIndex = 0;
+
+	uint16_t wNumberOfTags = 0;
+	if( phacDiscLoop_GetConfig(psDiscLoop, PHAC_DISCLOOP_CONFIG_NR_TAGS_FOUND, &wNumberOfTags) != PH_ERR_SUCCESS )
+	{
+		return;
+	}
+
+	for(guint i = 0; (i < wNumberOfTags) && (pHal->rdlib.targetCount < HAL_MAX_TAGS); i++)
+	{
+		hal_impl_nfc_target_t* pTarget = &pHal->rdlib.targets[pHal->rdlib.targetCount];
+		pTarget->index = i;
+
+		if( PHAC_DISCLOOP_CHECK_ANDMASK(wTagsDetected, PHAC_DISCLOOP_POS_BIT_MASK_A) )
+		{
+			//Type 1 tags cannot share the field, only Type 2 and Type 4A tags are kept
+			uint8_t bSak = psDiscLoop->sTypeATargetInfo.aTypeA_I3P3[i].aSak;
+			if( psDiscLoop->sTypeATargetInfo.bT1TFlag || ((bSak & (uint8_t) ~0xFB) != 0) )
+			{
+				continue;
+			}
+
+			switch( (bSak & 0x60) >> 5 )
+			{
+			case PHAC_DISCLOOP_TYPEA_TYPE2_TAG_CONFIG_MASK:
+				pTarget->type = hal_impl_nfc_tag_type_2;
+				break;
+			case PHAC_DISCLOOP_TYPEA_TYPE4A_TAG_CONFIG_MASK:
+				pTarget->type = hal_impl_nfc_tag_type_4a;
+				break;
+			default:
+				continue;
+			}
+
+			pTarget->tech = PHAC_DISCLOOP_TECH_TYPE_A;
+			pTarget->uidLength = psDiscLoop->sTypeATargetInfo.aTypeA_I3P3[i].bUidSize;
+			memcpy(pTarget->uid, psDiscLoop->sTypeATargetInfo.aTypeA_I3P3[i].aUid, pTarget->uidLength);
+		}
+		else if( PHAC_DISCLOOP_CHECK_ANDMASK(wTagsDetected, PHAC_DISCLOOP_POS_BIT_MASK_F212) ||
+			PHAC_DISCLOOP_CHECK_ANDMASK(wTagsDetected, PHAC_DISCLOOP_POS_BIT_MASK_F424) )
+		{
+			//Skip P2P devices
+			if( (psDiscLoop->sTypeFTargetInfo.aTypeFTag[i].aIDmPMm[0] == 0x01) &&
+				(psDiscLoop->sTypeFTargetInfo.aTypeFTag[i].aIDmPMm[1] == 0xFE) )
+			{
+				continue;
+			}
+
+			pTarget->type = hal_impl_nfc_tag_type_3;
+			pTarget->tech = PHAC_DISCLOOP_CHECK_ANDMASK(wTagsDetected, PHAC_DISCLOOP_POS_BIT_MASK_F212) ?
+					PHAC_DISCLOOP_TECH_TYPE_F212 : PHAC_DISCLOOP_TECH_TYPE_F424;
+			pTarget->uidLength = 8; //IDm
+			memcpy(pTarget->uid, psDiscLoop->sTypeFTargetInfo.aTypeFTag[i].aIDmPMm, pTarget->uidLength);
+		}
+		else
+		{
+			return;
+		}
+
+		pHal->rdlib.targetCount++;
+	}
+}
+
+guint rdlib_loop_targets(hal_impl_t* pHal, const hal_impl_nfc_target_t** ppTargets)
+{
+	*ppTargets = pHal->rdlib.targets;
+	return pHal->rdlib.targetCount;
+}
+
 static phStatus_t rdlib_loop_helper(hal_impl_t* pHal, hal_impl_nfc_type_t* pNFCType)
 {
     uint8_t bIndex;
@@ -701,6 +1295,12 @@ static phStatus_t rdlib_loop_helper(hal_impl_t* pHal, hal_impl_nfc_type_t* pNFCT
     status = phacDiscLoop_GetConfig(psDiscLoop, PHAC_DISCLOOP_CONFIG_NR_TAGS_FOUND, &wNumberOfTags);
     CHECK_STATUS(status);
 
+    //A single tag was activated right away, no snapshot was taken yet
+    if( pHal->rdlib.targetCount == 0 )
+    {
+    	rdlib_loop_snapshot(pHal, wTagsDetected);
+    }
+
     /* Required if DETECT_ERROR is not set. DETECT_ERROR is required for debugging purpose only */
     PH_UNUSED_VARIABLE(status);
 
@@ -835,6 +1435,14 @@ phStatus_t rdlib_loop_iteration(hal_impl_t* pHal, hal_impl_nfc_type_t* pNFCType)
 
 	while(true)
 	{
+		//An urgent command is waiting, do not go back to listening
+		if( g_atomic_int_get(&pHal->commands.urgent) > 0 )
+		{
+			return PH_ERR_FAILED;
+		}
+
+		pHal->rdlib.targetCount = 0;
+
         /* Set Discovery poll state to detection */
         status = phacDiscLoop_SetConfig(psDiscLoop, PHAC_DISCLOOP_CONFIG_NEXT_POLL_STATE, PHAC_DISCLOOP_POLL_STATE_DETECTION);
         CHECK_STATUS(status);
@@ -915,6 +1523,9 @@ phStatus_t rdlib_loop_iteration(hal_impl_t* pHal, hal_impl_nfc_type_t* pNFCType)
 
 				if(wNumberOfTags > 1)
 				{
+					//The session may activate the other ones later
+					rdlib_loop_snapshot(pHal, wTagsDetected);
+
 					/* Get 1st Detected Technology and Activate device at index 0*/
 					for(int idx = 0; idx < PHAC_DISCLOOP_PASS_POLL_MAX_TECHS_SUPPORTED; idx++)
 					{
@@ -1012,6 +1623,13 @@ phStatus_t rdlib_loop_iteration(hal_impl_t* pHal, hal_impl_nfc_type_t* pNFCType)
         }
         break;
 
+        case PH_ERR_ABORTED:
+        {
+        	//Cut short by rdlib_abort()
+        	return PH_ERR_FAILED;
+        }
+        break;
+
         case PHAC_DISCLOOP_ACTIVATED_BY_PEER:
         {
             memcpy(pHal->rdlib.aAtrRes, poll_res, 10);
@@ -1117,6 +1735,50 @@ phStatus_t rdlib_loop_iteration(hal_impl_t* pHal, hal_impl_nfc_type_t* pNFCType)
 	return PH_ERR_FAILED;
 }
 
+phStatus_t rdlib_field_off(hal_impl_t* pHal)
+{
+	//The next discovery loop run switches it back on
+	return phhalHw_FieldOff(&pHal->rdlib.hal);
+}
+
+void rdlib_abort(hal_impl_t* pHal, gboolean abort)
+{
+	if( abort )
+	{
+		//Makes the HAL's current or next wait for the reader return PH_ERR_ABORTED
+		phhalHw_AsyncAbort(&pHal->rdlib.hal);
+	}
+	else
+	{
+		phOsal_Event_Consume(E_PH_OSAL_EVT_ABORT, E_PH_OSAL_EVT_SRC_LIB);
+	}
+}
+
+//NXP Reader Library backend
+const hal_impl_backend_t hal_impl_backend_rdlib =
+{
+	.name = "NXP Reader Library",
+
+	.init = rdlib_init,
+	.close = rdlib_close,
+
+	.loop_setup = rdlib_loop_setup,
+	.loop_iteration = rdlib_loop_iteration,
+	.field_off = rdlib_field_off,
+	.loop_targets = rdlib_loop_targets,
+	.tag_activate = rdlib_tag_activate,
+
+	.tag_init = rdlib_tag_init,
+	.tag_ndef_read = rdlib_tag_ndef_read,
+	.tag_ndef_write = rdlib_tag_ndef_write,
+	.tag_presence_check = rdlib_tag_presence_check,
+	.tag_lock = rdlib_tag_lock,
+
+	.device_execute = rdlib_device_execute,
+
+	.abort = rdlib_abort,
+};
+
 //These functions will call calbacks to be executed in the GMainContext passed in init()
 
 void hal_impl_update_polling(hal_impl_t* pHal, gboolean polling)
@@ -1144,85 +1806,172 @@ void hal_impl_update_mode(hal_impl_t* pHal, nfc_mode_t mode)
 
 void hal_impl_call_adapter_on_mode_changed(hal_impl_t* pHal, nfc_mode_t mode)
 {
-	hal_impl_cb_info_t* pCbInfo = g_malloc(sizeof(hal_impl_cb_info_t));
-	pCbInfo->pHal = pHal;
-	pCbInfo->type = HAL_CB_MODE_CHANGED;
-	pCbInfo->mode = mode;
-	hal_impl_call_cb(pHal, pCbInfo);
+	hal_impl_cb_info_t cbInfo;
+	cbInfo.pHal = pHal;
+	cbInfo.type = HAL_CB_MODE_CHANGED;
+	cbInfo.mode = mode;
+	hal_impl_call_cb(pHal, &pHal->callbacks.hal, &cbInfo);
 }
 
 void hal_impl_call_adapter_on_polling_changed(hal_impl_t* pHal, gboolean polling)
 {
-	hal_impl_cb_info_t* pCbInfo = g_malloc(sizeof(hal_impl_cb_info_t));
-	pCbInfo->pHal = pHal;
-	pCbInfo->type = HAL_CB_POLLING_CHANGED;
-	pCbInfo->polling = polling;
-	hal_impl_call_cb(pHal, pCbInfo);
+	hal_impl_cb_info_t cbInfo;
+	cbInfo.pHal = pHal;
+	cbInfo.type = HAL_CB_POLLING_CHANGED;
+	cbInfo.polling = polling;
+	hal_impl_call_cb(pHal, &pHal->callbacks.hal, &cbInfo);
 }
 
 void hal_impl_call_adapter_on_tag_detected(hal_impl_t* pHal, guint tagId)
 {
-	hal_impl_cb_info_t* pCbInfo = g_malloc(sizeof(hal_impl_cb_info_t));
-	pCbInfo->pHal = pHal;
-	pCbInfo->type = HAL_CB_TAG_DETECTED;
-	pCbInfo->tagId = tagId;
+	hal_impl_cb_info_t cbInfo;
+	cbInfo.pHal = pHal;
+	cbInfo.type = HAL_CB_TAG_DETECTED;
+	cbInfo.detected.id = tagId;
+	cbInfo.detected.latency = pHal->session.discoveryEnd - pHal->session.lastPollStart;
+	cbInfo.detected.cycles = pHal->session.pollCycles;
 
 	hal_tag_ref((hal_t*)pHal, tagId); //Make sure tag is not deleted before callback is called - see hal_impl_call_main_context
-	hal_impl_call_cb(pHal, pCbInfo);
+	hal_tag_set_timing((hal_t*)pHal, tagId, nfc_tag_timing_posted);
+	hal_impl_call_cb(pHal, &pHal->callbacks.hal, &cbInfo);
 }
 
-void hal_impl_call_adapter_on_tag_lost(hal_impl_t* pHal, guint tagId)
+void hal_impl_call_adapter_on_tag_lost(hal_impl_t* pHal, guint tagId, gint64 latency, guint64 checks)
 {
-	hal_impl_cb_info_t* pCbInfo = g_malloc(sizeof(hal_impl_cb_info_t));
-	pCbInfo->pHal = pHal;
-	pCbInfo->type = HAL_CB_TAG_LOST;
-	pCbInfo->tagId = tagId;
-	hal_impl_call_cb(pHal, pCbInfo);
+	hal_impl_cb_info_t cbInfo;
+	cbInfo.pHal = pHal;
+	cbInfo.type = HAL_CB_TAG_LOST;
+	cbInfo.lost.tagId = tagId;
+	cbInfo.lost.latency = latency;
+	cbInfo.lost.checks = checks;
+	hal_impl_call_cb(pHal, &pHal->callbacks.hal, &cbInfo);
 }
 
 void hal_impl_call_adapter_on_device_detected(hal_impl_t* pHal, guint deviceId)
 {
-	hal_impl_cb_info_t* pCbInfo = g_malloc(sizeof(hal_impl_cb_info_t));
-	pCbInfo->pHal = pHal;
-	pCbInfo->type = HAL_CB_DEVICE_DETECTED;
-	pCbInfo->deviceId = deviceId;
+	hal_impl_cb_info_t cbInfo;
+	cbInfo.pHal = pHal;
+	cbInfo.type = HAL_CB_DEVICE_DETECTED;
+	cbInfo.detected.id = deviceId;
+	cbInfo.detected.latency = pHal->session.discoveryEnd - pHal->session.lastPollStart;
+	cbInfo.detected.cycles = pHal->session.pollCycles;
 
 	hal_device_ref((hal_t*)pHal, deviceId); //Make sure device is not deleted before callback is called - see hal_impl_call_main_context
-	hal_impl_call_cb(pHal, pCbInfo);
+	hal_impl_call_cb(pHal, &pHal->callbacks.hal, &cbInfo);
 }
 
 void hal_impl_call_adapter_on_device_ndef_received(hal_impl_t* pHal, guint deviceId)
 {
-	hal_impl_cb_info_t* pCbInfo = g_malloc(sizeof(hal_impl_cb_info_t));
-	pCbInfo->pHal = pHal;
-	pCbInfo->type = HAL_CB_DEVICE_NDEF_RECEIVED;
-	pCbInfo->deviceId = deviceId;
+	hal_impl_cb_info_t cbInfo;
+	cbInfo.pHal = pHal;
+	cbInfo.type = HAL_CB_DEVICE_NDEF_RECEIVED;
+	cbInfo.deviceId = deviceId;
 
 	hal_device_ref((hal_t*)pHal, deviceId); //Make sure device is not deleted before callback is called - see hal_impl_call_main_context
-	hal_impl_call_cb(pHal, pCbInfo);
+	hal_impl_call_cb(pHal, &pHal->callbacks.snep, &cbInfo);
 }
 
 void hal_impl_call_adapter_on_device_lost(hal_impl_t* pHal, guint deviceId)
 {
-	hal_impl_cb_info_t* pCbInfo = g_malloc(sizeof(hal_impl_cb_info_t));
-	pCbInfo->pHal = pHal;
-	pCbInfo->type = HAL_CB_DEVICE_LOST;
-	pCbInfo->deviceId = deviceId;
-	hal_impl_call_cb(pHal, pCbInfo);
+	hal_impl_cb_info_t cbInfo;
+	cbInfo.pHal = pHal;
+	cbInfo.type = HAL_CB_DEVICE_LOST;
+	cbInfo.deviceId = deviceId;
+	hal_impl_call_cb(pHal, &pHal->callbacks.hal, &cbInfo);
 }
 
-void hal_impl_call_cb(hal_impl_t* pHal, hal_impl_cb_info_t* pCbInfo)
+void hal_impl_call_adapter_on_provisioning_result(hal_impl_t* pHal, const nfc_provisioning_result_t* pResult)
 {
-	g_main_context_invoke(pHal->pRemoteMainContext, hal_impl_call_remote_context, (gpointer)pCbInfo);
+	hal_impl_cb_info_t cbInfo;
+	cbInfo.pHal = pHal;
+	cbInfo.type = HAL_CB_PROVISIONING_RESULT;
+	cbInfo.provisioning = *pResult;
+	hal_impl_call_cb(pHal, &pHal->callbacks.hal, &cbInfo);
 }
 
-//Executed in remote context
-gboolean hal_impl_call_remote_context(gpointer pData)
+void hal_impl_call_tag_write_cb(hal_impl_t* pHal, guint tagId, nfc_tag_write_result_t result, gint64 duration,
+		gsize length, gsize sent, hal_tag_write_cb_t writeCb, gpointer pUserData)
 {
-	hal_impl_cb_info_t* pCbInfo = (hal_impl_cb_info_t*) pData;
-	hal_impl_t* pHal = pCbInfo->pHal;
+	if( writeCb == NULL )
+	{
+		return;
+	}
 
-	g_rec_mutex_lock(&pHal->adapter.mutex); //FIXME useless, impl dependent
+	hal_impl_cb_info_t cbInfo;
+	cbInfo.pHal = pHal;
+	cbInfo.type = HAL_CB_TAG_WRITE_DONE;
+	cbInfo.write.tagId = tagId;
+	cbInfo.write.result = result;
+	cbInfo.write.duration = duration;
+	cbInfo.write.length = length;
+	cbInfo.write.sent = sent;
+	cbInfo.write.cb = writeCb;
+	cbInfo.write.pUserData = pUserData;
+	hal_impl_call_cb(pHal, &pHal->callbacks.hal, &cbInfo);
+}
+
+//Only called from the thread owning pQueue
+static void hal_impl_batch_post(hal_impl_t* pHal, hal_impl_cb_queue_t* pQueue)
+{
+	hal_impl_cb_batch_t* pBatch = &pQueue->batch;
+	if( pBatch->count == 0 )
+	{
+		return;
+	}
+
+	pBatch->seq = (guint)g_atomic_int_add((gint*)&pHal->callbacks.seq, 1);
+	pBatch->postTime = g_get_monotonic_time();
+	while( !hal_impl_ring_push(&pQueue->ring, pBatch) )
+	{
+		//The main loop is lagging behind, wait for it instead of dropping events
+		if( pHal->joining )
+		{
+			g_warning("Callback ring full, dropping %d events", pBatch->count);
+			break;
+		}
+		g_usleep(1000);
+	}
+	pBatch->count = 0;
+
+	hal_impl_notifier_signal(pHal->callbacks.notifyFd);
+}
+
+void hal_impl_batch_begin(hal_impl_t* pHal)
+{
+	pHal->callbacks.hal.batching = TRUE;
+}
+
+void hal_impl_batch_end(hal_impl_t* pHal)
+{
+	pHal->callbacks.hal.batching = FALSE;
+	hal_impl_batch_post(pHal, &pHal->callbacks.hal);
+}
+
+void hal_impl_call_cb(hal_impl_t* pHal, hal_impl_cb_queue_t* pQueue, const hal_impl_cb_info_t* pCbInfo)
+{
+	hal_impl_cb_batch_t* pBatch = &pQueue->batch;
+	pBatch->events[pBatch->count++] = *pCbInfo;
+
+	if( !pQueue->batching || (pBatch->count == HAL_CB_BATCH_SIZE) )
+	{
+		hal_impl_batch_post(pHal, pQueue);
+	}
+}
+
+//Main thread
+static void hal_impl_detection_update(hal_impl_t* pHal, const hal_impl_cb_info_t* pCbInfo)
+{
+	pHal->detection.count++;
+	pHal->detection.cycles += pCbInfo->detected.cycles;
+	pHal->detection.latencyTotal += pCbInfo->detected.latency;
+	if( pCbInfo->detected.latency > pHal->detection.latencyMax )
+	{
+		pHal->detection.latencyMax = pCbInfo->detected.latency;
+	}
+}
+
+static void hal_impl_call_remote_context_event(hal_impl_t* pHal, const hal_impl_cb_info_t* pCbInfo)
+{
 	switch(pCbInfo->type)
 	{
 	case HAL_CB_MODE_CHANGED:
@@ -1240,29 +1989,39 @@ gboolean hal_impl_call_remote_context(gpointer pData)
 		}
 		break;
 	case HAL_CB_TAG_DETECTED:
+		hal_impl_detection_update(pHal, pCbInfo);
+		hal_tag_set_timing((hal_t*)pHal, pCbInfo->detected.id, nfc_tag_timing_dispatched);
 		if( pHal->adapter.onTagDetectedCb != NULL )
 		{
 			pHal->adapter.onTagDetectedCb( (hal_t*)pHal, pHal->adapter.pAdapterObject,
-					pCbInfo->tagId );
+					pCbInfo->detected.id );
 		}
 		//Lose temporary ref
-		hal_tag_unref((hal_t*)pCbInfo->pHal, pCbInfo->tagId);
+		hal_tag_unref((hal_t*)pCbInfo->pHal, pCbInfo->detected.id);
 		break;
 	case HAL_CB_TAG_LOST:
+		pHal->lost.count++;
+		pHal->lost.checks += pCbInfo->lost.checks;
+		pHal->lost.latencyTotal += pCbInfo->lost.latency;
+		if( pCbInfo->lost.latency > pHal->lost.latencyMax )
+		{
+			pHal->lost.latencyMax = pCbInfo->lost.latency;
+		}
 		if( pHal->adapter.onTagLostCb != NULL )
 		{
 			pHal->adapter.onTagLostCb( (hal_t*)pHal, pHal->adapter.pAdapterObject,
-					pCbInfo->tagId );
+					pCbInfo->lost.tagId );
 		}
 		break;
 	case HAL_CB_DEVICE_DETECTED:
+		hal_impl_detection_update(pHal, pCbInfo);
 		if( pHal->adapter.onDeviceDetectedCb != NULL )
 		{
 			pHal->adapter.onDeviceDetectedCb( (hal_t*)pHal, pHal->adapter.pAdapterObject,
-					pCbInfo->deviceId );
+					pCbInfo->detected.id );
 		}
 		//Lose temporary ref
-		hal_device_unref((hal_t*)pCbInfo->pHal, pCbInfo->deviceId);
+		hal_device_unref((hal_t*)pCbInfo->pHal, pCbInfo->detected.id);
 		break;
 	case HAL_CB_DEVICE_NDEF_RECEIVED:
 		if( pHal->adapter.onDeviceNDEFReceivedCb != NULL )
@@ -1280,27 +2039,234 @@ gboolean hal_impl_call_remote_context(gpointer pData)
 					pCbInfo->deviceId );
 		}
 		break;
+	case HAL_CB_TAG_WRITE_DONE:
+		if( pCbInfo->write.result == nfc_tag_write_success )
+		{
+			pHal->writes.bytesWritten += pCbInfo->write.length;
+			pHal->writes.bytesSent += pCbInfo->write.sent;
+		}
+		pCbInfo->write.cb( (hal_t*)pHal, pCbInfo->write.tagId, pCbInfo->write.result,
+				pCbInfo->write.duration, pCbInfo->write.sent, pCbInfo->write.pUserData );
+		break;
+	case HAL_CB_PROVISIONING_RESULT:
+		if( pCbInfo->provisioning.result == nfc_tag_write_success )
+		{
+			pHal->provisioning.provisionedTags++;
+			pHal->writes.bytesWritten += pCbInfo->provisioning.length;
+			pHal->writes.bytesSent += pCbInfo->provisioning.bytesSent;
+		}
+		else
+		{
+			pHal->provisioning.failures++;
+		}
+		if( pHal->adapter.onProvisioningResultCb != NULL )
+		{
+			pHal->adapter.onProvisioningResultCb( (hal_t*)pHal, pHal->adapter.pAdapterObject,
+					&pCbInfo->provisioning );
+		}
+		break;
+	}
+}
+
+//Executed in remote context
+void hal_impl_call_remote_context(hal_impl_t* pHal, const hal_impl_cb_batch_t* pBatch)
+{
+	gint64 latency = g_get_monotonic_time() - pBatch->postTime;
+	pHal->callbacks.dispatched += pBatch->count;
+	pHal->callbacks.latencyTotal += pBatch->count * latency;
+	if( latency > pHal->callbacks.latencyMax )
+	{
+		pHal->callbacks.latencyMax = latency;
+	}
+
+	//All events are applied within this dispatch, so that the D-Bus skeletons
+	//coalesce the resulting property changes into a single PropertiesChanged signal
+	g_rec_mutex_lock(&pHal->adapter.mutex); //FIXME useless, impl dependent
+	for(guint i = 0; i < pBatch->count; i++)
+	{
+		hal_impl_call_remote_context_event(pHal, &pBatch->events[i]);
 	}
 	g_rec_mutex_unlock(&pHal->adapter.mutex);
+}
 
-	g_free(pCbInfo);
-	return FALSE; //Do not want to be called again
+static gboolean hal_impl_cb_source_dispatch(GSource* pSource, GSourceFunc callback, gpointer pUserData)
+{
+	hal_impl_t* pHal = ((hal_impl_cb_source_t*)pSource)->pHal;
+
+	//Consume the notification first, so that a batch pushed while draining wakes us up again
+	hal_impl_notifier_consume(pHal->callbacks.notifyFd);
+
+	//Merge both rings in posting order
+	while(TRUE)
+	{
+		hal_impl_cb_batch_t* pHalBatch = hal_impl_ring_peek(&pHal->callbacks.hal.ring);
+		hal_impl_cb_batch_t* pSnepBatch = hal_impl_ring_peek(&pHal->callbacks.snep.ring);
+
+		hal_impl_ring_t* pRing;
+		hal_impl_cb_batch_t* pBatch;
+		if( (pHalBatch != NULL) && ((pSnepBatch == NULL) || ((gint)(pHalBatch->seq - pSnepBatch->seq) < 0)) )
+		{
+			pRing = &pHal->callbacks.hal.ring;
+			pBatch = pHalBatch;
+		}
+		else if( pSnepBatch != NULL )
+		{
+			pRing = &pHal->callbacks.snep.ring;
+			pBatch = pSnepBatch;
+		}
+		else
+		{
+			break;
+		}
+
+		hal_impl_call_remote_context(pHal, pBatch);
+		hal_impl_ring_drop(pRing);
+	}
+
+	return G_SOURCE_CONTINUE;
 }
 
-void hal_impl_call_cmd(hal_impl_t* pHal, hal_impl_cmd_info_t* pCmdInfo)
+static GSourceFuncs hal_impl_cb_source_funcs =
 {
-	g_async_queue_push(pHal->pHalQueue, (gpointer)pCmdInfo);
+	NULL, //prepare
+	NULL, //check
+	hal_impl_cb_source_dispatch,
+	NULL, //finalize
+};
+
+static hal_impl_cmd_priority_t hal_impl_cmd_priority(gint type)
+{
+	switch(type)
+	{
+	//Nothing to gain from waiting for the end of the current discovery or P2P session
+	case HAL_CMD_POLLING_LOOP_STOP:
+	case HAL_CMD_TAG_NDEF_WRITE:
+	case HAL_CMD_SET_POWERED:
+	case HAL_CMD_JOIN:
+		return hal_impl_cmd_priority_urgent;
+
+	default:
+		return hal_impl_cmd_priority_normal;
+	}
 }
 
-gboolean hal_impl_process_queue(hal_impl_t* pHal, guint32 timeout)
+gboolean hal_impl_call_cmd(hal_impl_t* pHal, const hal_impl_cmd_info_t* pCmdInfo)
 {
-	gpointer pData = g_async_queue_timeout_pop(pHal->pHalQueue, timeout * 1000);
-	if( pData == NULL )
+	hal_impl_cmd_info_t cmdInfo = *pCmdInfo;
+	cmdInfo.postTime = g_get_monotonic_time();
+
+	//Counted before it can be run, so that the HAL thread does not start something it would have to abort
+	gboolean urgent = (hal_impl_cmd_priority(cmdInfo.type) == hal_impl_cmd_priority_urgent);
+	if( urgent )
 	{
+		g_atomic_int_inc(&pHal->commands.urgent);
+	}
+
+	//Only the main thread sends commands
+	if( !hal_impl_ring_push(&pHal->commands.ring, &cmdInfo) )
+	{
+		g_warning("HAL command ring full, dropping command %d", cmdInfo.type);
+		if( urgent )
+		{
+			g_atomic_int_add(&pHal->commands.urgent, -1);
+		}
 		return FALSE;
 	}
+	hal_impl_notifier_signal(pHal->commands.notifyFd);
+
+	if( urgent )
+	{
+		g_mutex_lock(&pHal->commands.preemptMutex);
+		if( pHal->commands.preemptible && !pHal->commands.preempted )
+		{
+			pHal->commands.preempted = TRUE;
+			if( pHal->pBackend->abort != NULL )
+			{
+				pHal->pBackend->abort(pHal, TRUE);
+			}
+		}
+		g_mutex_unlock(&pHal->commands.preemptMutex);
+	}
+	return TRUE;
+}
+
+gboolean hal_impl_preemptible_begin(hal_impl_t* pHal)
+{
+	gboolean begin;
+
+	g_mutex_lock(&pHal->commands.preemptMutex);
+	begin = (g_atomic_int_get(&pHal->commands.urgent) <= 0);
+	pHal->commands.preemptible = begin;
+	pHal->commands.preempted = FALSE;
+	g_mutex_unlock(&pHal->commands.preemptMutex);
+
+	return begin;
+}
+
+gboolean hal_impl_preemptible_end(hal_impl_t* pHal)
+{
+	gboolean preempted;
+
+	g_mutex_lock(&pHal->commands.preemptMutex);
+	preempted = pHal->commands.preempted;
+	pHal->commands.preemptible = FALSE;
+	pHal->commands.preempted = FALSE;
+
+	//The request may have come in after the backend's last wait
+	if( preempted && (pHal->pBackend->abort != NULL) )
+	{
+		pHal->pBackend->abort(pHal, FALSE);
+	}
+	g_mutex_unlock(&pHal->commands.preemptMutex);
+
+	if( preempted )
+	{
+		pHal->commands.preemptions++;
+	}
+
+	return preempted;
+}
+
+gboolean hal_impl_process_queue(hal_impl_t* pHal, guint32 timeout)
+{
+	hal_impl_cmd_info_t cmdInfo;
+
+	gint64 deadline = g_get_monotonic_time() + (gint64)timeout * 1000;
+	while( !hal_impl_ring_pop(&pHal->commands.ring, &cmdInfo) )
+	{
+		gint wait = -1;
+		if( timeout != HAL_QUEUE_WAIT_FOREVER )
+		{
+			gint64 remaining = deadline - g_get_monotonic_time();
+			if( remaining <= 0 )
+			{
+				return FALSE;
+			}
+			wait = (gint)((remaining + 999) / 1000);
+		}
+
+		//Wait for the main thread to push something, then empty the eventfd before checking the ring again
+		if( hal_impl_notifier_wait(pHal->commands.notifyFd, wait) )
+		{
+			hal_impl_notifier_consume(pHal->commands.notifyFd);
+		}
+	}
+
+	hal_impl_cmd_info_t* pCmdInfo = &cmdInfo;
 
-	hal_impl_cmd_info_t* pCmdInfo = (hal_impl_cmd_info_t*) pData;
+	//Time spent in the ring, behind other commands or a discovery run
+	gint64 latency = g_get_monotonic_time() - pCmdInfo->postTime;
+	pHal->commands.stats[pCmdInfo->type].count++;
+	pHal->commands.stats[pCmdInfo->type].latencyTotal += latency;
+	if( latency > pHal->commands.stats[pCmdInfo->type].latencyMax )
+	{
+		pHal->commands.stats[pCmdInfo->type].latencyMax = latency;
+	}
+
+	if( hal_impl_cmd_priority(pCmdInfo->type) == hal_impl_cmd_priority_urgent )
+	{
+		g_atomic_int_add(&pHal->commands.urgent, -1);
+	}
 
 	switch(pCmdInfo->type)
 	{
@@ -1313,16 +2279,28 @@ gboolean hal_impl_process_queue(hal_impl_t* pHal, guint32 timeout)
 		break;
 
 	case HAL_CMD_TAG_NDEF_WRITE:
-		hal_impl_tag_ndef_write(pHal, pCmdInfo->tagId, pCmdInfo->buffer, pCmdInfo->bufferLength);
+		hal_impl_tag_ndef_write(pHal, pCmdInfo);
 		g_free(pCmdInfo->buffer);
 		break;
 
+	case HAL_CMD_PROVISIONING_START:
+		hal_impl_provisioning_start(pHal, &pCmdInfo->provisioning);
+		break;
+
+	case HAL_CMD_PROVISIONING_STOP:
+		hal_impl_provisioning_stop(pHal);
+		break;
+
+	case HAL_CMD_SET_POWERED:
+		hal_impl_set_powered(pHal, pCmdInfo->powered);
+		break;
+
 	case HAL_CMD_JOIN:
 		pHal->joining = TRUE;
+		pHal->session.polling = FALSE;
 		break;
 	}
 
-	g_free(pCmdInfo);
 	return FALSE; //Do not want to be called again
 }
 
@@ -1330,25 +2308,51 @@ gboolean hal_impl_process_queue(hal_impl_t* pHal, guint32 timeout)
 gpointer hal_impl_thread_fn(gpointer param)
 {
 	hal_impl_t* pHal = (hal_impl_t*) param;
-    //Init NXP-RDLIB
-    if( rdlib_init(pHal) != PH_ERR_SUCCESS )
+    //Init backend (NXP-RDLIB or simulator)
+    if( pHal->pBackend->init(pHal) != PH_ERR_SUCCESS )
     {
-    	g_error("Could not init NXPRdLib\n");
+    	g_error("Could not init %s\n", pHal->pBackend->name);
     	return NULL;
     }
 
+    g_info("Using %s backend", pHal->pBackend->name);
+
+    if( (pHal->maxTags > 1) && ((pHal->pBackend->loop_targets == NULL) || (pHal->pBackend->tag_activate == NULL)) )
+    {
+    	g_warning("The %s backend handles one tag at a time", pHal->pBackend->name);
+    }
+
+    //Let the main thread read how much CPU time this thread uses
+    if( pthread_getcpuclockid(pthread_self(), &pHal->cpu.clock) == 0 )
+    {
+    	g_atomic_int_set(&pHal->cpu.valid, TRUE);
+    }
+
 	while(!pHal->joining)
 	{
-		hal_impl_process_queue(pHal, 10000);
-		while(pHal->session.polling)
+		//Nothing to do until told otherwise when powered off
+		hal_impl_process_queue(pHal, pHal->session.powered ? 10000 : HAL_QUEUE_WAIT_FOREVER);
+		while(pHal->session.polling && !pHal->joining)
 		{
-			hal_impl_polling_loop_iteration_fn(pHal);
-			hal_impl_process_queue(pHal, 0);
+			if( hal_impl_polling_loop_iteration_fn(pHal) && (pHal->pollInterval > 0) )
+			{
+				//Duty cycle: field off and sleep until the next cycle
+				hal_impl_polling_loop_idle(pHal);
+			}
+			else
+			{
+				hal_impl_process_queue(pHal, 0);
+			}
 		}
 	}
 
-	//Cleanup rdlib
-	rdlib_close(pHal);
+	g_atomic_int_set(&pHal->cpu.valid, FALSE);
+
+	//Release the provisioning parameters, if any
+	hal_impl_provisioning_stop(pHal);
+
+	//Cleanup backend
+	pHal->pBackend->close(pHal);
 
 	return NULL;
 }
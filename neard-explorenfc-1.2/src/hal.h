@@ -16,6 +16,11 @@
  */
 /** \defgroup HalGp HAL
  * Implementation of NFC routines using the NXPRdLib
+ *
+ * Built with ndef.c as libexplorenfc (pkg-config libexplorenfc), which applications can link
+ * to drive the reader themselves and get tag events without D-Bus: create a HAL, call
+ * hal_impl_init() with their main context and hal_adapter_register() with their callbacks.
+ * The daemon is not to be run at the same time.
  *  @{
  */
 
@@ -23,7 +28,9 @@
 #define HAL_H_
 
 #include <glib.h>
-#include "tag.h"
+#include <glib-object.h>
+
+#include "explorenfc-export.h"
 
 typedef gpointer hal_t;
 
@@ -39,25 +46,164 @@ enum nfc_mode
 };
 typedef enum nfc_mode nfc_mode_t; ///< NFC Mode
 
+/** NDEF cache validation
+ * What must match for a cached NDEF message to be used instead of reading the tag
+ */
+enum nfc_cache_validation
+{
+	nfc_cache_validation_uid, ///< UID only
+	nfc_cache_validation_length, ///< UID and NDEF message length
+	nfc_cache_validation_header, ///< UID, NDEF message length and tag header (capability container or attribute information block)
+};
+typedef enum nfc_cache_validation nfc_cache_validation_t; ///< NDEF cache validation
+
+/** Commands run by the HAL thread, as counted in the statistics
+ *
+ */
+enum nfc_command
+{
+	nfc_command_polling_loop_start, ///< Start polling loop
+	nfc_command_polling_loop_stop, ///< Stop polling loop
+	nfc_command_tag_write, ///< Write NDEF message to a tag
+	nfc_command_provisioning_start, ///< Start provisioning mode
+	nfc_command_provisioning_stop, ///< Stop provisioning mode
+	nfc_command_set_powered, ///< Power the adapter on or off
+};
+typedef enum nfc_command nfc_command_t; ///< HAL command
+
+#define NFC_COMMAND_COUNT 6 ///< Number of HAL commands (see nfc_command_t)
+
+/** Command statistics
+ *
+ */
+struct nfc_command_statistics
+{
+	guint64 count; ///< Number of commands run
+	guint64 latencyTotal; ///< Sum of the delays between issuing and running these commands, in microseconds
+	guint64 latencyMax; ///< Longest delay between issuing and running one of these commands, in microseconds
+};
+typedef struct nfc_command_statistics nfc_command_statistics_t; ///< Command statistics
+
+/** Adapter statistics
+ *
+ */
+struct nfc_statistics
+{
+	guint64 cacheHits; ///< Number of NDEF reads skipped thanks to the cache
+	guint64 cacheMisses; ///< Number of NDEF reads not found in the cache
+	guint64 cacheEvictions; ///< Number of cache entries evicted to make room
+	guint cacheEntries; ///< Number of cache entries
+	guint64 eventsDispatched; ///< Number of HAL events delivered to the main loop
+	guint64 eventLatencyTotal; ///< Sum of the delays between posting and dispatching events, in microseconds
+	guint64 eventLatencyMax; ///< Longest delay between posting and dispatching an event, in microseconds
+	guint64 provisionedTags; ///< Number of tags successfully programmed in provisioning mode
+	guint64 provisioningFailures; ///< Number of tags which could not be programmed in provisioning mode
+	guint64 bytesWritten; ///< Size of the NDEF messages successfully written
+	guint64 bytesSent; ///< Bytes actually sent over RF for these messages, only changed pages or blocks are rewritten
+	guint64 tagsLost; ///< Number of tags which left the field
+	guint64 presenceChecks; ///< Number of presence checks run on these tags
+	guint64 lostLatencyTotal; ///< Sum of the tag lost detection latencies, in microseconds: since the tag actually left with the simulated reader, since the last successful check (an upper bound) otherwise
+	guint64 lostLatencyMax; ///< Longest tag lost detection latency, in microseconds
+	guint64 detections; ///< Number of tags and devices detected
+	guint64 pollCycles; ///< Polling cycles run before these detections
+	guint64 detectionLatencyTotal; ///< Sum of the detection latencies (time since the start of the previous, unsuccessful polling cycle), in microseconds
+	guint64 detectionLatencyMax; ///< Longest detection latency, in microseconds
+	guint64 cpuTime; ///< CPU time used by the HAL thread, in microseconds
+	nfc_command_statistics_t commands[NFC_COMMAND_COUNT]; ///< Per command (indexed by nfc_command_t)
+	guint64 preemptions; ///< Number of discovery runs or P2P sessions cut short by urgent commands
+};
+typedef struct nfc_statistics nfc_statistics_t; ///< Adapter statistics
+
+#define NFC_TAG_TYPE_COUNT 4 ///< Number of tag types (see nfc_tag_type_t)
+
+/** Presence check schedule
+ * While a tag is in the field, its presence is checked every interval; in adaptive mode
+ * checks start at minInterval after detection and the interval doubles after each
+ * successful check, up to the tag type's interval
+ */
+struct nfc_presence_check_params
+{
+	guint interval[NFC_TAG_TYPE_COUNT]; ///< Interval per tag type (indexed by nfc_tag_type_t), in milliseconds
+	gboolean adaptive; ///< Start fast and back off while the tag stays in the field
+	guint minInterval; ///< Interval right after detection in adaptive mode, in milliseconds
+};
+typedef struct nfc_presence_check_params nfc_presence_check_params_t; ///< Presence check schedule
+
 /** \name Main functions
  */
 ///\{
 /** Instantiate HAL
  * \return hal_t instance
  */
-hal_t* hal_impl_new();
+EXPLORENFC_API hal_t* hal_impl_new();
 
 /** Initialize HAL
+ * Only one HAL at a time can use the NXP Reader Library, as the board's reader is process-wide
  * \param pHal hal_t instance
  * \param pGMainContext MainContext in which callbacks will be invoked
  * \return 0 on success, 1 on failure
  */
-int hal_impl_init(hal_t* pHal, GMainContext* pGMainContext);
+EXPLORENFC_API int hal_impl_init(hal_t* pHal, GMainContext* pGMainContext);
 
 /** Free HAL
  * \param pHal hal_t instance to free
  */
-void hal_impl_free(hal_t* pHal);
+EXPLORENFC_API void hal_impl_free(hal_t* pHal);
+
+/** Use the simulated reader instead of the NXP Reader Library
+ * Must be called before hal_impl_init()
+ * \param pHal hal_t instance
+ * \param scriptFile script describing the simulated tags
+ * \return 0 on success, 1 on failure
+ */
+EXPLORENFC_API int hal_impl_use_simulator(hal_t* pHal, const gchar* scriptFile);
+
+/** Configure the NDEF cache
+ * Must be called before hal_impl_init()
+ * \param pHal hal_t instance
+ * \param size maximum number of tags kept in the cache (0 to disable it)
+ * \param validation what must match for a cached message to be used
+ * \return 0 on success, 1 on failure
+ */
+EXPLORENFC_API int hal_impl_set_cache(hal_t* pHal, guint size, nfc_cache_validation_t validation);
+
+/** Keep the NDEF cache in a file so that it survives restarts
+ * Must be called after hal_impl_set_cache() and before hal_impl_init()
+ * \param pHal hal_t instance
+ * \param path cache file, created if needed
+ * \param maxSize size of the file in bytes; it is compacted once full
+ * \return 0 on success, 1 on failure
+ */
+EXPLORENFC_API int hal_impl_set_cache_file(hal_t* pHal, const gchar* path, gsize maxSize);
+
+/** Configure how often the tag in the field is checked for presence
+ * Must be called before hal_impl_init()
+ * \param pHal hal_t instance
+ * \param pParams presence check schedule, copied
+ * \return 0 on success, 1 on failure
+ */
+EXPLORENFC_API int hal_impl_set_presence_check(hal_t* pHal, const nfc_presence_check_params_t* pParams);
+
+/** Duty-cycle the polling loop
+ * When nothing is found, the RF field is switched off and the HAL thread sleeps
+ * until interval milliseconds after the start of the polling cycle
+ * Must be called before hal_impl_init()
+ * \param pHal hal_t instance
+ * \param interval time between the start of two polling cycles in milliseconds, 0 to poll back-to-back
+ * 
+eturn 0 on success, 1 on failure
+ */
+EXPLORENFC_API int hal_impl_set_poll_interval(hal_t* pHal, guint interval);
+
+/** Handle several tags in the field at once
+ * All tags of the same technology found by the polling loop are read and advertised,
+ * then followed until the last one leaves; provisioning mode still programs one tag at a time
+ * Must be called before hal_impl_init()
+ * \param pHal hal_t instance
+ * \param maxTags maximum number of tags, 1 (the default) to only handle one
+ * \return 0 on success, 1 on failure
+ */
+EXPLORENFC_API int hal_impl_set_max_tags(hal_t* pHal, guint maxTags);
 ///\}
 
 
@@ -115,11 +261,20 @@ typedef void (*hal_adapter_on_device_ndef_received_cb_t)(hal_t* pHal, GObject* p
  */
 typedef void (*hal_adapter_on_device_lost_cb_t)(hal_t* pHal, GObject* pAdapterObject, guint deviceId);
 
+typedef struct nfc_provisioning_result nfc_provisioning_result_t; ///< Outcome of programming one tag in provisioning mode
+
+/** On tag provisioned callback
+ * \param pHal hal_t instance
+ * \param pAdapterObject GObject passed in hal_adapter_register()
+ * \param pResult outcome of programming the tag, only valid during the call
+ */
+typedef void (*hal_adapter_on_provisioning_result_cb_t)(hal_t* pHal, GObject* pAdapterObject, const nfc_provisioning_result_t* pResult);
+
 
 /** Register callbacks
- * Callbacks will be called from pGMainContext passed in init()
+ * Callbacks will be called from pGMainContext passed in init(), any of them may be NULL
  * \param pHal hal_t instance
- * \param pAdapterObject GObject instance
+ * \param pAdapterObject GObject instance passed back to callbacks
  * \param onModeChangedCb mode changed callback
  * \param onPollingChangedCb polling changed callback
  * \param onTagDetectedCb tag detected callback
@@ -127,17 +282,19 @@ typedef void (*hal_adapter_on_device_lost_cb_t)(hal_t* pHal, GObject* pAdapterOb
  * \param onDeviceDetectedCb mode changed callback
  * \param onDeviceNDEFReceivedCb mode changed callback
  * \param onDeviceLostCb mode changed callback
+ * \param onProvisioningResultCb tag provisioned callback
  */
-void hal_adapter_register(hal_t* pHal, GObject* pAdapterObject,
+EXPLORENFC_API void hal_adapter_register(hal_t* pHal, GObject* pAdapterObject,
 		hal_adapter_on_mode_changed_cb_t onModeChangedCb,
 		hal_adapter_on_polling_changed_cb_t onPollingChangedCb,
 		hal_adapter_on_tag_detected_cb_t onTagDetectedCb,
 		hal_adapter_on_tag_lost_cb_t onTagLostCb,
 		hal_adapter_on_device_detected_cb_t onDeviceDetectedCb,
 		hal_adapter_on_device_ndef_received_cb_t onDeviceNDEFReceivedCb,
-		hal_adapter_on_device_lost_cb_t onDeviceLostCb
+		hal_adapter_on_device_lost_cb_t onDeviceLostCb,
+		hal_adapter_on_provisioning_result_cb_t onProvisioningResultCb
 		);
-void hal_adapter_unregister(hal_t* pHal, GObject* pAdapterObject);
+EXPLORENFC_API void hal_adapter_unregister(hal_t* pHal, GObject* pAdapterObject);
 ///\}
 
 /** \name Adapters
@@ -147,24 +304,38 @@ void hal_adapter_unregister(hal_t* pHal, GObject* pAdapterObject);
  * \param pHal hal_t instance
  * \param mode polling mode
  */
-void hal_adapter_polling_loop_start(hal_t* pHal, nfc_mode_t mode);
+EXPLORENFC_API void hal_adapter_polling_loop_start(hal_t* pHal, nfc_mode_t mode);
 
 /** Stop polling loop
  * \param pHal hal_t instance
  */
-void hal_adapter_polling_loop_stop(hal_t* pHal);
+EXPLORENFC_API void hal_adapter_polling_loop_stop(hal_t* pHal);
+
+/** Power the adapter on or off
+ * Powering off stops the polling loop, switches the RF field off and leaves the HAL thread
+ * waiting for commands; the polling loop cannot be started until the adapter is powered on again
+ * \param pHal hal_t instance
+ * \param powered TRUE to power on, FALSE to power off
+ */
+EXPLORENFC_API void hal_adapter_set_powered(hal_t* pHal, gboolean powered);
 
 /** Get current mode
  * \param pHal hal_t instance
  * \return current mode
  */
-nfc_mode_t hal_adapter_get_mode(hal_t* pHal);
+EXPLORENFC_API nfc_mode_t hal_adapter_get_mode(hal_t* pHal);
 
 /** Get whether polling is active
  * \param pHal hal_t instance
  * \return TRUE if polling is active, FALSE otherwise
  */
-gboolean hal_adapter_is_polling(hal_t* pHal);
+EXPLORENFC_API gboolean hal_adapter_is_polling(hal_t* pHal);
+
+/** Get statistics
+ * \param pHal hal_t instance
+ * \param pStatistics will return statistics
+ */
+EXPLORENFC_API void hal_adapter_get_statistics(hal_t* pHal, nfc_statistics_t* pStatistics);
 ///\}
 
 
@@ -184,61 +355,136 @@ enum nfc_tag_type
 };
 typedef enum nfc_tag_type nfc_tag_type_t; ///< Tag type
 
+/** Tap processing stage
+ * Each stage is timestamped (CLOCK_MONOTONIC, in microseconds) when a tag is processed
+ */
+enum nfc_tag_timing
+{
+	nfc_tag_timing_discovery_start, ///< Polling loop iteration which found the tag started
+	nfc_tag_timing_discovery_end, ///< Tag activated by the discovery loop
+	nfc_tag_timing_check_start, ///< NDEF check started
+	nfc_tag_timing_check_end, ///< NDEF check done
+	nfc_tag_timing_read_start, ///< NDEF read started
+	nfc_tag_timing_read_end, ///< NDEF read done
+	nfc_tag_timing_posted, ///< Detection posted to the main context
+	nfc_tag_timing_dispatched, ///< Detection dispatched in the main context
+	nfc_tag_timing_populate_start, ///< Records population started
+	nfc_tag_timing_populate_end, ///< Records population done
+	nfc_tag_timing_exported, ///< Tag object exported on D-Bus
+	nfc_tag_timing_write_start, ///< Last NDEF write started
+	nfc_tag_timing_write_end, ///< Last NDEF write done
+	nfc_tag_timing_verify_end, ///< Last NDEF write read back
+	nfc_tag_timing_count, ///< Number of stages
+};
+typedef enum nfc_tag_timing nfc_tag_timing_t; ///< Tap processing stage
+
+/** Outcome of an NDEF write
+ *
+ */
+enum nfc_tag_write_result
+{
+	nfc_tag_write_success, ///< Message written (and read back identical if verification was requested)
+	nfc_tag_write_not_connected, ///< Tag left the field before it could be written
+	nfc_tag_write_read_only, ///< Tag is read only
+	nfc_tag_write_failed, ///< Tag rejected the message
+	nfc_tag_write_verify_failed, ///< Message read back differs from the one written
+	nfc_tag_write_busy, ///< Too many commands pending in the HAL
+	nfc_tag_write_lock_failed, ///< Message written but the tag could not be made read only
+};
+typedef enum nfc_tag_write_result nfc_tag_write_result_t; ///< Outcome of an NDEF write
+
+/** Called in the main context once an NDEF write is done
+ * \param pHal hal_t instance
+ * \param tagId id of tag
+ * \param result outcome of the write
+ * \param duration time spent writing (and verifying) the tag, in microseconds
+ * \param bytesSent number of bytes actually sent over RF to update the tag
+ * \param pUserData user data passed to hal_tag_write_ndef()
+ */
+typedef void (*hal_tag_write_cb_t)(hal_t* pHal, guint tagId, nfc_tag_write_result_t result, gint64 duration,
+		gsize bytesSent, gpointer pUserData);
+
+/** Tag snapshot
+ * Immutable copy of a tag's properties and NDEF message, taken by the HAL once the tag has been read
+ */
+struct nfc_tag_snapshot
+{
+	guint tagId; ///< Id of tag
+	nfc_tag_type_t type; ///< Tag type
+	gboolean readOnly; ///< TRUE if tag is read-only
+	gboolean iso14443a; ///< TRUE if tag is ISO14443A-compliant, in which case the following fields are valid
+	guint8 atqa[2]; ///< ATQA
+	guint8 sak; ///< SAK
+	guint8 uid[10]; ///< UID
+	gsize uidLength; ///< UID's length
+	gboolean felica; ///< TRUE if tag is Felica-compliant, in which case the following fields are valid
+	guint8 manufacturer[2]; ///< Manufacturer information field
+	guint8 cid[6]; ///< Card ID
+	guint8 ic[2]; ///< Card IC code
+	guint8 maxRespTimes[6]; ///< Card maximum response times
+	GBytes* pNdef; ///< NDEF message (or NULL), shared with the HAL: must not be unreferenced
+};
+typedef struct nfc_tag_snapshot nfc_tag_snapshot_t; ///< Tag snapshot
+
 /** Increase reference count for tag
  * \param pHal hal_t instance
  * \param tagId id of tag
  */
-void hal_tag_ref(hal_t* pHal, guint tagId);
+EXPLORENFC_API void hal_tag_ref(hal_t* pHal, guint tagId);
 
 /** Decrease reference count for tag (and free if it reaches 0)
  * \param pHal hal_t instance
  * \param tagId id of tag
  */
-void hal_tag_unref(hal_t* pHal, guint tagId);
+EXPLORENFC_API void hal_tag_unref(hal_t* pHal, guint tagId);
 
 /** Get tag type
  * \param pHal hal_t instance
  * \param tagId id of tag
  * \return tag type
  */
-nfc_tag_type_t hal_tag_get_type(hal_t* pHal, guint tagId);
+EXPLORENFC_API nfc_tag_type_t hal_tag_get_type(hal_t* pHal, guint tagId);
 
 /** Check if tag is connected
  * \param pHal hal_t instance
  * \param tagId id of tag
  * \return TRUE if tag is connected, FALSE otherwise
  */
-gboolean hal_tag_is_connected(hal_t* pHal, guint tagId);
+EXPLORENFC_API gboolean hal_tag_is_connected(hal_t* pHal, guint tagId);
 
 /** Get NDEF message from tag
  * \param pHal hal_t instance
  * \param tagId id of tag
- * \param pBuffer will return buffer (or NULL)
- * \param pBufferLength will return buffer's length
+ * \return new reference to NDEF message (or NULL), release with g_bytes_unref()
  */
-void hal_tag_get_ndef(hal_t* pHal, guint tagId, guint8** pBuffer, gsize* pBufferLength);
+EXPLORENFC_API GBytes* hal_tag_get_ndef(hal_t* pHal, guint tagId);
 
 /** Write NDEF message to tag
+ * The write happens asynchronously in the HAL thread
  * \param pHal hal_t instance
  * \param tagId id of tag
  * \param buffer buffer to write
  * \param bufferLength buffer's length
+ * \param verify read the message back in the same RF session and compare it
+ * \param writeCb callback called once done (or NULL)
+ * \param pUserData user data passed to writeCb
  */
-void hal_tag_write_ndef(hal_t* pHal, guint tagId, guint8* buffer, gsize bufferLength);
+EXPLORENFC_API void hal_tag_write_ndef(hal_t* pHal, guint tagId, guint8* buffer, gsize bufferLength,
+		gboolean verify, hal_tag_write_cb_t writeCb, gpointer pUserData);
 
 /** Check whether the tag can be written
  * \param pHal hal_t instance
  * \param tagId id of tag
  * \return TRUE if tag is read-only, FALSE otherwise
  */
-gboolean hal_tag_is_readonly(hal_t* pHal, guint tagId);
+EXPLORENFC_API gboolean hal_tag_is_readonly(hal_t* pHal, guint tagId);
 
 /** Check whether the tag is ISO14443A-compliant
  * \param pHal hal_t instance
  * \param tagId id of tag
  * \return TRUE if tag is ISO14443A compliant, FALSE otherwise
  */
-gboolean hal_tag_is_iso14443a(hal_t* pHal, guint tagId);
+EXPLORENFC_API gboolean hal_tag_is_iso14443a(hal_t* pHal, guint tagId);
 
 /** Get ISO14443A-specific parameters for tag
  * \param pHal hal_t instance
@@ -248,14 +494,14 @@ gboolean hal_tag_is_iso14443a(hal_t* pHal, guint tagId);
  * \param uid buffer to store uid (max 10 bytes long)
  * \param pUidLength uid's length
  */
-void hal_tag_get_iso14443a_params(hal_t* pHal, guint tagId, guint8* atqa, guint8* sak, guint8* uid, gsize* pUidLength);
+EXPLORENFC_API void hal_tag_get_iso14443a_params(hal_t* pHal, guint tagId, guint8* atqa, guint8* sak, guint8* uid, gsize* pUidLength);
 
 /** Check whether the tag is Felica-compliant
  * \param pHal hal_t instance
  * \param tagId id of tag
  * \return TRUE if tag is Felica compliant, FALSE otherwise
  */
-gboolean hal_tag_is_felica(hal_t* pHal, guint tagId);
+EXPLORENFC_API gboolean hal_tag_is_felica(hal_t* pHal, guint tagId);
 
 /** Get Felica-specific parameters for tag
  * \param pHal hal_t instance
@@ -264,10 +510,105 @@ gboolean hal_tag_is_felica(hal_t* pHal, guint tagId);
  * \param ic card IC code (2 bytes long)
  * \param maxRespTimes card maximum response times (6 bytes long)
  */
-void hal_tag_get_felica_params(hal_t* pHal, guint tagId, guint8* manufacturer, guint8* cid, guint8* ic, guint8* maxRespTimes);
+EXPLORENFC_API void hal_tag_get_felica_params(hal_t* pHal, guint tagId, guint8* manufacturer, guint8* cid, guint8* ic, guint8* maxRespTimes);
+
+/** Timestamp a processing stage for tag with the current time
+ * \param pHal hal_t instance
+ * \param tagId id of tag
+ * \param timing stage to timestamp
+ */
+EXPLORENFC_API void hal_tag_set_timing(hal_t* pHal, guint tagId, nfc_tag_timing_t timing);
+
+/** Get the timestamp of a processing stage for tag
+ * \param pHal hal_t instance
+ * \param tagId id of tag
+ * \param timing stage
+ * \return CLOCK_MONOTONIC timestamp in microseconds, or 0 if the stage was not reached
+ */
+EXPLORENFC_API gint64 hal_tag_get_timing(hal_t* pHal, guint tagId, nfc_tag_timing_t timing);
+
+/** Get a snapshot of tag
+ * All the tag's properties in a single call, without any further lookup
+ * \param pHal hal_t instance
+ * \param tagId id of tag
+ * \return snapshot, release with hal_tag_snapshot_unref()
+ */
+EXPLORENFC_API const nfc_tag_snapshot_t* hal_tag_get_snapshot(hal_t* pHal, guint tagId);
+
+/** Increase reference count for tag snapshot
+ * \param pSnapshot snapshot
+ * \return pSnapshot
+ */
+EXPLORENFC_API const nfc_tag_snapshot_t* hal_tag_snapshot_ref(const nfc_tag_snapshot_t* pSnapshot);
+
+/** Decrease reference count for tag snapshot (and free if it reaches 0)
+ * \param pSnapshot snapshot
+ */
+EXPLORENFC_API void hal_tag_snapshot_unref(const nfc_tag_snapshot_t* pSnapshot);
 
 ///\}
 
+/** \name Provisioning
+ * In provisioning mode the HAL thread programs every tag brought into the field by itself:
+ * no tag is advertised to the adapter, only the outcome of each write is
+ */
+///\{
+
+/** Render the message to write on a tag
+ * Called from the HAL thread
+ * \param uid tag's UID (ISO14443A UID, or IDm for Felica tags)
+ * \param uidLength UID's length
+ * \param sequence sequence number of the tag, incremented after each successfully programmed tag
+ * \param pUserData pRenderData passed in nfc_provisioning_params_t
+ * \return new NDEF message, or NULL if it cannot be generated
+ */
+typedef GBytes* (*hal_provisioning_render_cb_t)(const guint8* uid, gsize uidLength, guint64 sequence, gpointer pUserData);
+
+/** Provisioning parameters
+ *
+ */
+struct nfc_provisioning_params
+{
+	hal_provisioning_render_cb_t renderCb; ///< Generates the message for each tag
+	gpointer pRenderData; ///< User data passed to renderCb
+	GDestroyNotify renderDataDestroy; ///< Frees pRenderData from the HAL thread once provisioning stops (or NULL)
+	gboolean verify; ///< Read each message back before declaring success
+	gboolean lock; ///< Make each tag read only once written
+	guint64 sequenceStart; ///< Sequence number of the first tag
+};
+typedef struct nfc_provisioning_params nfc_provisioning_params_t; ///< Provisioning parameters
+
+/** Outcome of programming one tag in provisioning mode
+ *
+ */
+struct nfc_provisioning_result
+{
+	guint8 uid[10]; ///< UID (ISO14443A UID, or IDm for Felica tags)
+	gsize uidLength; ///< UID's length
+	guint64 sequence; ///< Sequence number used to render the message
+	nfc_tag_write_result_t result; ///< Outcome of the write
+	gint64 duration; ///< Time spent programming the tag, in microseconds
+	gsize length; ///< Size of the NDEF message
+	gsize bytesSent; ///< Bytes actually sent over RF to write it
+	guint64 provisioned; ///< Tags successfully programmed since provisioning started
+	gint64 elapsed; ///< Time since provisioning started, in microseconds
+};
+
+/** Start provisioning mode
+ * Starts the polling loop in initiator mode if needed; replaces the parameters if already started
+ * \param pHal hal_t instance
+ * \param pParams parameters, copied
+ * \return TRUE on success, FALSE if the command could not be queued (pRenderData is then left to the caller)
+ */
+EXPLORENFC_API gboolean hal_adapter_provisioning_start(hal_t* pHal, const nfc_provisioning_params_t* pParams);
+
+/** Stop provisioning mode
+ * The polling loop is left running, tags are advertised to the adapter again
+ * \param pHal hal_t instance
+ */
+EXPLORENFC_API void hal_adapter_provisioning_stop(hal_t* pHal);
+///\}
+
 /** \name Devices
  */
 ///\{
@@ -281,32 +622,41 @@ enum nfc_device_type
 };
 typedef enum nfc_device_type nfc_device_type_t; ///< Device type
 
+/** Device snapshot
+ * Immutable copy of the last NDEF message sent by peer
+ */
+struct nfc_device_snapshot
+{
+	guint deviceId; ///< Id of device
+	GBytes* pNdef; ///< NDEF message (or NULL), shared with the HAL: must not be unreferenced
+};
+typedef struct nfc_device_snapshot nfc_device_snapshot_t; ///< Device snapshot
+
 /** Increase reference count for device
  * \param pHal hal_t instance
  * \param deviceId id of device
  */
-void hal_device_ref(hal_t* pHal, guint deviceId);
+EXPLORENFC_API void hal_device_ref(hal_t* pHal, guint deviceId);
 
 /** Decrease reference count for device (and free if it reaches 0)
  * \param pHal hal_t instance
  * \param deviceId id of device
  */
-void hal_device_unref(hal_t* pHal, guint deviceId);
+EXPLORENFC_API void hal_device_unref(hal_t* pHal, guint deviceId);
 
 /** Check if device is connected
  * \param pHal hal_t instance
  * \param deviceId id of device
  * \return TRUE if device is connected, FALSE otherwise
  */
-gboolean hal_device_is_connected(hal_t* pHal, guint deviceId);
+EXPLORENFC_API gboolean hal_device_is_connected(hal_t* pHal, guint deviceId);
 
 /** Get NDEF message sent by peer
  * \param pHal hal_t instance
  * \param deviceId id of device
- * \param pBuffer will return buffer (or NULL)
- * \param pBufferLength will return buffer's length
+ * \return new reference to NDEF message (or NULL), release with g_bytes_unref()
  */
-void hal_device_get_ndef(hal_t* pHal, guint deviceId, guint8** pBuffer, gsize* pBufferLength);
+EXPLORENFC_API GBytes* hal_device_get_ndef(hal_t* pHal, guint deviceId);
 
 /** Push NDEF message to peer
  * \param pHal hal_t instance
@@ -314,7 +664,19 @@ void hal_device_get_ndef(hal_t* pHal, guint deviceId, guint8** pBuffer, gsize* p
  * \param buffer buffer to write
  * \param bufferLength buffer's length
  */
-void hal_device_push_ndef(hal_t* pHal, guint deviceId, guint8* buffer, gsize bufferLength);
+EXPLORENFC_API void hal_device_push_ndef(hal_t* pHal, guint deviceId, guint8* buffer, gsize bufferLength);
+
+/** Get a snapshot of device
+ * \param pHal hal_t instance
+ * \param deviceId id of device
+ * \return snapshot, release with hal_device_snapshot_unref()
+ */
+EXPLORENFC_API const nfc_device_snapshot_t* hal_device_get_snapshot(hal_t* pHal, guint deviceId);
+
+/** Decrease reference count for device snapshot (and free if it reaches 0)
+ * \param pSnapshot snapshot
+ */
+EXPLORENFC_API void hal_device_snapshot_unref(const nfc_device_snapshot_t* pSnapshot);
 ///\}
 
 #endif /* HAL_H_ */
@@ -0,0 +1,375 @@
+/*
+*         Copyright (c), NXP Semiconductors Gratkorn / Austria
+*
+*                     (C)NXP Semiconductors
+*       All rights are reserved. Reproduction in whole or in part is
+*      prohibited without the written consent of the copyright owner.
+*  NXP reserves the right to make changes without notice at any time.
+* NXP makes no warranty, expressed, implied or statutory, including but
+* not limited to any implied warranty of merchantability or fitness for any
+*particular purpose, or that the use will not infringe any third party patent,
+* copyright or trademark. NXP must not be liable for any loss or damage
+*                          arising from its use.
+*/
+/**
+ * \file hal_cache.c
+ * NDEF content cache
+ *
+ * Keeps the NDEF messages of the most recently seen tags, indexed by UID.
+ * When a known tag comes back and the NDEF length and header read during the
+ * NDEF check still match, the cached message is used and the NDEF read is skipped.
+ *
+ * Optionally, every change is also logged to a persistent file (see hal_cache_file.c)
+ * so that the cache survives a restart of the daemon.
+ */
+
+#include "hal.h"
+#include "hal_internal.h"
+
+#include <string.h>
+
+#include <glib.h>
+#include <glib/gprintf.h>
+#include <gio/gio.h>
+
+struct hal_impl_cache_entry
+{
+	GBytes* pUid;
+	guint8 header[HAL_IMPL_TAG_HEADER_SIZE];
+	gsize headerLength;
+	gsize ndefLength;
+	GBytes* pNdef; //Shared with the tags it was read from or restored to
+	GList* pLink; //In LRU queue
+};
+typedef struct hal_impl_cache_entry hal_impl_cache_entry_t;
+
+static void hal_impl_cache_entry_free(gpointer pData)
+{
+	hal_impl_cache_entry_t* pEntry = (hal_impl_cache_entry_t*) pData;
+	g_bytes_unref(pEntry->pUid);
+	g_bytes_unref(pEntry->pNdef);
+	g_free(pEntry);
+}
+
+hal_impl_cache_t* hal_impl_cache_new(guint size, nfc_cache_validation_t validation)
+{
+	hal_impl_cache_t* pCache = g_malloc(sizeof(hal_impl_cache_t));
+
+	pCache->size = size;
+	pCache->validation = validation;
+	pCache->pTable = g_hash_table_new_full(g_bytes_hash, g_bytes_equal, NULL, hal_impl_cache_entry_free);
+	g_queue_init(&pCache->lru);
+
+	pCache->hits = 0;
+	pCache->misses = 0;
+	pCache->evictions = 0;
+
+	pCache->pFile = NULL;
+
+	g_mutex_init(&pCache->mutex);
+
+	return pCache;
+}
+
+void hal_impl_cache_free(hal_impl_cache_t* pCache)
+{
+	if( pCache->pFile != NULL )
+	{
+		hal_impl_cache_file_close(pCache->pFile);
+	}
+	g_queue_clear(&pCache->lru);
+	g_hash_table_destroy(pCache->pTable);
+	g_mutex_clear(&pCache->mutex);
+	g_free(pCache);
+}
+
+static GBytes* hal_impl_cache_get_uid(hal_impl_tag_t* pTag)
+{
+	if( HAL_IMPL_NFC_TYPE_IS_TAG_FELICA(pTag->type) )
+	{
+		//IDm
+		guint8 idm[8];
+		memcpy(&idm[0], pTag->felica.manufacturer, 2);
+		memcpy(&idm[2], pTag->felica.cid, 6);
+		return g_bytes_new(idm, sizeof(idm));
+	}
+
+	return g_bytes_new(pTag->iso14443a.uid, pTag->iso14443a.uidLength);
+}
+
+static void hal_impl_cache_remove(hal_impl_cache_t* pCache, hal_impl_cache_entry_t* pEntry)
+{
+	g_queue_delete_link(&pCache->lru, pEntry->pLink);
+	g_hash_table_remove(pCache->pTable, pEntry->pUid); //Frees entry
+}
+
+static void hal_impl_cache_entry_to_record(hal_impl_cache_entry_t* pEntry, hal_impl_cache_record_t* pRecord)
+{
+	gsize uidLength;
+	pRecord->type = hal_impl_cache_record_entry;
+	pRecord->uid = g_bytes_get_data(pEntry->pUid, &uidLength);
+	pRecord->uidLength = uidLength;
+	pRecord->header = pEntry->header;
+	pRecord->headerLength = pEntry->headerLength;
+	pRecord->ndefLength = pEntry->ndefLength;
+	gsize length;
+	pRecord->ndef = g_bytes_get_data(pEntry->pNdef, &length);
+	pRecord->length = length;
+}
+
+//Must be called with cache mutex held, once the change has been applied to the table
+static void hal_impl_cache_persist(hal_impl_cache_t* pCache, const hal_impl_cache_record_t* pRecord)
+{
+	if( pCache->pFile == NULL )
+	{
+		return;
+	}
+
+	if( hal_impl_cache_file_append(pCache->pFile, pRecord) )
+	{
+		return;
+	}
+
+	//File is full, rewrite it with live entries only (least recently used first, so that they are loaded back in the same order),
+	//the least recently used ones are dropped if they do not all fit
+	GPtrArray* pRecords = g_ptr_array_new_with_free_func(g_free);
+	for(GList* pLink = g_queue_peek_tail_link(&pCache->lru); pLink != NULL; pLink = pLink->prev)
+	{
+		hal_impl_cache_record_t* pLiveRecord = g_malloc(sizeof(hal_impl_cache_record_t));
+		hal_impl_cache_entry_to_record((hal_impl_cache_entry_t*) pLink->data, pLiveRecord);
+		g_ptr_array_add(pRecords, pLiveRecord);
+	}
+
+	if( !hal_impl_cache_file_rewrite(pCache->pFile, pRecords) )
+	{
+		g_warning("Could not compact cache file, NDEF cache changes will not be persisted");
+	}
+
+	g_ptr_array_free(pRecords, TRUE);
+}
+
+static void hal_impl_cache_persist_removal(hal_impl_cache_t* pCache, GBytes* pUid)
+{
+	gsize uidLength;
+	hal_impl_cache_record_t record = {0};
+	record.type = hal_impl_cache_record_removal;
+	record.uid = g_bytes_get_data(pUid, &uidLength);
+	record.uidLength = uidLength;
+	hal_impl_cache_persist(pCache, &record);
+}
+
+static void hal_impl_cache_load_cb(const hal_impl_cache_record_t* pRecord, gpointer pUserData)
+{
+	hal_impl_cache_t* pCache = (hal_impl_cache_t*) pUserData;
+
+	GBytes* pUid = g_bytes_new(pRecord->uid, pRecord->uidLength);
+	hal_impl_cache_entry_t* pOldEntry = g_hash_table_lookup(pCache->pTable, pUid);
+	if( pOldEntry != NULL )
+	{
+		hal_impl_cache_remove(pCache, pOldEntry);
+	}
+
+	if( pRecord->type != hal_impl_cache_record_entry )
+	{
+		g_bytes_unref(pUid);
+		return;
+	}
+
+	hal_impl_cache_entry_t* pEntry = g_malloc(sizeof(hal_impl_cache_entry_t));
+	pEntry->pUid = pUid;
+	memcpy(pEntry->header, pRecord->header, pRecord->headerLength);
+	pEntry->headerLength = pRecord->headerLength;
+	pEntry->ndefLength = pRecord->ndefLength;
+	pEntry->pNdef = g_bytes_new(pRecord->ndef, pRecord->length); //The mapping is rewritten on compaction
+
+	g_queue_push_head(&pCache->lru, pEntry);
+	pEntry->pLink = g_queue_peek_head_link(&pCache->lru);
+	g_hash_table_insert(pCache->pTable, pEntry->pUid, pEntry);
+}
+
+gboolean hal_impl_cache_attach_file(hal_impl_cache_t* pCache, const gchar* path, gsize size)
+{
+	g_mutex_lock(&pCache->mutex);
+	if( pCache->pFile != NULL )
+	{
+		hal_impl_cache_file_close(pCache->pFile);
+	}
+
+	pCache->pFile = hal_impl_cache_file_open(path, size, hal_impl_cache_load_cb, pCache);
+
+	//Size might have been reduced since the file was written
+	while( g_hash_table_size(pCache->pTable) > pCache->size )
+	{
+		hal_impl_cache_remove(pCache, (hal_impl_cache_entry_t*) g_queue_peek_tail(&pCache->lru));
+	}
+	g_mutex_unlock(&pCache->mutex);
+
+	return pCache->pFile != NULL;
+}
+
+gboolean hal_impl_cache_lookup(hal_impl_t* pHal, guint tagId)
+{
+	hal_impl_cache_t* pCache = pHal->pCache;
+	if( pCache == NULL )
+	{
+		return FALSE;
+	}
+
+	hal_impl_tag_t* pTag = hal_impl_tag_lookup(pHal, tagId);
+
+	if(pTag == NULL)
+	{
+		g_error("Did not find hal_impl_tag_t instance of id %d", tagId);
+		return FALSE;
+	}
+
+	gboolean hit = FALSE;
+
+	GBytes* pUid = hal_impl_cache_get_uid(pTag);
+
+	g_mutex_lock(&pCache->mutex);
+	hal_impl_cache_entry_t* pEntry = g_hash_table_lookup(pCache->pTable, pUid);
+	if( pEntry != NULL )
+	{
+		hit = TRUE;
+		if( g_atomic_int_get(&pTag->status) == hal_impl_nfc_ndef_status_invalid )
+		{
+			hit = FALSE;
+		}
+		if( (pCache->validation >= nfc_cache_validation_length) && (pEntry->ndefLength != pTag->ndefLength) )
+		{
+			hit = FALSE;
+		}
+		if( (pCache->validation >= nfc_cache_validation_header) &&
+				((pEntry->headerLength != pTag->headerLength) || memcmp(pEntry->header, pTag->header, pTag->headerLength)) )
+		{
+			hit = FALSE;
+		}
+
+		if( hit )
+		{
+			//Move to front
+			g_queue_unlink(&pCache->lru, pEntry->pLink);
+			g_queue_push_head_link(&pCache->lru, pEntry->pLink);
+
+			hal_impl_tag_set_message(pTag, g_bytes_ref(pEntry->pNdef));
+		}
+		else
+		{
+			//Tag was rewritten elsewhere, entry is stale
+			hal_impl_cache_remove(pCache, pEntry);
+			hal_impl_cache_persist_removal(pCache, pUid);
+		}
+	}
+
+	if( hit )
+	{
+		pCache->hits++;
+	}
+	else
+	{
+		pCache->misses++;
+	}
+	g_debug("NDEF cache %s (%" G_GUINT64_FORMAT " hits, %" G_GUINT64_FORMAT " misses)", hit?"hit":"miss", pCache->hits, pCache->misses);
+	g_mutex_unlock(&pCache->mutex);
+
+	g_bytes_unref(pUid);
+	hal_impl_tag_release(pHal, pTag);
+
+	return hit;
+}
+
+void hal_impl_cache_store(hal_impl_t* pHal, guint tagId)
+{
+	hal_impl_cache_t* pCache = pHal->pCache;
+	if( (pCache == NULL) || (pCache->size == 0) )
+	{
+		return;
+	}
+
+	hal_impl_tag_t* pTag = hal_impl_tag_lookup(pHal, tagId);
+
+	if(pTag == NULL)
+	{
+		g_error("Did not find hal_impl_tag_t instance of id %d", tagId);
+		return;
+	}
+
+	//The message is only replaced by the HAL thread, which is the one running this
+	if( (g_atomic_int_get(&pTag->status) == hal_impl_nfc_ndef_status_invalid) || (pTag->message.pBytes == NULL) )
+	{
+		hal_impl_tag_release(pHal, pTag);
+		return;
+	}
+
+	hal_impl_cache_entry_t* pEntry = g_malloc(sizeof(hal_impl_cache_entry_t));
+	pEntry->pUid = hal_impl_cache_get_uid(pTag);
+	memcpy(pEntry->header, pTag->header, pTag->headerLength);
+	pEntry->headerLength = pTag->headerLength;
+	pEntry->ndefLength = pTag->ndefLength;
+	pEntry->pNdef = g_bytes_ref(pTag->message.pBytes);
+	hal_impl_tag_release(pHal, pTag);
+
+	g_mutex_lock(&pCache->mutex);
+	hal_impl_cache_entry_t* pOldEntry = g_hash_table_lookup(pCache->pTable, pEntry->pUid);
+	if( pOldEntry != NULL )
+	{
+		hal_impl_cache_remove(pCache, pOldEntry);
+	}
+	else if( g_hash_table_size(pCache->pTable) >= pCache->size )
+	{
+		//Evict least recently used tag
+		hal_impl_cache_remove(pCache, (hal_impl_cache_entry_t*) g_queue_peek_tail(&pCache->lru));
+		pCache->evictions++;
+	}
+
+	g_queue_push_head(&pCache->lru, pEntry);
+	pEntry->pLink = g_queue_peek_head_link(&pCache->lru);
+	g_hash_table_insert(pCache->pTable, pEntry->pUid, pEntry);
+
+	hal_impl_cache_record_t record;
+	hal_impl_cache_entry_to_record(pEntry, &record);
+	hal_impl_cache_persist(pCache, &record);
+	g_mutex_unlock(&pCache->mutex);
+}
+
+void hal_impl_cache_invalidate(hal_impl_t* pHal, guint tagId)
+{
+	hal_impl_cache_t* pCache = pHal->pCache;
+	if( pCache == NULL )
+	{
+		return;
+	}
+
+	hal_impl_tag_t* pTag = hal_impl_tag_lookup(pHal, tagId);
+
+	if(pTag == NULL)
+	{
+		g_error("Did not find hal_impl_tag_t instance of id %d", tagId);
+		return;
+	}
+
+	GBytes* pUid = hal_impl_cache_get_uid(pTag);
+	hal_impl_tag_release(pHal, pTag);
+
+	g_mutex_lock(&pCache->mutex);
+	hal_impl_cache_entry_t* pEntry = g_hash_table_lookup(pCache->pTable, pUid);
+	if( pEntry != NULL )
+	{
+		hal_impl_cache_remove(pCache, pEntry);
+		hal_impl_cache_persist_removal(pCache, pUid);
+	}
+	g_mutex_unlock(&pCache->mutex);
+
+	g_bytes_unref(pUid);
+}
+
+void hal_impl_cache_get_statistics(hal_impl_cache_t* pCache, nfc_statistics_t* pStatistics)
+{
+	g_mutex_lock(&pCache->mutex);
+	pStatistics->cacheHits = pCache->hits;
+	pStatistics->cacheMisses = pCache->misses;
+	pStatistics->cacheEvictions = pCache->evictions;
+	pStatistics->cacheEntries = g_hash_table_size(pCache->pTable);
+	g_mutex_unlock(&pCache->mutex);
+}
@@ -0,0 +1,380 @@
+/*
+*         Copyright (c), NXP Semiconductors Gratkorn / Austria
+*
+*                     (C)NXP Semiconductors
+*       All rights are reserved. Reproduction in whole or in part is
+*      prohibited without the written consent of the copyright owner.
+*  NXP reserves the right to make changes without notice at any time.
+* NXP makes no warranty, expressed, implied or statutory, including but
+* not limited to any implied warranty of merchantability or fitness for any
+*particular purpose, or that the use will not infringe any third party patent,
+* copyright or trademark. NXP must not be liable for any loss or damage
+*                          arising from its use.
+*/
+/**
+ * \file hal_cache_file.c
+ * Persistent storage of the NDEF cache
+ *
+ * The file has a fixed size and is memory-mapped. It starts with a header,
+ * followed by records appended one after the other:
+ *
+ * | Offset | Size    | Field                                           |
+ * |--------|---------|-------------------------------------------------|
+ * | 0      | 4       | Magic                                           |
+ * | 4      | 4       | CRC32 of the record, from offset 8 to its end   |
+ * | 8      | 1       | Type (entry or removal)                         |
+ * | 9      | 1       | UID length                                      |
+ * | 10     | 1       | Header length                                   |
+ * | 11     | 1       | Reserved                                        |
+ * | 12     | 4       | NDEF length, as read during the NDEF check      |
+ * | 16     | 4       | NDEF message length                             |
+ * | 20     | ...     | UID, header, NDEF message                       |
+ *
+ * All integers are little-endian. When the file is opened, records are replayed
+ * in order to rebuild the cache; the first record with a bad magic, length or CRC
+ * (i.e. a write torn by a power loss) marks the end of the log and everything
+ * after it is erased. When the file is full, the most recently used live entries
+ * (up to half of the file) are written to a temporary file which then atomically
+ * replaces it.
+ */
+
+#include "hal.h"
+#include "hal_internal.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <glib.h>
+#include <glib/gprintf.h>
+#include <gio/gio.h>
+
+#define HAL_CACHE_FILE_MAGIC "NXNDEFC1"
+#define HAL_CACHE_FILE_HEADER_SIZE 16
+#define HAL_CACHE_RECORD_MAGIC 0x4345524EU //"NREC"
+#define HAL_CACHE_RECORD_HEADER_SIZE 20
+
+struct hal_impl_cache_file
+{
+	gchar* path;
+	int fd;
+	guint8* map;
+	gsize size;
+	gsize end; //Offset at which the next record will be appended
+};
+
+static guint32 crcTable[256];
+
+static void hal_impl_cache_file_crc_init()
+{
+	static gsize init = 0;
+	if( g_once_init_enter(&init) )
+	{
+		for(guint32 n = 0; n < 256; n++)
+		{
+			guint32 c = n;
+			for(int k = 0; k < 8; k++)
+			{
+				c = (c & 1) ? (0xEDB88320U ^ (c >> 1)) : (c >> 1);
+			}
+			crcTable[n] = c;
+		}
+		g_once_init_leave(&init, 1);
+	}
+}
+
+static guint32 hal_impl_cache_file_crc(const guint8* buffer, gsize length)
+{
+	guint32 crc = 0xFFFFFFFFU;
+	for(gsize i = 0; i < length; i++)
+	{
+		crc = crcTable[(crc ^ buffer[i]) & 0xFF] ^ (crc >> 8);
+	}
+	return crc ^ 0xFFFFFFFFU;
+}
+
+static void put_u32(guint8* p, guint32 value)
+{
+	p[0] = value & 0xFF;
+	p[1] = (value >> 8) & 0xFF;
+	p[2] = (value >> 16) & 0xFF;
+	p[3] = (value >> 24) & 0xFF;
+}
+
+static guint32 get_u32(const guint8* p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((guint32)p[3] << 24);
+}
+
+static gsize hal_impl_cache_file_record_size(const hal_impl_cache_record_t* pRecord)
+{
+	return HAL_CACHE_RECORD_HEADER_SIZE + pRecord->uidLength + pRecord->headerLength + pRecord->length;
+}
+
+static gboolean hal_impl_cache_file_map(hal_impl_cache_file_t* pFile, const gchar* path, gboolean create)
+{
+	pFile->fd = open(path, O_RDWR | (create ? (O_CREAT | O_TRUNC) : O_CREAT), 0644);
+	if( pFile->fd < 0 )
+	{
+		g_warning("Could not open cache file %s: %s", path, g_strerror(errno));
+		return FALSE;
+	}
+
+	struct stat st;
+	gboolean blank = create;
+	if( (fstat(pFile->fd, &st) != 0) || ((gsize)st.st_size != pFile->size) )
+	{
+		//New file, or maximum size changed: start over
+		if( ftruncate(pFile->fd, 0) || ftruncate(pFile->fd, pFile->size) )
+		{
+			g_warning("Could not resize cache file %s: %s", path, g_strerror(errno));
+			close(pFile->fd);
+			return FALSE;
+		}
+		blank = TRUE;
+	}
+
+	pFile->map = mmap(NULL, pFile->size, PROT_READ | PROT_WRITE, MAP_SHARED, pFile->fd, 0);
+	if( pFile->map == MAP_FAILED )
+	{
+		g_warning("Could not map cache file %s: %s", path, g_strerror(errno));
+		close(pFile->fd);
+		return FALSE;
+	}
+
+	if( blank || memcmp(pFile->map, HAL_CACHE_FILE_MAGIC, 8) )
+	{
+		memset(pFile->map, 0, pFile->size);
+		memcpy(pFile->map, HAL_CACHE_FILE_MAGIC, 8);
+		msync(pFile->map, pFile->size, MS_SYNC);
+	}
+
+	pFile->end = HAL_CACHE_FILE_HEADER_SIZE;
+	return TRUE;
+}
+
+static void hal_impl_cache_file_unmap(hal_impl_cache_file_t* pFile)
+{
+	munmap(pFile->map, pFile->size);
+	close(pFile->fd);
+}
+
+static gboolean hal_impl_cache_file_write(hal_impl_cache_file_t* pFile, const hal_impl_cache_record_t* pRecord)
+{
+	gsize recordSize = hal_impl_cache_file_record_size(pRecord);
+	if( pFile->end + recordSize > pFile->size )
+	{
+		return FALSE;
+	}
+
+	guint8* p = pFile->map + pFile->end;
+
+	p[8] = pRecord->type;
+	p[9] = (guint8)pRecord->uidLength;
+	p[10] = (guint8)pRecord->headerLength;
+	p[11] = 0;
+	put_u32(&p[12], (guint32)pRecord->ndefLength);
+	put_u32(&p[16], (guint32)pRecord->length);
+
+	guint8* q = p + HAL_CACHE_RECORD_HEADER_SIZE;
+	memcpy(q, pRecord->uid, pRecord->uidLength);
+	q += pRecord->uidLength;
+	memcpy(q, pRecord->header, pRecord->headerLength);
+	q += pRecord->headerLength;
+	if( pRecord->length > 0 )
+	{
+		memcpy(q, pRecord->ndef, pRecord->length);
+	}
+
+	put_u32(&p[4], hal_impl_cache_file_crc(&p[8], recordSize - 8));
+
+	//Magic goes last, a record is only valid once complete
+	put_u32(&p[0], HAL_CACHE_RECORD_MAGIC);
+
+	pFile->end += recordSize;
+	return TRUE;
+}
+
+static void hal_impl_cache_file_flush(hal_impl_cache_file_t* pFile, gsize start, int flags)
+{
+	//msync() needs a page-aligned address
+	gsize pageSize = sysconf(_SC_PAGESIZE);
+	gsize alignedStart = start - (start % pageSize);
+	msync(pFile->map + alignedStart, pFile->end - alignedStart, flags);
+}
+
+hal_impl_cache_file_t* hal_impl_cache_file_open(const gchar* path, gsize size,
+		hal_impl_cache_file_load_cb_t loadCb, gpointer pUserData)
+{
+	hal_impl_cache_file_crc_init();
+
+	gchar* dir = g_path_get_dirname(path);
+	if( g_mkdir_with_parents(dir, 0755) )
+	{
+		g_warning("Could not create cache directory %s: %s", dir, g_strerror(errno));
+	}
+	g_free(dir);
+
+	hal_impl_cache_file_t* pFile = g_malloc(sizeof(hal_impl_cache_file_t));
+	pFile->path = g_strdup(path);
+	pFile->size = MAX(size, HAL_CACHE_FILE_HEADER_SIZE + HAL_CACHE_RECORD_HEADER_SIZE);
+
+	if( !hal_impl_cache_file_map(pFile, path, FALSE) )
+	{
+		g_free(pFile->path);
+		g_free(pFile);
+		return NULL;
+	}
+
+	//Replay log
+	guint count = 0;
+	while( pFile->end + HAL_CACHE_RECORD_HEADER_SIZE <= pFile->size )
+	{
+		const guint8* p = pFile->map + pFile->end;
+		if( get_u32(&p[0]) != HAL_CACHE_RECORD_MAGIC )
+		{
+			break;
+		}
+
+		hal_impl_cache_record_t record;
+		record.type = p[8];
+		record.uidLength = p[9];
+		record.headerLength = p[10];
+		record.ndefLength = get_u32(&p[12]);
+		record.length = get_u32(&p[16]);
+
+		gsize recordSize = hal_impl_cache_file_record_size(&record);
+		if( (record.uidLength > 10) || (record.headerLength > HAL_IMPL_TAG_HEADER_SIZE)
+				|| (record.length > HAL_IMPL_NFC_NDEF_MESSAGE_MAX_SIZE)
+				|| (pFile->end + recordSize > pFile->size) )
+		{
+			break;
+		}
+
+		if( get_u32(&p[4]) != hal_impl_cache_file_crc(&p[8], recordSize - 8) )
+		{
+			break;
+		}
+
+		record.uid = p + HAL_CACHE_RECORD_HEADER_SIZE;
+		record.header = record.uid + record.uidLength;
+		record.ndef = record.header + record.headerLength;
+
+		loadCb(&record, pUserData);
+
+		pFile->end += recordSize;
+		count++;
+	}
+
+	//Erase torn or stale data after the last valid record
+	if( pFile->end < pFile->size )
+	{
+		gsize start = pFile->end;
+		pFile->end = pFile->size;
+		memset(pFile->map + start, 0, pFile->size - start);
+		hal_impl_cache_file_flush(pFile, start, MS_SYNC);
+		pFile->end = start;
+	}
+
+	g_info("Loaded %d records from cache file %s", count, path);
+
+	return pFile;
+}
+
+void hal_impl_cache_file_close(hal_impl_cache_file_t* pFile)
+{
+	msync(pFile->map, pFile->size, MS_SYNC);
+	hal_impl_cache_file_unmap(pFile);
+	g_free(pFile->path);
+	g_free(pFile);
+}
+
+gboolean hal_impl_cache_file_append(hal_impl_cache_file_t* pFile, const hal_impl_cache_record_t* pRecord)
+{
+	gsize start = pFile->end;
+	if( !hal_impl_cache_file_write(pFile, pRecord) )
+	{
+		return FALSE;
+	}
+
+	//A record lost on power failure is detected by its CRC, no need to wait for the write
+	hal_impl_cache_file_flush(pFile, start, MS_ASYNC);
+	return TRUE;
+}
+
+gboolean hal_impl_cache_file_rewrite(hal_impl_cache_file_t* pFile, GPtrArray* pRecords)
+{
+	gchar* tmpPath = g_strconcat(pFile->path, ".tmp", NULL);
+
+	hal_impl_cache_file_t tmpFile;
+	tmpFile.size = pFile->size;
+	if( !hal_impl_cache_file_map(&tmpFile, tmpPath, TRUE) )
+	{
+		g_free(tmpPath);
+		return FALSE;
+	}
+
+	//Keep the most recently used entries, at the end of the array, within half of the file so that
+	//the next records can be appended without compacting again; the last one (the entry being stored)
+	//is kept as long as it fits at all
+	gsize space = pFile->size - tmpFile.end;
+	gsize used = 0;
+	guint first = pRecords->len;
+	while( first > 0 )
+	{
+		gsize recordSize = hal_impl_cache_file_record_size(g_ptr_array_index(pRecords, first - 1));
+		gsize limit = (first == pRecords->len) ? space : (space / 2);
+		if( used + recordSize > limit )
+		{
+			break;
+		}
+		used += recordSize;
+		first--;
+	}
+
+	if( first > 0 )
+	{
+		g_info("Cache file %s full, dropping %u least recently used entries", pFile->path, first);
+	}
+
+	for(guint i = first; i < pRecords->len; i++)
+	{
+		hal_impl_cache_file_write(&tmpFile, g_ptr_array_index(pRecords, i));
+	}
+
+	//Make sure the new file is on disk before it replaces the old one
+	msync(tmpFile.map, tmpFile.size, MS_SYNC);
+	fsync(tmpFile.fd);
+
+	if( rename(tmpPath, pFile->path) )
+	{
+		g_warning("Could not replace cache file %s: %s", pFile->path, g_strerror(errno));
+		hal_impl_cache_file_unmap(&tmpFile);
+		unlink(tmpPath);
+		g_free(tmpPath);
+		return FALSE;
+	}
+	g_free(tmpPath);
+
+	gchar* dir = g_path_get_dirname(pFile->path);
+	int dirFd = open(dir, O_RDONLY);
+	if( dirFd >= 0 )
+	{
+		fsync(dirFd);
+		close(dirFd);
+	}
+	g_free(dir);
+
+	hal_impl_cache_file_unmap(pFile);
+	pFile->fd = tmpFile.fd;
+	pFile->map = tmpFile.map;
+	pFile->end = tmpFile.end;
+
+	g_debug("Compacted cache file %s, %" G_GSIZE_FORMAT " bytes used", pFile->path, pFile->end);
+
+	return TRUE;
+}
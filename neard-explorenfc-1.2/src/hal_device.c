@@ -29,11 +29,16 @@ static void hal_impl_snep_ndef_received_cb(hal_impl_t* pHal, guint8* buffer, gsi
 
 int hal_impl_device_new(hal_impl_t* pHal, hal_impl_nfc_type_t nfcType, guint* pDeviceId)
 {
-	hal_impl_device_t* pDevice = g_malloc(sizeof(hal_impl_device_t));
+	//Reserve a slot, the device is not visible to other threads until it is published
+	hal_impl_device_t* pDevice = (hal_impl_device_t*) hal_impl_registry_alloc(&pHal->devices);
+	if(pDevice == NULL)
+	{
+		g_warning("Too many devices in use");
+		return PH_ERR_FAILED;
+	}
 
 	//Initialize everything
-	pDevice->message.buffer = NULL;
-	pDevice->message.length = 0;
+	pDevice->message.pBytes = NULL;
 	pDevice->message.size = 0;
 
 	pDevice->type = nfcType;
@@ -42,87 +47,74 @@ int hal_impl_device_new(hal_impl_t* pHal, hal_impl_nfc_type_t nfcType, guint* pD
 
 	//Init other fields from device
 	pDevice->connected = TRUE;
-	pDevice->refs = 1; //1 reference
-	g_rec_mutex_init(&pDevice->mutex);
 
-	//Find a free ID in the hash table and add the device
-	g_mutex_lock(&pHal->deviceTableMutex);
+	*pDeviceId = pDevice->object.id;
 
-	pDevice->id = 0;
+	g_debug("New device id %d", pDevice->object.id);
 
-	while(g_hash_table_contains(pHal->pDeviceTable, GUINT_TO_POINTER(pDevice->id)))
-	{
-		pDevice->id++;
-	}
+	hal_impl_registry_publish(&pHal->devices, &pDevice->object); //1 reference
 
-	*pDeviceId = pDevice->id;
+	return 0;
+}
 
-	g_debug("New device id %d", pDevice->id);
+hal_impl_device_t* hal_impl_device_lookup(hal_impl_t* pHal, guint deviceId)
+{
+	return (hal_impl_device_t*) hal_impl_registry_ref(&pHal->devices, deviceId);
+}
 
-	g_hash_table_insert(pHal->pDeviceTable, GUINT_TO_POINTER(pDevice->id), (gpointer*)pDevice);
+void hal_impl_device_release(hal_impl_t* pHal, hal_impl_device_t* pDevice)
+{
+	hal_impl_registry_unref(&pHal->devices, &pDevice->object);
+}
 
-	g_mutex_unlock(&pHal->deviceTableMutex);
+void hal_impl_device_clear(hal_impl_object_t* pObject)
+{
+	hal_impl_device_t* pDevice = (hal_impl_device_t*) pObject;
 
-	return 0;
+	if(pDevice->message.pBytes != NULL)
+	{
+		g_bytes_unref(pDevice->message.pBytes);
+		pDevice->message.pBytes = NULL;
+	}
 }
 
 void hal_device_ref(hal_t* pHal, guint deviceId)
 {
 	hal_impl_t* pHalImpl = (hal_impl_t*) pHal;
 
-	g_mutex_lock(&pHalImpl->deviceTableMutex);
-	hal_impl_device_t* pDevice = g_hash_table_lookup(pHalImpl->pDeviceTable, GUINT_TO_POINTER(deviceId));
-	g_mutex_unlock(&pHalImpl->deviceTableMutex);
+	hal_impl_device_t* pDevice = hal_impl_device_lookup(pHalImpl, deviceId);
 
 	if(pDevice == NULL)
 	{
 		g_error("Did not find hal_impl_device_t instance of id %d", deviceId);
 		return;
 	}
-	g_rec_mutex_lock(&pDevice->mutex);
-	pDevice->refs++;
-	g_rec_mutex_unlock(&pDevice->mutex);
+
+	//Keep the reference taken by the lookup
 }
 
 void hal_device_unref(hal_t* pHal, guint deviceId)
 {
 	hal_impl_t* pHalImpl = (hal_impl_t*) pHal;
 
-	g_mutex_lock(&pHalImpl->deviceTableMutex);
-	hal_impl_device_t* pDevice = g_hash_table_lookup(pHalImpl->pDeviceTable, GUINT_TO_POINTER(deviceId));
-	g_mutex_unlock(&pHalImpl->deviceTableMutex);
+	hal_impl_device_t* pDevice = hal_impl_device_lookup(pHalImpl, deviceId);
 
 	if(pDevice == NULL)
 	{
 		g_error("Did not find hal_impl_device_t instance of id %d", deviceId);
 		return;
 	}
-	g_rec_mutex_lock(&pDevice->mutex);
-	guint refs = --pDevice->refs;
-	g_rec_mutex_unlock(&pDevice->mutex);
-	if(refs == 0)
-	{
-		//No one is using the device anymore, so free it
-		g_mutex_lock(&pHalImpl->deviceTableMutex);
-		g_hash_table_remove(pHalImpl->pDeviceTable, GUINT_TO_POINTER(deviceId));
-		g_mutex_unlock(&pHalImpl->deviceTableMutex);
 
-		if(pDevice->message.buffer != NULL)
-		{
-			g_free(pDevice->message.buffer);
-		}
-
-		g_free(pDevice);
-	}
+	//Drop the reference taken by the lookup and the caller's one
+	hal_impl_device_release(pHalImpl, pDevice);
+	hal_impl_device_release(pHalImpl, pDevice);
 }
 
 gboolean hal_device_is_connected(hal_t* pHal, guint deviceId)
 {
 	hal_impl_t* pHalImpl = (hal_impl_t*) pHal;
 
-	g_mutex_lock(&pHalImpl->deviceTableMutex);
-	hal_impl_device_t* pDevice = g_hash_table_lookup(pHalImpl->pDeviceTable, GUINT_TO_POINTER(deviceId));
-	g_mutex_unlock(&pHalImpl->deviceTableMutex);
+	hal_impl_device_t* pDevice = hal_impl_device_lookup(pHalImpl, deviceId);
 
 	if(pDevice == NULL)
 	{
@@ -130,34 +122,66 @@ gboolean hal_device_is_connected(hal_t* pHal, guint deviceId)
 		return FALSE;
 	}
 
-	g_rec_mutex_lock(&pDevice->mutex);
-	gboolean connected = pDevice->connected;
-	g_rec_mutex_unlock(&pDevice->mutex);
+	gboolean connected = g_atomic_int_get(&pDevice->connected);
+	hal_impl_device_release(pHalImpl, pDevice);
 
 	return connected;
 }
 
-void hal_device_get_ndef(hal_t* pHal, guint deviceId, guint8** pBuffer, gsize* pBufferLength)
+GBytes* hal_device_get_ndef(hal_t* pHal, guint deviceId)
 {
 	hal_impl_t* pHalImpl = (hal_impl_t*) pHal;
 
-	g_mutex_lock(&pHalImpl->deviceTableMutex);
-	hal_impl_device_t* pDevice = g_hash_table_lookup(pHalImpl->pDeviceTable, GUINT_TO_POINTER(deviceId));
-	g_mutex_unlock(&pHalImpl->deviceTableMutex);
+	hal_impl_device_t* pDevice = hal_impl_device_lookup(pHalImpl, deviceId);
 
 	if(pDevice == NULL)
 	{
 		g_error("Did not find hal_impl_device_t instance of id %d", deviceId);
-		return;
+		return NULL;
 	}
 
-	g_rec_mutex_lock(&pDevice->mutex);
-	*pBufferLength = pDevice->message.length;
-	if(pDevice->message.buffer != NULL)
+	GBytes* pBytes = hal_impl_object_get_bytes(&pDevice->object, &pDevice->message.pBytes);
+	hal_impl_device_release(pHalImpl, pDevice);
+
+	return pBytes;
+}
+
+const nfc_device_snapshot_t* hal_device_get_snapshot(hal_t* pHal, guint deviceId)
+{
+	hal_impl_t* pHalImpl = (hal_impl_t*) pHal;
+
+	hal_impl_device_t* pDevice = hal_impl_device_lookup(pHalImpl, deviceId);
+
+	if(pDevice == NULL)
 	{
-		*pBuffer = g_memdup(pDevice->message.buffer, pDevice->message.length);
+		g_error("Did not find hal_impl_device_t instance of id %d", deviceId);
+		return NULL;
+	}
+
+	hal_impl_device_snapshot_t* pImplSnapshot = g_malloc0(sizeof(hal_impl_device_snapshot_t));
+	nfc_device_snapshot_t* pSnapshot = &pImplSnapshot->snapshot;
+	pImplSnapshot->refs = 1;
+
+	pSnapshot->deviceId = deviceId;
+
+	//Messages can be received at any time, so unlike tags the snapshot is taken on demand
+	pSnapshot->pNdef = hal_impl_object_get_bytes(&pDevice->object, &pDevice->message.pBytes);
+	hal_impl_device_release(pHalImpl, pDevice);
+
+	return pSnapshot;
+}
+
+void hal_device_snapshot_unref(const nfc_device_snapshot_t* pSnapshot)
+{
+	hal_impl_device_snapshot_t* pImplSnapshot = (hal_impl_device_snapshot_t*) pSnapshot;
+	if(g_atomic_int_dec_and_test(&pImplSnapshot->refs))
+	{
+		if(pImplSnapshot->snapshot.pNdef != NULL)
+		{
+			g_bytes_unref(pImplSnapshot->snapshot.pNdef);
+		}
+		g_free(pImplSnapshot);
 	}
-	g_rec_mutex_unlock(&pDevice->mutex);
 }
 
 void hal_device_push_ndef(hal_t* pHal, guint deviceId, guint8* buffer, gsize bufferLength)
@@ -169,27 +193,21 @@ void hal_device_push_ndef(hal_t* pHal, guint deviceId, guint8* buffer, gsize buf
 
 void hal_impl_device_disconnected(hal_impl_t* pHal, guint deviceId)
 {
-	g_mutex_lock(&pHal->deviceTableMutex);
-	hal_impl_device_t* pDevice = g_hash_table_lookup(pHal->pDeviceTable, GUINT_TO_POINTER(deviceId));
-	g_mutex_unlock(&pHal->deviceTableMutex);
+	hal_impl_device_t* pDevice = hal_impl_device_lookup(pHal, deviceId);
 
 	if(pDevice == NULL)
 	{
 		g_error("Did not find hal_impl_device_t instance of id %d", deviceId);
+		return;
 	}
-	g_rec_mutex_lock(&pDevice->mutex);
-	pDevice->connected = FALSE;
-	g_rec_mutex_unlock(&pDevice->mutex);
+	g_atomic_int_set(&pDevice->connected, FALSE);
+	hal_impl_device_release(pHal, pDevice);
 }
 
 void hal_impl_device_ndef_push(hal_impl_t* pHal, guint deviceId, guint8* buffer, gsize length)
 {
-	//Make sure tag won't get destroyed by other thread
-	hal_device_ref((hal_t*)pHal, deviceId);
-
-	g_mutex_lock(&pHal->deviceTableMutex);
-	hal_impl_device_t* pDevice = g_hash_table_lookup(pHal->pDeviceTable, GUINT_TO_POINTER(deviceId));
-	g_mutex_unlock(&pHal->deviceTableMutex);
+	//Make sure device won't get destroyed by other thread
+	hal_impl_device_t* pDevice = hal_impl_device_lookup(pHal, deviceId);
 
 	if(pDevice == NULL)
 	{
@@ -197,12 +215,7 @@ void hal_impl_device_ndef_push(hal_impl_t* pHal, guint deviceId, guint8* buffer,
 		return;
 	}
 
-	gboolean connected;
-	g_rec_mutex_lock(&pDevice->mutex);
-	connected = pDevice->connected;
-	g_rec_mutex_unlock(&pDevice->mutex);
-
-	if(connected)
+	if(g_atomic_int_get(&pDevice->connected))
 	{
 		rdlib_snep_client_send_message(pHal, deviceId, buffer, length); //TODO callback?
 	}
@@ -211,7 +224,7 @@ void hal_impl_device_ndef_push(hal_impl_t* pHal, guint deviceId, guint8* buffer,
 		g_warning("Tag is disconnected\r\n");
 	}
 
-	hal_device_unref((hal_t*)pHal, deviceId);
+	hal_impl_device_release(pHal, pDevice);
 }
 
 static void rdlib_llcp(const rdlib_llcp_t* pLlcp);
@@ -465,15 +478,14 @@ phStatus_t rdlib_snep_close(hal_impl_t* pHal)
 
 phStatus_t rdlib_snep_client_send_message(hal_impl_t* pHal, guint deviceId, guint8* buffer, gsize bufferLength)
 {
-	g_mutex_lock(&pHal->deviceTableMutex);
-	hal_impl_device_t* pDevice = g_hash_table_lookup(pHal->pDeviceTable, GUINT_TO_POINTER(deviceId));
-	g_mutex_unlock(&pHal->deviceTableMutex);
+	hal_impl_device_t* pDevice = hal_impl_device_lookup(pHal, deviceId);
 
 	if(pDevice == NULL)
 	{
 		g_warning("Did not find hal_impl_device_t instance of id %d", deviceId);
 		return PH_ERR_FAILED;
 	}
+	hal_impl_device_release(pHal, pDevice);
 
 	rdlib_snep_client_msg_t* pMsg = g_malloc(sizeof(rdlib_snep_client_msg_t));
 	pMsg->msg = g_memdup(buffer, bufferLength);
@@ -592,9 +604,7 @@ void hal_impl_snep_ndef_received_cb(hal_impl_t* pHal, guint8* buffer, gsize leng
 {
 	guint deviceId = pHal->session.currentDeviceId;
 
-	g_mutex_lock(&pHal->deviceTableMutex);
-	hal_impl_device_t* pDevice = g_hash_table_lookup(pHal->pDeviceTable, GUINT_TO_POINTER(deviceId));
-	g_mutex_unlock(&pHal->deviceTableMutex);
+	hal_impl_device_t* pDevice = hal_impl_device_lookup(pHal, deviceId);
 
 	if(pDevice == NULL)
 	{
@@ -602,16 +612,16 @@ void hal_impl_snep_ndef_received_cb(hal_impl_t* pHal, guint8* buffer, gsize leng
 		return;
 	}
 
-	g_rec_mutex_lock(&pDevice->mutex);
-	if(pDevice->message.buffer != NULL)
-	{
-		g_free(pDevice->message.buffer);
-	}
-	pDevice->message.buffer = g_memdup(buffer, length);
-	pDevice->message.length = length;
+	//Only copy made of the message, the library reuses its buffer
+	GBytes* pBytes = g_bytes_new(buffer, length);
+
+	hal_impl_object_write_begin(&pDevice->object);
+	hal_impl_object_retire(&pDevice->object, pDevice->message.pBytes);
+	g_atomic_pointer_set(&pDevice->message.pBytes, pBytes);
 	pDevice->message.size = length;
-	g_rec_mutex_unlock(&pDevice->mutex);
+	hal_impl_object_write_end(&pDevice->object);
+	hal_impl_device_release(pHal, pDevice);
 
 	//Advertise it
-	hal_impl_call_adapter_on_device_ndef_received(pHal, deviceId);
+	hal_impl_call_adapter_on_device_ndef_received(pHal, deviceId); //From the SNEP server thread
 }
@@ -18,6 +18,7 @@
 #include <glib.h>
 #include <glib/gprintf.h>
 #include <gio/gio.h>
+#include <time.h>
 
 #include "hal.h"
 
@@ -25,17 +26,26 @@
 //#include <phhwConfig.h>
 
 #define HAL_IMPL_NFC_NDEF_MESSAGE_MAX_SIZE (16*1024)
-#define HAL_POLLING_LOOP_INTERVAL 200 //Milliseconds
-#define HAL_TAG_PRESENCE_CHECK_INTERVAL 500
+#define HAL_IMPL_TAG_HEADER_SIZE 16
+#define HAL_POLLING_LOOP_INTERVAL 0 //Default time between the start of two polling cycles, 0 polls back-to-back
+#define HAL_TAG_PRESENCE_CHECK_INTERVAL 500 //Default, upper bound in adaptive mode
+#define HAL_TAG_PRESENCE_CHECK_MIN_INTERVAL 50 //Default interval right after detection in adaptive mode
 #define HAL_DEVICE_PRESENCE_CHECK_INTERVAL 200
+#define HAL_MAX_TAGS 4 //Tags handled at once in a multi-tag session
+#define HAL_PROVISIONING_PRESENCE_CHECK_INTERVAL 100 //Shorter, so that the next tag can be programmed as soon as possible
 
 #define HAL_THREAD_NAME "NFC HAL"
-#define HAL_CMD_POLLING_LOOP_START			0
-#define HAL_CMD_POLLING_LOOP_STOP  			1
-#define HAL_CMD_TAG_NDEF_WRITE	  			2
+#define HAL_QUEUE_WAIT_FOREVER G_MAXUINT32 //Timeout of hal_impl_process_queue()
+#define HAL_CMD_POLLING_LOOP_START			nfc_command_polling_loop_start
+#define HAL_CMD_POLLING_LOOP_STOP  			nfc_command_polling_loop_stop
+#define HAL_CMD_TAG_NDEF_WRITE	  			nfc_command_tag_write
 //#define HAL_CMD_DEVICE_NDEF_PUSH			3
-#define HAL_CMD_JOIN						3
 //#define HAL_CMD_INTL_DEVICE_LOST			4
+#define HAL_CMD_PROVISIONING_START			nfc_command_provisioning_start
+#define HAL_CMD_PROVISIONING_STOP			nfc_command_provisioning_stop
+#define HAL_CMD_SET_POWERED					nfc_command_set_powered
+#define HAL_CMD_JOIN						NFC_COMMAND_COUNT //Internal, not in the statistics
+#define HAL_CMD_COUNT						(NFC_COMMAND_COUNT + 1)
 
 #define HAL_CB_MODE_CHANGED					0
 #define HAL_CB_POLLING_CHANGED				1
@@ -44,6 +54,13 @@
 #define HAL_CB_DEVICE_DETECTED				4
 #define HAL_CB_DEVICE_NDEF_RECEIVED			5
 #define HAL_CB_DEVICE_LOST					6
+#define HAL_CB_TAG_WRITE_DONE				7
+#define HAL_CB_PROVISIONING_RESULT			8
+
+#define HAL_CB_BATCH_SIZE					8
+
+#define HAL_CMD_RING_SIZE					32
+#define HAL_CB_RING_SIZE					16
 
 /*
  * Reader Library Headers
@@ -144,9 +161,18 @@
 struct hal_impl;
 typedef struct hal_impl hal_impl_t;
 
+//Urgent commands cut a running discovery or P2P session short, commands still run in the order they were issued
+enum hal_impl_cmd_priority
+{
+	hal_impl_cmd_priority_normal,
+	hal_impl_cmd_priority_urgent,
+};
+typedef enum hal_impl_cmd_priority hal_impl_cmd_priority_t;
+
 struct hal_impl_cmd_info
 {
 	gint type;
+	gint64 postTime; //Set by hal_impl_call_cmd()
 	union {
 		//Polling start
 		nfc_mode_t mode;
@@ -161,7 +187,16 @@ struct hal_impl_cmd_info
 			};
 			guint8* buffer;
 			gsize bufferLength;
+			gboolean verify;
+			hal_tag_write_cb_t writeCb;
+			gpointer pWriteUserData;
 		};
+
+		//Provisioning start
+		nfc_provisioning_params_t provisioning;
+
+		//Power
+		gboolean powered;
 	};
 };
 typedef struct hal_impl_cmd_info hal_impl_cmd_info_t;
@@ -182,11 +217,72 @@ struct hal_impl_cb_info
 
 		//Polling
 		gboolean polling;
+
+		//Tag write completion
+		struct
+		{
+			guint tagId;
+			nfc_tag_write_result_t result;
+			gint64 duration;
+			gsize length;
+			gsize sent;
+			hal_tag_write_cb_t cb;
+			gpointer pUserData;
+		} write;
+
+		//Tag or device detected
+		struct
+		{
+			guint id;
+			gint64 latency; //Time between the start of the previous polling cycle and the detection
+			guint64 cycles; //Polling cycles run since polling started
+		} detected;
+
+		//Tag lost
+		struct
+		{
+			guint tagId;
+			gint64 latency; //Time between the last successful presence check and the failed one
+			guint64 checks;
+		} lost;
+
+		//Tag provisioned
+		nfc_provisioning_result_t provisioning;
 	};
 	struct hal_impl* pHal;
 };
 typedef struct hal_impl_cb_info hal_impl_cb_info_t;
 
+//Callbacks resulting from one polling loop iteration, applied at once in the remote context
+struct hal_impl_cb_batch
+{
+	guint seq; //Orders batches coming from different rings
+	gint64 postTime;
+	guint count;
+	hal_impl_cb_info_t events[HAL_CB_BATCH_SIZE];
+};
+typedef struct hal_impl_cb_batch hal_impl_cb_batch_t;
+
+//Single-producer, single-consumer ring of fixed-size elements
+struct hal_impl_ring
+{
+	guint8* elements;
+	gsize elementSize;
+	guint mask; //Number of elements - 1
+	guint head; //Written by consumer only
+	guint tail; //Written by producer only
+};
+typedef struct hal_impl_ring hal_impl_ring_t;
+
+//Producer side of callbacks, owned by a single thread
+struct hal_impl_cb_queue
+{
+	hal_impl_ring_t ring;
+	hal_impl_cb_batch_t batch; //Being filled
+	gboolean batching;
+};
+typedef struct hal_impl_cb_queue hal_impl_cb_queue_t;
+
 
 enum hal_impl_nfc_type
 {
@@ -222,9 +318,8 @@ typedef enum hal_impl_nfc_ndef_status hal_impl_nfc_ndef_status_t;
 
 struct hal_impl_nfc_ndef_message
 {
-	guint8* buffer;
+	GBytes* pBytes; //Shared with snapshots, the cache and the D-Bus objects, never modified in place
 	gsize size;
-	gsize length;
 };
 typedef struct hal_impl_nfc_ndef_message hal_impl_nfc_ndef_message_t;
 
@@ -246,32 +341,97 @@ struct hal_impl_nfc_felica_params
 };
 typedef struct hal_impl_nfc_felica_params hal_impl_nfc_felica_params_t;
 
+//Tag resolved by the discovery loop, see hal_session.c
+struct hal_impl_nfc_target
+{
+	hal_impl_nfc_type_t type;
+	guint index; //Index in the discovery loop's results
+	guint8 tech; //Technology it was found with (backend specific)
+	guint8 uid[10]; //UID, or IDm for Felica
+	gsize uidLength;
+};
+typedef struct hal_impl_nfc_target hal_impl_nfc_target_t;
+
+//Registry of tags and devices, see hal_registry.c
+#define HAL_IMPL_REGISTRY_SIZE 32
+#define HAL_IMPL_REGISTRY_INDEX(id) ((id) & (HAL_IMPL_REGISTRY_SIZE - 1))
+
+struct hal_impl_object
+{
+	guint id; //Slot index and generation
+	gint refs; //Atomic
+	guint seq; //Sequence counter of mutable fields, odd while they are being written
+	GMutex writeMutex; //Serializes writers
+	GSList* pRetired; //Buffers replaced while readers might still be copying them
+};
+typedef struct hal_impl_object hal_impl_object_t;
+
+typedef void (*hal_impl_object_clear_fn_t)(hal_impl_object_t* pObject);
+
+struct hal_impl_registry
+{
+	gsize objectSize;
+	hal_impl_object_clear_fn_t clearFn;
+	hal_impl_object_t* objects[HAL_IMPL_REGISTRY_SIZE]; //Allocated on first use, kept until the registry is cleared
+	guint freeSlots; //Bitmap, atomic
+};
+typedef struct hal_impl_registry hal_impl_registry_t;
+
 struct hal_impl_tag
 {
-	guint id;
-	gboolean connected;
+	hal_impl_object_t object; //Must be first
+
+	//Set before the tag is published, immutable afterwards
 	hal_impl_nfc_type_t type;
-	hal_impl_nfc_ndef_status_t status;
-	hal_impl_nfc_ndef_message_t message;
 	hal_impl_nfc_iso14443a_params_t iso14443a;
 	hal_impl_nfc_felica_params_t felica;
+	guint8 header[HAL_IMPL_TAG_HEADER_SIZE]; //Capability container / attribute information block, as read during NDEF check
+	gsize headerLength;
+	gsize ndefLength; //NDEF message length, as read during NDEF check
+
+	//Atomic
+	gint connected;
+	gint status; //hal_impl_nfc_ndef_status_t
+
+	//Protected by the object's sequence counter
+	hal_impl_nfc_ndef_message_t message;
+	gint64 timings[nfc_tag_timing_count];
 //	hal_impl_nfc_ndef_message_t outMessage;
-	gint refs;
-	GRecMutex mutex;
+
+	//Atomic, set once the NDEF message has been read and never replaced
+	nfc_tag_snapshot_t* pSnapshot;
 };
 typedef struct hal_impl_tag hal_impl_tag_t;
 
+struct hal_impl_tag_snapshot
+{
+	nfc_tag_snapshot_t snapshot; //Must be first
+	gint refs;
+};
+typedef struct hal_impl_tag_snapshot hal_impl_tag_snapshot_t;
+
 struct hal_impl_device
 {
-	guint id;
-	gboolean connected;
+	hal_impl_object_t object; //Must be first
+
+	//Set before the device is published, immutable afterwards
 	hal_impl_nfc_type_t type;
+
+	//Atomic
+	gint connected;
+
+	//Protected by the object's sequence counter
 	hal_impl_nfc_ndef_message_t message;
-	gint refs;
-	GRecMutex mutex;
 };
 typedef struct hal_impl_device hal_impl_device_t;
 
+struct hal_impl_device_snapshot
+{
+	nfc_device_snapshot_t snapshot; //Must be first
+	gint refs;
+};
+typedef struct hal_impl_device_snapshot hal_impl_device_snapshot_t;
+
 #define HAL_BUFFER_TX_SIZE 256
 #define HAL_BUFFER_RX_SIZE 256
 
@@ -284,6 +444,11 @@ typedef struct hal_impl_device hal_impl_device_t;
 
 #define PH_ERR_FAILED PH_ERR_ABORTED
 
+//Differential writes, see hal_tag_diff.c
+#define HAL_T2T_PAGE_SIZE 4
+#define HAL_T3T_BLOCK_SIZE 16
+#define HAL_T3T_MAX_BLOCKS_PER_WRITE 4
+
 
 struct rdlib
 {
@@ -319,6 +484,22 @@ struct rdlib
 	/* Array allocated to store LLCP General Bytes. */
 	uint8_t   aLLCPGeneralBytes[36];
 	uint8_t    bLLCPGBLength;
+
+	//Memory image of the tag in the field, so that writes only send what changed (see hal_tag_diff.c)
+	struct
+	{
+		guint tagId; //0 if unknown
+		GBytes* pMessage; //NDEF message currently on the tag
+		guint8 header[HAL_IMPL_TAG_HEADER_SIZE]; //T2T: pages 3 to 6, T3T: attribute information block
+		gboolean headerValid;
+		gboolean written; //The tag was written since it was detected, its hal_impl_tag_t header is out of date
+		gboolean topStale; //phalTop's view of the NDEF length is out of date
+	} image;
+
+	//Tags resolved by the last discovery loop run, and the one currently activated
+	hal_impl_nfc_target_t targets[HAL_MAX_TAGS];
+	guint targetCount;
+	guint activeIndex;
 };
 typedef struct rdlib rdlib_t;
 
@@ -347,9 +528,92 @@ struct rdlib_snep_client_msg
 typedef struct rdlib_snep_client_msg rdlib_snep_client_msg_t;
 
 
+/** Backend operations
+ * All accesses to the reader hardware go through this table, so that the NXP Reader
+ * Library can be swapped for another implementation (e.g. the simulated reader)
+ * Every operation is called from the HAL thread
+ */
+struct hal_impl_backend
+{
+	const gchar* name;
+
+	phStatus_t (*init)(hal_impl_t* pHal);
+	void (*close)(hal_impl_t* pHal);
+
+	phStatus_t (*loop_setup)(hal_impl_t* pHal, nfc_mode_t pollingMode);
+	phStatus_t (*loop_iteration)(hal_impl_t* pHal, hal_impl_nfc_type_t* pNFCType);
+	phStatus_t (*field_off)(hal_impl_t* pHal); //Optional
+	guint (*loop_targets)(hal_impl_t* pHal, const hal_impl_nfc_target_t** ppTargets); //Optional, tags resolved by the last successful loop_iteration
+	phStatus_t (*tag_activate)(hal_impl_t* pHal, const hal_impl_nfc_target_t* pTarget); //Optional, deactivates the current tag
+
+	phStatus_t (*tag_init)(hal_impl_t* pHal, hal_impl_tag_t* pTag);
+	phStatus_t (*tag_ndef_read)(hal_impl_t* pHal, guint tagId);
+	phStatus_t (*tag_ndef_write)(hal_impl_t* pHal, guint tagId, guint8* buffer, gsize length, gsize* pSent);
+	phStatus_t (*tag_presence_check)(hal_impl_t* pHal, guint tagId);
+	phStatus_t (*tag_lock)(hal_impl_t* pHal, guint tagId); //Optional
+	gint64 (*tag_departure)(hal_impl_t* pHal); //Optional, monotonic time the last tag actually left the field, 0 if unknown
+
+	phStatus_t (*device_execute)(hal_impl_t* pHal, hal_impl_nfc_type_t nfcType);
+
+	void (*abort)(hal_impl_t* pHal, gboolean abort); //Optional, TRUE from the main thread cuts loop_iteration or device_execute short, FALSE from the HAL thread clears a request left over
+};
+typedef struct hal_impl_backend hal_impl_backend_t;
+
+extern const hal_impl_backend_t hal_impl_backend_rdlib;
+extern const hal_impl_backend_t hal_impl_backend_sim;
+
+//Persistent cache record
+enum hal_impl_cache_record_type
+{
+	hal_impl_cache_record_entry = 1,
+	hal_impl_cache_record_removal = 2,
+};
+typedef enum hal_impl_cache_record_type hal_impl_cache_record_type_t;
+
+struct hal_impl_cache_record
+{
+	hal_impl_cache_record_type_t type;
+	const guint8* uid;
+	gsize uidLength;
+	const guint8* header;
+	gsize headerLength;
+	gsize ndefLength;
+	const guint8* ndef;
+	gsize length;
+};
+typedef struct hal_impl_cache_record hal_impl_cache_record_t;
+
+typedef struct hal_impl_cache_file hal_impl_cache_file_t;
+typedef void (*hal_impl_cache_file_load_cb_t)(const hal_impl_cache_record_t* pRecord, gpointer pUserData);
+
+struct hal_impl_cache
+{
+	guint size;
+	nfc_cache_validation_t validation;
+	GHashTable* pTable; //UID -> entry
+	GQueue lru; //Most recently used first
+
+	guint64 hits;
+	guint64 misses;
+	guint64 evictions;
+
+	hal_impl_cache_file_t* pFile; //Persistent storage (or NULL)
+
+	GMutex mutex;
+};
+typedef struct hal_impl_cache hal_impl_cache_t;
+
 struct hal_impl
 {
 	gboolean init;
+
+	//Backend
+	const hal_impl_backend_t* pBackend;
+	gpointer pBackendData;
+
+	//NDEF cache (or NULL)
+	hal_impl_cache_t* pCache;
+
 	struct
 	{
 		//HAL --> Adapter
@@ -370,22 +634,136 @@ struct hal_impl
 		guint currentDeviceId;
 
 		gboolean polling;
+
+		//Timestamps of the last polling loop iteration
+		gint64 discoveryStart;
+		gint64 discoveryEnd;
+
+		//Polling cycles run since polling started, and the start of the last one which found nothing
+		guint64 pollCycles;
+		gint64 lastPollStart;
+
+		//RF field allowed, the thread only waits for commands otherwise
+		gboolean powered;
+
+		//Tags of a multi-tag session, see hal_session.c
+		struct
+		{
+			guint tagId;
+			hal_impl_nfc_target_t target;
+		} tags[HAL_MAX_TAGS];
+		guint tagCount;
+
+		//Presence check of the tag in the field
+		guint presenceInterval;
+		guint presenceMaxInterval;
+		gint64 lastSeen;
+		guint64 presenceChecks;
 	} session;
 
-	//These can be accessed from multiple threads
-	GMutex tagTableMutex;
-	GHashTable* pTagTable;
+	//Presence check schedule, set before init
+	nfc_presence_check_params_t presenceCheck;
+
+	//Time between the start of two polling cycles in milliseconds (0 polls back-to-back), set before init
+	guint pollInterval;
 
-	GMutex deviceTableMutex;
-	GHashTable* pDeviceTable;
+	//Tags handled at once, set before init
+	guint maxTags;
+
+	//CPU time clock of the HAL thread, valid while it runs
+	struct
+	{
+		clockid_t clock;
+		gint valid;
+	} cpu;
+
+	//Tags and devices detected, main thread only
+	struct
+	{
+		guint64 count;
+		guint64 cycles;
+		guint64 latencyTotal;
+		guint64 latencyMax;
+	} detection;
+
+	//Provisioning mode
+	struct
+	{
+		//HAL thread
+		gboolean active;
+		nfc_provisioning_params_t params;
+		guint64 sequence;
+		guint64 provisioned;
+		gint64 start;
+
+		//Main thread only
+		guint64 provisionedTags;
+		guint64 failures;
+	} provisioning;
+
+	//NDEF writes, main thread only
+	struct
+	{
+		guint64 bytesWritten;
+		guint64 bytesSent;
+	} writes;
+
+	//Tags lost, main thread only
+	struct
+	{
+		guint64 count;
+		guint64 checks;
+		guint64 latencyTotal;
+		guint64 latencyMax;
+	} lost;
+
+	//These can be accessed from multiple threads
+	hal_impl_registry_t tags;
+	hal_impl_registry_t devices;
 	//End
 
 	//Main thread
 	GThread* pThread;
 	gboolean joining;
 
+	//Commands, main thread --> HAL thread
+	struct
+	{
+		hal_impl_ring_t ring;
+		int notifyFd;
+		gint urgent; //Atomic, urgent commands issued but not run yet
+
+		//Discovery or P2P session running, see hal_impl_preemptible_begin()
+		GMutex preemptMutex;
+		gboolean preemptible;
+		gboolean preempted;
+
+		//HAL thread only
+		struct
+		{
+			guint64 count;
+			guint64 latencyTotal;
+			guint64 latencyMax;
+		} stats[HAL_CMD_COUNT];
+		guint64 preemptions;
+	} commands;
+
+	//Callbacks, HAL thread and SNEP server thread --> main thread
+	struct
+	{
+		hal_impl_cb_queue_t hal;
+		hal_impl_cb_queue_t snep;
+		guint seq;
+		int notifyFd;
+		GSource* pSource;
+
+		//Main thread only
+		guint64 dispatched;
+		guint64 latencyTotal;
+		guint64 latencyMax;
+	} callbacks;
+
 	//Queues
-	GAsyncQueue* pHalQueue;
 	GAsyncQueue* pSnepQueue;
 
 	//LLCP thread
@@ -409,6 +787,7 @@ struct hal_impl
 		hal_adapter_on_device_detected_cb_t onDeviceDetectedCb;
 		hal_adapter_on_device_ndef_received_cb_t onDeviceNDEFReceivedCb;
 		hal_adapter_on_device_lost_cb_t onDeviceLostCb;
+		hal_adapter_on_provisioning_result_cb_t onProvisioningResultCb;
 		GObject* pAdapterObject;
 		GRecMutex mutex;
 	} adapter;
@@ -419,11 +798,47 @@ struct hal_impl
 };
 typedef struct hal_impl hal_impl_t;
 
+void hal_impl_registry_init(hal_impl_registry_t* pRegistry, gsize objectSize, hal_impl_object_clear_fn_t clearFn);
+void hal_impl_registry_clear(hal_impl_registry_t* pRegistry);
+hal_impl_object_t* hal_impl_registry_alloc(hal_impl_registry_t* pRegistry);
+void hal_impl_registry_publish(hal_impl_registry_t* pRegistry, hal_impl_object_t* pObject);
+void hal_impl_registry_discard(hal_impl_registry_t* pRegistry, hal_impl_object_t* pObject);
+hal_impl_object_t* hal_impl_registry_ref(hal_impl_registry_t* pRegistry, guint id);
+void hal_impl_registry_unref(hal_impl_registry_t* pRegistry, hal_impl_object_t* pObject);
+void hal_impl_object_write_begin(hal_impl_object_t* pObject);
+void hal_impl_object_write_end(hal_impl_object_t* pObject);
+guint hal_impl_object_read_begin(hal_impl_object_t* pObject);
+gboolean hal_impl_object_read_retry(hal_impl_object_t* pObject, guint seq);
+void hal_impl_ring_init(hal_impl_ring_t* pRing, guint count, gsize elementSize);
+void hal_impl_ring_clear(hal_impl_ring_t* pRing);
+gboolean hal_impl_ring_push(hal_impl_ring_t* pRing, gconstpointer pElement);
+gpointer hal_impl_ring_peek(hal_impl_ring_t* pRing);
+void hal_impl_ring_drop(hal_impl_ring_t* pRing);
+gboolean hal_impl_ring_pop(hal_impl_ring_t* pRing, gpointer pElement);
+int hal_impl_notifier_new();
+void hal_impl_notifier_free(int fd);
+void hal_impl_notifier_signal(int fd);
+void hal_impl_notifier_consume(int fd);
+gboolean hal_impl_notifier_wait(int fd, gint timeout);
+
+void hal_impl_object_retire(hal_impl_object_t* pObject, GBytes* pBytes);
+GBytes* hal_impl_object_get_bytes(hal_impl_object_t* pObject, GBytes* const* ppBytes);
+
 int hal_impl_tag_new(hal_impl_t* pHal, hal_impl_nfc_type_t nfcType, guint* pTagId);
+hal_impl_tag_t* hal_impl_tag_lookup(hal_impl_t* pHal, guint tagId);
+void hal_impl_tag_release(hal_impl_t* pHal, hal_impl_tag_t* pTag);
+void hal_impl_tag_clear(hal_impl_object_t* pObject);
+void hal_impl_tag_set_message(hal_impl_tag_t* pTag, GBytes* pBytes);
+void hal_impl_tag_take_snapshot(hal_impl_t* pHal, guint tagId);
 void hal_impl_tag_disconnected(hal_impl_t* pHal, guint tagId);
-void hal_impl_tag_ndef_write(hal_impl_t* pHal, guint tagId, guint8* buffer, gsize length);
+void hal_impl_tag_ndef_write(hal_impl_t* pHal, const hal_impl_cmd_info_t* pCmdInfo);
+nfc_tag_write_result_t hal_impl_tag_ndef_verify(hal_impl_t* pHal, hal_impl_tag_t* pTag, const guint8* buffer, gsize length);
+void hal_impl_tag_set_timing(hal_impl_t* pHal, guint tagId, nfc_tag_timing_t timing, gint64 time);
 
 int hal_impl_device_new(hal_impl_t* pHal, hal_impl_nfc_type_t nfcType, guint* pDeviceId);
+hal_impl_device_t* hal_impl_device_lookup(hal_impl_t* pHal, guint deviceId);
+void hal_impl_device_release(hal_impl_t* pHal, hal_impl_device_t* pDevice);
+void hal_impl_device_clear(hal_impl_object_t* pObject);
 void hal_impl_device_disconnected(hal_impl_t* pHal, guint deviceId);
 void hal_impl_device_ndef_push(hal_impl_t* pHal, guint deviceId, guint8* buffer, gsize length);
 
@@ -434,10 +849,23 @@ phStatus_t rdlib_llcp_reset(hal_impl_t* pHal);
 void rdlib_close(hal_impl_t* pHal);
 phStatus_t rdlib_loop_setup(hal_impl_t* pHal, nfc_mode_t pollingMode);
 phStatus_t rdlib_loop_iteration(hal_impl_t* pHal, hal_impl_nfc_type_t* pNFCType);
+phStatus_t rdlib_field_off(hal_impl_t* pHal);
+void rdlib_abort(hal_impl_t* pHal, gboolean abort);
+guint rdlib_loop_targets(hal_impl_t* pHal, const hal_impl_nfc_target_t** ppTargets);
 
+phStatus_t rdlib_device_execute(hal_impl_t* pHal, hal_impl_nfc_type_t nfcType);
+
+phStatus_t rdlib_tag_init(hal_impl_t* pHal, hal_impl_tag_t* pTag);
+phStatus_t rdlib_tag_activate(hal_impl_t* pHal, const hal_impl_nfc_target_t* pTarget);
+void rdlib_tag_read_header(hal_impl_t* pHal, hal_impl_tag_t* pTag);
 phStatus_t rdlib_tag_ndef_read(hal_impl_t* pHal, guint tagId);
-phStatus_t rdlib_tag_ndef_write(hal_impl_t* pHal, guint tagId, guint8* buffer, gsize length);
+phStatus_t rdlib_tag_ndef_write(hal_impl_t* pHal, guint tagId, guint8* buffer, gsize length, gsize* pSent);
+phStatus_t rdlib_tag_ndef_write_diff(hal_impl_t* pHal, hal_impl_tag_t* pTag, guint8* buffer, gsize length, gsize* pSent);
+phStatus_t rdlib_tag_read_header_block(hal_impl_t* pHal, hal_impl_nfc_type_t type, guint8* header);
+void rdlib_tag_image_set(hal_impl_t* pHal, guint tagId, GBytes* pMessage);
+void rdlib_tag_image_clear(hal_impl_t* pHal);
 phStatus_t rdlib_tag_presence_check(hal_impl_t* pHal, guint tagId);
+phStatus_t rdlib_tag_lock(hal_impl_t* pHal, guint tagId);
 
 phStatus_t rdlib_llcp_execute(hal_impl_t* pHal, uint8_t* pGeneralBytes, size_t generalBytesSz, uint8_t bDevType);
 //phStatus_t rdlib_llcp_close(hal_impl_t* pHal);
@@ -446,29 +874,66 @@ phStatus_t rdlib_snep_init(hal_impl_t* pHal);
 phStatus_t rdlib_snep_close(hal_impl_t* pHal);
 phStatus_t rdlib_snep_client_send_message(hal_impl_t* pHal, guint deviceId, guint8* buffer, gsize bufferLength);
 
+gpointer sim_load(const gchar* scriptFile);
+
+hal_impl_cache_t* hal_impl_cache_new(guint size, nfc_cache_validation_t validation);
+void hal_impl_cache_free(hal_impl_cache_t* pCache);
+gboolean hal_impl_cache_lookup(hal_impl_t* pHal, guint tagId);
+void hal_impl_cache_store(hal_impl_t* pHal, guint tagId);
+void hal_impl_cache_invalidate(hal_impl_t* pHal, guint tagId);
+void hal_impl_cache_get_statistics(hal_impl_cache_t* pCache, nfc_statistics_t* pStatistics);
+gboolean hal_impl_cache_attach_file(hal_impl_cache_t* pCache, const gchar* path, gsize size);
+
+hal_impl_cache_file_t* hal_impl_cache_file_open(const gchar* path, gsize size,
+		hal_impl_cache_file_load_cb_t loadCb, gpointer pUserData);
+void hal_impl_cache_file_close(hal_impl_cache_file_t* pFile);
+gboolean hal_impl_cache_file_append(hal_impl_cache_file_t* pFile, const hal_impl_cache_record_t* pRecord);
+gboolean hal_impl_cache_file_rewrite(hal_impl_cache_file_t* pFile, GPtrArray* pRecords);
+
 void hal_impl_polling_loop_start(hal_impl_t* pHalImpl, nfc_mode_t mode);
 void hal_impl_polling_loop_stop(hal_impl_t* pHalImpl);
 gboolean hal_impl_polling_loop_iteration_fn(hal_impl_t* pHalImpl);
+void hal_impl_tag_presence_begin(hal_impl_t* pHalImpl, hal_impl_nfc_type_t nfcType);
+void hal_impl_tag_read(hal_impl_t* pHalImpl, guint tagId);
 gboolean hal_impl_tag_present_fn(hal_impl_t* pHalImpl);
+void hal_impl_tag_lost(hal_impl_t* pHalImpl, gint64 now);
+gint64 hal_impl_tag_lost_latency(hal_impl_t* pHalImpl, gint64 now);
+void hal_impl_polling_loop_idle(hal_impl_t* pHalImpl);
+void hal_impl_set_powered(hal_impl_t* pHalImpl, gboolean powered);
 //gboolean hal_impl_device_present_fn(gpointer pData);
 void hal_impl_device_lost(hal_impl_t* pHal);
 
+void hal_impl_provisioning_start(hal_impl_t* pHal, const nfc_provisioning_params_t* pParams);
+void hal_impl_provisioning_stop(hal_impl_t* pHal);
+void hal_impl_provisioning_tag(hal_impl_t* pHal, guint tagId);
+
+gboolean hal_impl_session_enabled(hal_impl_t* pHal);
+gboolean hal_impl_session_run(hal_impl_t* pHal, hal_impl_nfc_type_t nfcType);
+gboolean hal_impl_session_select(hal_impl_t* pHal, guint tagId);
+
 void hal_impl_update_polling(hal_impl_t* pHal, gboolean polling);
 void hal_impl_update_mode(hal_impl_t* pHal, nfc_mode_t mode);
 
 void hal_impl_call_adapter_on_mode_changed(hal_impl_t* pHal, nfc_mode_t mode);
 void hal_impl_call_adapter_on_polling_changed(hal_impl_t* pHal, gboolean polling);
 void hal_impl_call_adapter_on_tag_detected(hal_impl_t* pHal, guint tagId);
-void hal_impl_call_adapter_on_tag_lost(hal_impl_t* pHal, guint tagId);
+void hal_impl_call_adapter_on_tag_lost(hal_impl_t* pHal, guint tagId, gint64 latency, guint64 checks);
 void hal_impl_call_adapter_on_device_detected(hal_impl_t* pHal, guint deviceId);
 void hal_impl_call_adapter_on_device_ndef_received(hal_impl_t* pHal, guint deviceId);
 void hal_impl_call_adapter_on_device_lost(hal_impl_t* pHal, guint deviceId);
+void hal_impl_call_tag_write_cb(hal_impl_t* pHal, guint tagId, nfc_tag_write_result_t result, gint64 duration,
+		gsize length, gsize sent, hal_tag_write_cb_t writeCb, gpointer pUserData);
+void hal_impl_call_adapter_on_provisioning_result(hal_impl_t* pHal, const nfc_provisioning_result_t* pResult);
 
-void hal_impl_call_cb(hal_impl_t* pHal, hal_impl_cb_info_t* pCbInfo);
-gboolean hal_impl_call_remote_context(gpointer pData);
+void hal_impl_batch_begin(hal_impl_t* pHal);
+void hal_impl_batch_end(hal_impl_t* pHal);
+void hal_impl_call_cb(hal_impl_t* pHal, hal_impl_cb_queue_t* pQueue, const hal_impl_cb_info_t* pCbInfo);
+void hal_impl_call_remote_context(hal_impl_t* pHal, const hal_impl_cb_batch_t* pBatch);
 
-void hal_impl_call_cmd(hal_impl_t* pHal, hal_impl_cmd_info_t* pCmdInfo);
+gboolean hal_impl_call_cmd(hal_impl_t* pHal, const hal_impl_cmd_info_t* pCmdInfo);
 gboolean hal_impl_process_queue(hal_impl_t* pHal, guint32 timeout);
+gboolean hal_impl_preemptible_begin(hal_impl_t* pHal); //FALSE if an urgent command is waiting, do not start then
+gboolean hal_impl_preemptible_end(hal_impl_t* pHal); //TRUE if an urgent command cut it short
 
 gpointer hal_impl_thread_fn(gpointer param);
 
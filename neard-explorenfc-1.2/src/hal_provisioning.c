@@ -0,0 +1,181 @@
+/*
+*         Copyright (c), NXP Semiconductors Gratkorn / Austria
+*
+*                     (C)NXP Semiconductors
+*       All rights are reserved. Reproduction in whole or in part is
+*      prohibited without the written consent of the copyright owner.
+*  NXP reserves the right to make changes without notice at any time.
+* NXP makes no warranty, expressed, implied or statutory, including but
+* not limited to any implied warranty of merchantability or fitness for any
+*particular purpose, or that the use will not infringe any third party patent,
+* copyright or trademark. NXP must not be liable for any loss or damage
+*                          arising from its use.
+*/
+/**
+ * \file hal_provisioning.c
+ * Provisioning mode: tags are programmed by the HAL thread as soon as they are detected
+ *
+ * The message is rendered, written, optionally read back and locked without
+ * going through the main loop, and the tag is never advertised to the adapter.
+ * Only the outcome is posted, so that the main loop stays out of the critical path
+ * and the polling loop resumes as soon as the tag leaves the field.
+ */
+
+#include "hal.h"
+#include "hal_internal.h"
+
+#include <glib.h>
+#include <glib/gprintf.h>
+#include <gio/gio.h>
+
+static void hal_impl_provisioning_release_params(hal_impl_t* pHal)
+{
+	if( pHal->provisioning.params.renderDataDestroy != NULL )
+	{
+		pHal->provisioning.params.renderDataDestroy(pHal->provisioning.params.pRenderData);
+	}
+	memset(&pHal->provisioning.params, 0, sizeof(nfc_provisioning_params_t));
+}
+
+void hal_impl_provisioning_start(hal_impl_t* pHal, const nfc_provisioning_params_t* pParams)
+{
+	//Replace previous parameters, if any
+	hal_impl_provisioning_release_params(pHal);
+
+	pHal->provisioning.params = *pParams;
+	pHal->provisioning.sequence = pParams->sequenceStart;
+	pHal->provisioning.provisioned = 0;
+	pHal->provisioning.start = g_get_monotonic_time();
+	pHal->provisioning.active = TRUE;
+
+	g_info("Provisioning started");
+
+	//Nothing happens until tags are polled for
+	hal_impl_polling_loop_start(pHal, nfc_mode_initiator);
+}
+
+void hal_impl_provisioning_stop(hal_impl_t* pHal)
+{
+	if( pHal->provisioning.active )
+	{
+		g_info("Provisioning stopped, %" G_GUINT64_FORMAT " tag(s) programmed", pHal->provisioning.provisioned);
+	}
+
+	pHal->provisioning.active = FALSE;
+	hal_impl_provisioning_release_params(pHal);
+}
+
+static nfc_tag_write_result_t hal_impl_provisioning_write(hal_impl_t* pHal, hal_impl_tag_t* pTag,
+		nfc_provisioning_result_t* pResult)
+{
+	guint tagId = pTag->object.id;
+
+	if( g_atomic_int_get(&pTag->status) == hal_impl_nfc_ndef_status_readonly )
+	{
+		g_warning("Tag is read only");
+		return nfc_tag_write_read_only;
+	}
+
+	GBytes* pBytes = pHal->provisioning.params.renderCb(pResult->uid, pResult->uidLength, pResult->sequence,
+			pHal->provisioning.params.pRenderData);
+	if( pBytes == NULL )
+	{
+		g_warning("Could not render message for tag %" G_GUINT64_FORMAT, pResult->sequence);
+		return nfc_tag_write_failed;
+	}
+
+	gsize length;
+	guint8* buffer = (guint8*)g_bytes_get_data(pBytes, &length);
+
+	nfc_tag_write_result_t result = nfc_tag_write_success;
+	pResult->length = length;
+	phStatus_t status = pHal->pBackend->tag_ndef_write(pHal, tagId, buffer, length, &pResult->bytesSent);
+
+	//Whatever the outcome, the cached message cannot be trusted anymore
+	hal_impl_cache_invalidate(pHal, tagId);
+
+	if( status != PH_ERR_SUCCESS )
+	{
+		result = nfc_tag_write_failed;
+	}
+	else if( pHal->provisioning.params.verify )
+	{
+		result = hal_impl_tag_ndef_verify(pHal, pTag, buffer, length);
+	}
+
+	g_bytes_unref(pBytes);
+
+	if( (result == nfc_tag_write_success) && pHal->provisioning.params.lock )
+	{
+		if( (pHal->pBackend->tag_lock == NULL) || (pHal->pBackend->tag_lock(pHal, tagId) != PH_ERR_SUCCESS) )
+		{
+			result = nfc_tag_write_lock_failed;
+		}
+	}
+
+	return result;
+}
+
+void hal_impl_provisioning_tag(hal_impl_t* pHal, guint tagId)
+{
+	nfc_provisioning_result_t result;
+	memset(&result, 0, sizeof(nfc_provisioning_result_t));
+
+	gint64 start = g_get_monotonic_time();
+
+	hal_impl_tag_t* pTag = hal_impl_tag_lookup(pHal, tagId);
+
+	if(pTag == NULL)
+	{
+		g_error("Did not find hal_impl_tag_t instance of id %d", tagId);
+		return;
+	}
+
+	//Identify the tag, the UID is what templates usually key on
+	if( HAL_IMPL_NFC_TYPE_IS_TAG_ISO14443A(pTag->type) )
+	{
+		memcpy(result.uid, pTag->iso14443a.uid, pTag->iso14443a.uidLength);
+		result.uidLength = pTag->iso14443a.uidLength;
+	}
+	else if( HAL_IMPL_NFC_TYPE_IS_TAG_FELICA(pTag->type) )
+	{
+		//IDm
+		memcpy(&result.uid[0], pTag->felica.manufacturer, 2);
+		memcpy(&result.uid[2], pTag->felica.cid, 6);
+		result.uidLength = 8;
+	}
+
+	result.sequence = pHal->provisioning.sequence;
+	result.result = hal_impl_provisioning_write(pHal, pTag, &result);
+
+	hal_impl_tag_release(pHal, pTag);
+
+	if( result.result == nfc_tag_write_success )
+	{
+		pHal->provisioning.sequence++;
+		pHal->provisioning.provisioned++;
+	}
+
+	gint64 end = g_get_monotonic_time();
+	result.duration = end - start;
+	result.provisioned = pHal->provisioning.provisioned;
+	result.elapsed = end - pHal->provisioning.start;
+
+	//Report right away, the operator does not have to wait for the tag to be removed
+	hal_impl_call_adapter_on_provisioning_result(pHal, &result);
+
+	//Keep serving commands until the tag leaves the field, so that it is not programmed twice
+	//(a stopped provisioning or a shutdown does not wait for it)
+	pHal->session.tagOrDevicePresent = TRUE;
+	do
+	{
+		hal_impl_process_queue(pHal, HAL_PROVISIONING_PRESENCE_CHECK_INTERVAL);
+	} while( pHal->session.powered && pHal->provisioning.active && !pHal->joining
+			&& (pHal->pBackend->tag_presence_check(pHal, tagId) == PH_ERR_SUCCESS) );
+
+	hal_impl_tag_disconnected(pHal, tagId);
+	hal_tag_unref((hal_t*)pHal, tagId);
+	pHal->session.tagOrDevicePresent = FALSE;
+
+	//The polling loop is still configured and running, the next tag is picked up by the following iteration
+}
@@ -0,0 +1,225 @@
+/*
+*         Copyright (c), NXP Semiconductors Gratkorn / Austria
+*
+*                     (C)NXP Semiconductors
+*       All rights are reserved. Reproduction in whole or in part is
+*      prohibited without the written consent of the copyright owner.
+*  NXP reserves the right to make changes without notice at any time.
+* NXP makes no warranty, expressed, implied or statutory, including but
+* not limited to any implied warranty of merchantability or fitness for any
+*particular purpose, or that the use will not infringe any third party patent,
+* copyright or trademark. NXP must not be liable for any loss or damage
+*                          arising from its use.
+*/
+/**
+ * \file hal_registry.c
+ * Registry of tags and devices shared between the HAL thread and the main thread
+ *
+ * Objects live in a fixed array of slots. An id is made of the slot index in its
+ * lower bits and of a generation count in its upper bits, which is increased
+ * every time the slot is reused, so that a stale id never resolves to a newer
+ * object. Free slots are tracked in a bitmap, making allocation O(1).
+ *
+ * Slot memory is never freed while the registry exists, so a lookup only needs
+ * to take a reference with a compare-and-swap (which fails once the count has
+ * dropped to 0) and then check the id: no lock is involved.
+ *
+ * Fields set before an object is published are immutable afterwards. Fields
+ * which change later are either atomic or protected by the object's sequence
+ * counter: writers are serialized by a mutex, readers never block and simply
+ * retry if a write happened while they were copying. Buffers replaced by a
+ * writer are kept until the object is released, so that a reader taking a
+ * reference to them concurrently does not access freed memory.
+ */
+
+#include "hal.h"
+#include "hal_internal.h"
+
+#include <string.h>
+
+#include <glib.h>
+#include <glib/gprintf.h>
+#include <gio/gio.h>
+
+void hal_impl_registry_init(hal_impl_registry_t* pRegistry, gsize objectSize, hal_impl_object_clear_fn_t clearFn)
+{
+	pRegistry->objectSize = objectSize;
+	pRegistry->clearFn = clearFn;
+	memset(pRegistry->objects, 0, sizeof(pRegistry->objects));
+	pRegistry->freeSlots = 0xFFFFFFFFU;
+}
+
+void hal_impl_registry_clear(hal_impl_registry_t* pRegistry)
+{
+	for(guint index = 0; index < HAL_IMPL_REGISTRY_SIZE; index++)
+	{
+		hal_impl_object_t* pObject = pRegistry->objects[index];
+		if(pObject == NULL)
+		{
+			continue;
+		}
+
+		if(pObject->refs > 0)
+		{
+			pRegistry->clearFn(pObject);
+		}
+		g_slist_free_full(pObject->pRetired, (GDestroyNotify)g_bytes_unref);
+		g_mutex_clear(&pObject->writeMutex);
+		g_free(pObject);
+		pRegistry->objects[index] = NULL;
+	}
+}
+
+hal_impl_object_t* hal_impl_registry_alloc(hal_impl_registry_t* pRegistry)
+{
+	//Reserve a free slot
+	guint freeSlots;
+	gint index;
+	do
+	{
+		freeSlots = g_atomic_int_get(&pRegistry->freeSlots);
+		index = g_bit_nth_lsf(freeSlots, -1);
+		if(index < 0)
+		{
+			return NULL;
+		}
+	} while(!g_atomic_int_compare_and_exchange((gint*)&pRegistry->freeSlots, (gint)freeSlots, (gint)(freeSlots & ~(1U << index))));
+
+	hal_impl_object_t* pObject = g_atomic_pointer_get(&pRegistry->objects[index]);
+	if(pObject == NULL)
+	{
+		pObject = g_malloc0(pRegistry->objectSize);
+		pObject->id = index;
+		g_mutex_init(&pObject->writeMutex);
+		g_atomic_pointer_set(&pRegistry->objects[index], pObject);
+	}
+	else
+	{
+		//Reset everything but the header
+		memset((guint8*)pObject + sizeof(hal_impl_object_t), 0, pRegistry->objectSize - sizeof(hal_impl_object_t));
+		g_atomic_int_set((gint*)&pObject->id, pObject->id + HAL_IMPL_REGISTRY_SIZE);
+	}
+
+	return pObject;
+}
+
+void hal_impl_registry_publish(hal_impl_registry_t* pRegistry, hal_impl_object_t* pObject)
+{
+	//From now on lookups can succeed
+	g_atomic_int_set(&pObject->refs, 1);
+}
+
+void hal_impl_registry_discard(hal_impl_registry_t* pRegistry, hal_impl_object_t* pObject)
+{
+	//Object was never published
+	g_atomic_int_or(&pRegistry->freeSlots, 1U << HAL_IMPL_REGISTRY_INDEX(pObject->id));
+}
+
+hal_impl_object_t* hal_impl_registry_ref(hal_impl_registry_t* pRegistry, guint id)
+{
+	hal_impl_object_t* pObject = g_atomic_pointer_get(&pRegistry->objects[HAL_IMPL_REGISTRY_INDEX(id)]);
+	if(pObject == NULL)
+	{
+		return NULL;
+	}
+
+	//Only take a reference if the object is still alive
+	gint refs;
+	do
+	{
+		refs = g_atomic_int_get(&pObject->refs);
+		if(refs == 0)
+		{
+			return NULL;
+		}
+	} while(!g_atomic_int_compare_and_exchange(&pObject->refs, refs, refs + 1));
+
+	//The slot might have been reused in the meantime
+	if(g_atomic_int_get((gint*)&pObject->id) != (gint)id)
+	{
+		hal_impl_registry_unref(pRegistry, pObject);
+		return NULL;
+	}
+
+	return pObject;
+}
+
+void hal_impl_registry_unref(hal_impl_registry_t* pRegistry, hal_impl_object_t* pObject)
+{
+	if(!g_atomic_int_dec_and_test(&pObject->refs))
+	{
+		return;
+	}
+
+	//No one is using the object anymore, so free its content and give the slot back
+	pRegistry->clearFn(pObject);
+
+	g_slist_free_full(pObject->pRetired, (GDestroyNotify)g_bytes_unref);
+	pObject->pRetired = NULL;
+
+	g_atomic_int_or(&pRegistry->freeSlots, 1U << HAL_IMPL_REGISTRY_INDEX(pObject->id));
+}
+
+void hal_impl_object_write_begin(hal_impl_object_t* pObject)
+{
+	g_mutex_lock(&pObject->writeMutex);
+	g_atomic_int_inc((gint*)&pObject->seq);
+}
+
+void hal_impl_object_write_end(hal_impl_object_t* pObject)
+{
+	g_atomic_int_inc((gint*)&pObject->seq);
+	g_mutex_unlock(&pObject->writeMutex);
+}
+
+guint hal_impl_object_read_begin(hal_impl_object_t* pObject)
+{
+	guint seq;
+	while((seq = g_atomic_int_get((gint*)&pObject->seq)) & 1)
+	{
+		//Write in progress
+		g_thread_yield();
+	}
+	return seq;
+}
+
+gboolean hal_impl_object_read_retry(hal_impl_object_t* pObject, guint seq)
+{
+	return (guint)g_atomic_int_get((gint*)&pObject->seq) != seq;
+}
+
+void hal_impl_object_retire(hal_impl_object_t* pObject, GBytes* pBytes)
+{
+	//Must be called between hal_impl_object_write_begin() and hal_impl_object_write_end()
+	if(pBytes != NULL)
+	{
+		pObject->pRetired = g_slist_prepend(pObject->pRetired, pBytes);
+	}
+}
+
+GBytes* hal_impl_object_get_bytes(hal_impl_object_t* pObject, GBytes* const* ppBytes)
+{
+	GBytes* pBytes;
+	guint seq;
+	do
+	{
+		seq = hal_impl_object_read_begin(pObject);
+		pBytes = g_atomic_pointer_get(ppBytes);
+		//Even if the field is replaced in the meantime, the old value is retired and stays valid
+		if(pBytes != NULL)
+		{
+			g_bytes_ref(pBytes);
+		}
+		if( hal_impl_object_read_retry(pObject, seq) )
+		{
+			if(pBytes != NULL)
+			{
+				g_bytes_unref(pBytes);
+			}
+			continue;
+		}
+		break;
+	} while(TRUE);
+
+	return pBytes;
+}
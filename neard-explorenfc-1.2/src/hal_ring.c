@@ -0,0 +1,148 @@
+/*
+*         Copyright (c), NXP Semiconductors Gratkorn / Austria
+*
+*                     (C)NXP Semiconductors
+*       All rights are reserved. Reproduction in whole or in part is
+*      prohibited without the written consent of the copyright owner.
+*  NXP reserves the right to make changes without notice at any time.
+* NXP makes no warranty, expressed, implied or statutory, including but
+* not limited to any implied warranty of merchantability or fitness for any
+*particular purpose, or that the use will not infringe any third party patent,
+* copyright or trademark. NXP must not be liable for any loss or damage
+*                          arising from its use.
+*/
+/**
+ * \file hal_ring.c
+ * Rings used to pass commands and callbacks between the HAL thread and the main loop
+ *
+ * A ring is a preallocated array of fixed-size elements with one producer
+ * thread and one consumer thread. The producer only writes the tail index and
+ * the consumer only writes the head index, so neither side takes a lock and
+ * no memory is allocated once the ring exists.
+ *
+ * Rings do not wake up their consumer by themselves: the producer signals an
+ * eventfd after pushing, which the consumer either polls directly or watches
+ * from a GSource.
+ */
+
+#include "hal.h"
+#include "hal_internal.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+#include <glib.h>
+#include <glib/gprintf.h>
+#include <gio/gio.h>
+
+void hal_impl_ring_init(hal_impl_ring_t* pRing, guint count, gsize elementSize)
+{
+	//Indexes wrap around with a mask
+	g_assert( (count != 0) && ((count & (count - 1)) == 0) );
+
+	pRing->elements = g_malloc0(count * elementSize);
+	pRing->elementSize = elementSize;
+	pRing->mask = count - 1;
+	pRing->head = 0;
+	pRing->tail = 0;
+}
+
+void hal_impl_ring_clear(hal_impl_ring_t* pRing)
+{
+	g_free(pRing->elements);
+	pRing->elements = NULL;
+}
+
+gboolean hal_impl_ring_push(hal_impl_ring_t* pRing, gconstpointer pElement)
+{
+	//Producer only
+	guint tail = (guint)g_atomic_int_get((gint*)&pRing->tail);
+	guint head = (guint)g_atomic_int_get((gint*)&pRing->head);
+	if( tail - head > pRing->mask )
+	{
+		return FALSE; //Full
+	}
+
+	memcpy(&pRing->elements[(tail & pRing->mask) * pRing->elementSize], pElement, pRing->elementSize);
+
+	//Publish the element
+	g_atomic_int_set((gint*)&pRing->tail, (gint)(tail + 1));
+	return TRUE;
+}
+
+gpointer hal_impl_ring_peek(hal_impl_ring_t* pRing)
+{
+	//Consumer only
+	guint head = (guint)g_atomic_int_get((gint*)&pRing->head);
+	guint tail = (guint)g_atomic_int_get((gint*)&pRing->tail);
+	if( head == tail )
+	{
+		return NULL; //Empty
+	}
+
+	return &pRing->elements[(head & pRing->mask) * pRing->elementSize];
+}
+
+void hal_impl_ring_drop(hal_impl_ring_t* pRing)
+{
+	//Consumer only, give the slot returned by hal_impl_ring_peek() back to the producer
+	guint head = (guint)g_atomic_int_get((gint*)&pRing->head);
+	g_atomic_int_set((gint*)&pRing->head, (gint)(head + 1));
+}
+
+gboolean hal_impl_ring_pop(hal_impl_ring_t* pRing, gpointer pElement)
+{
+	gpointer pSlot = hal_impl_ring_peek(pRing);
+	if( pSlot == NULL )
+	{
+		return FALSE;
+	}
+
+	memcpy(pElement, pSlot, pRing->elementSize);
+	hal_impl_ring_drop(pRing);
+	return TRUE;
+}
+
+int hal_impl_notifier_new()
+{
+	int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if( fd < 0 )
+	{
+		g_error("Could not create eventfd: %s", g_strerror(errno));
+	}
+	return fd;
+}
+
+void hal_impl_notifier_free(int fd)
+{
+	close(fd);
+}
+
+void hal_impl_notifier_signal(int fd)
+{
+	guint64 value = 1;
+	while( (write(fd, &value, sizeof(value)) < 0) && (errno == EINTR) );
+}
+
+void hal_impl_notifier_consume(int fd)
+{
+	//Reset the counter, consumer must then empty the ring(s) it watches
+	guint64 value;
+	while( (read(fd, &value, sizeof(value)) < 0) && (errno == EINTR) );
+}
+
+gboolean hal_impl_notifier_wait(int fd, gint timeout)
+{
+	struct pollfd pfd;
+	pfd.fd = fd;
+	pfd.events = POLLIN;
+	pfd.revents = 0;
+
+	int ret;
+	while( ((ret = poll(&pfd, 1, timeout)) < 0) && (errno == EINTR) );
+
+	return ret > 0;
+}
@@ -0,0 +1,240 @@
+/*
+*         Copyright (c), NXP Semiconductors Gratkorn / Austria
+*
+*                     (C)NXP Semiconductors
+*       All rights are reserved. Reproduction in whole or in part is
+*      prohibited without the written consent of the copyright owner.
+*  NXP reserves the right to make changes without notice at any time.
+* NXP makes no warranty, expressed, implied or statutory, including but
+* not limited to any implied warranty of merchantability or fitness for any
+*particular purpose, or that the use will not infringe any third party patent,
+* copyright or trademark. NXP must not be liable for any loss or damage
+*                          arising from its use.
+*/
+/**
+ * \file hal_session.c
+ * Multi-tag sessions: several tags of the same technology share the field
+ *
+ * Every tag resolved by the discovery loop is activated in turn and read while the
+ * field stays on, then advertised to the adapter. Instead of checking the presence of
+ * each tag, the discovery loop is run again on the presence check schedule: tags it
+ * does not find anymore are reported lost and the ones brought in since are read.
+ * The session ends, and polling can resume, once the last tag has left.
+ */
+
+#include "hal.h"
+#include "hal_internal.h"
+
+#include <glib.h>
+#include <glib/gprintf.h>
+#include <gio/gio.h>
+
+gboolean hal_impl_session_enabled(hal_impl_t* pHal)
+{
+	//Provisioning programs tags one at a time
+	return (pHal->maxTags > 1) && (pHal->pBackend->loop_targets != NULL) && (pHal->pBackend->tag_activate != NULL)
+			&& !pHal->provisioning.active;
+}
+
+static gboolean hal_impl_session_target_equal(const hal_impl_nfc_target_t* pTarget1, const hal_impl_nfc_target_t* pTarget2)
+{
+	return (pTarget1->type == pTarget2->type) && (pTarget1->uidLength == pTarget2->uidLength)
+			&& (memcmp(pTarget1->uid, pTarget2->uid, pTarget1->uidLength) == 0);
+}
+
+//Bring the session in line with the last discovery loop run (which found nothing unless found is TRUE)
+//Returns TRUE if a tag was added or lost
+static gboolean hal_impl_session_update(hal_impl_t* pHal, gboolean found)
+{
+	const hal_impl_nfc_target_t* pTargets = NULL;
+	guint count = found ? pHal->pBackend->loop_targets(pHal, &pTargets) : 0;
+	gboolean known[HAL_MAX_TAGS] = { FALSE };
+	gint64 now = g_get_monotonic_time();
+
+	//Tags still there keep their object, only their place in the discovery results may change
+	guint lost[HAL_MAX_TAGS];
+	guint lostCount = 0;
+	guint kept = 0;
+	for(guint i = 0; i < pHal->session.tagCount; i++)
+	{
+		guint j;
+		for(j = 0; j < count; j++)
+		{
+			if( !known[j] && hal_impl_session_target_equal(&pTargets[j], &pHal->session.tags[i].target) )
+			{
+				break;
+			}
+		}
+
+		if( j < count )
+		{
+			known[j] = TRUE;
+			pHal->session.tags[kept].tagId = pHal->session.tags[i].tagId;
+			pHal->session.tags[kept].target = pTargets[j];
+			kept++;
+		}
+		else
+		{
+			lost[lostCount++] = pHal->session.tags[i].tagId;
+		}
+	}
+	pHal->session.tagCount = kept;
+
+	//Join the caller's batch if it opened one
+	gboolean batch = !pHal->callbacks.hal.batching;
+	if( batch )
+	{
+		hal_impl_batch_begin(pHal);
+	}
+
+	//Read the new ones while the field is on
+	gboolean changed = (lostCount > 0);
+	for(guint j = 0; (j < count) && (pHal->session.tagCount < pHal->maxTags); j++)
+	{
+		if( known[j] || (pHal->pBackend->tag_activate(pHal, &pTargets[j]) != PH_ERR_SUCCESS) )
+		{
+			continue;
+		}
+
+		guint tagId;
+		if( hal_impl_tag_new(pHal, pTargets[j].type, &tagId) != PH_ERR_SUCCESS )
+		{
+			continue;
+		}
+
+		hal_impl_tag_read(pHal, tagId);
+
+		//Freeze what the main thread will need, so that it does not have to query the tag field by field
+		hal_impl_tag_take_snapshot(pHal, tagId);
+
+		//Advertise NFC tag to adapter
+		hal_impl_call_adapter_on_tag_detected(pHal, tagId);
+
+		pHal->session.tags[pHal->session.tagCount].tagId = tagId;
+		pHal->session.tags[pHal->session.tagCount].target = pTargets[j];
+		pHal->session.tagCount++;
+		pHal->session.currentTagId = tagId;
+		changed = TRUE;
+	}
+
+	//Idle again once the last tag has left, before the adapter hears about it
+	if( (pHal->session.tagCount == 0) && pHal->session.tagOrDevicePresent )
+	{
+		hal_impl_update_mode(pHal, nfc_mode_idle);
+		pHal->session.tagOrDevicePresent = FALSE;
+	}
+
+	for(guint i = 0; i < lostCount; i++)
+	{
+		//Set tag as disconnected and unref it
+		hal_impl_tag_disconnected(pHal, lost[i]);
+		hal_tag_unref((hal_t*)pHal, lost[i]);
+
+		//Callback to adapter
+		hal_impl_call_adapter_on_tag_lost(pHal, lost[i], hal_impl_tag_lost_latency(pHal, now), pHal->session.presenceChecks);
+	}
+
+	if( batch )
+	{
+		hal_impl_batch_end(pHal);
+	}
+
+	pHal->session.lastSeen = now;
+
+	return changed;
+}
+
+gboolean hal_impl_session_run(hal_impl_t* pHal, hal_impl_nfc_type_t nfcType)
+{
+	pHal->session.tagCount = 0;
+	pHal->session.lastSeen = g_get_monotonic_time();
+	pHal->session.presenceChecks = 0;
+
+	//The tags found and the polling and mode changes reach the adapter together
+	hal_impl_batch_begin(pHal);
+	hal_impl_session_update(pHal, TRUE);
+	if( pHal->session.tagCount == 0 )
+	{
+		//Nothing usable, keep polling
+		hal_impl_batch_end(pHal);
+		return FALSE;
+	}
+
+	g_debug("Session started with %u tag(s)", pHal->session.tagCount);
+
+	//Say we are not polling anymore
+	hal_impl_update_polling(pHal, FALSE);
+	pHal->session.polling = FALSE;
+	pHal->session.tagOrDevicePresent = TRUE;
+	hal_impl_update_mode(pHal, nfc_mode_initiator);
+	hal_impl_batch_end(pHal);
+
+	//Run discovery again on the presence check schedule and wait for commands meanwhile
+	hal_impl_tag_presence_begin(pHal, nfcType);
+	while( pHal->session.tagCount > 0 )
+	{
+		hal_impl_process_queue(pHal, pHal->session.presenceInterval);
+
+		//Powered off or shutting down, every tag is dropped
+		gboolean found = FALSE;
+		if( pHal->session.powered && !pHal->joining )
+		{
+			//An urgent command must not make the tags look lost, run it and check again
+			if( !hal_impl_preemptible_begin(pHal) )
+			{
+				continue;
+			}
+
+			hal_impl_nfc_type_t type;
+			pHal->session.discoveryStart = g_get_monotonic_time();
+			found = (pHal->pBackend->loop_iteration(pHal, &type) == PH_ERR_SUCCESS) && HAL_IMPL_NFC_TYPE_IS_TAG(type);
+			pHal->session.discoveryEnd = g_get_monotonic_time();
+
+			if( hal_impl_preemptible_end(pHal) )
+			{
+				continue;
+			}
+			pHal->session.pollCycles++;
+			pHal->session.presenceChecks++;
+		}
+
+		//Check again soon after a change, back off while the field is stable
+		if( hal_impl_session_update(pHal, found) )
+		{
+			if( pHal->presenceCheck.adaptive )
+			{
+				pHal->session.presenceInterval = MIN(pHal->presenceCheck.minInterval, pHal->session.presenceMaxInterval);
+			}
+		}
+		else if( pHal->presenceCheck.adaptive )
+		{
+			pHal->session.presenceInterval = MIN(pHal->session.presenceInterval * 2, pHal->session.presenceMaxInterval);
+		}
+
+		//Tags found by the next run arrived after this one started
+		pHal->session.lastPollStart = pHal->session.discoveryStart;
+	}
+
+	g_debug("Session ended");
+
+	return TRUE;
+}
+
+gboolean hal_impl_session_select(hal_impl_t* pHal, guint tagId)
+{
+	//Outside of a session, the only tag is the active one
+	if( pHal->session.tagCount == 0 )
+	{
+		return TRUE;
+	}
+
+	for(guint i = 0; i < pHal->session.tagCount; i++)
+	{
+		if( pHal->session.tags[i].tagId == tagId )
+		{
+			return pHal->pBackend->tag_activate(pHal, &pHal->session.tags[i].target) == PH_ERR_SUCCESS;
+		}
+	}
+
+	return FALSE;
+}
@@ -0,0 +1,579 @@
+/*
+*         Copyright (c), NXP Semiconductors Gratkorn / Austria
+*
+*                     (C)NXP Semiconductors
+*       All rights are reserved. Reproduction in whole or in part is
+*      prohibited without the written consent of the copyright owner.
+*  NXP reserves the right to make changes without notice at any time.
+* NXP makes no warranty, expressed, implied or statutory, including but
+* not limited to any implied warranty of merchantability or fitness for any
+*particular purpose, or that the use will not infringe any third party patent,
+* copyright or trademark. NXP must not be liable for any loss or damage
+*                          arising from its use.
+*/
+/**
+ * \file hal_sim.c
+ * Simulated reader backend
+ *
+ * Replays tag arrivals described in a key file instead of driving the PN512.
+ * Tags are presented one after the other, every Interval milliseconds, and
+ * stay in the field for Hold milliseconds:
+ *
+ * [Simulator]
+ * Interval = 1000
+ * Hold = 500
+ * Repeat = 0
+ *
+ * [Tag uri]
+ * Type = 2
+ * Uid = 04:A2:3B:12:5C:80:80
+ * Ndef = D1010B5503676F6F676C652E636F6D
+ */
+
+#include "hal.h"
+#include "hal_internal.h"
+
+#include <string.h>
+
+#include <glib.h>
+#include <glib/gprintf.h>
+#include <gio/gio.h>
+
+#define SIM_GROUP "Simulator"
+#define SIM_TAG_GROUP_PREFIX "Tag "
+
+#define SIM_DEFAULT_INTERVAL 1000 //Milliseconds
+#define SIM_DEFAULT_TAG_SIZE 1024
+#define SIM_MAX_SLEEP 50 //Milliseconds, so that commands are not delayed too much while polling (urgent ones are not delayed at all)
+
+struct sim_tag
+{
+	gchar* name;
+	hal_impl_nfc_type_t type;
+	guint8 uid[10];
+	gsize uidLength;
+	guint8* ndef;
+	gsize ndefLength;
+	gsize size;
+	gboolean readOnly;
+	gint64 hold; //Microseconds
+};
+typedef struct sim_tag sim_tag_t;
+
+struct sim
+{
+	//Script
+	GPtrArray* pTags;
+	gint64 interval; //Microseconds
+	gint64 hold; //Microseconds
+	guint repeat; //0 = forever
+	gint64 checkTime; //Microseconds
+	gint64 readTime; //Microseconds
+	gint64 writeTime; //Microseconds
+
+	//State
+	gboolean initiator;
+	gint64 start;
+	gint64 lastSlot;
+	sim_tag_t* pCurrent;
+	gint64 departure;
+
+	//Wakes the polling loop up for urgent commands
+	GMutex abortMutex;
+	GCond abortCond;
+	gboolean abort;
+};
+typedef struct sim sim_t;
+
+static void sim_tag_free(gpointer pData)
+{
+	sim_tag_t* pSimTag = (sim_tag_t*)pData;
+	g_free(pSimTag->name);
+	g_free(pSimTag->ndef);
+	g_free(pSimTag);
+}
+
+static gboolean sim_parse_hex(const gchar* str, guint8** ppBuffer, gsize* pLength)
+{
+	gsize maxLength = strlen(str) / 2;
+	guint8* buffer = g_malloc(maxLength + 1);
+	gsize length = 0;
+	gint high = -1;
+
+	for(; *str != '\0'; str++)
+	{
+		if( (*str == ':') || (*str == '-') || g_ascii_isspace(*str) )
+		{
+			continue;
+		}
+
+		gint value = g_ascii_xdigit_value(*str);
+		if( value < 0 )
+		{
+			g_free(buffer);
+			return FALSE;
+		}
+
+		if( high < 0 )
+		{
+			high = value;
+		}
+		else
+		{
+			buffer[length++] = (guint8)((high << 4) | value);
+			high = -1;
+		}
+	}
+
+	if( high >= 0 ) //Odd number of digits
+	{
+		g_free(buffer);
+		return FALSE;
+	}
+
+	*ppBuffer = buffer;
+	*pLength = length;
+	return TRUE;
+}
+
+static gint sim_get_integer(GKeyFile* pKeyFile, const gchar* group, const gchar* key, gint defaultValue)
+{
+	GError* pError = NULL;
+	gint value = g_key_file_get_integer(pKeyFile, group, key, &pError);
+	if(pError != NULL)
+	{
+		if( pError->code != G_KEY_FILE_ERROR_KEY_NOT_FOUND )
+		{
+			g_warning("Could not read %s parameter in [%s], defaulting to %d: %s", key, group, defaultValue, pError->message);
+		}
+		g_error_free(pError);
+		return defaultValue;
+	}
+	return value;
+}
+
+static sim_tag_t* sim_tag_load(sim_t* pSim, GKeyFile* pKeyFile, const gchar* group)
+{
+	sim_tag_t* pSimTag = g_malloc0(sizeof(sim_tag_t));
+	pSimTag->name = g_strdup(group + strlen(SIM_TAG_GROUP_PREFIX));
+
+	switch( sim_get_integer(pKeyFile, group, "Type", 2) )
+	{
+	case 1:
+		pSimTag->type = hal_impl_nfc_tag_type_1;
+		break;
+	case 2:
+		pSimTag->type = hal_impl_nfc_tag_type_2;
+		break;
+	case 3:
+		pSimTag->type = hal_impl_nfc_tag_type_3;
+		break;
+	case 4:
+		pSimTag->type = hal_impl_nfc_tag_type_4a;
+		break;
+	default:
+		g_warning("Invalid tag type in [%s]", group);
+		sim_tag_free(pSimTag);
+		return NULL;
+	}
+
+	gchar* str = g_key_file_get_string(pKeyFile, group, "Uid", NULL);
+	if( str != NULL )
+	{
+		guint8* buffer;
+		gsize length;
+		if( !sim_parse_hex(str, &buffer, &length) || (length == 0) || (length > sizeof(pSimTag->uid)) )
+		{
+			g_warning("Invalid Uid in [%s]", group);
+			g_free(str);
+			sim_tag_free(pSimTag);
+			return NULL;
+		}
+		memcpy(pSimTag->uid, buffer, length);
+		pSimTag->uidLength = length;
+		g_free(buffer);
+		g_free(str);
+	}
+	else
+	{
+		//Derive a UID from the tag's position in the script
+		pSimTag->uidLength = HAL_IMPL_NFC_TYPE_IS_TAG_FELICA(pSimTag->type) ? 8 : 7;
+		pSimTag->uid[0] = HAL_IMPL_NFC_TYPE_IS_TAG_FELICA(pSimTag->type) ? 0x01 : 0x04;
+		pSimTag->uid[pSimTag->uidLength - 1] = (guint8)pSim->pTags->len;
+	}
+
+	str = g_key_file_get_string(pKeyFile, group, "Ndef", NULL);
+	if( str != NULL )
+	{
+		if( !sim_parse_hex(str, &pSimTag->ndef, &pSimTag->ndefLength) )
+		{
+			g_warning("Invalid Ndef in [%s]", group);
+			g_free(str);
+			sim_tag_free(pSimTag);
+			return NULL;
+		}
+		g_free(str);
+	}
+
+	pSimTag->size = sim_get_integer(pKeyFile, group, "Size", SIM_DEFAULT_TAG_SIZE);
+	if( pSimTag->size < pSimTag->ndefLength )
+	{
+		pSimTag->size = pSimTag->ndefLength;
+	}
+
+	pSimTag->readOnly = g_key_file_get_boolean(pKeyFile, group, "ReadOnly", NULL);
+
+	gint hold = sim_get_integer(pKeyFile, group, "Hold", -1);
+	pSimTag->hold = (hold >= 0) ? (gint64)hold * 1000 : pSim->hold;
+
+	return pSimTag;
+}
+
+gpointer sim_load(const gchar* scriptFile)
+{
+	GKeyFile* pKeyFile = g_key_file_new();
+	GError* pError = NULL;
+
+	if(!g_key_file_load_from_file(pKeyFile, scriptFile, 0, &pError))
+	{
+		g_printerr("Could not load simulator script %s: %s\r\n", scriptFile, pError->message);
+		g_error_free(pError);
+		g_key_file_free(pKeyFile);
+		return NULL;
+	}
+
+	sim_t* pSim = g_malloc0(sizeof(sim_t));
+	pSim->pTags = g_ptr_array_new_with_free_func(sim_tag_free);
+
+	gint interval = sim_get_integer(pKeyFile, SIM_GROUP, "Interval", SIM_DEFAULT_INTERVAL);
+	if( interval < 1 )
+	{
+		interval = 1;
+	}
+	pSim->interval = (gint64)interval * 1000;
+	pSim->hold = (gint64)sim_get_integer(pKeyFile, SIM_GROUP, "Hold", interval / 2) * 1000;
+	pSim->repeat = MAX(sim_get_integer(pKeyFile, SIM_GROUP, "Repeat", 0), 0);
+	pSim->checkTime = (gint64)sim_get_integer(pKeyFile, SIM_GROUP, "CheckTime", 0) * 1000;
+	pSim->readTime = (gint64)sim_get_integer(pKeyFile, SIM_GROUP, "ReadTime", 0) * 1000;
+	pSim->writeTime = (gint64)sim_get_integer(pKeyFile, SIM_GROUP, "WriteTime", 0) * 1000;
+
+	gchar** groups = g_key_file_get_groups(pKeyFile, NULL);
+	for(gchar** group = groups; *group != NULL; group++)
+	{
+		if( !g_str_has_prefix(*group, SIM_TAG_GROUP_PREFIX) )
+		{
+			continue;
+		}
+
+		sim_tag_t* pSimTag = sim_tag_load(pSim, pKeyFile, *group);
+		if( pSimTag != NULL )
+		{
+			g_ptr_array_add(pSim->pTags, pSimTag);
+		}
+	}
+	g_strfreev(groups);
+	g_key_file_free(pKeyFile);
+
+	if( pSim->pTags->len == 0 )
+	{
+		g_printerr("No valid [Tag ...] group in simulator script %s\r\n", scriptFile);
+		g_ptr_array_unref(pSim->pTags);
+		g_free(pSim);
+		return NULL;
+	}
+
+	g_info("Simulating %d tag(s), one every %d ms", pSim->pTags->len, interval);
+
+	return pSim;
+}
+
+static phStatus_t sim_init(hal_impl_t* pHal)
+{
+	sim_t* pSim = (sim_t*)pHal->pBackendData;
+
+	pSim->start = g_get_monotonic_time();
+	pSim->lastSlot = -1;
+	pSim->pCurrent = NULL;
+	pSim->departure = 0;
+
+	g_mutex_init(&pSim->abortMutex);
+	g_cond_init(&pSim->abortCond);
+	pSim->abort = FALSE;
+
+	return PH_ERR_SUCCESS;
+}
+
+static void sim_close(hal_impl_t* pHal)
+{
+	sim_t* pSim = (sim_t*)pHal->pBackendData;
+
+	g_mutex_clear(&pSim->abortMutex);
+	g_cond_clear(&pSim->abortCond);
+	g_ptr_array_unref(pSim->pTags);
+	g_free(pSim);
+
+	pHal->pBackendData = NULL;
+}
+
+static phStatus_t sim_loop_setup(hal_impl_t* pHal, nfc_mode_t pollingMode)
+{
+	sim_t* pSim = (sim_t*)pHal->pBackendData;
+
+	//Only tags are simulated, so there is nothing to find in target mode
+	pSim->initiator = (pollingMode == nfc_mode_initiator) || (pollingMode == nfc_mode_dual);
+
+	return PH_ERR_SUCCESS;
+}
+
+static phStatus_t sim_loop_iteration(hal_impl_t* pHal, hal_impl_nfc_type_t* pNFCType)
+{
+	sim_t* pSim = (sim_t*)pHal->pBackendData;
+
+	gint64 now = g_get_monotonic_time();
+	gint64 slot = (now - pSim->start) / pSim->interval;
+	gint64 slotStart = pSim->start + slot * pSim->interval;
+	gboolean finished = (pSim->repeat != 0) && (slot >= (gint64)pSim->repeat * pSim->pTags->len);
+
+	if( pSim->initiator && !finished && (slot > pSim->lastSlot) )
+	{
+		sim_tag_t* pSimTag = g_ptr_array_index(pSim->pTags, slot % pSim->pTags->len);
+		if( now < slotStart + pSimTag->hold )
+		{
+			pSim->lastSlot = slot;
+			pSim->pCurrent = pSimTag;
+			pSim->departure = slotStart + pSimTag->hold;
+
+			*pNFCType = pSimTag->type;
+			return PH_ERR_SUCCESS;
+		}
+	}
+
+	//Nothing in the field, wait for the next arrival (but not too long) or an urgent command
+	gint64 wakeUp = MIN(slotStart + pSim->interval, now + SIM_MAX_SLEEP * 1000);
+	g_mutex_lock(&pSim->abortMutex);
+	while( !pSim->abort && g_cond_wait_until(&pSim->abortCond, &pSim->abortMutex, wakeUp) );
+	pSim->abort = FALSE;
+	g_mutex_unlock(&pSim->abortMutex);
+
+	return PH_ERR_FAILED;
+}
+
+static phStatus_t sim_tag_init(hal_impl_t* pHal, hal_impl_tag_t* pTag)
+{
+	sim_t* pSim = (sim_t*)pHal->pBackendData;
+	sim_tag_t* pSimTag = pSim->pCurrent;
+
+	if( (pSimTag == NULL) || (pSimTag->type != pTag->type) )
+	{
+		return PH_ERR_INVALID_PARAMETER;
+	}
+
+	if( pSim->checkTime > 0 )
+	{
+		g_usleep(pSim->checkTime);
+	}
+
+	if( HAL_IMPL_NFC_TYPE_IS_TAG_ISO14443A(pTag->type) )
+	{
+		switch(pTag->type)
+		{
+		case hal_impl_nfc_tag_type_1:
+			pTag->iso14443a.atqa[0] = 0x0C;
+			pTag->iso14443a.sak = 0x00;
+			break;
+		case hal_impl_nfc_tag_type_4a:
+			pTag->iso14443a.atqa[0] = 0x44;
+			pTag->iso14443a.sak = 0x20;
+			break;
+		case hal_impl_nfc_tag_type_2:
+		default:
+			pTag->iso14443a.atqa[0] = 0x44;
+			pTag->iso14443a.sak = 0x00;
+			break;
+		}
+		memcpy(pTag->iso14443a.uid, pSimTag->uid, pSimTag->uidLength);
+		pTag->iso14443a.uidLength = pSimTag->uidLength;
+	}
+
+	if( HAL_IMPL_NFC_TYPE_IS_TAG_FELICA(pTag->type) )
+	{
+		//IDm = manufacturer code + card identifier
+		memcpy(pTag->felica.manufacturer, &pSimTag->uid[0], MIN(pSimTag->uidLength, 2));
+		if( pSimTag->uidLength > 2 )
+		{
+			memcpy(pTag->felica.cid, &pSimTag->uid[2], MIN(pSimTag->uidLength - 2, 6));
+		}
+	}
+
+	if( pSimTag->readOnly )
+	{
+		pTag->status = hal_impl_nfc_ndef_status_readonly;
+	}
+	else if( pSimTag->ndef == NULL )
+	{
+		pTag->status = hal_impl_nfc_ndef_status_formattable;
+	}
+	else
+	{
+		pTag->status = hal_impl_nfc_ndef_status_readwrite;
+	}
+
+	pTag->message.size = pSimTag->size;
+	pTag->ndefLength = pSimTag->ndefLength;
+
+	return PH_ERR_SUCCESS;
+}
+
+static phStatus_t sim_tag_ndef_read(hal_impl_t* pHal, guint tagId)
+{
+	sim_t* pSim = (sim_t*)pHal->pBackendData;
+
+	hal_impl_tag_t* pTag = hal_impl_tag_lookup(pHal, tagId);
+
+	if(pTag == NULL)
+	{
+		g_error("Did not find hal_impl_tag_t instance of id %d", tagId);
+		return PH_ERR_FAILED;
+	}
+
+	sim_tag_t* pSimTag = pSim->pCurrent;
+	if( (pSimTag == NULL) || (pSimTag->ndef == NULL) )
+	{
+		hal_impl_tag_release(pHal, pTag);
+		return PH_ERR_SUCCESS; //NDEF message is empty
+	}
+
+	if( pSim->readTime > 0 )
+	{
+		g_usleep(pSim->readTime);
+	}
+
+	//Stands for the transfer from the tag, the only copy made
+	hal_impl_tag_set_message(pTag, g_bytes_new(pSimTag->ndef, pSimTag->ndefLength));
+	hal_impl_tag_release(pHal, pTag);
+
+	return PH_ERR_SUCCESS;
+}
+
+static phStatus_t sim_tag_ndef_write(hal_impl_t* pHal, guint tagId, guint8* buffer, gsize length, gsize* pSent)
+{
+	sim_t* pSim = (sim_t*)pHal->pBackendData;
+
+	hal_impl_tag_t* pTag = hal_impl_tag_lookup(pHal, tagId);
+
+	if(pTag == NULL)
+	{
+		g_error("Did not find hal_impl_tag_t instance of id %d", tagId);
+		return PH_ERR_FAILED;
+	}
+
+	sim_tag_t* pSimTag = pSim->pCurrent;
+	if( (pSimTag == NULL) || pSimTag->readOnly || (length > pSimTag->size) )
+	{
+		g_warning("Could not write tag");
+		hal_impl_tag_release(pHal, pTag);
+		return PH_ERR_FAILED;
+	}
+
+	if( pSim->writeTime > 0 )
+	{
+		g_usleep(pSim->writeTime);
+	}
+
+	//The written message is kept for the next time this tag is presented
+	g_free(pSimTag->ndef);
+	pSimTag->ndef = g_memdup(buffer, length);
+	pSimTag->ndefLength = length;
+
+	//No memory layout is simulated, the whole message is sent
+	*pSent = length;
+
+	g_atomic_int_set(&pTag->status, hal_impl_nfc_ndef_status_readwrite);
+	hal_impl_tag_release(pHal, pTag);
+
+	g_info("Tag written");
+
+	return PH_ERR_SUCCESS;
+}
+
+static phStatus_t sim_tag_presence_check(hal_impl_t* pHal, guint tagId)
+{
+	sim_t* pSim = (sim_t*)pHal->pBackendData;
+
+	if( (pSim->pCurrent == NULL) || (g_get_monotonic_time() >= pSim->departure) )
+	{
+		pSim->pCurrent = NULL;
+		return PH_ERR_FAILED;
+	}
+
+	return PH_ERR_SUCCESS;
+}
+
+static gint64 sim_tag_departure(hal_impl_t* pHal)
+{
+	sim_t* pSim = (sim_t*)pHal->pBackendData;
+
+	//The scripted removal time, so that the detection latency is measured rather than bounded
+	return pSim->departure;
+}
+
+static phStatus_t sim_tag_lock(hal_impl_t* pHal, guint tagId)
+{
+	sim_t* pSim = (sim_t*)pHal->pBackendData;
+
+	hal_impl_tag_t* pTag = hal_impl_tag_lookup(pHal, tagId);
+
+	if(pTag == NULL)
+	{
+		g_error("Did not find hal_impl_tag_t instance of id %d", tagId);
+		return PH_ERR_FAILED;
+	}
+
+	sim_tag_t* pSimTag = pSim->pCurrent;
+	if( pSimTag == NULL )
+	{
+		hal_impl_tag_release(pHal, pTag);
+		return PH_ERR_FAILED;
+	}
+
+	//Kept for the next time this tag is presented
+	pSimTag->readOnly = TRUE;
+
+	g_atomic_int_set(&pTag->status, hal_impl_nfc_ndef_status_readonly);
+	hal_impl_tag_release(pHal, pTag);
+
+	return PH_ERR_SUCCESS;
+}
+
+static phStatus_t sim_device_execute(hal_impl_t* pHal, hal_impl_nfc_type_t nfcType)
+{
+	//Peer to peer is not simulated
+	return PH_ERR_FAILED;
+}
+
+static void sim_abort(hal_impl_t* pHal, gboolean abort)
+{
+	sim_t* pSim = (sim_t*)pHal->pBackendData;
+
+	g_mutex_lock(&pSim->abortMutex);
+	pSim->abort = abort;
+	g_cond_signal(&pSim->abortCond);
+	g_mutex_unlock(&pSim->abortMutex);
+}
+
+const hal_impl_backend_t hal_impl_backend_sim =
+{
+	.name = "simulated reader",
+	.init = sim_init,
+	.close = sim_close,
+	.loop_setup = sim_loop_setup,
+	.loop_iteration = sim_loop_iteration,
+	.tag_init = sim_tag_init,
+	.tag_ndef_read = sim_tag_ndef_read,
+	.tag_ndef_write = sim_tag_ndef_write,
+	.tag_presence_check = sim_tag_presence_check,
+	.tag_lock = sim_tag_lock,
+	.tag_departure = sim_tag_departure,
+	.device_execute = sim_device_execute,
+	.abort = sim_abort,
+};
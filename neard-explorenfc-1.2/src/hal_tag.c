@@ -21,208 +21,282 @@
 
 int hal_impl_tag_new(hal_impl_t* pHal, hal_impl_nfc_type_t nfcType, guint* pTagId)
 {
-	hal_impl_tag_t* pTag = g_malloc(sizeof(hal_impl_tag_t));
-
-	//Reset Top parameters
-	phalTop_Reset(&pHal->rdlib.tagop);
+	//Reserve a slot, the tag is not visible to other threads until it is published
+	hal_impl_tag_t* pTag = (hal_impl_tag_t*) hal_impl_registry_alloc(&pHal->tags);
+	if(pTag == NULL)
+	{
+		g_warning("Too many tags in use");
+		return PH_ERR_FAILED;
+	}
 
 	//Initialize everything
 	pTag->status = hal_impl_nfc_ndef_status_invalid;
 
-	pTag->message.buffer = NULL;
-	pTag->message.length = 0;
+	pTag->message.pBytes = NULL;
 	pTag->message.size = 0;
 
 	pTag->type = nfcType;
 
-	uint16_t tagType;
+	memset(&pTag->iso14443a, 0, sizeof(hal_impl_nfc_iso14443a_params_t));
+	memset(&pTag->felica, 0, sizeof(hal_impl_nfc_felica_params_t));
 
-	switch(	nfcType )
+	memset(pTag->timings, 0, sizeof(pTag->timings));
+	pTag->headerLength = 0;
+	pTag->ndefLength = 0;
+	pTag->timings[nfc_tag_timing_discovery_start] = pHal->session.discoveryStart;
+	pTag->timings[nfc_tag_timing_discovery_end] = pHal->session.discoveryEnd;
+
+	//Let the backend fill in the tag's parameters and NDEF status
+	pTag->timings[nfc_tag_timing_check_start] = g_get_monotonic_time();
+	phStatus_t status = pHal->pBackend->tag_init(pHal, pTag);
+	pTag->timings[nfc_tag_timing_check_end] = g_get_monotonic_time();
+	if( status != PH_ERR_SUCCESS )
 	{
-	case hal_impl_nfc_tag_type_1:
-		tagType = PHAL_TOP_TAG_TYPE_T1T_TAG;
-		break;
-	case hal_impl_nfc_tag_type_2:
-		tagType = PHAL_TOP_TAG_TYPE_T2T_TAG;
+		if(pTag->message.pBytes != NULL)
+		{
+			g_bytes_unref(pTag->message.pBytes);
+		}
+		hal_impl_registry_discard(&pHal->tags, &pTag->object);
+		return status;
+	}
+
+	switch(pTag->status)
+	{
+	case hal_impl_nfc_ndef_status_readwrite:
+		g_info("Tag is in read/write mode");
 		break;
-	case hal_impl_nfc_tag_type_3:
-		tagType = PHAL_TOP_TAG_TYPE_T3T_TAG;
+	case hal_impl_nfc_ndef_status_formattable:
+		g_info("Tag is formattable");
 		break;
-	case hal_impl_nfc_tag_type_4a:
-		tagType = PHAL_TOP_TAG_TYPE_T4T_TAG;
+	case hal_impl_nfc_ndef_status_readonly:
+		g_info("Tag is in read only mode");
 		break;
+	case hal_impl_nfc_ndef_status_invalid:
 	default:
-		g_free(pTag);
-		return PH_ERR_INVALID_PARAMETER;
+		g_info("Tag is invalid");
+		break;
 	}
 
-	//If tag is ISO14443A-compliant
-	if( HAL_IMPL_NFC_TYPE_IS_TAG_ISO14443A(nfcType) )
+	//Init other fields from tag
+	pTag->connected = TRUE;
+
+	*pTagId = pTag->object.id;
+
+	g_debug("New tag id %d", pTag->object.id);
+
+	hal_impl_registry_publish(&pHal->tags, &pTag->object); //1 reference
+
+	return 0;
+}
+
+hal_impl_tag_t* hal_impl_tag_lookup(hal_impl_t* pHal, guint tagId)
+{
+	return (hal_impl_tag_t*) hal_impl_registry_ref(&pHal->tags, tagId);
+}
+
+void hal_impl_tag_release(hal_impl_t* pHal, hal_impl_tag_t* pTag)
+{
+	hal_impl_registry_unref(&pHal->tags, &pTag->object);
+}
+
+void hal_impl_tag_clear(hal_impl_object_t* pObject)
+{
+	hal_impl_tag_t* pTag = (hal_impl_tag_t*) pObject;
+
+	if(pTag->message.pBytes != NULL)
 	{
-		memcpy(pTag->iso14443a.atqa, pHal->rdlib.discLoop.sTypeATargetInfo.aTypeA_I3P3[0].aAtqa, 2);
-		pTag->iso14443a.sak = pHal->rdlib.discLoop.sTypeATargetInfo.aTypeA_I3P3[0].aSak;
-		memcpy(pTag->iso14443a.uid, pHal->rdlib.discLoop.sTypeATargetInfo.aTypeA_I3P3[0].aUid, 10);
-		pTag->iso14443a.uidLength = pHal->rdlib.discLoop.sTypeATargetInfo.aTypeA_I3P3[0].bUidSize;
+		g_bytes_unref(pTag->message.pBytes);
+		pTag->message.pBytes = NULL;
 	}
-	else
+
+	if(pTag->pSnapshot != NULL)
 	{
-		memset(&pTag->iso14443a, 0, sizeof(hal_impl_nfc_iso14443a_params_t));
+		hal_tag_snapshot_unref(pTag->pSnapshot);
+		pTag->pSnapshot = NULL;
 	}
+}
 
-	//If tag is ISO14443A-compliant
-	if( HAL_IMPL_NFC_TYPE_IS_TAG_FELICA(nfcType) )
+static nfc_tag_type_t hal_impl_tag_get_nfc_type(hal_impl_tag_t* pTag)
+{
+	switch(pTag->type)
 	{
-		memcpy(pTag->felica.manufacturer, &pHal->rdlib.discLoop.sTypeFTargetInfo.aTypeFTag[0].aIDmPMm[0], 2);
-		memcpy(pTag->felica.cid, &pHal->rdlib.discLoop.sTypeFTargetInfo.aTypeFTag[0].aIDmPMm[2], 6);
-		memcpy(pTag->felica.ic, &pHal->rdlib.discLoop.sTypeFTargetInfo.aTypeFTag[0].aIDmPMm[2+6], 2);
-		memcpy(pTag->felica.maxRespTimes, &pHal->rdlib.discLoop.sTypeFTargetInfo.aTypeFTag[0].aIDmPMm[2+6+2], 6);
+	case hal_impl_nfc_tag_type_1:
+		return nfc_tag_type_1;
+	case hal_impl_nfc_tag_type_2:
+		return nfc_tag_type_2;
+	case hal_impl_nfc_tag_type_3:
+		return nfc_tag_type_3;
+	case hal_impl_nfc_tag_type_4a:
+	default:
+		return nfc_tag_type_4;
 	}
-	else
+}
+
+static gboolean hal_impl_tag_is_readonly(hal_impl_tag_t* pTag)
+{
+	switch(g_atomic_int_get(&pTag->status))
 	{
-		memset(&pTag->felica, 0, sizeof(hal_impl_nfc_felica_params_t));
+	case hal_impl_nfc_ndef_status_readwrite:
+	case hal_impl_nfc_ndef_status_formattable:
+		return FALSE;
+	case hal_impl_nfc_ndef_status_readonly:
+	case hal_impl_nfc_ndef_status_invalid:
+	default:
+		return TRUE;
 	}
+}
 
-	//Set tag parameters
-	phalTop_SetConfig(&pHal->rdlib.tagop, PHAL_TOP_CONFIG_TAG_TYPE, tagType);
+static nfc_tag_snapshot_t* hal_impl_tag_snapshot_new(hal_impl_tag_t* pTag)
+{
+	hal_impl_tag_snapshot_t* pImplSnapshot = g_malloc0(sizeof(hal_impl_tag_snapshot_t));
+	nfc_tag_snapshot_t* pSnapshot = &pImplSnapshot->snapshot;
+	pImplSnapshot->refs = 1;
 
-	//Check if a NDEF message is there
-	uint8_t value = 0;
-	phStatus_t status = phalTop_CheckNdef(&pHal->rdlib.tagop, &value);
-	if((status != PH_ERR_SUCCESS) && 
-	(status & PH_ERR_MASK) != PHAL_TOP_ERR_NON_NDEF_TAG && 
-	(status & PH_ERR_MASK) != PHAL_TOP_ERR_MISCONFIGURED_TAG)
+	pSnapshot->tagId = pTag->object.id;
+	pSnapshot->type = hal_impl_tag_get_nfc_type(pTag);
+	pSnapshot->readOnly = hal_impl_tag_is_readonly(pTag);
+
+	pSnapshot->iso14443a = HAL_IMPL_NFC_TYPE_IS_TAG_ISO14443A(pTag->type);
+	if( pSnapshot->iso14443a )
 	{
-		g_warning("phalTop_CheckNdef() returned %04X\n", status);
-		pTag->status = hal_impl_nfc_ndef_status_invalid;
+		memcpy(pSnapshot->atqa, pTag->iso14443a.atqa, 2);
+		pSnapshot->sak = pTag->iso14443a.sak;
+		memcpy(pSnapshot->uid, pTag->iso14443a.uid, pTag->iso14443a.uidLength);
+		pSnapshot->uidLength = pTag->iso14443a.uidLength;
 	}
-	else
+
+	pSnapshot->felica = HAL_IMPL_NFC_TYPE_IS_TAG_FELICA(pTag->type);
+	if( pSnapshot->felica )
 	{
-		//Is Tag in R/W or RO mode?
-		if( value == PHAL_TOP_STATE_READWRITE  )
-		{
-			pTag->status = hal_impl_nfc_ndef_status_readwrite;
-		}
-		else if( value ==  PHAL_TOP_STATE_READONLY )
-		{
-			pTag->status = hal_impl_nfc_ndef_status_readonly;
-		}
-		else
-		{
-			pTag->status = hal_impl_nfc_ndef_status_formattable;
-		}
+		memcpy(pSnapshot->manufacturer, pTag->felica.manufacturer, sizeof(pSnapshot->manufacturer));
+		memcpy(pSnapshot->cid, pTag->felica.cid, sizeof(pSnapshot->cid));
+		memcpy(pSnapshot->ic, pTag->felica.ic, sizeof(pSnapshot->ic));
+		memcpy(pSnapshot->maxRespTimes, pTag->felica.maxRespTimes, sizeof(pSnapshot->maxRespTimes));
 	}
 
+	pSnapshot->pNdef = hal_impl_object_get_bytes(&pTag->object, &pTag->message.pBytes);
 
-	if( pTag->status != hal_impl_nfc_ndef_status_invalid )
-	{
-		uint16_t value;
+	return pSnapshot;
+}
 
-		phalTop_GetConfig(&pHal->rdlib.tagop, PHAL_TOP_CONFIG_MAX_NDEF_LENGTH, &value);
+static nfc_tag_snapshot_t* hal_impl_tag_get_or_take_snapshot(hal_impl_tag_t* pTag)
+{
+	nfc_tag_snapshot_t* pSnapshot = g_atomic_pointer_get(&pTag->pSnapshot);
+	if( pSnapshot != NULL )
+	{
+		return pSnapshot;
+	}
 
-		pTag->message.size = (gsize)value;
-		//pTag->message.buffer = g_malloc(pTag->message.size);
+	pSnapshot = hal_impl_tag_snapshot_new(pTag);
+	if( !g_atomic_pointer_compare_and_exchange(&pTag->pSnapshot, NULL, pSnapshot) )
+	{
+		//Taken by another thread in the meantime
+		hal_tag_snapshot_unref(pSnapshot);
+		pSnapshot = g_atomic_pointer_get(&pTag->pSnapshot);
 	}
 
-	switch(pTag->status)
+	return pSnapshot;
+}
+
+void hal_impl_tag_take_snapshot(hal_impl_t* pHal, guint tagId)
+{
+	hal_impl_tag_t* pTag = hal_impl_tag_lookup(pHal, tagId);
+
+	if(pTag == NULL)
 	{
-	case hal_impl_nfc_ndef_status_readwrite:
-		g_info("Tag is in read/write mode");
-		break;
-	case hal_impl_nfc_ndef_status_formattable:
-		g_info("Tag is formattable");
-		break;
-	case hal_impl_nfc_ndef_status_readonly:
-		g_info("Tag is in read only mode");
-		break;
-	case hal_impl_nfc_ndef_status_invalid:
-	default:
-		g_info("Tag is invalid");
-		break;
+		g_error("Did not find hal_impl_tag_t instance of id %d", tagId);
+		return;
 	}
 
-	//Init other fields from tag
-	pTag->connected = TRUE;
-	pTag->refs = 1; //1 reference
-	g_rec_mutex_init(&pTag->mutex);
+	hal_impl_tag_get_or_take_snapshot(pTag);
+	hal_impl_tag_release(pHal, pTag);
+}
 
-	//Find a free ID in the hash table and add the tag
-	g_mutex_lock(&pHal->tagTableMutex);
+const nfc_tag_snapshot_t* hal_tag_get_snapshot(hal_t* pHal, guint tagId)
+{
+	hal_impl_t* pHalImpl = (hal_impl_t*) pHal;
 
-	pTag->id = 0;
+	hal_impl_tag_t* pTag = hal_impl_tag_lookup(pHalImpl, tagId);
 
-	while(g_hash_table_contains(pHal->pTagTable, GUINT_TO_POINTER(pTag->id)))
+	if(pTag == NULL)
 	{
-		pTag->id++;
+		g_error("Did not find hal_impl_tag_t instance of id %d", tagId);
+		return NULL;
 	}
 
-	*pTagId = pTag->id;
+	//Normally taken by the HAL thread before the tag is advertised
+	const nfc_tag_snapshot_t* pSnapshot = hal_tag_snapshot_ref(hal_impl_tag_get_or_take_snapshot(pTag));
+	hal_impl_tag_release(pHalImpl, pTag);
 
-	g_debug("New tag id %d", pTag->id);
+	return pSnapshot;
+}
 
-	g_hash_table_insert(pHal->pTagTable, GUINT_TO_POINTER(pTag->id), (gpointer*)pTag);
+const nfc_tag_snapshot_t* hal_tag_snapshot_ref(const nfc_tag_snapshot_t* pSnapshot)
+{
+	hal_impl_tag_snapshot_t* pImplSnapshot = (hal_impl_tag_snapshot_t*) pSnapshot;
+	g_atomic_int_inc(&pImplSnapshot->refs);
+	return pSnapshot;
+}
 
-	g_mutex_unlock(&pHal->tagTableMutex);
+void hal_tag_snapshot_unref(const nfc_tag_snapshot_t* pSnapshot)
+{
+	hal_impl_tag_snapshot_t* pImplSnapshot = (hal_impl_tag_snapshot_t*) pSnapshot;
+	if(g_atomic_int_dec_and_test(&pImplSnapshot->refs))
+	{
+		if(pImplSnapshot->snapshot.pNdef != NULL)
+		{
+			g_bytes_unref(pImplSnapshot->snapshot.pNdef);
+		}
+		g_free(pImplSnapshot);
+	}
+}
 
-	return 0;
+void hal_impl_tag_set_message(hal_impl_tag_t* pTag, GBytes* pBytes)
+{
+	//Takes ownership of pBytes
+	hal_impl_object_write_begin(&pTag->object);
+	hal_impl_object_retire(&pTag->object, pTag->message.pBytes);
+	g_atomic_pointer_set(&pTag->message.pBytes, pBytes);
+	hal_impl_object_write_end(&pTag->object);
 }
 
 void hal_tag_ref(hal_t* pHal, guint tagId)
 {
 	hal_impl_t* pHalImpl = (hal_impl_t*) pHal;
 
-	g_mutex_lock(&pHalImpl->tagTableMutex);
-	hal_impl_tag_t* pTag = g_hash_table_lookup(pHalImpl->pTagTable, GUINT_TO_POINTER(tagId));
-	g_mutex_unlock(&pHalImpl->tagTableMutex);
+	hal_impl_tag_t* pTag = hal_impl_tag_lookup(pHalImpl, tagId);
 
 	if(pTag == NULL)
 	{
 		g_error("Did not find hal_impl_tag_t instance of id %d", tagId);
 		return;
 	}
-	g_rec_mutex_lock(&pTag->mutex);
-	pTag->refs++;
-	g_rec_mutex_unlock(&pTag->mutex);
+
+	//Keep the reference taken by the lookup
 }
 
 void hal_tag_unref(hal_t* pHal, guint tagId)
 {
 	hal_impl_t* pHalImpl = (hal_impl_t*) pHal;
 
-	g_mutex_lock(&pHalImpl->tagTableMutex);
-	hal_impl_tag_t* pTag = g_hash_table_lookup(pHalImpl->pTagTable, GUINT_TO_POINTER(tagId));
-	g_mutex_unlock(&pHalImpl->tagTableMutex);
+	hal_impl_tag_t* pTag = hal_impl_tag_lookup(pHalImpl, tagId);
 
 	if(pTag == NULL)
 	{
 		g_error("Did not find hal_impl_tag_t instance of id %d", tagId);
 		return;
 	}
-	g_rec_mutex_lock(&pTag->mutex);
-	guint refs = --pTag->refs;
-	g_rec_mutex_unlock(&pTag->mutex);
-	if(refs == 0)
-	{
-		//No one is using the tag anymore, so free it
-		g_mutex_lock(&pHalImpl->tagTableMutex);
-		g_hash_table_remove(pHalImpl->pTagTable, GUINT_TO_POINTER(tagId));
-		g_mutex_unlock(&pHalImpl->tagTableMutex);
 
-		if(pTag->message.buffer != NULL)
-		{
-			g_free(pTag->message.buffer);
-		}
-
-		g_free(pTag);
-	}
+	//Drop the reference taken by the lookup and the caller's one
+	hal_impl_tag_release(pHalImpl, pTag);
+	hal_impl_tag_release(pHalImpl, pTag);
 }
 
 nfc_tag_type_t hal_tag_get_type(hal_t* pHal, guint tagId)
 {
 	hal_impl_t* pHalImpl = (hal_impl_t*) pHal;
 
-	g_mutex_lock(&pHalImpl->tagTableMutex);
-	hal_impl_tag_t* pTag = g_hash_table_lookup(pHalImpl->pTagTable, GUINT_TO_POINTER(tagId));
-	g_mutex_unlock(&pHalImpl->tagTableMutex);
+	hal_impl_tag_t* pTag = hal_impl_tag_lookup(pHalImpl, tagId);
 
 	if(pTag == NULL)
 	{
@@ -230,31 +304,17 @@ nfc_tag_type_t hal_tag_get_type(hal_t* pHal, guint tagId)
 		return nfc_tag_type_1;
 	}
 
-	g_rec_mutex_lock(&pTag->mutex);
-	hal_impl_nfc_type_t type = pTag->type;
-	g_rec_mutex_unlock(&pTag->mutex);
+	nfc_tag_type_t type = hal_impl_tag_get_nfc_type(pTag);
+	hal_impl_tag_release(pHalImpl, pTag);
 
-	switch(type)
-	{
-	case hal_impl_nfc_tag_type_1:
-		return nfc_tag_type_1;
-	case hal_impl_nfc_tag_type_2:
-		return nfc_tag_type_2;
-	case hal_impl_nfc_tag_type_3:
-		return nfc_tag_type_3;
-	case hal_impl_nfc_tag_type_4a:
-	default:
-		return nfc_tag_type_4;
-	}
+	return type;
 }
 
 gboolean hal_tag_is_connected(hal_t* pHal, guint tagId)
 {
 	hal_impl_t* pHalImpl = (hal_impl_t*) pHal;
 
-	g_mutex_lock(&pHalImpl->tagTableMutex);
-	hal_impl_tag_t* pTag = g_hash_table_lookup(pHalImpl->pTagTable, GUINT_TO_POINTER(tagId));
-	g_mutex_unlock(&pHalImpl->tagTableMutex);
+	hal_impl_tag_t* pTag = hal_impl_tag_lookup(pHalImpl, tagId);
 
 	if(pTag == NULL)
 	{
@@ -262,56 +322,59 @@ gboolean hal_tag_is_connected(hal_t* pHal, guint tagId)
 		return FALSE;
 	}
 
-	g_rec_mutex_lock(&pTag->mutex);
-	gboolean connected = pTag->connected;
-	g_rec_mutex_unlock(&pTag->mutex);
+	gboolean connected = g_atomic_int_get(&pTag->connected);
+	hal_impl_tag_release(pHalImpl, pTag);
 
 	return connected;
 }
 
-void hal_tag_get_ndef(hal_t* pHal, guint tagId, guint8** pBuffer, gsize* pBufferLength)
+GBytes* hal_tag_get_ndef(hal_t* pHal, guint tagId)
 {
 	hal_impl_t* pHalImpl = (hal_impl_t*) pHal;
 
-	g_mutex_lock(&pHalImpl->tagTableMutex);
-	hal_impl_tag_t* pTag = g_hash_table_lookup(pHalImpl->pTagTable, GUINT_TO_POINTER(tagId));
-	g_mutex_unlock(&pHalImpl->tagTableMutex);
+	hal_impl_tag_t* pTag = hal_impl_tag_lookup(pHalImpl, tagId);
 
 	if(pTag == NULL)
 	{
 		g_error("Did not find hal_impl_tag_t instance of id %d", tagId);
-		return;
+		return NULL;
 	}
 
-	g_rec_mutex_lock(&pTag->mutex);
-	*pBufferLength = pTag->message.length;
-	if(pTag->message.buffer != NULL)
-	{
-		*pBuffer = g_memdup(pTag->message.buffer, pTag->message.length);
-	}
-	g_rec_mutex_unlock(&pTag->mutex);
+	GBytes* pBytes = hal_impl_object_get_bytes(&pTag->object, &pTag->message.pBytes);
+	hal_impl_tag_release(pHalImpl, pTag);
+
+	return pBytes;
 }
 
-void hal_tag_write_ndef(hal_t* pHal, guint tagId, guint8* buffer, gsize bufferLength)
+void hal_tag_write_ndef(hal_t* pHal, guint tagId, guint8* buffer, gsize bufferLength,
+		gboolean verify, hal_tag_write_cb_t writeCb, gpointer pUserData)
 {
     hal_impl_t* pHalImpl = (hal_impl_t*)pHal;
 
-    hal_impl_cmd_info_t* pCmdInfo = g_malloc(sizeof(hal_impl_cmd_info_t));
-    pCmdInfo->type = HAL_CMD_TAG_NDEF_WRITE;
-    pCmdInfo->tagId = tagId;
-    pCmdInfo->buffer = g_memdup(buffer, bufferLength);
-    pCmdInfo->bufferLength = bufferLength;
+    hal_impl_cmd_info_t cmdInfo;
+    cmdInfo.type = HAL_CMD_TAG_NDEF_WRITE;
+    cmdInfo.tagId = tagId;
+    cmdInfo.buffer = g_memdup(buffer, bufferLength);
+    cmdInfo.bufferLength = bufferLength;
+    cmdInfo.verify = verify;
+    cmdInfo.writeCb = writeCb;
+    cmdInfo.pWriteUserData = pUserData;
 
-	hal_impl_call_cmd(pHalImpl, pCmdInfo);
+	if( !hal_impl_call_cmd(pHalImpl, &cmdInfo) )
+	{
+		g_free(cmdInfo.buffer);
+		if( writeCb != NULL )
+		{
+			writeCb(pHal, tagId, nfc_tag_write_busy, 0, 0, pUserData);
+		}
+	}
 }
 
 gboolean hal_tag_is_readonly(hal_t* pHal, guint tagId)
 {
 	hal_impl_t* pHalImpl = (hal_impl_t*) pHal;
 
-	g_mutex_lock(&pHalImpl->tagTableMutex);
-	hal_impl_tag_t* pTag = g_hash_table_lookup(pHalImpl->pTagTable, GUINT_TO_POINTER(tagId));
-	g_mutex_unlock(&pHalImpl->tagTableMutex);
+	hal_impl_tag_t* pTag = hal_impl_tag_lookup(pHalImpl, tagId);
 
 	if(pTag == NULL)
 	{
@@ -319,22 +382,8 @@ gboolean hal_tag_is_readonly(hal_t* pHal, guint tagId)
 		return TRUE;
 	}
 
-	g_rec_mutex_lock(&pTag->mutex);
-	gboolean readonly;
-	switch(pTag->status)
-	{
-	case hal_impl_nfc_ndef_status_readwrite:
-	case hal_impl_nfc_ndef_status_formattable:
-		readonly = FALSE;
-		break;
-	case hal_impl_nfc_ndef_status_readonly:
-	case hal_impl_nfc_ndef_status_invalid:
-	default:
-		readonly = TRUE;
-		break;
-	}
-
-	g_rec_mutex_unlock(&pTag->mutex);
+	gboolean readonly = hal_impl_tag_is_readonly(pTag);
+	hal_impl_tag_release(pHalImpl, pTag);
 
 	return readonly;
 }
@@ -343,9 +392,7 @@ gboolean hal_tag_is_iso14443a(hal_t* pHal, guint tagId)
 {
 	hal_impl_t* pHalImpl = (hal_impl_t*) pHal;
 
-	g_mutex_lock(&pHalImpl->tagTableMutex);
-	hal_impl_tag_t* pTag = g_hash_table_lookup(pHalImpl->pTagTable, GUINT_TO_POINTER(tagId));
-	g_mutex_unlock(&pHalImpl->tagTableMutex);
+	hal_impl_tag_t* pTag = hal_impl_tag_lookup(pHalImpl, tagId);
 
 	if(pTag == NULL)
 	{
@@ -353,9 +400,8 @@ gboolean hal_tag_is_iso14443a(hal_t* pHal, guint tagId)
 		return FALSE;
 	}
 
-	g_rec_mutex_lock(&pTag->mutex);
 	gboolean iso14443a = HAL_IMPL_NFC_TYPE_IS_TAG_ISO14443A(pTag->type);
-	g_rec_mutex_unlock(&pTag->mutex);
+	hal_impl_tag_release(pHalImpl, pTag);
 
 	return iso14443a;
 }
@@ -364,9 +410,7 @@ void hal_tag_get_iso14443a_params(hal_t* pHal, guint tagId, guint8* atqa, guint8
 {
 	hal_impl_t* pHalImpl = (hal_impl_t*) pHal;
 
-	g_mutex_lock(&pHalImpl->tagTableMutex);
-	hal_impl_tag_t* pTag = g_hash_table_lookup(pHalImpl->pTagTable, GUINT_TO_POINTER(tagId));
-	g_mutex_unlock(&pHalImpl->tagTableMutex);
+	hal_impl_tag_t* pTag = hal_impl_tag_lookup(pHalImpl, tagId);
 
 	if(pTag == NULL)
 	{
@@ -374,21 +418,18 @@ void hal_tag_get_iso14443a_params(hal_t* pHal, guint tagId, guint8* atqa, guint8
 		return;
 	}
 
-	g_rec_mutex_lock(&pTag->mutex);
 	memcpy(atqa, pTag->iso14443a.atqa, 2);
 	*sak = pTag->iso14443a.sak;
 	memcpy(uid, pTag->iso14443a.uid, pTag->iso14443a.uidLength);
 	*pUidLength = pTag->iso14443a.uidLength;
-	g_rec_mutex_unlock(&pTag->mutex);
+	hal_impl_tag_release(pHalImpl, pTag);
 }
 
 gboolean hal_tag_is_felica(hal_t* pHal, guint tagId)
 {
 	hal_impl_t* pHalImpl = (hal_impl_t*) pHal;
 
-	g_mutex_lock(&pHalImpl->tagTableMutex);
-	hal_impl_tag_t* pTag = g_hash_table_lookup(pHalImpl->pTagTable, GUINT_TO_POINTER(tagId));
-	g_mutex_unlock(&pHalImpl->tagTableMutex);
+	hal_impl_tag_t* pTag = hal_impl_tag_lookup(pHalImpl, tagId);
 
 	if(pTag == NULL)
 	{
@@ -396,9 +437,8 @@ gboolean hal_tag_is_felica(hal_t* pHal, guint tagId)
 		return FALSE;
 	}
 
-	g_rec_mutex_lock(&pTag->mutex);
 	gboolean felica = HAL_IMPL_NFC_TYPE_IS_TAG_FELICA(pTag->type);
-	g_rec_mutex_unlock(&pTag->mutex);
+	hal_impl_tag_release(pHalImpl, pTag);
 
 	return felica;
 }
@@ -407,9 +447,7 @@ void hal_tag_get_felica_params(hal_t* pHal, guint tagId, guint8* manufacturer, g
 {
 	hal_impl_t* pHalImpl = (hal_impl_t*) pHal;
 
-	g_mutex_lock(&pHalImpl->tagTableMutex);
-	hal_impl_tag_t* pTag = g_hash_table_lookup(pHalImpl->pTagTable, GUINT_TO_POINTER(tagId));
-	g_mutex_unlock(&pHalImpl->tagTableMutex);
+	hal_impl_tag_t* pTag = hal_impl_tag_lookup(pHalImpl, tagId);
 
 	if(pTag == NULL)
 	{
@@ -417,68 +455,375 @@ void hal_tag_get_felica_params(hal_t* pHal, guint tagId, guint8* manufacturer, g
 		return;
 	}
 
-	g_rec_mutex_lock(&pTag->mutex);
 	memcpy(manufacturer, pTag->felica.manufacturer, sizeof(pTag->felica.manufacturer));
 	memcpy(cid, pTag->felica.cid, sizeof(pTag->felica.cid));
 	memcpy(ic, pTag->felica.ic, sizeof(pTag->felica.ic));
 	memcpy(maxRespTimes, pTag->felica.maxRespTimes, sizeof(pTag->felica.maxRespTimes));
-	g_rec_mutex_unlock(&pTag->mutex);
+	hal_impl_tag_release(pHalImpl, pTag);
+}
+
+gint64 hal_tag_get_timing(hal_t* pHal, guint tagId, nfc_tag_timing_t timing)
+{
+	hal_impl_t* pHalImpl = (hal_impl_t*) pHal;
+
+	hal_impl_tag_t* pTag = hal_impl_tag_lookup(pHalImpl, tagId);
+
+	if(pTag == NULL)
+	{
+		g_error("Did not find hal_impl_tag_t instance of id %d", tagId);
+		return 0;
+	}
+
+	//64-bit reads are not atomic on every platform
+	gint64 time;
+	guint seq;
+	do
+	{
+		seq = hal_impl_object_read_begin(&pTag->object);
+		time = pTag->timings[timing];
+	} while( hal_impl_object_read_retry(&pTag->object, seq) );
+	hal_impl_tag_release(pHalImpl, pTag);
+
+	return time;
+}
+
+void hal_tag_set_timing(hal_t* pHal, guint tagId, nfc_tag_timing_t timing)
+{
+	hal_impl_tag_set_timing((hal_impl_t*) pHal, tagId, timing, g_get_monotonic_time());
+}
+
+void hal_impl_tag_set_timing(hal_impl_t* pHal, guint tagId, nfc_tag_timing_t timing, gint64 time)
+{
+	hal_impl_tag_t* pTag = hal_impl_tag_lookup(pHal, tagId);
+
+	if(pTag == NULL)
+	{
+		g_error("Did not find hal_impl_tag_t instance of id %d", tagId);
+		return;
+	}
+
+	hal_impl_object_write_begin(&pTag->object);
+	pTag->timings[timing] = time;
+	hal_impl_object_write_end(&pTag->object);
+	hal_impl_tag_release(pHal, pTag);
 }
 
 void hal_impl_tag_disconnected(hal_impl_t* pHal, guint tagId)
 {
-	g_mutex_lock(&pHal->tagTableMutex);
-	hal_impl_tag_t* pTag = g_hash_table_lookup(pHal->pTagTable, GUINT_TO_POINTER(tagId));
-	g_mutex_unlock(&pHal->tagTableMutex);
+	hal_impl_tag_t* pTag = hal_impl_tag_lookup(pHal, tagId);
 
 	if(pTag == NULL)
 	{
 		g_error("Did not find hal_impl_tag_t instance of id %d", tagId);
+		return;
 	}
-	g_rec_mutex_lock(&pTag->mutex);
-	pTag->connected = FALSE;
-	g_rec_mutex_unlock(&pTag->mutex);
+	g_atomic_int_set(&pTag->connected, FALSE);
+	hal_impl_tag_release(pHal, pTag);
 }
 
-void hal_impl_tag_ndef_write(hal_impl_t* pHal, guint tagId, guint8* buffer, gsize length)
+nfc_tag_write_result_t hal_impl_tag_ndef_verify(hal_impl_t* pHal, hal_impl_tag_t* pTag, const guint8* buffer, gsize length)
 {
-	//Make sure tag won't get destroyed by other thread
-	hal_tag_ref((hal_t*)pHal, tagId);
+	//Read the message back while the tag is still in the field
+	if( pHal->pBackend->tag_ndef_read(pHal, pTag->object.id) != PH_ERR_SUCCESS )
+	{
+		g_warning("Could not read tag back");
+		return nfc_tag_write_verify_failed;
+	}
 
-	g_mutex_lock(&pHal->tagTableMutex);
-	hal_impl_tag_t* pTag = g_hash_table_lookup(pHal->pTagTable, GUINT_TO_POINTER(tagId));
-	g_mutex_unlock(&pHal->tagTableMutex);
+	nfc_tag_write_result_t result = nfc_tag_write_success;
+
+	GBytes* pBytes = hal_impl_object_get_bytes(&pTag->object, &pTag->message.pBytes);
+	gsize readLength = 0;
+	const guint8* readBuffer = (pBytes != NULL) ? g_bytes_get_data(pBytes, &readLength) : NULL;
+	if( (readLength != length) || ((length > 0) && memcmp(readBuffer, buffer, length)) )
+	{
+		g_warning("Message read back differs from the one written");
+		result = nfc_tag_write_verify_failed;
+	}
+
+	if( pBytes != NULL )
+	{
+		g_bytes_unref(pBytes);
+	}
+
+	return result;
+}
+
+void hal_impl_tag_ndef_write(hal_impl_t* pHal, const hal_impl_cmd_info_t* pCmdInfo)
+{
+	guint tagId = pCmdInfo->tagId;
+	nfc_tag_write_result_t result;
+	gint64 duration = 0;
+	gsize sent = 0;
+
+	//Make sure tag won't get destroyed by other thread
+	hal_impl_tag_t* pTag = hal_impl_tag_lookup(pHal, tagId);
 
 	if(pTag == NULL)
 	{
 		g_warning("Did not find hal_impl_tag_t instance of id %d", tagId);
+		hal_impl_call_tag_write_cb(pHal, tagId, nfc_tag_write_not_connected, 0, pCmdInfo->bufferLength, 0,
+				pCmdInfo->writeCb, pCmdInfo->pWriteUserData);
 		return;
 	}
 
-	gboolean connected;
-	g_rec_mutex_lock(&pTag->mutex);
-	connected = pTag->connected;
-	g_rec_mutex_unlock(&pTag->mutex);
+	if(!g_atomic_int_get(&pTag->connected))
+	{
+		g_warning("Tag is disconnected\r\n");
+		result = nfc_tag_write_not_connected;
+	}
+	else if(g_atomic_int_get(&pTag->status) == hal_impl_nfc_ndef_status_readonly)
+	{
+		g_warning("Tag is read only");
+		result = nfc_tag_write_read_only;
+	}
+	else if(!hal_impl_session_select(pHal, tagId))
+	{
+		//Shares the field with other tags and could not be woken up
+		result = nfc_tag_write_not_connected;
+	}
+	else
+	{
+		gint64 start = g_get_monotonic_time();
+		hal_impl_tag_set_timing(pHal, tagId, nfc_tag_timing_write_start, start);
+		hal_impl_tag_set_timing(pHal, tagId, nfc_tag_timing_verify_end, 0);
+
+		phStatus_t status = pHal->pBackend->tag_ndef_write(pHal, tagId, pCmdInfo->buffer, pCmdInfo->bufferLength, &sent);
+		gint64 end = g_get_monotonic_time();
+		hal_impl_tag_set_timing(pHal, tagId, nfc_tag_timing_write_end, end);
+
+		//Whatever the outcome, the cached message cannot be trusted anymore
+		hal_impl_cache_invalidate(pHal, tagId);
+
+		if( status != PH_ERR_SUCCESS )
+		{
+			result = nfc_tag_write_failed;
+		}
+		else if( pCmdInfo->verify )
+		{
+			result = hal_impl_tag_ndef_verify(pHal, pTag, pCmdInfo->buffer, pCmdInfo->bufferLength);
+			end = g_get_monotonic_time();
+			hal_impl_tag_set_timing(pHal, tagId, nfc_tag_timing_verify_end, end);
+		}
+		else
+		{
+			result = nfc_tag_write_success;
+		}
+
+		duration = end - start;
+	}
+
+	hal_impl_tag_release(pHal, pTag);
 
-	if(connected)
+	hal_impl_call_tag_write_cb(pHal, tagId, result, duration, pCmdInfo->bufferLength, sent,
+			pCmdInfo->writeCb, pCmdInfo->pWriteUserData);
+}
+
+static gboolean rdlib_tag_top_type(hal_impl_nfc_type_t nfcType, uint16_t* pTagType)
+{
+	switch(	nfcType )
 	{
-		rdlib_tag_ndef_write(pHal, tagId, buffer, length); //TODO callback?
+	case hal_impl_nfc_tag_type_1:
+		*pTagType = PHAL_TOP_TAG_TYPE_T1T_TAG;
+		return TRUE;
+	case hal_impl_nfc_tag_type_2:
+		*pTagType = PHAL_TOP_TAG_TYPE_T2T_TAG;
+		return TRUE;
+	case hal_impl_nfc_tag_type_3:
+		*pTagType = PHAL_TOP_TAG_TYPE_T3T_TAG;
+		return TRUE;
+	case hal_impl_nfc_tag_type_4a:
+		*pTagType = PHAL_TOP_TAG_TYPE_T4T_TAG;
+		return TRUE;
+	default:
+		return FALSE;
+	}
+}
+
+phStatus_t rdlib_tag_init(hal_impl_t* pHal, hal_impl_tag_t* pTag)
+{
+	hal_impl_nfc_type_t nfcType = pTag->type;
+
+	//Reset Top parameters
+	phalTop_Reset(&pHal->rdlib.tagop);
+
+	//Forget the previous tag's memory image
+	rdlib_tag_image_clear(pHal);
+	pHal->rdlib.image.written = FALSE;
+	pHal->rdlib.image.topStale = FALSE;
+
+	uint16_t tagType;
+	if( !rdlib_tag_top_type(nfcType, &tagType) )
+	{
+		return PH_ERR_INVALID_PARAMETER;
+	}
+
+	//Activated tag in the discovery loop's results
+	guint i = pHal->rdlib.activeIndex;
+
+	//If tag is ISO14443A-compliant
+	if( HAL_IMPL_NFC_TYPE_IS_TAG_ISO14443A(nfcType) )
+	{
+		memcpy(pTag->iso14443a.atqa, pHal->rdlib.discLoop.sTypeATargetInfo.aTypeA_I3P3[i].aAtqa, 2);
+		pTag->iso14443a.sak = pHal->rdlib.discLoop.sTypeATargetInfo.aTypeA_I3P3[i].aSak;
+		memcpy(pTag->iso14443a.uid, pHal->rdlib.discLoop.sTypeATargetInfo.aTypeA_I3P3[i].aUid, 10);
+		pTag->iso14443a.uidLength = pHal->rdlib.discLoop.sTypeATargetInfo.aTypeA_I3P3[i].bUidSize;
+	}
+
+	//If tag is ISO14443A-compliant
+	if( HAL_IMPL_NFC_TYPE_IS_TAG_FELICA(nfcType) )
+	{
+		memcpy(pTag->felica.manufacturer, &pHal->rdlib.discLoop.sTypeFTargetInfo.aTypeFTag[i].aIDmPMm[0], 2);
+		memcpy(pTag->felica.cid, &pHal->rdlib.discLoop.sTypeFTargetInfo.aTypeFTag[i].aIDmPMm[2], 6);
+		memcpy(pTag->felica.ic, &pHal->rdlib.discLoop.sTypeFTargetInfo.aTypeFTag[i].aIDmPMm[2+6], 2);
+		memcpy(pTag->felica.maxRespTimes, &pHal->rdlib.discLoop.sTypeFTargetInfo.aTypeFTag[i].aIDmPMm[2+6+2], 6);
+	}
+
+	//Set tag parameters
+	phalTop_SetConfig(&pHal->rdlib.tagop, PHAL_TOP_CONFIG_TAG_TYPE, tagType);
+
+	//Check if a NDEF message is there
+	uint8_t value = 0;
+	phStatus_t status = phalTop_CheckNdef(&pHal->rdlib.tagop, &value);
+	if((status != PH_ERR_SUCCESS) && 
+	(status & PH_ERR_MASK) != PHAL_TOP_ERR_NON_NDEF_TAG && 
+	(status & PH_ERR_MASK) != PHAL_TOP_ERR_MISCONFIGURED_TAG)
+	{
+		g_warning("phalTop_CheckNdef() returned %04X\n", status);
+		pTag->status = hal_impl_nfc_ndef_status_invalid;
 	}
 	else
 	{
-		g_warning("Tag is disconnected\r\n");
+		//Is Tag in R/W or RO mode?
+		if( value == PHAL_TOP_STATE_READWRITE  )
+		{
+			pTag->status = hal_impl_nfc_ndef_status_readwrite;
+		}
+		else if( value ==  PHAL_TOP_STATE_READONLY )
+		{
+			pTag->status = hal_impl_nfc_ndef_status_readonly;
+		}
+		else
+		{
+			pTag->status = hal_impl_nfc_ndef_status_formattable;
+		}
+	}
+
+
+	if( pTag->status != hal_impl_nfc_ndef_status_invalid )
+	{
+		uint16_t value;
+
+		phalTop_GetConfig(&pHal->rdlib.tagop, PHAL_TOP_CONFIG_MAX_NDEF_LENGTH, &value);
+
+		pTag->message.size = (gsize)value;
+		//pTag->message.buffer = g_malloc(pTag->message.size);
+
+		phalTop_GetConfig(&pHal->rdlib.tagop, PHAL_TOP_CONFIG_NDEF_LENGTH, &value);
+		pTag->ndefLength = (gsize)value;
+
+		//Read the tag's header so that a cached NDEF message can be validated against it
+		if( (pHal->pCache != NULL) && (pHal->pCache->validation == nfc_cache_validation_header) )
+		{
+			rdlib_tag_read_header(pHal, pTag);
+		}
+	}
+
+	return PH_ERR_SUCCESS;
+}
+
+phStatus_t rdlib_tag_activate(hal_impl_t* pHal, const hal_impl_nfc_target_t* pTarget)
+{
+	phStatus_t status;
+
+	if( pTarget->index != pHal->rdlib.activeIndex )
+	{
+		//Put the current tag to sleep first, so that only the requested one answers
+		for(guint i = 0; i < pHal->rdlib.targetCount; i++)
+		{
+			if( pHal->rdlib.targets[i].index != pHal->rdlib.activeIndex )
+			{
+				continue;
+			}
+
+			if( pHal->rdlib.targets[i].type == hal_impl_nfc_tag_type_4a )
+			{
+				phpalI14443p4_Deselect(&pHal->rdlib.palI14443p4);
+			}
+			else if( pHal->rdlib.targets[i].type == hal_impl_nfc_tag_type_2 )
+			{
+				phpalI14443p3a_HaltA(&pHal->rdlib.palI14443p3a);
+			}
+			break;
+		}
+
+		status = phacDiscLoop_ActivateCard(&pHal->rdlib.discLoop, pTarget->tech, (uint8_t)pTarget->index);
+		if( (status & PH_ERR_MASK) != PHAC_DISCLOOP_DEVICE_ACTIVATED )
+		{
+			g_warning("Could not activate tag %u, error %04X", pTarget->index, status);
+			return PH_ERR_FAILED;
+		}
+
+		pHal->rdlib.activeIndex = pTarget->index;
 	}
 
-	hal_tag_unref((hal_t*)pHal, tagId);
+	//phalTop may still be set up for another tag, the NDEF length is checked again before it is used
+	uint16_t tagType;
+	if( rdlib_tag_top_type(pTarget->type, &tagType) )
+	{
+		phalTop_Reset(&pHal->rdlib.tagop);
+		phalTop_SetConfig(&pHal->rdlib.tagop, PHAL_TOP_CONFIG_TAG_TYPE, tagType);
+		pHal->rdlib.image.topStale = TRUE;
+	}
+
+	return PH_ERR_SUCCESS;
+}
+
+phStatus_t rdlib_tag_read_header_block(hal_impl_t* pHal, hal_impl_nfc_type_t type, guint8* header)
+{
+	uint8_t rxNumBlocks;
+
+	//Felica specific
+	uint8_t bAttributeBlockList[2] = { 0x80, 0x00 }; /* Attribute Information Block is block 0 */
+	uint8_t bReadServiceList[2] = { 0x0B, 0x00};
+
+	switch(type)
+	{
+	case hal_impl_nfc_tag_type_2:
+		//Capability container (page 3) followed by the first TLVs
+		return phalMful_Read(&pHal->rdlib.alMful, 0x03, header);
+	case hal_impl_nfc_tag_type_3:
+		return phalFelica_Read(&pHal->rdlib.alFelica, 0x01, bReadServiceList, 0x01,
+				bAttributeBlockList, 0x02, &rxNumBlocks, header);
+	default:
+		return PH_ERR_UNSUPPORTED_COMMAND;
+	}
+}
+
+void rdlib_tag_read_header(hal_impl_t* pHal, hal_impl_tag_t* pTag)
+{
+	//No cheap header read for other types, validation falls back to the NDEF length
+	if( (pTag->type != hal_impl_nfc_tag_type_2) && (pTag->type != hal_impl_nfc_tag_type_3) )
+	{
+		return;
+	}
+
+	phStatus_t status = rdlib_tag_read_header_block(pHal, pTag->type, pTag->header);
+	if( status == PH_ERR_SUCCESS )
+	{
+		pTag->headerLength = HAL_IMPL_TAG_HEADER_SIZE;
+	}
+	else
+	{
+		g_warning("Could not read tag header, error %04X", status);
+	}
 }
 
 phStatus_t rdlib_tag_ndef_read(hal_impl_t* pHal, guint tagId)
 {
     phStatus_t    status;
 
-	g_mutex_lock(&pHal->tagTableMutex);
-	hal_impl_tag_t* pTag = g_hash_table_lookup(pHal->pTagTable, GUINT_TO_POINTER(tagId));
-	g_mutex_unlock(&pHal->tagTableMutex);
+	hal_impl_tag_t* pTag = hal_impl_tag_lookup(pHal, tagId);
 
 	if(pTag == NULL)
 	{
@@ -487,31 +832,36 @@ phStatus_t rdlib_tag_ndef_read(hal_impl_t* pHal, guint tagId)
 	}
 
     uint16_t length = 0;
-    gsize allocSize;
-
-	g_rec_mutex_lock(&pTag->mutex);
-	allocSize = pTag->message.size;
-	g_rec_mutex_unlock(&pTag->mutex);
+    gsize allocSize = pTag->message.size;
 
 	if(allocSize == 0)
 	{
+		hal_impl_tag_release(pHal, pTag);
 		return PH_ERR_SUCCESS; //NDEF message is empty
 	}
 
+	//A differential write bypassed phalTop, let it find the new NDEF length
+	if( pHal->rdlib.image.topStale )
+	{
+		uint8_t value = 0;
+		phalTop_CheckNdef(&pHal->rdlib.tagop, &value);
+		pHal->rdlib.image.topStale = FALSE;
+	}
+
 	uint8_t* buffer = g_malloc(allocSize);
 
     status = phalTop_ReadNdef(&pHal->rdlib.tagop, buffer, &length);
     if((status & PH_ERR_MASK) == PH_ERR_SUCCESS)
     {
-		g_rec_mutex_lock(&pTag->mutex);
-		pTag->message.length = length;
-		if(pTag->message.buffer != NULL)
-		{
-			g_free(pTag->message.buffer);
-		}
-		pTag->message.buffer = buffer;
-		g_rec_mutex_unlock(&pTag->mutex);
+		//The buffer is handed over as is, it is not copied again on its way to D-Bus
+		GBytes* pBytes = g_bytes_new_take(g_realloc(buffer, length), length);
+
+		//What was just read is what is on the tag
+		rdlib_tag_image_set(pHal, tagId, pBytes);
+
+		hal_impl_tag_set_message(pTag, pBytes);
     }
+    hal_impl_tag_release(pHal, pTag);
     if((status & PH_ERR_MASK) != PH_ERR_SUCCESS)
     {
     	g_free(buffer);
@@ -521,13 +871,11 @@ phStatus_t rdlib_tag_ndef_read(hal_impl_t* pHal, guint tagId)
 	return PH_ERR_SUCCESS;
 }
 
-phStatus_t rdlib_tag_ndef_write(hal_impl_t* pHal, guint tagId, guint8* buffer, gsize length)
+phStatus_t rdlib_tag_ndef_write(hal_impl_t* pHal, guint tagId, guint8* buffer, gsize length, gsize* pSent)
 {
     phStatus_t    status;
 
-	g_mutex_lock(&pHal->tagTableMutex);
-	hal_impl_tag_t* pTag = g_hash_table_lookup(pHal->pTagTable, GUINT_TO_POINTER(tagId));
-	g_mutex_unlock(&pHal->tagTableMutex);
+	hal_impl_tag_t* pTag = hal_impl_tag_lookup(pHal, tagId);
 
 	if(pTag == NULL)
 	{
@@ -535,9 +883,7 @@ phStatus_t rdlib_tag_ndef_write(hal_impl_t* pHal, guint tagId, guint8* buffer, g
 		return PH_ERR_FAILED;
 	}
 
-	g_rec_mutex_lock(&pTag->mutex);
-	hal_impl_nfc_ndef_status_t tagStatus = pTag->status;
-	g_rec_mutex_unlock(&pTag->mutex);
+	hal_impl_nfc_ndef_status_t tagStatus = g_atomic_int_get(&pTag->status);
 
 	if( tagStatus == hal_impl_nfc_ndef_status_formattable )
 	{
@@ -552,29 +898,56 @@ phStatus_t rdlib_tag_ndef_write(hal_impl_t* pHal, guint tagId, guint8* buffer, g
 	    	if(status & PH_ERR_MASK == PHAL_TOP_ERR_FORMATTED_TAG)
 	    		g_info("Tag already formatted");
 
-	    	g_rec_mutex_lock(&pTag->mutex);
-			pTag->status = hal_impl_nfc_ndef_status_readwrite;
-			g_rec_mutex_unlock(&pTag->mutex);
+			g_atomic_int_set(&pTag->status, hal_impl_nfc_ndef_status_readwrite);
 			tagStatus = hal_impl_nfc_ndef_status_readwrite;
 	    }
 	    /* check NDEF must not be performed because it leaves invalid TOP status which avoids subsequent write */
 	}
 
+	//Only send the pages or blocks which differ from what is on the tag, if its memory image is known
+	status = PH_ERR_UNSUPPORTED_COMMAND;
+	if( tagStatus == hal_impl_nfc_ndef_status_readwrite )
+	{
+		status = rdlib_tag_ndef_write_diff(pHal, pTag, buffer, length, pSent);
+	}
+
+	if( (status & PH_ERR_MASK) == PH_ERR_UNSUPPORTED_COMMAND )
+	{
+		if( pHal->rdlib.image.topStale )
+		{
+			uint8_t value = 0;
+			phalTop_CheckNdef(&pHal->rdlib.tagop, &value);
+			pHal->rdlib.image.topStale = FALSE;
+		}
+
+		status = phalTop_WriteNdef(&pHal->rdlib.tagop, buffer, (guint16)length);
+
+		//phalTop does not say how much it sent, assume the whole message went through
+		*pSent = length;
+	}
+
+	pHal->rdlib.image.written = TRUE;
 
-    status = phalTop_WriteNdef(&pHal->rdlib.tagop, buffer, (guint16)length);
     if((status & PH_ERR_MASK) != PH_ERR_SUCCESS)
     {
     	g_warning("Could not write tag");
+    	//The tag might have been partially written
+    	rdlib_tag_image_clear(pHal);
+    	hal_impl_tag_release(pHal, pTag);
     	return PH_ERR_FAILED;
     }
-    else if(tagStatus != hal_impl_nfc_ndef_status_readwrite)
+
+    GBytes* pBytes = g_bytes_new(buffer, length);
+    rdlib_tag_image_set(pHal, tagId, pBytes);
+    g_bytes_unref(pBytes);
+
+    if(tagStatus != hal_impl_nfc_ndef_status_readwrite)
     {
-    	g_rec_mutex_lock(&pTag->mutex);
-		pTag->status = hal_impl_nfc_ndef_status_readwrite;
-		g_rec_mutex_unlock(&pTag->mutex);
+		g_atomic_int_set(&pTag->status, hal_impl_nfc_ndef_status_readwrite);
     }
+    hal_impl_tag_release(pHal, pTag);
 
-    g_info("Tag written");
+    g_info("Tag written, %" G_GSIZE_FORMAT " bytes sent", *pSent);
 
 	return PH_ERR_SUCCESS;
 }
@@ -585,15 +958,9 @@ phStatus_t rdlib_tag_presence_check(hal_impl_t* pHal, guint tagId)
 
     uint8_t dummy[16];
     uint16_t length = 0;
-    uint8_t rxNumBlocks;
-
-    //Felica specific
-    uint8_t bMCBlockList[2] = { 0x80, 0x88 }; /* Memory Configuration(MC) Block is 88h */
-    uint8_t bReadServiceList[2] = { 0x0B, 0x00};
+    uint8_t mode;
 
-	g_mutex_lock(&pHal->tagTableMutex);
-	hal_impl_tag_t* pTag = g_hash_table_lookup(pHal->pTagTable, GUINT_TO_POINTER(tagId));
-	g_mutex_unlock(&pHal->tagTableMutex);
+	hal_impl_tag_t* pTag = hal_impl_tag_lookup(pHal, tagId);
 
 	if(pTag == NULL)
 	{
@@ -601,23 +968,28 @@ phStatus_t rdlib_tag_presence_check(hal_impl_t* pHal, guint tagId)
 		return PH_ERR_FAILED;
 	}
 
-	g_rec_mutex_lock(&pTag->mutex);
 	hal_impl_nfc_type_t type = pTag->type;
-	g_rec_mutex_unlock(&pTag->mutex);
+	hal_impl_tag_release(pHal, pTag);
 
+	//Cheapest exchange each type answers to without changing state
 	switch(type)
 	{
 	case hal_impl_nfc_tag_type_1:
+		//Single byte read
 		status = phalT1T_ReadByte(&pHal->rdlib.alT1T, pHal->rdlib.t1tparam.bUid, 0x00, dummy, &length);
 		break;
 	case hal_impl_nfc_tag_type_2:
+		//A single READ is the floor: it is the only command every Type 2 tag must answer (GET_VERSION and
+		//FAST_READ are NTAG only), anything else is NAKed and sends the tag back to IDLE, and selecting it
+		//again (WUPA, anticollision and SELECT for each cascade level) costs more than the 16 bytes returned
 		status = phalMful_Read(&pHal->rdlib.alMful, 0x03, dummy);
 		break;
 	case hal_impl_nfc_tag_type_3:
-		status = phalFelica_Read(&pHal->rdlib.alFelica, 0x01, bReadServiceList, 0x01,
-				bMCBlockList, 0x02, &rxNumBlocks, dummy);
+		//Request Response: no service or block list, a single byte of payload in the reply
+		status = phalFelica_RequestResponse(&pHal->rdlib.alFelica, &mode);
 		break;
 	case hal_impl_nfc_tag_type_4a:
+		//Empty I-block / R(NAK) exchange
 		status = phpalI14443p4_PresCheck(&pHal->rdlib.palI14443p4);
 		break;
 	default:
@@ -631,3 +1003,58 @@ phStatus_t rdlib_tag_presence_check(hal_impl_t* pHal, guint tagId)
 
     return PH_ERR_SUCCESS;
 }
+
+phStatus_t rdlib_tag_lock(hal_impl_t* pHal, guint tagId)
+{
+	phStatus_t status;
+	uint8_t page[16]; //A read returns 4 pages
+
+	hal_impl_tag_t* pTag = hal_impl_tag_lookup(pHal, tagId);
+
+	if(pTag == NULL)
+	{
+		g_error("Did not find hal_impl_tag_t instance of id %d", tagId);
+		return PH_ERR_FAILED;
+	}
+
+	//Only the static memory layout of Type 2 tags is supported
+	if( pTag->type != hal_impl_nfc_tag_type_2 )
+	{
+		g_warning("Locking is not supported for this tag type");
+		hal_impl_tag_release(pHal, pTag);
+		return PH_ERR_UNSUPPORTED_COMMAND;
+	}
+
+	//Capability container first, as the lock bytes also protect it: no write access
+	status = phalMful_Read(&pHal->rdlib.alMful, 0x03, page);
+	if( status == PH_ERR_SUCCESS )
+	{
+		page[3] = 0x0F;
+		status = phalMful_Write(&pHal->rdlib.alMful, 0x03, page);
+	}
+
+	//Then the static lock bytes (page 2, bytes 2 and 3)
+	if( status == PH_ERR_SUCCESS )
+	{
+		status = phalMful_Read(&pHal->rdlib.alMful, 0x02, page);
+	}
+	if( status == PH_ERR_SUCCESS )
+	{
+		page[2] = 0xFF;
+		page[3] = 0xFF;
+		status = phalMful_Write(&pHal->rdlib.alMful, 0x02, page);
+	}
+
+	if( (status & PH_ERR_MASK) != PH_ERR_SUCCESS )
+	{
+		g_warning("Could not lock tag, error %04X", status);
+	}
+	else
+	{
+		g_atomic_int_set(&pTag->status, hal_impl_nfc_ndef_status_readonly);
+	}
+
+	hal_impl_tag_release(pHal, pTag);
+
+	return status;
+}
@@ -0,0 +1,459 @@
+/*
+*         Copyright (c), NXP Semiconductors Gratkorn / Austria
+*
+*                     (C)NXP Semiconductors
+*       All rights are reserved. Reproduction in whole or in part is
+*      prohibited without the written consent of the copyright owner.
+*  NXP reserves the right to make changes without notice at any time.
+* NXP makes no warranty, expressed, implied or statutory, including but
+* not limited to any implied warranty of merchantability or fitness for any
+*particular purpose, or that the use will not infringe any third party patent,
+* copyright or trademark. NXP must not be liable for any loss or damage
+*                          arising from its use.
+*/
+/**
+ * \file hal_tag_diff.c
+ * Differential NDEF writes for Type 2 and Type 3 tags
+ *
+ * The reader library backend keeps an image of the tag in the field: the NDEF
+ * message last read or written and the tag's header (capability container and
+ * first TLVs for Type 2 tags, attribute information block for Type 3 tags).
+ * A new message is compared against it and only the pages or blocks which
+ * differ are sent.
+ *
+ * Updates stay tearing-safe: the NDEF length (T2T) or the attribute information
+ * block (T3T) is first marked as being updated, then the changed data is written,
+ * then the final length is written last.
+ *
+ * Whenever the layout is not the simple one handled here, PH_ERR_UNSUPPORTED_COMMAND
+ * is returned and the caller falls back to phalTop_WriteNdef().
+ */
+
+#include "hal.h"
+#include "hal_internal.h"
+
+#include <glib.h>
+#include <glib/gprintf.h>
+#include <gio/gio.h>
+
+void rdlib_tag_image_clear(hal_impl_t* pHal)
+{
+	if( pHal->rdlib.image.pMessage != NULL )
+	{
+		g_bytes_unref(pHal->rdlib.image.pMessage);
+	}
+	pHal->rdlib.image.pMessage = NULL;
+	pHal->rdlib.image.tagId = 0;
+	pHal->rdlib.image.headerValid = FALSE;
+}
+
+void rdlib_tag_image_set(hal_impl_t* pHal, guint tagId, GBytes* pMessage)
+{
+	//The header is read again when needed, the message might have moved it
+	rdlib_tag_image_clear(pHal);
+	pHal->rdlib.image.tagId = tagId;
+	pHal->rdlib.image.pMessage = g_bytes_ref(pMessage);
+}
+
+//Make sure the image matches the tag, FALSE if that cannot be established
+static gboolean rdlib_tag_image_get(hal_impl_t* pHal, hal_impl_tag_t* pTag)
+{
+	guint tagId = pTag->object.id;
+
+	if( pHal->rdlib.image.tagId != tagId )
+	{
+		//The message was not read from the tag but taken from the cache: only trust it
+		//if the cache checked it against the tag's header
+		if( (pHal->pCache == NULL) || (pHal->pCache->validation != nfc_cache_validation_header)
+				|| (pTag->headerLength != HAL_IMPL_TAG_HEADER_SIZE) || pHal->rdlib.image.written )
+		{
+			return FALSE;
+		}
+
+		GBytes* pBytes = hal_impl_object_get_bytes(&pTag->object, &pTag->message.pBytes);
+		if( pBytes == NULL )
+		{
+			return FALSE;
+		}
+		rdlib_tag_image_set(pHal, tagId, pBytes);
+		g_bytes_unref(pBytes);
+	}
+
+	if( !pHal->rdlib.image.headerValid )
+	{
+		//The header read at detection is good as long as the tag has not been written
+		if( !pHal->rdlib.image.written && (pTag->headerLength == HAL_IMPL_TAG_HEADER_SIZE) )
+		{
+			memcpy(pHal->rdlib.image.header, pTag->header, HAL_IMPL_TAG_HEADER_SIZE);
+		}
+		else if( rdlib_tag_read_header_block(pHal, pTag->type, pHal->rdlib.image.header) != PH_ERR_SUCCESS )
+		{
+			return FALSE;
+		}
+		pHal->rdlib.image.headerValid = TRUE;
+	}
+
+	return TRUE;
+}
+
+static phStatus_t rdlib_t2t_write_page(hal_impl_t* pHal, gsize page, guint8* data, gsize* pSent)
+{
+	//Pages are counted from the start of the data area (page 4)
+	phStatus_t status = phalMful_Write(&pHal->rdlib.alMful, (uint8_t)(4 + page), data);
+	*pSent += HAL_T2T_PAGE_SIZE;
+	return status;
+}
+
+static phStatus_t rdlib_t2t_write_diff(hal_impl_t* pHal, const guint8* oldMessage, gsize oldLength,
+		const guint8* buffer, gsize length, gsize* pSent)
+{
+	const guint8* header = pHal->rdlib.image.header;
+	const guint8* data = &header[4]; //Pages 4 to 6
+	const gsize dataKnown = HAL_IMPL_TAG_HEADER_SIZE - 4;
+	gsize dataSize = (gsize)header[2] * 8; //Data area size from the capability container
+
+	//READ and WRITE only address pages 0 to 255, larger tags need a sector select
+	if( 4 + (dataSize + HAL_T2T_PAGE_SIZE - 1) / HAL_T2T_PAGE_SIZE > 256 )
+	{
+		return PH_ERR_UNSUPPORTED_COMMAND;
+	}
+
+	//Locate the NDEF TLV, only lock control and NULL TLVs may come first
+	gsize start = 0;
+	while( (start < dataKnown) && (data[start] != 0x03) )
+	{
+		if( data[start] == 0x00 )
+		{
+			start++;
+		}
+		else if( (data[start] == 0x01) && (start + 1 < dataKnown) )
+		{
+			start += 2 + data[start + 1];
+		}
+		else
+		{
+			//Memory control TLVs reserve areas within the data area
+			return PH_ERR_UNSUPPORTED_COMMAND;
+		}
+	}
+
+	if( start + 1 >= dataKnown )
+	{
+		return PH_ERR_UNSUPPORTED_COMMAND;
+	}
+
+	gsize lengthSize = (data[start + 1] == 0xFF) ? 3 : 1;
+	if( start + 1 + lengthSize > dataKnown )
+	{
+		return PH_ERR_UNSUPPORTED_COMMAND;
+	}
+
+	gsize tlvLength = (lengthSize == 3) ? (((gsize)data[start + 2] << 8) | data[start + 3]) : data[start + 1];
+	if( tlvLength != oldLength )
+	{
+		g_debug("Tag image is out of date");
+		return PH_ERR_UNSUPPORTED_COMMAND;
+	}
+
+	//The message must stay where it is and fit in the data area
+	if( (((length < 0xFF) ? 1 : 3) != lengthSize) || (start + 1 + lengthSize + length > dataSize) )
+	{
+		return PH_ERR_UNSUPPORTED_COMMAND;
+	}
+
+	gsize oldEnd = start + 1 + lengthSize + oldLength;
+	gsize newEnd = start + 1 + lengthSize + length;
+	gsize end = MIN(newEnd + 1, dataSize); //Including the terminator TLV if there is room for it
+
+	//The data area announced by the capability container must hold what was read and the old message
+	if( (dataSize < dataKnown) || (oldEnd > dataSize) )
+	{
+		return PH_ERR_UNSUPPORTED_COMMAND;
+	}
+
+	//What is known of the tag's data area
+	guint8* old = g_malloc0(dataSize);
+	guint8* known = g_malloc0(dataSize);
+	memcpy(old, data, MIN(dataKnown, dataSize));
+	memset(known, 1, MIN(dataKnown, dataSize));
+	if( oldLength > 0 )
+	{
+		memcpy(&old[start + 1 + lengthSize], oldMessage, oldLength);
+	}
+	memset(&known[start], 1, oldEnd - start);
+
+	//What it should become; past the new message, known bytes keep their old value and unknown ones are cleared
+	guint8* image = g_memdup(old, dataSize);
+	if( lengthSize == 3 )
+	{
+		image[start + 2] = (guint8)(length >> 8);
+		image[start + 3] = (guint8)(length & 0xFF);
+	}
+	else
+	{
+		image[start + 1] = (guint8)length;
+	}
+	if( length > 0 )
+	{
+		memcpy(&image[start + 1 + lengthSize], buffer, length);
+	}
+	if( newEnd < dataSize )
+	{
+		image[newEnd] = 0xFE;
+	}
+
+	//The length field lies within the first pages, which are known
+	gsize firstLengthPage = (start + 1) / HAL_T2T_PAGE_SIZE;
+	gsize lastLengthPage = (start + lengthSize) / HAL_T2T_PAGE_SIZE;
+	gsize pageCount = (end + HAL_T2T_PAGE_SIZE - 1) / HAL_T2T_PAGE_SIZE;
+
+	gboolean* dirty = g_new0(gboolean, pageCount);
+	gboolean bodyDirty = FALSE;
+	gboolean lengthDirty = FALSE;
+	for(gsize d = start; d < end; d++)
+	{
+		if( !known[d] || (old[d] != image[d]) )
+		{
+			gsize page = d / HAL_T2T_PAGE_SIZE;
+			dirty[page] = TRUE;
+			if( (page >= firstLengthPage) && (page <= lastLengthPage) )
+			{
+				lengthDirty = TRUE;
+			}
+			else
+			{
+				bodyDirty = TRUE;
+			}
+		}
+	}
+
+	phStatus_t status = PH_ERR_SUCCESS;
+
+	//Empty the message first, so that a torn write leaves an empty tag rather than a corrupted one
+	if( bodyDirty )
+	{
+		guint8 page[HAL_T2T_PAGE_SIZE];
+		for(gsize p = firstLengthPage; (p <= lastLengthPage) && (status == PH_ERR_SUCCESS); p++)
+		{
+			memcpy(page, &old[p * HAL_T2T_PAGE_SIZE], HAL_T2T_PAGE_SIZE);
+			for(gsize d = start + 1; d < start + 1 + lengthSize; d++)
+			{
+				if( d / HAL_T2T_PAGE_SIZE == p )
+				{
+					page[d % HAL_T2T_PAGE_SIZE] = ((lengthSize == 3) && (d == start + 1)) ? 0xFF : 0x00;
+				}
+			}
+			status = rdlib_t2t_write_page(pHal, p, page, pSent);
+		}
+	}
+
+	//Changed pages
+	for(gsize p = 0; (p < pageCount) && (status == PH_ERR_SUCCESS); p++)
+	{
+		if( dirty[p] && ((p < firstLengthPage) || (p > lastLengthPage)) )
+		{
+			status = rdlib_t2t_write_page(pHal, p, &image[p * HAL_T2T_PAGE_SIZE], pSent);
+		}
+	}
+
+	//Final length last
+	if( bodyDirty || lengthDirty )
+	{
+		for(gsize p = firstLengthPage; (p <= lastLengthPage) && (status == PH_ERR_SUCCESS); p++)
+		{
+			status = rdlib_t2t_write_page(pHal, p, &image[p * HAL_T2T_PAGE_SIZE], pSent);
+		}
+	}
+
+	g_free(dirty);
+	g_free(image);
+	g_free(known);
+	g_free(old);
+
+	return status;
+}
+
+static void rdlib_t3t_set_checksum(guint8* aib)
+{
+	guint16 sum = 0;
+	for(gsize i = 0; i < 14; i++)
+	{
+		sum += aib[i];
+	}
+	aib[14] = (guint8)(sum >> 8);
+	aib[15] = (guint8)(sum & 0xFF);
+}
+
+static phStatus_t rdlib_t3t_write_blocks(hal_impl_t* pHal, gsize block, gsize count, guint8* data, gsize* pSent)
+{
+	uint8_t bWriteServiceList[2] = { 0x09, 0x00 }; /* NDEF service, read/write */
+	uint8_t bBlockList[3 * HAL_T3T_MAX_BLOCKS_PER_WRITE];
+	uint8_t bBlockListLength = 0;
+
+	for(gsize i = 0; i < count; i++)
+	{
+		gsize n = block + i;
+		if( n < 256 )
+		{
+			//2-byte block list element
+			bBlockList[bBlockListLength++] = 0x80;
+			bBlockList[bBlockListLength++] = (uint8_t)n;
+		}
+		else
+		{
+			//3-byte block list element, block number is little endian
+			bBlockList[bBlockListLength++] = 0x00;
+			bBlockList[bBlockListLength++] = (uint8_t)(n & 0xFF);
+			bBlockList[bBlockListLength++] = (uint8_t)(n >> 8);
+		}
+	}
+
+	phStatus_t status = phalFelica_Write(&pHal->rdlib.alFelica, 0x01, bWriteServiceList, (uint8_t)count,
+			bBlockList, bBlockListLength, data);
+	*pSent += count * HAL_T3T_BLOCK_SIZE;
+	return status;
+}
+
+static phStatus_t rdlib_t3t_write_diff(hal_impl_t* pHal, const guint8* oldMessage, gsize oldLength,
+		const guint8* buffer, gsize length, gsize* pSent)
+{
+	guint8 aib[HAL_T3T_BLOCK_SIZE];
+	memcpy(aib, pHal->rdlib.image.header, HAL_T3T_BLOCK_SIZE);
+
+	//Attribute information block must be consistent and the tag idle and writable
+	guint8 checked[HAL_T3T_BLOCK_SIZE];
+	memcpy(checked, aib, HAL_T3T_BLOCK_SIZE);
+	rdlib_t3t_set_checksum(checked);
+	if( memcmp(checked, aib, HAL_T3T_BLOCK_SIZE) || (aib[9] != 0x00) || (aib[10] != 0x01) )
+	{
+		return PH_ERR_UNSUPPORTED_COMMAND;
+	}
+
+	gsize ln = ((gsize)aib[11] << 16) | ((gsize)aib[12] << 8) | aib[13];
+	if( ln != oldLength )
+	{
+		g_debug("Tag image is out of date");
+		return PH_ERR_UNSUPPORTED_COMMAND;
+	}
+
+	//At most 0xFFFF blocks, block numbers above 255 use 3-byte block list elements
+	gsize maxBlocks = ((gsize)aib[3] << 8) | aib[4];
+	if( length > maxBlocks * HAL_T3T_BLOCK_SIZE )
+	{
+		return PH_ERR_UNSUPPORTED_COMMAND;
+	}
+
+	gsize blocksPerWrite = MIN(MAX(aib[2], 1), HAL_T3T_MAX_BLOCKS_PER_WRITE);
+
+	//Data blocks, from block 1; past the new message, the last block keeps the bytes of the old message, zeros beyond it
+	gsize blockCount = (length + HAL_T3T_BLOCK_SIZE - 1) / HAL_T3T_BLOCK_SIZE;
+	guint8* image = g_malloc0(blockCount * HAL_T3T_BLOCK_SIZE + 1);
+	if( oldLength > 0 )
+	{
+		memcpy(image, oldMessage, MIN(oldLength, blockCount * HAL_T3T_BLOCK_SIZE));
+	}
+	if( length > 0 )
+	{
+		memcpy(image, buffer, length);
+	}
+
+	gboolean* dirty = g_new0(gboolean, blockCount + 1);
+	gboolean anyDirty = FALSE;
+	for(gsize d = 0; d < length; d++)
+	{
+		if( (d >= oldLength) || (oldMessage[d] != buffer[d]) )
+		{
+			dirty[d / HAL_T3T_BLOCK_SIZE] = TRUE;
+			anyDirty = TRUE;
+		}
+	}
+
+	phStatus_t status = PH_ERR_SUCCESS;
+
+	if( anyDirty )
+	{
+		//Flag the update in progress
+		aib[9] = 0x0F;
+		rdlib_t3t_set_checksum(aib);
+		status = rdlib_t3t_write_blocks(pHal, 0, 1, aib, pSent);
+	}
+
+	//Changed blocks, contiguous ones in a single command
+	gsize b = 0;
+	while( (b < blockCount) && (status == PH_ERR_SUCCESS) )
+	{
+		if( !dirty[b] )
+		{
+			b++;
+			continue;
+		}
+
+		gsize count = 1;
+		while( (b + count < blockCount) && dirty[b + count] && (count < blocksPerWrite) )
+		{
+			count++;
+		}
+		status = rdlib_t3t_write_blocks(pHal, 1 + b, count, &image[b * HAL_T3T_BLOCK_SIZE], pSent);
+		b += count;
+	}
+
+	//Final length last, clearing the update flag
+	if( (status == PH_ERR_SUCCESS) && (anyDirty || (length != oldLength)) )
+	{
+		aib[9] = 0x00;
+		aib[11] = (guint8)(length >> 16);
+		aib[12] = (guint8)(length >> 8);
+		aib[13] = (guint8)(length & 0xFF);
+		rdlib_t3t_set_checksum(aib);
+		status = rdlib_t3t_write_blocks(pHal, 0, 1, aib, pSent);
+	}
+
+	g_free(dirty);
+	g_free(image);
+
+	return status;
+}
+
+phStatus_t rdlib_tag_ndef_write_diff(hal_impl_t* pHal, hal_impl_tag_t* pTag, guint8* buffer, gsize length, gsize* pSent)
+{
+	if( (pTag->type != hal_impl_nfc_tag_type_2) && (pTag->type != hal_impl_nfc_tag_type_3) )
+	{
+		return PH_ERR_UNSUPPORTED_COMMAND;
+	}
+
+	if( !rdlib_tag_image_get(pHal, pTag) )
+	{
+		return PH_ERR_UNSUPPORTED_COMMAND;
+	}
+
+	gsize oldLength = 0;
+	const guint8* oldMessage = g_bytes_get_data(pHal->rdlib.image.pMessage, &oldLength);
+
+	*pSent = 0;
+
+	phStatus_t status;
+	if( pTag->type == hal_impl_nfc_tag_type_2 )
+	{
+		status = rdlib_t2t_write_diff(pHal, oldMessage, oldLength, buffer, length, pSent);
+	}
+	else
+	{
+		status = rdlib_t3t_write_diff(pHal, oldMessage, oldLength, buffer, length, pSent);
+	}
+
+	if( (status & PH_ERR_MASK) == PH_ERR_UNSUPPORTED_COMMAND )
+	{
+		//Nothing was sent
+		return status;
+	}
+
+	//phalTop still has the previous NDEF length
+	pHal->rdlib.image.topStale = TRUE;
+
+	if( (status & PH_ERR_MASK) == PH_ERR_SUCCESS )
+	{
+		g_debug("Differential write: %" G_GSIZE_FORMAT " bytes sent for a %" G_GSIZE_FORMAT " bytes message", *pSent, length);
+	}
+
+	return status;
+}
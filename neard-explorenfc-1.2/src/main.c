@@ -35,14 +35,60 @@
 
 #include "dbus-daemon.h"
 #include "hal.h"
+#include "event-socket.h"
 
 #define CONFIG_FILE CONFIGDIR "/main.conf"
+#define DEFAULT_CACHE_SIZE 0 //Opt-in, a cached message can be stale (see main.conf)
+#define DEFAULT_CACHE_FILE CACHEDIR "/ndef.cache"
+#define DEFAULT_CACHE_FILE_SIZE 256 //KiB
+#define DEFAULT_PRESENCE_CHECK_INTERVAL 500 //Milliseconds
+#define DEFAULT_POLL_INTERVAL 0 //Milliseconds, back-to-back
+#define DEFAULT_MAX_TAGS 1
+#define DEFAULT_PRESENCE_CHECK_MIN_INTERVAL 50 //Milliseconds
+#define MAX_ADAPTERS 8
+#define DEFAULT_RETAINED_TAGS 8
+
+static const gchar* presenceCheckIntervalKeys[NFC_TAG_TYPE_COUNT] = {"Type1Interval", "Type2Interval", "Type3Interval", "Type4Interval"};
+
+//Reader described by an [AdapterN] group
+struct adapter_config
+{
+	guint id; //N, the adapter is exported at /org/neard/nfcN
+	gchar* script; //Simulator script, NULL for the NXP Reader Library
+	gint pollInterval;
+	gint maxTags;
+	gchar* cacheFile;
+};
+typedef struct adapter_config adapter_config_t;
+
+//Read an optional integer, falling back to defaultValue if absent or below minValue
+static gint config_get_integer(GKeyFile* pKeyFile, const gchar* group, const gchar* key, gint defaultValue, gint minValue)
+{
+	if(!g_key_file_has_key(pKeyFile, group, key, NULL))
+	{
+		return defaultValue;
+	}
+
+	GError* pError = NULL;
+	gint value = g_key_file_get_integer(pKeyFile, group, key, &pError);
+	if((pError != NULL) || (value < minValue))
+	{
+		g_warning("Could not read %s parameter of %s, defaulting to %d: %s\r\n", key, group, defaultValue, (pError != NULL)?pError->message:"value out of range");
+		if(pError != NULL)
+		{
+			g_error_free(pError);
+		}
+		value = defaultValue;
+	}
+	return value;
+}
 
 int main(int argc, char** argv)
 {
 	gboolean debug = FALSE;
 	gboolean daemonize = TRUE;
 	gboolean version = FALSE;
+	gchar* simulate = NULL;
 
 	//Parse options
 	const GOptionEntry entries[] =
@@ -50,6 +96,7 @@ int main(int argc, char** argv)
 	  { "debug", 'd', 0, G_OPTION_ARG_NONE, &debug, "Enable debugging mode", NULL },
 	  { "nodaemon", 'n', G_OPTION_FLAG_REVERSE, G_OPTION_ARG_NONE, &daemonize, "Do not fork daemon to background", NULL },
 	  { "version", 'v', 0, G_OPTION_ARG_NONE, &version, "Show version information and exit", NULL },
+	  { "simulate", 's', 0, G_OPTION_ARG_FILENAME, &simulate, "Use a simulated reader driven by the given script", "FILE" },
 	  { NULL }
 	};
 
@@ -85,6 +132,25 @@ int main(int argc, char** argv)
 
 	//Parse config file
     gboolean constantPoll = FALSE;
+    gboolean lazyRecords = FALSE;
+    gboolean uidObjectPaths = FALSE;
+    gint retainedTags = DEFAULT_RETAINED_TAGS;
+    gint pollInterval = DEFAULT_POLL_INTERVAL;
+    gint maxTags = DEFAULT_MAX_TAGS;
+    gint cacheSize = DEFAULT_CACHE_SIZE;
+    nfc_cache_validation_t cacheValidation = nfc_cache_validation_header;
+    gchar* cacheFile = g_strdup(DEFAULT_CACHE_FILE);
+    gint cacheFileSize = DEFAULT_CACHE_FILE_SIZE;
+    gchar* eventSocketPath = NULL;
+    gchar* statusPageDirectory = NULL;
+    gchar* peerSocketPath = NULL;
+    nfc_presence_check_params_t presenceCheck;
+    for(guint i = 0; i < NFC_TAG_TYPE_COUNT; i++)
+    {
+    	presenceCheck.interval[i] = DEFAULT_PRESENCE_CHECK_INTERVAL;
+    }
+    presenceCheck.adaptive = FALSE;
+    presenceCheck.minInterval = DEFAULT_PRESENCE_CHECK_MIN_INTERVAL;
 	GKeyFile* pKeyFile = g_key_file_new();
 
 	pError = NULL;
@@ -98,6 +164,175 @@ int main(int argc, char** argv)
 			g_error_free(pError);
 			constantPoll = TRUE;
 		}
+
+		if(g_key_file_has_key(pKeyFile, "General", "PollInterval", NULL))
+		{
+			pError = NULL;
+			pollInterval = g_key_file_get_integer(pKeyFile, "General", "PollInterval", &pError);
+			if((pError != NULL) || (pollInterval < 0))
+			{
+				g_warning("Could not read PollInterval parameter, defaulting to %d: %s\r\n", DEFAULT_POLL_INTERVAL, (pError != NULL)?pError->message:"negative value");
+				if(pError != NULL)
+				{
+					g_error_free(pError);
+				}
+				pollInterval = DEFAULT_POLL_INTERVAL;
+			}
+		}
+
+		if(g_key_file_has_key(pKeyFile, "General", "MaxTags", NULL))
+		{
+			pError = NULL;
+			maxTags = g_key_file_get_integer(pKeyFile, "General", "MaxTags", &pError);
+			if((pError != NULL) || (maxTags <= 0))
+			{
+				g_warning("Could not read MaxTags parameter, defaulting to %d: %s\r\n", DEFAULT_MAX_TAGS, (pError != NULL)?pError->message:"not a positive value");
+				if(pError != NULL)
+				{
+					g_error_free(pError);
+				}
+				maxTags = DEFAULT_MAX_TAGS;
+			}
+		}
+
+		if(g_key_file_has_key(pKeyFile, "General", "LazyRecords", NULL))
+		{
+			pError = NULL;
+			lazyRecords = g_key_file_get_boolean(pKeyFile, "General", "LazyRecords", &pError);
+			if(pError != NULL)
+			{
+				g_warning("Could not read LazyRecords parameter, defaulting to FALSE: %s\r\n", pError->message);
+				g_error_free(pError);
+				lazyRecords = FALSE;
+			}
+		}
+
+		if(g_key_file_has_key(pKeyFile, "General", "UidObjectPaths", NULL))
+		{
+			pError = NULL;
+			uidObjectPaths = g_key_file_get_boolean(pKeyFile, "General", "UidObjectPaths", &pError);
+			if(pError != NULL)
+			{
+				g_warning("Could not read UidObjectPaths parameter, defaulting to FALSE: %s\r\n", pError->message);
+				g_error_free(pError);
+				uidObjectPaths = FALSE;
+			}
+		}
+
+		retainedTags = config_get_integer(pKeyFile, "General", "RetainedTags", DEFAULT_RETAINED_TAGS, 0);
+
+		if(g_key_file_has_group(pKeyFile, "Cache"))
+		{
+			pError = NULL;
+			cacheSize = g_key_file_get_integer(pKeyFile, "Cache", "Size", &pError);
+			if((pError != NULL) || (cacheSize < 0))
+			{
+				g_warning("Could not read Size parameter, defaulting to %d: %s\r\n", DEFAULT_CACHE_SIZE, (pError != NULL)?pError->message:"negative value");
+				if(pError != NULL)
+				{
+					g_error_free(pError);
+				}
+				cacheSize = DEFAULT_CACHE_SIZE;
+			}
+
+			gchar* validation = g_key_file_get_string(pKeyFile, "Cache", "Validation", NULL);
+			if( validation != NULL )
+			{
+				if( !g_strcmp0(validation, "Uid") )
+				{
+					cacheValidation = nfc_cache_validation_uid;
+				}
+				else if( !g_strcmp0(validation, "Length") )
+				{
+					cacheValidation = nfc_cache_validation_length;
+				}
+				else if( !g_strcmp0(validation, "Header") )
+				{
+					cacheValidation = nfc_cache_validation_header;
+				}
+				else
+				{
+					g_warning("Unknown Validation parameter %s, defaulting to Header\r\n", validation);
+				}
+				g_free(validation);
+			}
+
+			if(g_key_file_has_key(pKeyFile, "Cache", "File", NULL))
+			{
+				g_free(cacheFile);
+				cacheFile = g_key_file_get_string(pKeyFile, "Cache", "File", NULL);
+			}
+
+			if(g_key_file_has_key(pKeyFile, "Cache", "FileSize", NULL))
+			{
+				pError = NULL;
+				cacheFileSize = g_key_file_get_integer(pKeyFile, "Cache", "FileSize", &pError);
+				if((pError != NULL) || (cacheFileSize <= 0))
+				{
+					g_warning("Could not read FileSize parameter, defaulting to %d: %s\r\n", DEFAULT_CACHE_FILE_SIZE, (pError != NULL)?pError->message:"not a positive value");
+					if(pError != NULL)
+					{
+						g_error_free(pError);
+					}
+					cacheFileSize = DEFAULT_CACHE_FILE_SIZE;
+				}
+			}
+		}
+
+		//No path, no socket
+		eventSocketPath = g_key_file_get_string(pKeyFile, "EventSocket", "Path", NULL);
+		statusPageDirectory = g_key_file_get_string(pKeyFile, "StatusPage", "Directory", NULL);
+		peerSocketPath = g_key_file_get_string(pKeyFile, "PeerToPeer", "Path", NULL);
+
+		if(g_key_file_has_group(pKeyFile, "PresenceCheck"))
+		{
+			for(guint i = 0; i < NFC_TAG_TYPE_COUNT; i++)
+			{
+				if(g_key_file_has_key(pKeyFile, "PresenceCheck", presenceCheckIntervalKeys[i], NULL))
+				{
+					pError = NULL;
+					gint interval = g_key_file_get_integer(pKeyFile, "PresenceCheck", presenceCheckIntervalKeys[i], &pError);
+					if((pError != NULL) || (interval <= 0))
+					{
+						g_warning("Could not read %s parameter, defaulting to %d: %s\r\n", presenceCheckIntervalKeys[i], DEFAULT_PRESENCE_CHECK_INTERVAL, (pError != NULL)?pError->message:"not a positive value");
+						if(pError != NULL)
+						{
+							g_error_free(pError);
+						}
+						interval = DEFAULT_PRESENCE_CHECK_INTERVAL;
+					}
+					presenceCheck.interval[i] = (guint)interval;
+				}
+			}
+
+			if(g_key_file_has_key(pKeyFile, "PresenceCheck", "Adaptive", NULL))
+			{
+				pError = NULL;
+				presenceCheck.adaptive = g_key_file_get_boolean(pKeyFile, "PresenceCheck", "Adaptive", &pError);
+				if(pError != NULL)
+				{
+					g_warning("Could not read Adaptive parameter, defaulting to FALSE: %s\r\n", pError->message);
+					g_error_free(pError);
+					presenceCheck.adaptive = FALSE;
+				}
+			}
+
+			if(g_key_file_has_key(pKeyFile, "PresenceCheck", "MinInterval", NULL))
+			{
+				pError = NULL;
+				gint minInterval = g_key_file_get_integer(pKeyFile, "PresenceCheck", "MinInterval", &pError);
+				if((pError != NULL) || (minInterval <= 0))
+				{
+					g_warning("Could not read MinInterval parameter, defaulting to %d: %s\r\n", DEFAULT_PRESENCE_CHECK_MIN_INTERVAL, (pError != NULL)?pError->message:"not a positive value");
+					if(pError != NULL)
+					{
+						g_error_free(pError);
+					}
+					minInterval = DEFAULT_PRESENCE_CHECK_MIN_INTERVAL;
+				}
+				presenceCheck.minInterval = (guint)minInterval;
+			}
+		}
 	}
 	else
 	{
@@ -120,6 +355,89 @@ int main(int argc, char** argv)
 		}
 	}
 
+    //Readers, each of them gets its own HAL thread and adapter
+    adapter_config_t adapters[MAX_ADAPTERS];
+    guint adapterCount = 0;
+    gchar** groups = g_key_file_get_groups(pKeyFile, NULL);
+    for(guint i = 0; groups[i] != NULL; i++)
+    {
+    	guint id;
+    	gchar trailing;
+    	if(sscanf(groups[i], "Adapter%u%c", &id, &trailing) != 1)
+    	{
+    		continue;
+    	}
+
+    	guint j;
+    	for(j = 0; (j < adapterCount) && (adapters[j].id != id); j++);
+    	if(j < adapterCount)
+    	{
+    		g_warning("Adapter %u is configured twice, ignoring %s\r\n", id, groups[i]);
+    		continue;
+    	}
+    	if(adapterCount == MAX_ADAPTERS)
+    	{
+    		g_warning("At most %d adapters are supported, ignoring %s\r\n", MAX_ADAPTERS, groups[i]);
+    		continue;
+    	}
+
+    	adapter_config_t* pConfig = &adapters[adapterCount++];
+    	pConfig->id = id;
+    	pConfig->script = g_key_file_get_string(pKeyFile, groups[i], "Simulate", NULL);
+    	pConfig->pollInterval = config_get_integer(pKeyFile, groups[i], "PollInterval", pollInterval, 0);
+    	pConfig->maxTags = config_get_integer(pKeyFile, groups[i], "MaxTags", maxTags, 1);
+    	pConfig->cacheFile = g_key_file_get_string(pKeyFile, groups[i], "CacheFile", NULL);
+    }
+    g_strfreev(groups);
+
+    //Without any [AdapterN] group, the reader on the board is adapter 0
+    if(adapterCount == 0)
+    {
+    	adapters[0].id = 0;
+    	adapters[0].script = NULL;
+    	adapters[0].pollInterval = pollInterval;
+    	adapters[0].maxTags = maxTags;
+    	adapters[0].cacheFile = NULL;
+    	adapterCount = 1;
+    }
+
+    //The command line takes over the first adapter
+    if(simulate != NULL)
+    {
+    	g_free(adapters[0].script);
+    	adapters[0].script = simulate;
+    }
+
+    hal_t* pHals[MAX_ADAPTERS];
+    for(guint i = 0; i < adapterCount; i++)
+    {
+    	pHals[i] = hal_impl_new();
+
+    	if(adapters[i].script != NULL)
+    	{
+    		if(hal_impl_use_simulator(pHals[i], adapters[i].script))
+    		{
+    			g_printerr("Could not start simulated reader for adapter %u\r\n", adapters[i].id);
+    			exit(1);
+    		}
+    		g_free(adapters[i].script);
+    	}
+
+    	//Caches must not be shared, adapters other than 0 get their own file by default
+    	if(adapters[i].cacheFile == NULL)
+    	{
+    		if((adapters[i].id == 0) || (cacheFile == NULL) || (*cacheFile == '\0'))
+    		{
+    			adapters[i].cacheFile = g_strdup((cacheFile != NULL) ? cacheFile : "");
+    		}
+    		else
+    		{
+    			adapters[i].cacheFile = g_strdup_printf("%s.%u", cacheFile, adapters[i].id);
+    		}
+    	}
+    }
+    g_free(cacheFile);
+
     if(daemonize)
     {
 		if (daemon(0, 0))
@@ -129,15 +447,93 @@ int main(int argc, char** argv)
 		}
     }
 
-    hal_t* pHal = hal_impl_new();
-    hal_impl_init(pHal, g_main_context_default());
-
     g_info("Constant polling is %s", constantPoll?"enabled":"disabled");
+    g_info("Records are exported %s", lazyRecords?"on first access":"as soon as a tag is found");
+    if(uidObjectPaths)
+    {
+    	g_info("Tag object paths are derived from UIDs, the objects of the last %d tags are kept", retainedTags);
+    }
+    g_info("NDEF cache holds %d tags", cacheSize);
+    g_info("Presence check every %d/%d/%d/%d ms (types 1/2/3/4)%s", presenceCheck.interval[0], presenceCheck.interval[1],
+    		presenceCheck.interval[2], presenceCheck.interval[3], presenceCheck.adaptive?", adaptive":"");
+
+    //A reader which cannot be brought up does not prevent the others from running
+    guint adapterIds[MAX_ADAPTERS];
+    guint halCount = 0;
+    for(guint i = 0; i < adapterCount; i++)
+    {
+    	hal_t* pHal = pHals[i];
+
+    	hal_impl_set_cache(pHal, cacheSize, cacheValidation);
+    	if((cacheSize > 0) && (*adapters[i].cacheFile != '\0'))
+    	{
+    		if(hal_impl_set_cache_file(pHal, adapters[i].cacheFile, (gsize)cacheFileSize * 1024))
+    		{
+    			g_warning("Could not use cache file %s, NDEF cache of adapter %u will not persist across restarts", adapters[i].cacheFile, adapters[i].id);
+    		}
+    	}
+    	g_free(adapters[i].cacheFile);
+    	hal_impl_set_presence_check(pHal, &presenceCheck);
+    	hal_impl_set_poll_interval(pHal, (guint)adapters[i].pollInterval);
+    	if(hal_impl_set_max_tags(pHal, (guint)adapters[i].maxTags))
+    	{
+    		adapters[i].maxTags = DEFAULT_MAX_TAGS;
+    	}
+    	if(hal_impl_init(pHal, g_main_context_default()))
+    	{
+    		g_warning("Could not start adapter %u", adapters[i].id);
+    		hal_impl_free(pHal);
+    		continue;
+    	}
+
+    	g_info("Adapter %u: up to %d tag(s) in the field at once", adapters[i].id, adapters[i].maxTags);
+    	if(adapters[i].pollInterval > 0)
+    	{
+    		g_info("Adapter %u: polling cycle starts every %d ms", adapters[i].id, adapters[i].pollInterval);
+    	}
+
+    	pHals[halCount] = pHal;
+    	adapterIds[halCount] = adapters[i].id;
+    	halCount++;
+    }
+
+    if(halCount == 0)
+    {
+    	g_printerr("No adapter could be started\r\n");
+    	exit(1);
+    }
 
     GMainLoop* pGMainLoop = g_main_loop_new(NULL, FALSE);
 
-    DBusDaemon* pDBusDaemon = dbus_daemon_new(pHal, pGMainLoop);
+    DBusDaemon* pDBusDaemon = dbus_daemon_new(pHals, adapterIds, halCount, pGMainLoop);
     dbus_daemon_set_constant_poll(pDBusDaemon, constantPoll);
+    dbus_daemon_set_lazy_records(pDBusDaemon, lazyRecords);
+    dbus_daemon_set_object_paths(pDBusDaemon, uidObjectPaths, (guint)retainedTags);
+
+    if((statusPageDirectory != NULL) && (*statusPageDirectory != '\0'))
+    {
+    	g_info("Publishing adapter status in %s", statusPageDirectory);
+    	dbus_daemon_set_status_page_directory(pDBusDaemon, statusPageDirectory);
+    }
+    g_free(statusPageDirectory);
+
+    if((peerSocketPath != NULL) && (*peerSocketPath != '\0'))
+    {
+    	dbus_daemon_set_peer_socket(pDBusDaemon, peerSocketPath);
+    }
+    g_free(peerSocketPath);
+
+    event_socket_t* pEventSocket = NULL;
+    if((eventSocketPath != NULL) && (*eventSocketPath != '\0'))
+    {
+    	pEventSocket = event_socket_new(eventSocketPath);
+    	if(pEventSocket != NULL)
+    	{
+    		g_info("Streaming events on %s", eventSocketPath);
+    		dbus_daemon_set_event_socket(pDBusDaemon, pEventSocket);
+    	}
+    }
+    g_free(eventSocketPath);
 
     g_info("Starting main loop");
 
@@ -147,7 +543,15 @@ int main(int argc, char** argv)
 
     g_object_unref(pDBusDaemon);
 
-    hal_impl_free(pHal);
+    if(pEventSocket != NULL)
+    {
+    	event_socket_free(pEventSocket);
+    }
+
+    for(guint i = 0; i < halCount; i++)
+    {
+    	hal_impl_free(pHals[i]);
+    }
 
     g_info("End\r\n");
 
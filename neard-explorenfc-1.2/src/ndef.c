@@ -49,18 +49,18 @@ static void ndef_record_class_init(NdefRecordClass* pNdefRecordClass);
 static void ndef_record_init(NdefRecord* pNdefRecord);
 static void ndef_record_dispose(GObject* pGObject);
 
-static GList* ndef_message_parse_internal(guint8* data, gsize dataLength, gboolean smartPoster);
-static NdefRecord* ndef_message_parse_smart_poster_record(guint8* data, gsize dataLength);
-static NdefRecord* ndef_message_parse_text_record(guint8* data, gsize dataLength);
-static NdefRecord* ndef_message_parse_uri_record(guint8* data, gsize dataLength);
-static NdefRecord* ndef_message_parse_handover_request_record(guint8* data, gsize dataLength);
-static NdefRecord* ndef_message_parse_handover_select_record(guint8* data, gsize dataLength);
-static NdefRecord* ndef_message_parse_handover_carrier_record(guint8* data, gsize dataLength);
-static NdefRecord* ndef_message_parse_aar_record(guint8* data, gsize dataLength);
-static NdefRecord* ndef_message_parse_sp_local_action_record(guint8* data, gsize dataLength);
-static NdefRecord* ndef_message_parse_sp_local_size_record(guint8* data, gsize dataLength);
-static NdefRecord* ndef_message_parse_sp_local_type_record(guint8* data, gsize dataLength);
-static NdefRecord* ndef_message_parse_mime_record(guint8* type, gsize typeLength, guint8* data, gsize dataLength);
+static GList* ndef_message_parse_internal(GBytes* pMessage, const guint8* data, gsize dataLength, gboolean smartPoster);
+static NdefRecord* ndef_message_parse_smart_poster_record(GBytes* pMessage, const guint8* data, gsize dataLength);
+static NdefRecord* ndef_message_parse_text_record(const guint8* data, gsize dataLength);
+static NdefRecord* ndef_message_parse_uri_record(const guint8* data, gsize dataLength);
+static NdefRecord* ndef_message_parse_handover_request_record(const guint8* data, gsize dataLength);
+static NdefRecord* ndef_message_parse_handover_select_record(const guint8* data, gsize dataLength);
+static NdefRecord* ndef_message_parse_handover_carrier_record(const guint8* data, gsize dataLength);
+static NdefRecord* ndef_message_parse_aar_record(const guint8* data, gsize dataLength);
+static NdefRecord* ndef_message_parse_sp_local_action_record(const guint8* data, gsize dataLength);
+static NdefRecord* ndef_message_parse_sp_local_size_record(const guint8* data, gsize dataLength);
+static NdefRecord* ndef_message_parse_sp_local_type_record(const guint8* data, gsize dataLength);
+static NdefRecord* ndef_message_parse_mime_record(GBytes* pMessage, const guint8* type, gsize typeLength, const guint8* data, gsize dataLength);
 
 static GBytes* ndef_message_record_make(guint8 tnf, gchar* type, guint8* payload, gsize payloadLength, gboolean mb, gboolean me);
 static GBytes* ndef_message_generate_record(NdefRecord* pRecord, gboolean mb, gboolean me);
@@ -262,6 +262,88 @@ NdefRecord* ndef_record_from_dictionary(GVariant* pVariant)
 	return pNdefRecord;
 }
 
+const gchar* ndef_record_type_name(NdefRecord* pNdefRecord)
+{
+	switch(pNdefRecord->type)
+	{
+	case ndef_record_type_smart_poster:
+		return "SmartPoster";
+	case ndef_record_type_text:
+		return "Text";
+	case ndef_record_type_uri:
+		return "URI";
+	case ndef_record_type_handover_request:
+		return "HandoverRequest";
+	case ndef_record_type_handover_select:
+		return "HandoverSelect";
+	case ndef_record_type_handover_carrier:
+		return "HandoverCarrier";
+	case ndef_record_type_aar:
+		return "AAR";
+	case ndef_record_type_mime:
+		return "MIME";
+	default:
+		return "Unknown";
+	}
+}
+
+const gchar* ndef_record_encoding_name(NdefRecord* pNdefRecord)
+{
+	switch(pNdefRecord->encoding)
+	{
+	case ndef_record_encoding_utf_8:
+		return "UTF-8";
+	case ndef_record_encoding_utf_16:
+	default:
+		return "UTF-16";
+	}
+}
+
+GVariant* ndef_record_to_dictionary(NdefRecord* pNdefRecord)
+{
+	GVariantBuilder variantBld;
+	g_variant_builder_init(&variantBld, G_VARIANT_TYPE("a{sv}"));
+
+	g_variant_builder_add(&variantBld, "{sv}", "Type", g_variant_new_string(ndef_record_type_name(pNdefRecord)));
+
+	//Encoding only makes sense for text
+	if( (pNdefRecord->type == ndef_record_type_text) || (pNdefRecord->type == ndef_record_type_smart_poster) )
+	{
+		g_variant_builder_add(&variantBld, "{sv}", "Encoding", g_variant_new_string(ndef_record_encoding_name(pNdefRecord)));
+	}
+
+	//Unset fields are left out
+	const struct { const gchar* key; const gchar* value; } fields[] =
+	{
+		{ "Language", pNdefRecord->language },
+		{ "Representation", pNdefRecord->representation },
+		{ "URI", pNdefRecord->uri },
+		{ "MIMEType", pNdefRecord->mimeType },
+		{ "Action", pNdefRecord->action },
+		{ "AndroidPackage", pNdefRecord->androidPackage },
+	};
+	for(guint i = 0; i < G_N_ELEMENTS(fields); i++)
+	{
+		if( fields[i].value != NULL )
+		{
+			g_variant_builder_add(&variantBld, "{sv}", fields[i].key, g_variant_new_string(fields[i].value));
+		}
+	}
+
+	if( pNdefRecord->size != 0 )
+	{
+		g_variant_builder_add(&variantBld, "{sv}", "Size", g_variant_new_uint32((guint32)pNdefRecord->size));
+	}
+
+	//Not part of the Record properties, saves a GetRawNDEF() call for MIME content
+	if( pNdefRecord->mimePayload != NULL )
+	{
+		g_variant_builder_add(&variantBld, "{sv}", "Payload", g_variant_new_from_bytes(G_VARIANT_TYPE_BYTESTRING, pNdefRecord->mimePayload, TRUE));
+	}
+
+	return g_variant_builder_end(&variantBld); //Floating
+}
+
 gboolean ndef_record_validate(NdefRecord* pRecord)
 {
 	gboolean valid = FALSE;
@@ -298,12 +380,35 @@ gboolean ndef_record_validate(NdefRecord* pRecord)
 	return valid;
 }
 
-GList* ndef_message_parse(guint8* data, gsize dataLength) //Returns a list of NDEF records
+gboolean ndef_record_equal(NdefRecord* pRecord1, NdefRecord* pRecord2)
+{
+	if( (pRecord1->type != pRecord2->type) || (pRecord1->encoding != pRecord2->encoding) || (pRecord1->size != pRecord2->size) )
+	{
+		return FALSE;
+	}
+
+	if( g_strcmp0(pRecord1->language, pRecord2->language) || g_strcmp0(pRecord1->representation, pRecord2->representation)
+			|| g_strcmp0(pRecord1->uri, pRecord2->uri) || g_strcmp0(pRecord1->mimeType, pRecord2->mimeType)
+			|| g_strcmp0(pRecord1->action, pRecord2->action) || g_strcmp0(pRecord1->androidPackage, pRecord2->androidPackage) )
+	{
+		return FALSE;
+	}
+
+	if( (pRecord1->mimePayload == NULL) || (pRecord2->mimePayload == NULL) )
+	{
+		return (pRecord1->mimePayload == pRecord2->mimePayload);
+	}
+	return g_bytes_equal(pRecord1->mimePayload, pRecord2->mimePayload);
+}
+
+GList* ndef_message_parse(GBytes* pMessage) //Returns a list of NDEF records
 {
-	return ndef_message_parse_internal(data, dataLength, FALSE);
+	gsize dataLength;
+	const guint8* data = g_bytes_get_data(pMessage, &dataLength);
+	return ndef_message_parse_internal(pMessage, data, dataLength, FALSE);
 }
 
-GList* ndef_message_parse_internal(guint8* data, gsize dataLength, gboolean smartPoster) //Returns a list of NDEF records
+GList* ndef_message_parse_internal(GBytes* pMessage, const guint8* data, gsize dataLength, gboolean smartPoster) //Returns a list of NDEF records
 {
 	GList* pList = NULL; //This is a valid list
 
@@ -404,7 +509,7 @@ GList* ndef_message_parse_internal(guint8* data, gsize dataLength, gboolean smar
 			if( !smartPoster && (typeLength == strlen(RECORD_RTD_WELL_KNOWN_SMART_POSTER))
 								&& (!memcmp(data, RECORD_RTD_WELL_KNOWN_SMART_POSTER, strlen(RECORD_RTD_WELL_KNOWN_SMART_POSTER))) )
 			{
-				pRecord = ndef_message_parse_smart_poster_record(&data[typeLength + idLength], payloadLength);
+				pRecord = ndef_message_parse_smart_poster_record(pMessage, &data[typeLength + idLength], payloadLength);
 			}
 			else if( (typeLength == strlen(RECORD_RTD_WELL_KNOWN_TEXT))
 					&& (!memcmp(data, RECORD_RTD_WELL_KNOWN_TEXT, strlen(RECORD_RTD_WELL_KNOWN_TEXT))) )
@@ -436,7 +541,7 @@ GList* ndef_message_parse_internal(guint8* data, gsize dataLength, gboolean smar
 			}
 			break;
 		case RECORD_TNF_MEDIA:
-			pRecord = ndef_message_parse_mime_record(data, typeLength, &data[typeLength + idLength], payloadLength);
+			pRecord = ndef_message_parse_mime_record(pMessage, data, typeLength, &data[typeLength + idLength], payloadLength);
 #if 0
 			if( (typeLength == strlen(RECORD_MIME_WIFI))
 								&& (!memcmp(data, RECORD_MIME_WIFI, strlen(RECORD_MIME_WIFI))) )
@@ -487,11 +592,11 @@ GList* ndef_message_parse_internal(guint8* data, gsize dataLength, gboolean smar
 	return pList;
 }
 
-NdefRecord* ndef_message_parse_smart_poster_record(guint8* data, gsize dataLength)
+NdefRecord* ndef_message_parse_smart_poster_record(GBytes* pMessage, const guint8* data, gsize dataLength)
 {
 	gboolean foundURIRecord = FALSE;
 
-	GList* pList = ndef_message_parse(data, dataLength);
+	GList* pList = ndef_message_parse_internal(pMessage, data, dataLength, FALSE);
 
 	if(pList == NULL)
 	{
@@ -559,7 +664,7 @@ NdefRecord* ndef_message_parse_smart_poster_record(guint8* data, gsize dataLengt
 	return pRecord; //TODO
 }
 
-NdefRecord* ndef_message_parse_text_record(guint8* data, gsize dataLength)
+NdefRecord* ndef_message_parse_text_record(const guint8* data, gsize dataLength)
 {
 	if( dataLength < 1 )
 	{
@@ -638,7 +743,7 @@ static const gchar* abbreviations[ABBREVIATIONS_COUNT] =
 		"urn:nfc:",
 };
 
-NdefRecord* ndef_message_parse_uri_record(guint8* data, gsize dataLength)
+NdefRecord* ndef_message_parse_uri_record(const guint8* data, gsize dataLength)
 {
 	if( dataLength < 1 )
 	{
@@ -662,22 +767,22 @@ NdefRecord* ndef_message_parse_uri_record(guint8* data, gsize dataLength)
 	return pRecord;
 }
 
-NdefRecord* ndef_message_parse_handover_request_record(guint8* data, gsize dataLength)
+NdefRecord* ndef_message_parse_handover_request_record(const guint8* data, gsize dataLength)
 {
 	return NULL; //TODO
 }
 
-NdefRecord* ndef_message_parse_handover_select_record(guint8* data, gsize dataLength)
+NdefRecord* ndef_message_parse_handover_select_record(const guint8* data, gsize dataLength)
 {
 	return NULL; //TODO
 }
 
-NdefRecord* ndef_message_parse_handover_carrier_record(guint8* data, gsize dataLength)
+NdefRecord* ndef_message_parse_handover_carrier_record(const guint8* data, gsize dataLength)
 {
 	return NULL; //TODO
 }
 
-NdefRecord* ndef_message_parse_aar_record(guint8* data, gsize dataLength)
+NdefRecord* ndef_message_parse_aar_record(const guint8* data, gsize dataLength)
 {
 	if( dataLength < 1 )
 	{
@@ -697,7 +802,7 @@ NdefRecord* ndef_message_parse_aar_record(guint8* data, gsize dataLength)
 	return pRecord;
 }
 
-NdefRecord* ndef_message_parse_sp_local_action_record(guint8* data, gsize dataLength)
+NdefRecord* ndef_message_parse_sp_local_action_record(const guint8* data, gsize dataLength)
 {
 	if( dataLength != 1 )
 	{
@@ -730,7 +835,7 @@ NdefRecord* ndef_message_parse_sp_local_action_record(guint8* data, gsize dataLe
 	return pRecord;
 }
 
-NdefRecord* ndef_message_parse_sp_local_size_record(guint8* data, gsize dataLength)
+NdefRecord* ndef_message_parse_sp_local_size_record(const guint8* data, gsize dataLength)
 {
 	if( dataLength != 4 )
 	{
@@ -746,7 +851,7 @@ NdefRecord* ndef_message_parse_sp_local_size_record(guint8* data, gsize dataLeng
 	return pRecord;
 }
 
-NdefRecord* ndef_message_parse_sp_local_type_record(guint8* data, gsize dataLength)
+NdefRecord* ndef_message_parse_sp_local_type_record(const guint8* data, gsize dataLength)
 {
 	NdefRecord* pRecord = ndef_record_new();
 
@@ -758,7 +863,7 @@ NdefRecord* ndef_message_parse_sp_local_type_record(guint8* data, gsize dataLeng
 	return pRecord;
 }
 
-NdefRecord* ndef_message_parse_mime_record(guint8* type, gsize typeLength, guint8* data, gsize dataLength)
+NdefRecord* ndef_message_parse_mime_record(GBytes* pMessage, const guint8* type, gsize typeLength, const guint8* data, gsize dataLength)
 {
 	NdefRecord* pRecord = ndef_record_new();
 
@@ -767,7 +872,9 @@ NdefRecord* ndef_message_parse_mime_record(guint8* type, gsize typeLength, guint
 	pRecord->mimeType = g_malloc0(typeLength + 1);
 	memcpy(pRecord->mimeType, type, typeLength);
 
-	pRecord->mimePayload = g_bytes_new(data, dataLength); //Data is copied
+	//Slice of the message, data is not copied
+	const guint8* message = g_bytes_get_data(pMessage, NULL);
+	pRecord->mimePayload = g_bytes_new_from_bytes(pMessage, data - message, dataLength);
 
 	return pRecord;
 }
@@ -25,6 +25,8 @@
 #include <glib.h>
 #include <glib-object.h>
 
+#include "explorenfc-export.h"
+
 #define TYPE_NDEF_RECORD   (ndef_record_get_type               ())
 #define NDEF_RECORD(obj)   (G_TYPE_CHECK_INSTANCE_CAST ((obj), TYPE_NDEF_RECORD, NdefRecord))
 #define NDEF_RECORD_CLASS(cls)     (G_TYPE_CHECK_CLASS_CAST    ((cls), TYPE_NDEF_RECORD, NdefRecordClass))
@@ -91,36 +93,67 @@ struct ndef_record_class
 };
 typedef struct ndef_record_class NdefRecordClass; ///< NDEF Record class
 
+/** Get NDEF Record GType
+ * \return NDEF Record GType
+ */
+EXPLORENFC_API GType ndef_record_get_type();
+
 /** Create a new NDEF Record instance
  * \return new NDEF Record instance
  */
-NdefRecord* ndef_record_new();
+EXPLORENFC_API NdefRecord* ndef_record_new();
 
 /** Create a new NDEF Record instance based on dictionary (variant)
  * \param pVariant variant dictionary (a{sv}) containing record values according to the neard DBUS spec
  * \return new NDEF Record instance
  */
-NdefRecord* ndef_record_from_dictionary(GVariant* pVariant);
+EXPLORENFC_API NdefRecord* ndef_record_from_dictionary(GVariant* pVariant);
+
+/** Get the name of the record's type, as in the neard DBUS spec
+ * \param pNdefRecord NDEF Record instance
+ * \return type name ("Text", "URI"...)
+ */
+EXPLORENFC_API const gchar* ndef_record_type_name(NdefRecord* pNdefRecord);
+
+/** Get the name of the record's encoding, as in the neard DBUS spec
+ * \param pNdefRecord NDEF Record instance
+ * \return encoding name ("UTF-8" or "UTF-16")
+ */
+EXPLORENFC_API const gchar* ndef_record_encoding_name(NdefRecord* pNdefRecord);
+
+/** Create a dictionary (variant) from an NDEF Record instance
+ * This is the reverse of ndef_record_from_dictionary(), unset fields are omitted
+ * \param pNdefRecord NDEF Record instance
+ * \return floating variant dictionary (a{sv})
+ */
+EXPLORENFC_API GVariant* ndef_record_to_dictionary(NdefRecord* pNdefRecord);
 
 /** Checks whether this record is consistent
  * \param pRecord NDEF Record instance
  * \return TRUE if valid, FALSE otherwise
  */
-gboolean ndef_record_validate(NdefRecord* pRecord);
+EXPLORENFC_API gboolean ndef_record_validate(NdefRecord* pRecord);
+
+/** Compare two NDEF Record instances
+ * \param pRecord1 NDEF Record instance
+ * \param pRecord2 NDEF Record instance
+ * \return TRUE if every field (and MIME payload) is the same, FALSE otherwise
+ */
+EXPLORENFC_API gboolean ndef_record_equal(NdefRecord* pRecord1, NdefRecord* pRecord2);
 
 /** Parse the NDEF message into list of records
- * \param data NDEF message buffer
- * \param dataLength NDEF message buffer's length
+ * MIME payloads keep a reference to the message instead of copying it
+ * \param pMessage NDEF message
  * \return list of NDEF Record instances (1 per record)
  */
-GList* ndef_message_parse(guint8* data, gsize dataLength); //Returns a list of NDEF records
+EXPLORENFC_API GList* ndef_message_parse(GBytes* pMessage); //Returns a list of NDEF records
 
 /** Generate a NDEF message from list of records
  * \param pList list of NDEF Record instances
  * \param pData will return NDEF message buffer
  * \param dataLength will return NDEF message buffer's length
  */
-void ndef_message_generate(GList* pList, guint8** pData, gsize* pDataLength);
+EXPLORENFC_API void ndef_message_generate(GList* pList, guint8** pData, gsize* pDataLength);
 
 #endif /* NDEF_H_ */
 
@@ -25,8 +25,6 @@
 static void record_class_init (RecordClass* pRecordClass);
 static void record_init(Record* pRecord);
 static void record_dispose(GObject* pGObject);
-static gchar* ndef_record_type_strdup(NdefRecord* pNdefRecord);
-static gchar* ndef_record_encoding_strdup(NdefRecord* pNdefRecord);
 
 
 //GObject implementation
@@ -52,6 +50,7 @@ void record_init(Record* pRecord)
 	pRecord->pNeardRecord = NULL;
 	pRecord->pObjectSkeleton = NULL;
 	pRecord->recordId = 0;
+	pRecord->exported = FALSE;
 }
 
 void record_dispose(GObject* pGObject)
@@ -66,57 +65,9 @@ void record_dispose(GObject* pGObject)
 	G_OBJECT_CLASS (record_parent_class)->dispose(pGObject);
 }
 
-gchar* ndef_record_type_strdup(NdefRecord* pNdefRecord)
-{
-	gchar* str = NULL;
-	switch(pNdefRecord->type)
-	{
-	case ndef_record_type_smart_poster:
-		str = "SmartPoster";
-		break;
-	case ndef_record_type_text:
-		str = "Text";
-		break;
-	case ndef_record_type_uri:
-		str = "URI";
-		break;
-	case ndef_record_type_handover_request:
-		str = "HandoverRequest";
-		break;
-	case ndef_record_type_handover_select:
-		str = "HandoverSelect";
-		break;
-	case ndef_record_type_handover_carrier:
-		str = "HandoverCarrier";
-		break;
-	case ndef_record_type_aar:
-		str = "AAR";
-		break;
-	case ndef_record_type_mime:
-		str = "MIME";
-		break;
-	default:
-		str = "Unknown";
-		break;
-	}
-	return g_strdup(str);
-}
-
-gchar* ndef_record_encoding_strdup(NdefRecord* pNdefRecord)
-{
-	gchar* str = NULL;
-	switch(pNdefRecord->encoding)
-	{
-	case ndef_record_encoding_utf_8:
-		str = "UTF-8";
-		break;
-	case ndef_record_encoding_utf_16:
-	default:
-		str = "UTF-16";
-		break;
-	}
-	return g_strdup(str);
-}
+//Skeletons of unregistered records, reused by the next ones instead of being created again
+#define RECORD_SKELETON_POOL_SIZE 16
+static GQueue recordSkeletonPool = G_QUEUE_INIT;
 
 Record* record_new()
 {
@@ -134,17 +85,22 @@ void record_register(Record* pRecord, RecordContainer* pRecordContainer, NdefRec
 	pRecord->objectPath = g_strdup_printf("%s"DBUS_RECORD_OBJECT_PATH, pRecordContainer->objectPath, recordId);
 	g_info("Record at %s\r\n", pRecord->objectPath);
 
-	pRecord->pObjectSkeleton = neard_object_skeleton_new(pRecord->objectPath);
-	pRecord->pNeardRecord = neard_record_skeleton_new();
-	neard_object_skeleton_set_record(pRecord->pObjectSkeleton, pRecord->pNeardRecord);
-
-	gchar* typeStr = ndef_record_type_strdup(pNdefRecord);
-    neard_record_set_type_(pRecord->pNeardRecord, typeStr);
-    g_free(typeStr);
+	pRecord->pObjectSkeleton = g_queue_pop_head(&recordSkeletonPool);
+	if(pRecord->pObjectSkeleton != NULL)
+	{
+		//Every property is set again below
+		g_dbus_object_skeleton_set_object_path(G_DBUS_OBJECT_SKELETON(pRecord->pObjectSkeleton), pRecord->objectPath);
+		pRecord->pNeardRecord = neard_object_get_record(NEARD_OBJECT(pRecord->pObjectSkeleton));
+	}
+	else
+	{
+		pRecord->pObjectSkeleton = neard_object_skeleton_new(pRecord->objectPath);
+		pRecord->pNeardRecord = neard_record_skeleton_new();
+		neard_object_skeleton_set_record(pRecord->pObjectSkeleton, pRecord->pNeardRecord);
+	}
 
-    gchar* encodingStr = ndef_record_encoding_strdup(pNdefRecord);
-    neard_record_set_encoding(pRecord->pNeardRecord, encodingStr);
-    g_free(encodingStr);
+    neard_record_set_type_(pRecord->pNeardRecord, ndef_record_type_name(pNdefRecord));
+    neard_record_set_encoding(pRecord->pNeardRecord, ndef_record_encoding_name(pNdefRecord));
 
     neard_record_set_name(pRecord->pNeardRecord, pRecord->objectPath);
     neard_record_set_language(pRecord->pNeardRecord, pNdefRecord->language);
@@ -156,15 +112,24 @@ void record_register(Record* pRecord, RecordContainer* pRecordContainer, NdefRec
     neard_record_set_android_package(pRecord->pNeardRecord, pNdefRecord->androidPackage);
 
 	//Export
-	g_dbus_object_manager_server_export( pRecord->pRecordContainer->pAdapter->pDaemon->pObjectManagerServer, G_DBUS_OBJECT_SKELETON(pRecord->pObjectSkeleton) );
+	record_export(pRecord);
 }
 
 void record_unregister(Record* pRecord)
 {
-	g_dbus_object_manager_server_unexport( pRecord->pRecordContainer->pAdapter->pDaemon->pObjectManagerServer, pRecord->objectPath );
+	record_unexport(pRecord);
 
 	g_object_unref(pRecord->pNeardRecord);
-	g_object_unref(pRecord->pObjectSkeleton);
+	if(g_queue_get_length(&recordSkeletonPool) < RECORD_SKELETON_POOL_SIZE)
+	{
+		g_queue_push_tail(&recordSkeletonPool, pRecord->pObjectSkeleton);
+	}
+	else
+	{
+		g_object_unref(pRecord->pObjectSkeleton);
+	}
+	pRecord->pNeardRecord = NULL;
+	pRecord->pObjectSkeleton = NULL;
 
 	g_free(pRecord->objectPath);
 	pRecord->objectPath = NULL;
@@ -172,3 +137,21 @@ void record_unregister(Record* pRecord)
 	//Clear ref to RecordContainer
 	g_clear_object(&pRecord->pRecordContainer);
 }
+
+void record_unexport(Record* pRecord)
+{
+	if( pRecord->exported )
+	{
+		dbus_daemon_unexport( pRecord->pRecordContainer->pAdapter->pDaemon, pRecord->objectPath );
+		pRecord->exported = FALSE;
+	}
+}
+
+void record_export(Record* pRecord)
+{
+	if( !pRecord->exported )
+	{
+		dbus_daemon_export( pRecord->pRecordContainer->pAdapter->pDaemon, G_DBUS_OBJECT_SKELETON(pRecord->pObjectSkeleton) );
+		pRecord->exported = TRUE;
+	}
+}
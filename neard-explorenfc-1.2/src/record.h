@@ -49,6 +49,7 @@ struct record
 	NeardRecord* pNeardRecord; ///< DBUS record interface
 	gchar* objectPath; ///< Object path
 	RecordContainer* pRecordContainer; ///< Parent (tag or device)
+	gboolean exported; ///< Object currently exported on D-Bus
 };
 typedef struct record Record; ///< Record
 
@@ -82,6 +83,16 @@ void record_register(Record* pRecord, RecordContainer* pRecordContainer, NdefRec
  */
 void record_unregister(Record* pRecord);
 
+/** Withdraw the record from D-Bus while keeping it registered, e.g. while its tag is retained
+ * \param pRecord Record to unexport
+ */
+void record_unexport(Record* pRecord);
+
+/** Export a record withdrawn with record_unexport() again
+ * \param pRecord Record to export
+ */
+void record_export(Record* pRecord);
+
 #endif /* RECORD_H_ */
 
 /**
@@ -0,0 +1,119 @@
+/*
+*         Copyright (c), NXP Semiconductors Gratkorn / Austria
+*
+*                     (C)NXP Semiconductors
+*       All rights are reserved. Reproduction in whole or in part is
+*      prohibited without the written consent of the copyright owner.
+*  NXP reserves the right to make changes without notice at any time.
+* NXP makes no warranty, expressed, implied or statutory, including but
+* not limited to any implied warranty of merchantability or fitness for any
+*particular purpose, or that the use will not infringe any third party patent,
+* copyright or trademark. NXP must not be liable for any loss or damage
+*                          arising from its use.
+*/
+/**
+ * \file status-page.c
+ * Status page: a shared mapping of a file, written by the main loop only
+ *
+ * The page is initialised in a temporary file which then replaces the previous one, so
+ * that readers opening the path never see it half-written.
+ */
+
+#include "status-page.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+struct status_page
+{
+	gchar* path;
+	status_page_data_t* pData;
+	gsize size;
+};
+
+status_page_t* status_page_new(const gchar* path, guint adapterId)
+{
+	gsize pageSize = (gsize)sysconf(_SC_PAGESIZE);
+	gsize size = ((sizeof(status_page_data_t) + pageSize - 1) / pageSize) * pageSize;
+
+	gchar* dir = g_path_get_dirname(path);
+	g_mkdir_with_parents(dir, 0755);
+	g_free(dir);
+
+	gchar* tmpPath = g_strdup_printf("%s.tmp", path);
+	int fd = open(tmpPath, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if( fd < 0 )
+	{
+		g_warning("Could not create status page %s: %s", tmpPath, g_strerror(errno));
+		g_free(tmpPath);
+		return NULL;
+	}
+
+	status_page_data_t* pData = MAP_FAILED;
+	if( ftruncate(fd, size) == 0 )
+	{
+		pData = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	}
+	//The mapping stays valid once the file is closed
+	close(fd);
+
+	if( pData == MAP_FAILED )
+	{
+		g_warning("Could not map status page %s: %s", tmpPath, g_strerror(errno));
+		g_unlink(tmpPath);
+		g_free(tmpPath);
+		return NULL;
+	}
+
+	//Zero-filled by ftruncate
+	pData->magic = STATUS_PAGE_MAGIC;
+	pData->version = STATUS_PAGE_VERSION;
+	pData->size = sizeof(status_page_data_t);
+	pData->adapterId = adapterId;
+	pData->lastEvent = g_get_monotonic_time();
+
+	if( rename(tmpPath, path) )
+	{
+		g_warning("Could not create status page %s: %s", path, g_strerror(errno));
+		munmap(pData, size);
+		g_unlink(tmpPath);
+		g_free(tmpPath);
+		return NULL;
+	}
+	g_free(tmpPath);
+
+	status_page_t* pStatusPage = g_malloc(sizeof(status_page_t));
+	pStatusPage->path = g_strdup(path);
+	pStatusPage->pData = pData;
+	pStatusPage->size = size;
+
+	return pStatusPage;
+}
+
+void status_page_free(status_page_t* pStatusPage)
+{
+	g_unlink(pStatusPage->path);
+	munmap(pStatusPage->pData, pStatusPage->size);
+	g_free(pStatusPage->path);
+	g_free(pStatusPage);
+}
+
+status_page_data_t* status_page_begin(status_page_t* pStatusPage)
+{
+	//Full barrier: readers see the odd sequence before any of the changes
+	g_atomic_int_inc((gint*)&pStatusPage->pData->sequence);
+	return pStatusPage->pData;
+}
+
+void status_page_end(status_page_t* pStatusPage)
+{
+	//Full barrier: the changes are visible before the sequence is even again
+	g_atomic_int_inc((gint*)&pStatusPage->pData->sequence);
+}
@@ -0,0 +1,119 @@
+/*
+*         Copyright (c), NXP Semiconductors Gratkorn / Austria
+*
+*                     (C)NXP Semiconductors
+*       All rights are reserved. Reproduction in whole or in part is
+*      prohibited without the written consent of the copyright owner.
+*  NXP reserves the right to make changes without notice at any time.
+* NXP makes no warranty, expressed, implied or statutory, including but
+* not limited to any implied warranty of merchantability or fitness for any
+*particular purpose, or that the use will not infringe any third party patent,
+* copyright or trademark. NXP must not be liable for any loss or damage
+*                          arising from its use.
+*/
+/**
+ * \file status-page.h
+ */
+/** \defgroup StatusPageGp Status Page
+ * State of an adapter published in a file which local clients map read-only
+ *
+ * The file holds one status_page_data_t, rewritten by the main loop whenever the adapter
+ * changes. Its sequence field makes it a seqlock: it is odd while an update is in progress.
+ * A reader copies the page and checks it was not updated meanwhile:
+ * - read sequence (with acquire semantics), start over if it is odd
+ * - copy the page
+ * - issue a read barrier and read sequence again, start over if it changed
+ *
+ * Readers never block the daemon, and sampling the page costs no system call.
+ *  @{
+ */
+
+#ifndef STATUS_PAGE_H_
+#define STATUS_PAGE_H_
+
+#include <glib.h>
+
+#define STATUS_PAGE_MAGIC 0x5343464E ///< "NFCS" on little-endian hosts
+#define STATUS_PAGE_VERSION 1 ///< Version of the page layout
+#define STATUS_PAGE_MAX_TAGS 8 ///< Number of tags listed
+#define STATUS_PAGE_MAX_DEVICES 4 ///< Number of devices listed
+
+/** Tag in the field
+ *
+ */
+struct status_page_tag
+{
+	guint32 tagId; ///< Tag ID
+	guint8 type; ///< Tag type (nfc_tag_type_t)
+	guint8 uidLength; ///< UID length, 0 if unknown
+	guint8 uid[10]; ///< UID (or Felica IDm)
+};
+typedef struct status_page_tag status_page_tag_t; ///< Tag in the field
+
+/** Page contents
+ *
+ */
+struct status_page_data
+{
+	guint32 magic; ///< STATUS_PAGE_MAGIC
+	guint16 version; ///< STATUS_PAGE_VERSION
+	guint16 size; ///< sizeof(status_page_data_t)
+	guint32 sequence; ///< Incremented before and after each update, odd while it is in progress
+	guint32 adapterId; ///< Adapter ID (object path /org/neard/nfc[adapterId])
+
+	guint8 mode; ///< Current mode (nfc_mode_t)
+	guint8 polling; ///< 1 if polling
+	guint8 powered; ///< 1 if powered
+	guint8 reserved; ///< Set to 0
+	guint16 tagCount; ///< Number of tags in the field, only the first STATUS_PAGE_MAX_TAGS are listed
+	guint16 deviceCount; ///< Number of devices in the field, only the first STATUS_PAGE_MAX_DEVICES are listed
+
+	guint64 lastEvent; ///< CLOCK_MONOTONIC time of the last update, in microseconds
+
+	//Counters, as in the adapter's Statistics property
+	guint64 detections; ///< Number of tags and devices detected
+	guint64 tagsLost; ///< Number of tags which left the field
+	guint64 pollCycles; ///< Polling cycles run before these detections
+	guint64 presenceChecks; ///< Number of presence checks run
+	guint64 eventsDispatched; ///< Number of HAL events delivered to the main loop
+	guint64 cacheHits; ///< Number of NDEF reads skipped thanks to the cache
+	guint64 cacheMisses; ///< Number of NDEF reads not found in the cache
+	guint64 detectionLatencyMax; ///< Longest detection latency, in microseconds
+	guint64 cpuTime; ///< CPU time used by the HAL thread, in microseconds
+
+	status_page_tag_t tags[STATUS_PAGE_MAX_TAGS]; ///< Tags in the field
+	guint32 devices[STATUS_PAGE_MAX_DEVICES]; ///< IDs of the devices in the field
+};
+typedef struct status_page_data status_page_data_t; ///< Page contents
+
+struct status_page;
+typedef struct status_page status_page_t; ///< Status page
+
+/** Create the page file, replacing any previous one
+ * \param path file system path, on a tmpfs such as /run
+ * \param adapterId adapter ID
+ * \return new status page, NULL on failure
+ */
+status_page_t* status_page_new(const gchar* path, guint adapterId);
+
+/** Remove the page file
+ * \param pStatusPage status page
+ */
+void status_page_free(status_page_t* pStatusPage);
+
+/** Start an update, readers retry until status_page_end() is called
+ * \param pStatusPage status page
+ * \return page contents to update
+ */
+status_page_data_t* status_page_begin(status_page_t* pStatusPage);
+
+/** Finish an update
+ * \param pStatusPage status page
+ */
+void status_page_end(status_page_t* pStatusPage);
+
+#endif /* STATUS_PAGE_H_ */
+
+/**
+ * @}
+ * */
@@ -0,0 +1,214 @@
+/*
+*         Copyright (c), NXP Semiconductors Gratkorn / Austria
+*
+*                     (C)NXP Semiconductors
+*       All rights are reserved. Reproduction in whole or in part is
+*      prohibited without the written consent of the copyright owner.
+*  NXP reserves the right to make changes without notice at any time.
+* NXP makes no warranty, expressed, implied or statutory, including but
+* not limited to any implied warranty of merchantability or fitness for any
+*particular purpose, or that the use will not infringe any third party patent,
+* copyright or trademark. NXP must not be liable for any loss or damage
+*                          arising from its use.
+*/
+/**
+ * \file subscription.c
+ * Subscriptions: matched against the snapshot built for TagRead, so that a tap costs
+ * nothing more than a few string comparisons per subscriber
+ */
+
+#include "subscription.h"
+#include "dbus-parameters.h"
+
+#include <glib.h>
+#include <gio/gio.h>
+#include <string.h>
+
+subscription_t* subscription_new(guint id, GDBusConnection* pConnection, const gchar* sender, GVariant* pFilter)
+{
+	subscription_t* pSubscription = g_malloc0(sizeof(subscription_t));
+	pSubscription->id = id;
+	pSubscription->pConnection = g_object_ref(pConnection);
+	pSubscription->sender = g_strdup(sender);
+	pSubscription->pMatchedTags = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+
+	GVariantIter iter;
+	const gchar* key;
+	GVariant* pValue;
+	g_variant_iter_init(&iter, pFilter);
+	while( g_variant_iter_next(&iter, "{&sv}", &key, &pValue) )
+	{
+		gboolean valid = TRUE;
+		if( !g_strcmp0(key, "RecordType") && g_variant_is_of_type(pValue, G_VARIANT_TYPE_STRING) )
+		{
+			g_free(pSubscription->recordType);
+			pSubscription->recordType = g_variant_dup_string(pValue, NULL);
+		}
+		else if( !g_strcmp0(key, "MIMEType") && g_variant_is_of_type(pValue, G_VARIANT_TYPE_STRING) )
+		{
+			g_free(pSubscription->mimeType);
+			pSubscription->mimeType = g_variant_dup_string(pValue, NULL);
+		}
+		else if( !g_strcmp0(key, "URIPrefix") && g_variant_is_of_type(pValue, G_VARIANT_TYPE_STRING) )
+		{
+			g_free(pSubscription->uriPrefix);
+			pSubscription->uriPrefix = g_variant_dup_string(pValue, NULL);
+		}
+		else if( !g_strcmp0(key, "UidPrefix") && g_variant_is_of_type(pValue, G_VARIANT_TYPE_BYTESTRING) )
+		{
+			if( pSubscription->pUidPrefix != NULL )
+			{
+				g_bytes_unref(pSubscription->pUidPrefix);
+			}
+			gsize length;
+			const guint8* prefix = g_variant_get_fixed_array(pValue, &length, sizeof(guint8));
+			pSubscription->pUidPrefix = g_bytes_new(prefix, length);
+		}
+		else
+		{
+			g_warning("Invalid subscription filter %s", key);
+			valid = FALSE;
+		}
+		g_variant_unref(pValue);
+
+		if( !valid )
+		{
+			subscription_free(pSubscription);
+			return NULL;
+		}
+	}
+
+	return pSubscription;
+}
+
+void subscription_free(subscription_t* pSubscription)
+{
+	if( pSubscription->watchId != 0 )
+	{
+		g_bus_unwatch_name(pSubscription->watchId);
+	}
+	g_object_unref(pSubscription->pConnection);
+	g_free(pSubscription->sender);
+	g_free(pSubscription->recordType);
+	g_free(pSubscription->mimeType);
+	g_free(pSubscription->uriPrefix);
+	if( pSubscription->pUidPrefix != NULL )
+	{
+		g_bytes_unref(pSubscription->pUidPrefix);
+	}
+	g_hash_table_destroy(pSubscription->pMatchedTags);
+	g_free(pSubscription);
+}
+
+static gboolean subscription_match_record(const subscription_t* pSubscription, GVariant* pRecord)
+{
+	const gchar* value;
+
+	if( pSubscription->recordType != NULL )
+	{
+		if( !g_variant_lookup(pRecord, "Type", "&s", &value) || g_strcmp0(value, pSubscription->recordType) )
+		{
+			return FALSE;
+		}
+	}
+
+	//MIME types are case-insensitive
+	if( pSubscription->mimeType != NULL )
+	{
+		if( !g_variant_lookup(pRecord, "MIMEType", "&s", &value) || g_ascii_strcasecmp(value, pSubscription->mimeType) )
+		{
+			return FALSE;
+		}
+	}
+
+	if( pSubscription->uriPrefix != NULL )
+	{
+		if( !g_variant_lookup(pRecord, "URI", "&s", &value) || !g_str_has_prefix(value, pSubscription->uriPrefix) )
+		{
+			return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
+gboolean subscription_match(const subscription_t* pSubscription, GVariant* pSnapshot)
+{
+	if( pSubscription->pUidPrefix != NULL )
+	{
+		gsize prefixLength;
+		const guint8* prefix = g_bytes_get_data(pSubscription->pUidPrefix, &prefixLength);
+
+		GVariant* pUid = g_variant_lookup_value(pSnapshot, "Uid", G_VARIANT_TYPE_BYTESTRING);
+		if( pUid == NULL )
+		{
+			return FALSE;
+		}
+		gsize uidLength;
+		const guint8* uid = g_variant_get_fixed_array(pUid, &uidLength, sizeof(guint8));
+		gboolean match = (uidLength >= prefixLength) && (memcmp(uid, prefix, prefixLength) == 0);
+		g_variant_unref(pUid);
+		if( !match )
+		{
+			return FALSE;
+		}
+	}
+
+	if( (pSubscription->recordType == NULL) && (pSubscription->mimeType == NULL) && (pSubscription->uriPrefix == NULL) )
+	{
+		return TRUE;
+	}
+
+	GVariant* pRecords = g_variant_lookup_value(pSnapshot, "Records", G_VARIANT_TYPE("aa{sv}"));
+	if( pRecords == NULL )
+	{
+		return FALSE;
+	}
+
+	gboolean match = FALSE;
+	gsize count = g_variant_n_children(pRecords);
+	for(gsize i = 0; (i < count) && !match; i++)
+	{
+		GVariant* pRecord = g_variant_get_child_value(pRecords, i);
+		match = subscription_match_record(pSubscription, pRecord);
+		g_variant_unref(pRecord);
+	}
+	g_variant_unref(pRecords);
+
+	return match;
+}
+
+void subscription_notify(subscription_t* pSubscription, const gchar* objectPath, GVariant* pSnapshot)
+{
+	GError* pError = NULL;
+
+	g_hash_table_add(pSubscription->pMatchedTags, g_strdup(objectPath));
+
+	//Addressed to the subscriber, the bus does not route it to anyone else
+	if( !g_dbus_connection_emit_signal(pSubscription->pConnection, pSubscription->sender, DBUS_ROOT_OBJECT_PATH,
+			DBUS_MANAGER_INTERFACE_NAME, DBUS_MANAGER_SIGNAL_TAG_MATCHED,
+			g_variant_new("(uo@a{sv})", pSubscription->id, objectPath, pSnapshot), &pError) )
+	{
+		g_debug("Could not notify subscription %u: %s", pSubscription->id, pError->message);
+		g_error_free(pError);
+	}
+}
+
+void subscription_notify_unmatched(subscription_t* pSubscription, const gchar* objectPath)
+{
+	GError* pError = NULL;
+
+	//Only the tags the subscriber was told about
+	if( !g_hash_table_remove(pSubscription->pMatchedTags, objectPath) )
+	{
+		return;
+	}
+
+	if( !g_dbus_connection_emit_signal(pSubscription->pConnection, pSubscription->sender, DBUS_ROOT_OBJECT_PATH,
+			DBUS_MANAGER_INTERFACE_NAME, DBUS_MANAGER_SIGNAL_TAG_UNMATCHED,
+			g_variant_new("(uo)", pSubscription->id, objectPath), &pError) )
+	{
+		g_debug("Could not notify subscription %u: %s", pSubscription->id, pError->message);
+		g_error_free(pError);
+	}
+}
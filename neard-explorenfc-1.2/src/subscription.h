@@ -0,0 +1,87 @@
+/*
+*         Copyright (c), NXP Semiconductors Gratkorn / Austria
+*
+*                     (C)NXP Semiconductors
+*       All rights are reserved. Reproduction in whole or in part is
+*      prohibited without the written consent of the copyright owner.
+*  NXP reserves the right to make changes without notice at any time.
+* NXP makes no warranty, expressed, implied or statutory, including but
+* not limited to any implied warranty of merchantability or fitness for any
+*particular purpose, or that the use will not infringe any third party patent,
+* copyright or trademark. NXP must not be liable for any loss or damage
+*                          arising from its use.
+*/
+/**
+ * \file subscription.h
+ */
+/** \defgroup SubscriptionGp Subscription
+ * Filter set by a client with Manager.Subscribe, tags which match it are signalled to that client only
+ *  @{
+ */
+
+#ifndef SUBSCRIPTION_H_
+#define SUBSCRIPTION_H_
+
+#include <glib.h>
+#include <gio/gio.h>
+
+/** Subscription
+ *
+ */
+struct subscription
+{
+	guint id; ///< Subscription ID
+	GDBusConnection* pConnection; ///< Connection of the subscriber, the bus or a direct peer
+	gchar* sender; ///< Unique bus name of the subscriber, NULL for a direct peer
+	guint watchId; ///< Watch on the subscriber's bus name, 0 if none
+
+	//Filter, every criterion set must match
+	gchar* recordType; ///< Type of a record (Record Type property), NULL for any
+	gchar* mimeType; ///< MIME type of a record, NULL for any
+	gchar* uriPrefix; ///< Start of the URI of a record, NULL for any
+	GBytes* pUidPrefix; ///< Start of the tag's UID, NULL for any
+
+	GHashTable* pMatchedTags; ///< Object paths of the tags signalled with TagMatched and not unmatched since
+};
+typedef struct subscription subscription_t; ///< Subscription
+
+/** Create a subscription
+ * \param id subscription ID
+ * \param pConnection connection of the subscriber
+ * \param sender unique bus name of the subscriber, NULL for a direct peer
+ * \param pFilter filter dictionary (a{sv}) passed to Subscribe
+ * \return new subscription, NULL if the filter is invalid
+ */
+subscription_t* subscription_new(guint id, GDBusConnection* pConnection, const gchar* sender, GVariant* pFilter);
+
+/** Free a subscription, stops watching the subscriber
+ * \param pSubscription subscription
+ */
+void subscription_free(subscription_t* pSubscription);
+
+/** Check whether a tag matches the filter
+ * Record criteria must all be met by the same record
+ * \param pSubscription subscription
+ * \param pSnapshot snapshot of the tag, as carried by the TagRead signal
+ * \return TRUE if it matches
+ */
+gboolean subscription_match(const subscription_t* pSubscription, GVariant* pSnapshot);
+
+/** Send the TagMatched signal to the subscriber only, and remember the tag as matched
+ * \param pSubscription subscription
+ * \param objectPath object path of the tag
+ * \param pSnapshot snapshot of the tag
+ */
+void subscription_notify(subscription_t* pSubscription, const gchar* objectPath, GVariant* pSnapshot);
+
+/** Send the TagUnmatched signal to the subscriber only, if the tag was signalled with TagMatched
+ * \param pSubscription subscription
+ * \param objectPath object path of the tag
+ */
+void subscription_notify_unmatched(subscription_t* pSubscription, const gchar* objectPath);
+
+#endif /* SUBSCRIPTION_H_ */
+
+/**
+ * @}
+ * */
@@ -15,10 +15,12 @@
 #include "tag.h"
 #include "dbus-daemon.h"
 #include "dbus-parameters.h"
+#include "adapter.h"
 
 #include <glib.h>
 #include <glib/gprintf.h>
 #include <gio/gio.h>
+#include <string.h>
 
 #include "hal.h"
 #include "ndef.h"
@@ -54,7 +56,10 @@ void tag_init(Tag* pTag)
 	pTag->pObjectSkeleton = NULL;
 	pTag->tagId = 0;
 	pTag->pRecordTable = g_hash_table_new(g_direct_hash, g_direct_equal);
+	pTag->pSnapshot = NULL;
 	pTag->pRawNDEF = NULL;
+	pTag->recordsPending = FALSE;
+	pTag->stablePath = FALSE;
 }
 
 void tag_dispose(GObject* pGObject)
@@ -74,6 +79,8 @@ static gboolean on_write (NeardTag *pInterfaceSkeleton, GDBusMethodInvocation *p
 							GVariant *arg_attributes, gpointer pUserData);
 static gboolean on_get_raw_ndef (NeardTag *pInterfaceSkeleton, GDBusMethodInvocation *pInvocation,
 							gpointer pUserData);
+static gboolean on_get_records (NeardTag *pInterfaceSkeleton, GDBusMethodInvocation *pInvocation,
+							gpointer pUserData);
 
 Tag* tag_new()
 {
@@ -81,6 +88,42 @@ Tag* tag_new()
 	return pTag;
 }
 
+//Keys of the Timings property, indexed by nfc_tag_timing_t
+static const gchar* timingNames[nfc_tag_timing_count] =
+{
+	"DiscoveryStart",
+	"DiscoveryEnd",
+	"CheckNdefStart",
+	"CheckNdefEnd",
+	"ReadNdefStart",
+	"ReadNdefEnd",
+	"Posted",
+	"Dispatched",
+	"PopulateStart",
+	"PopulateEnd",
+	"Exported",
+	"WriteStart",
+	"WriteEnd",
+	"VerifyEnd",
+};
+
+static GVariant* tag_get_timings(Tag* pTag)
+{
+	GVariantBuilder variantBld;
+	g_variant_builder_init(&variantBld, G_VARIANT_TYPE("a{st}"));
+
+	for(nfc_tag_timing_t timing = 0; timing < nfc_tag_timing_count; timing++)
+	{
+		gint64 time = hal_tag_get_timing(RECORD_CONTAINER(pTag)->pAdapter->pHal, pTag->tagId, timing);
+		if( time != 0 ) //Stage reached
+		{
+			g_variant_builder_add(&variantBld, "{st}", timingNames[timing], (guint64)time);
+		}
+	}
+
+	return g_variant_builder_end(&variantBld); //Floating
+}
+
 static GVariant* g_variant_new_from_raw_bytes(const guint8* array, gsize size)
 {
 	GBytes* pBytes = g_bytes_new(array, size);
@@ -89,32 +132,128 @@ static GVariant* g_variant_new_from_raw_bytes(const guint8* array, gsize size)
 	return pVariant; //Floating
 }
 
-void tag_register(Tag* pTag, Adapter* pAdapter, guint tagId)
+//Handover agents still get the records of a tag whose records are not exported yet
+static void tag_check_agents(Tag* pTag)
 {
-	RECORD_CONTAINER(pTag)->pAdapter = pAdapter;
-	g_object_ref(pAdapter);
+	DBusDaemon* pDBusDaemon = RECORD_CONTAINER(pTag)->pAdapter->pDaemon;
 
-	pTag->tagId = tagId;
+	if( (pTag->pRawNDEF == NULL) || (g_hash_table_size(pDBusDaemon->pAgentTable) == 0) )
+	{
+		return;
+	}
 
-	RECORD_CONTAINER(pTag)->objectPath = g_strdup_printf("%s"DBUS_TAG_OBJECT_PATH, pAdapter->objectPath, tagId);
-	g_info("Tag at %s\n", RECORD_CONTAINER(pTag)->objectPath);
+	GList* pList = ndef_message_parse(pTag->pRawNDEF);
+	for(GList* pItem = pList; pItem != NULL; pItem = g_list_next(pItem))
+	{
+		NdefRecord* pNdefRecord = (NdefRecord*) pItem->data;
+		dbus_daemon_check_ndef_record(pDBusDaemon, pNdefRecord);
+		g_object_unref(G_OBJECT(pNdefRecord));
+	}
+	g_list_free(pList);
+}
+
+//Skeletons of unregistered tags, reused by the next ones instead of being created again
+#define TAG_SKELETON_POOL_SIZE 4
+static GQueue tagSkeletonPool = G_QUEUE_INIT;
+
+static void tag_skeleton_acquire(Tag* pTag)
+{
+	pTag->pObjectSkeleton = g_queue_pop_head(&tagSkeletonPool);
+	if(pTag->pObjectSkeleton != NULL)
+	{
+		g_dbus_object_skeleton_set_object_path(G_DBUS_OBJECT_SKELETON(pTag->pObjectSkeleton), RECORD_CONTAINER(pTag)->objectPath);
+		pTag->pNeardTag = neard_object_get_tag(NEARD_OBJECT(pTag->pObjectSkeleton));
+		return;
+	}
 
 	pTag->pObjectSkeleton = neard_object_skeleton_new(RECORD_CONTAINER(pTag)->objectPath);
 	pTag->pNeardTag = neard_tag_skeleton_new();
 	neard_object_skeleton_set_tag(pTag->pObjectSkeleton, pTag->pNeardTag);
+}
 
-	//Connect signals
-	g_signal_connect(pTag->pNeardTag, "handle-write",
-					G_CALLBACK (on_write), pTag);
-	g_signal_connect(pTag->pNeardTag, "handle-get-raw-ndef",
-						G_CALLBACK (on_get_raw_ndef), pTag);
+static void tag_skeleton_release(Tag* pTag)
+{
+	//Handlers refer to this tag
+	g_signal_handlers_disconnect_by_data(pTag->pNeardTag, pTag);
+	g_object_unref(pTag->pNeardTag);
+	pTag->pNeardTag = NULL;
 
-    neard_tag_set_name(pTag->pNeardTag, RECORD_CONTAINER(pTag)->objectPath);
-	neard_tag_set_adapter(pTag->pNeardTag, pAdapter->objectPath);
+	if(g_queue_get_length(&tagSkeletonPool) < TAG_SKELETON_POOL_SIZE)
+	{
+		g_queue_push_tail(&tagSkeletonPool, pTag->pObjectSkeleton);
+	}
+	else
+	{
+		g_object_unref(pTag->pObjectSkeleton);
+	}
+	pTag->pObjectSkeleton = NULL;
+}
+
+//Felica cards are identified by their IDm, manufacturer code followed by card ID
+static gsize tag_snapshot_get_uid(const nfc_tag_snapshot_t* pSnapshot, guint8* uid)
+{
+	if(pSnapshot->uidLength > 0)
+	{
+		gsize uidLength = MIN(pSnapshot->uidLength, TAG_UID_MAX_LENGTH);
+		memcpy(uid, pSnapshot->uid, uidLength);
+		return uidLength;
+	}
+	else if(pSnapshot->felica)
+	{
+		memcpy(uid, pSnapshot->manufacturer, sizeof(pSnapshot->manufacturer));
+		memcpy(uid + sizeof(pSnapshot->manufacturer), pSnapshot->cid, sizeof(pSnapshot->cid));
+		return sizeof(pSnapshot->manufacturer) + sizeof(pSnapshot->cid);
+	}
+	return 0;
+}
+
+gchar* tag_object_path_new(Adapter* pAdapter, guint tagId, gboolean* pStable)
+{
+	gchar* objectPath = NULL;
+
+	if(pAdapter->pDaemon->uidObjectPaths)
+	{
+		const nfc_tag_snapshot_t* pSnapshot = hal_tag_get_snapshot(pAdapter->pHal, tagId);
+		guint8 uid[TAG_UID_MAX_LENGTH];
+		gsize uidLength = tag_snapshot_get_uid(pSnapshot, uid);
+		hal_tag_snapshot_unref(pSnapshot);
+
+		if(uidLength > 0)
+		{
+			GString* pObjectPath = g_string_new(pAdapter->objectPath);
+			g_string_append(pObjectPath, DBUS_TAG_UID_OBJECT_PATH);
+			for(gsize i = 0; i < uidLength; i++)
+			{
+				g_string_append_printf(pObjectPath, "%02X", uid[i]);
+			}
+			objectPath = g_string_free(pObjectPath, FALSE);
+
+			//Clones of a tag already in the field fall back to the id
+			if(adapter_lookup_tag(pAdapter, objectPath) != NULL)
+			{
+				g_free(objectPath);
+				objectPath = NULL;
+			}
+		}
+	}
+
+	*pStable = (objectPath != NULL);
+	if(objectPath == NULL)
+	{
+		objectPath = g_strdup_printf("%s"DBUS_TAG_OBJECT_PATH, pAdapter->objectPath, tagId);
+	}
+
+	return objectPath;
+}
+
+//Set properties from the snapshot, a pooled skeleton may still hold the ones of a previous tag
+static void tag_update_properties(Tag* pTag)
+{
+	const nfc_tag_snapshot_t* pSnapshot = pTag->pSnapshot;
 
 	gchar* typeStr;
 	gchar* protocolStr;
-	switch(hal_tag_get_type(RECORD_CONTAINER(pTag)->pAdapter->pDaemon->pHal, tagId))
+	switch(pSnapshot->type)
 	{
 	case nfc_tag_type_1:
 		typeStr = g_strdup("Type 1");
@@ -140,59 +279,314 @@ void tag_register(Tag* pTag, Adapter* pAdapter, guint tagId)
 	g_free(typeStr);
 	g_free(protocolStr);
 
-	//Populate records
-	tag_populate_records(pTag);
-
-	neard_tag_set_read_only(pTag->pNeardTag, hal_tag_is_readonly(RECORD_CONTAINER(pTag)->pAdapter->pDaemon->pHal, tagId));
+	neard_tag_set_read_only(pTag->pNeardTag, pSnapshot->readOnly);
 
 	//See if tag is ISO14443A compliant
-	if( hal_tag_is_iso14443a( RECORD_CONTAINER(pTag)->pAdapter->pDaemon->pHal, tagId ) )
+	if( pSnapshot->iso14443a )
+	{
+		neard_tag_set_iso14443a_uid(pTag->pNeardTag, g_variant_new_from_raw_bytes(pSnapshot->uid, pSnapshot->uidLength));
+		neard_tag_set_iso14443a_sak(pTag->pNeardTag, g_variant_new_from_raw_bytes(&pSnapshot->sak, 1));
+		neard_tag_set_iso14443a_atqa(pTag->pNeardTag, g_variant_new_from_raw_bytes(pSnapshot->atqa, sizeof(pSnapshot->atqa)));
+	}
+	else
 	{
-		guint8 atqa[2];
-		guint8 uid[10];
-		gsize uidLength;
-		guint8 sak;
+		neard_tag_set_iso14443a_uid(pTag->pNeardTag, NULL);
+		neard_tag_set_iso14443a_sak(pTag->pNeardTag, NULL);
+		neard_tag_set_iso14443a_atqa(pTag->pNeardTag, NULL);
+	}
 
-		hal_tag_get_iso14443a_params( RECORD_CONTAINER(pTag)->pAdapter->pDaemon->pHal, tagId,
-				atqa, &sak, uid, &uidLength );
+	//See if tag is Felica compliant
+	if( pSnapshot->felica )
+	{
+		neard_tag_set_felica_manufacturer(pTag->pNeardTag, g_variant_new_from_raw_bytes(pSnapshot->manufacturer, sizeof(pSnapshot->manufacturer)));
+		neard_tag_set_felica_cid(pTag->pNeardTag, g_variant_new_from_raw_bytes(pSnapshot->cid, sizeof(pSnapshot->cid)));
+		neard_tag_set_felica_ic(pTag->pNeardTag, g_variant_new_from_raw_bytes(pSnapshot->ic, sizeof(pSnapshot->ic)));
+		neard_tag_set_felica_max_resp_times(pTag->pNeardTag, g_variant_new_from_raw_bytes(pSnapshot->maxRespTimes, sizeof(pSnapshot->maxRespTimes)));
+	}
+	else
+	{
+		neard_tag_set_felica_manufacturer(pTag->pNeardTag, NULL);
+		neard_tag_set_felica_cid(pTag->pNeardTag, NULL);
+		neard_tag_set_felica_ic(pTag->pNeardTag, NULL);
+		neard_tag_set_felica_max_resp_times(pTag->pNeardTag, NULL);
+	}
+}
+
+//Remove & free records
+static void tag_clear_records(Tag* pTag)
+{
+	GHashTableIter iter;
+	guint* pRecordId;
+	Record* pRecord;
 
-		neard_tag_set_iso14443a_uid(pTag->pNeardTag, g_variant_new_from_raw_bytes(uid, uidLength));
-		neard_tag_set_iso14443a_sak(pTag->pNeardTag, g_variant_new_from_raw_bytes(&sak, 1));
-		neard_tag_set_iso14443a_atqa(pTag->pNeardTag, g_variant_new_from_raw_bytes(atqa, sizeof(atqa)));
+	g_hash_table_iter_init (&iter, pTag->pRecordTable);
+	while (g_hash_table_iter_next(&iter, (gpointer*)&pRecordId, (gpointer*)&pRecord))
+	{
+		record_unregister(pRecord);
+
+		//Remove from table
+		g_hash_table_iter_remove(&iter);
+
+		//Free record
+		g_object_unref(pRecord);
 	}
 
-	//See if tag is ISO14443A compliant
-	if( hal_tag_is_felica( RECORD_CONTAINER(pTag)->pAdapter->pDaemon->pHal, tagId ) )
+	neard_tag_set_records(pTag->pNeardTag, NULL);
+	pTag->recordsPending = FALSE;
+}
+
+//Bring the exported records in line with the current message, one index at a time
+//Records equal to the ones parsed from pOldNDEF keep their object, the others are registered again
+static void tag_update_records(Tag* pTag, GBytes* pOldNDEF)
+{
+	GList* pOldList = (pOldNDEF != NULL) ? ndef_message_parse(pOldNDEF) : NULL;
+	GList* pNewList = (pTag->pRawNDEF != NULL) ? ndef_message_parse(pTag->pRawNDEF) : NULL;
+	gsize length = g_list_length(pNewList);
+
+	const gchar* objectPaths[length + 1];
+	guint kept = 0;
+
+	GList* pOldItem = pOldList;
+	GList* pNewItem = pNewList;
+	for(guint recordId = 0; (pOldItem != NULL) || (pNewItem != NULL); recordId++)
 	{
-		guint8 manufacturer[2];
-		guint8 cid[6];
-		guint8 ic[2];
-		guint8 maxRespTimes[6];
+		NdefRecord* pOldNdefRecord = (pOldItem != NULL) ? (NdefRecord*) pOldItem->data : NULL;
+		NdefRecord* pNewNdefRecord = (pNewItem != NULL) ? (NdefRecord*) pNewItem->data : NULL;
+		Record* pRecord = g_hash_table_lookup(pTag->pRecordTable, GUINT_TO_POINTER(recordId));
 
-		hal_tag_get_felica_params( RECORD_CONTAINER(pTag)->pAdapter->pDaemon->pHal, tagId,
-				manufacturer, cid, ic, maxRespTimes );
+		if( (pRecord != NULL) && (pOldNdefRecord != NULL) && (pNewNdefRecord != NULL)
+				&& ndef_record_equal(pOldNdefRecord, pNewNdefRecord) )
+		{
+			kept++;
+		}
+		else
+		{
+			//Changed or removed
+			if( pRecord != NULL )
+			{
+				record_unregister(pRecord);
+				g_hash_table_remove(pTag->pRecordTable, GUINT_TO_POINTER(recordId));
+				g_object_unref(pRecord);
+				pRecord = NULL;
+			}
+
+			//Changed or added
+			if( pNewNdefRecord != NULL )
+			{
+				pRecord = record_new();
+				record_register(pRecord, RECORD_CONTAINER(pTag), pNewNdefRecord, recordId);
+				g_hash_table_insert(pTag->pRecordTable, GUINT_TO_POINTER(pRecord->recordId), pRecord);
+			}
+		}
 
-		neard_tag_set_felica_manufacturer(pTag->pNeardTag, g_variant_new_from_raw_bytes(manufacturer, sizeof(manufacturer)));
-		neard_tag_set_felica_cid(pTag->pNeardTag, g_variant_new_from_raw_bytes(cid, sizeof(cid)));
-		neard_tag_set_felica_ic(pTag->pNeardTag, g_variant_new_from_raw_bytes(ic, sizeof(ic)));
-		neard_tag_set_felica_max_resp_times(pTag->pNeardTag, g_variant_new_from_raw_bytes(maxRespTimes, sizeof(maxRespTimes)));
+		if( pNewNdefRecord != NULL )
+		{
+			objectPaths[recordId] = pRecord->objectPath;
+		}
+
+		pOldItem = (pOldItem != NULL) ? g_list_next(pOldItem) : NULL;
+		pNewItem = (pNewItem != NULL) ? g_list_next(pNewItem) : NULL;
 	}
+	objectPaths[length] = NULL;
+
+	g_list_free_full(pOldList, g_object_unref);
+	g_list_free_full(pNewList, g_object_unref);
+
+	neard_tag_set_records(pTag->pNeardTag, (length > 0) ? objectPaths : NULL);
+
+	g_debug("Kept %u of %" G_GSIZE_FORMAT " records of %s", kept, length, RECORD_CONTAINER(pTag)->objectPath);
+}
+
+void tag_register(Tag* pTag, Adapter* pAdapter, guint tagId)
+{
+	RECORD_CONTAINER(pTag)->pAdapter = pAdapter;
+	g_object_ref(pAdapter);
+
+	pTag->tagId = tagId;
+
+	RECORD_CONTAINER(pTag)->objectPath = tag_object_path_new(pAdapter, tagId, &pTag->stablePath);
+	g_info("Tag at %s\n", RECORD_CONTAINER(pTag)->objectPath);
+
+	tag_skeleton_acquire(pTag);
+
+	//Connect signals
+	g_signal_connect(pTag->pNeardTag, "handle-write",
+					G_CALLBACK (on_write), pTag);
+	g_signal_connect(pTag->pNeardTag, "handle-get-raw-ndef",
+						G_CALLBACK (on_get_raw_ndef), pTag);
+	g_signal_connect(pTag->pNeardTag, "handle-get-records",
+						G_CALLBACK (on_get_records), pTag);
+
+    neard_tag_set_name(pTag->pNeardTag, RECORD_CONTAINER(pTag)->objectPath);
+	neard_tag_set_adapter(pTag->pNeardTag, pAdapter->objectPath);
+
+	//Get all properties at once
+	pTag->pSnapshot = hal_tag_get_snapshot(RECORD_CONTAINER(pTag)->pAdapter->pHal, tagId);
+	const nfc_tag_snapshot_t* pSnapshot = pTag->pSnapshot;
+
+	//Same buffer as the HAL's, records and RawNDEF share it
+	if(pSnapshot->pNdef != NULL)
+	{
+		pTag->pRawNDEF = g_bytes_ref(pSnapshot->pNdef);
+	}
+
+	//Populate records, unless they are only exported on first access
+	hal_tag_set_timing(RECORD_CONTAINER(pTag)->pAdapter->pHal, tagId, nfc_tag_timing_populate_start);
+	neard_tag_set_records(pTag->pNeardTag, NULL);
+	if(pAdapter->pDaemon->lazyRecords)
+	{
+		pTag->recordsPending = TRUE;
+		tag_check_agents(pTag);
+	}
+	else
+	{
+		tag_populate_records(pTag);
+	}
+	hal_tag_set_timing(RECORD_CONTAINER(pTag)->pAdapter->pHal, tagId, nfc_tag_timing_populate_end);
+
+	tag_update_properties(pTag);
 
 	//Export
-	g_dbus_object_manager_server_export( RECORD_CONTAINER(pTag)->pAdapter->pDaemon->pObjectManagerServer, G_DBUS_OBJECT_SKELETON(pTag->pObjectSkeleton) );
+	dbus_daemon_export( RECORD_CONTAINER(pTag)->pAdapter->pDaemon, G_DBUS_OBJECT_SKELETON(pTag->pObjectSkeleton) );
+	hal_tag_set_timing(RECORD_CONTAINER(pTag)->pAdapter->pHal, tagId, nfc_tag_timing_exported);
+
+	neard_tag_set_timings(pTag->pNeardTag, tag_get_timings(pTag));
+}
+
+gsize tag_get_uid(Tag* pTag, guint8* uid)
+{
+	return tag_snapshot_get_uid(pTag->pSnapshot, uid);
+}
+
+GVariant* tag_get_snapshot_dictionary(Tag* pTag)
+{
+	GVariantBuilder variantBld;
+	g_variant_builder_init(&variantBld, G_VARIANT_TYPE("a{sv}"));
+
+	g_variant_builder_add(&variantBld, "{sv}", "Type", g_variant_new_string(neard_tag_get_type_(pTag->pNeardTag)));
+	g_variant_builder_add(&variantBld, "{sv}", "Protocol", g_variant_new_string(neard_tag_get_protocol(pTag->pNeardTag)));
+	g_variant_builder_add(&variantBld, "{sv}", "ReadOnly", g_variant_new_boolean(neard_tag_get_read_only(pTag->pNeardTag)));
+
+	guint8 uid[TAG_UID_MAX_LENGTH];
+	gsize uidLength = tag_snapshot_get_uid(pTag->pSnapshot, uid);
+	if(uidLength > 0)
+	{
+		g_variant_builder_add(&variantBld, "{sv}", "Uid", g_variant_new_from_raw_bytes(uid, uidLength));
+	}
+
+	//Parsed again rather than read from the record objects, which may not exist yet
+	GVariantBuilder recordsBld;
+	g_variant_builder_init(&recordsBld, G_VARIANT_TYPE("aa{sv}"));
+	if(pTag->pRawNDEF != NULL)
+	{
+		GList* pList = ndef_message_parse(pTag->pRawNDEF);
+		for(GList* pItem = pList; pItem != NULL; pItem = g_list_next(pItem))
+		{
+			NdefRecord* pNdefRecord = (NdefRecord*) pItem->data;
+			g_variant_builder_add_value(&recordsBld, ndef_record_to_dictionary(pNdefRecord));
+			g_object_unref(G_OBJECT(pNdefRecord));
+		}
+		g_list_free(pList);
+	}
+	g_variant_builder_add(&variantBld, "{sv}", "Records", g_variant_builder_end(&recordsBld));
+
+	return g_variant_builder_end(&variantBld); //Floating
+}
+
+//Withdraw or bring back the record objects of a retained tag, which stay registered
+static void tag_export_retained_records(Tag* pTag, gboolean export)
+{
+	GHashTableIter iter;
+	guint* pRecordId;
+	Record* pRecord;
+
+	g_hash_table_iter_init (&iter, pTag->pRecordTable);
+	while (g_hash_table_iter_next(&iter, (gpointer*)&pRecordId, (gpointer*)&pRecord))
+	{
+		if( export )
+		{
+			record_export(pRecord);
+		}
+		else
+		{
+			record_unexport(pRecord);
+		}
+	}
+}
+
+void tag_retain(Tag* pTag)
+{
+	//No record must be left under a path which does not exist anymore
+	tag_export_retained_records(pTag, FALSE);
+	dbus_daemon_unexport( RECORD_CONTAINER(pTag)->pAdapter->pDaemon, RECORD_CONTAINER(pTag)->objectPath );
+
+	//Records and raw message stay, the HAL's tag goes
+	if( pTag->pSnapshot != NULL )
+	{
+		hal_tag_snapshot_unref(pTag->pSnapshot);
+		pTag->pSnapshot = NULL;
+	}
+	pTag->tagId = 0;
+}
+
+void tag_resume(Tag* pTag, guint tagId)
+{
+	Adapter* pAdapter = RECORD_CONTAINER(pTag)->pAdapter;
+
+	pTag->tagId = tagId;
+	pTag->pSnapshot = hal_tag_get_snapshot(pAdapter->pHal, tagId);
+	GBytes* pNdef = pTag->pSnapshot->pNdef;
+
+	hal_tag_set_timing(pAdapter->pHal, tagId, nfc_tag_timing_populate_start);
+
+	//Records are only looked at again if the message changed since the tag was last seen
+	gboolean unchanged = (pNdef == NULL) ? (pTag->pRawNDEF == NULL) : ((pTag->pRawNDEF != NULL) && g_bytes_equal(pNdef, pTag->pRawNDEF));
+	if( unchanged )
+	{
+		g_debug("Keeping records of %s", RECORD_CONTAINER(pTag)->objectPath);
+		tag_check_agents(pTag);
+	}
+	else
+	{
+		GBytes* pOldNDEF = pTag->pRawNDEF;
+		pTag->pRawNDEF = (pNdef != NULL) ? g_bytes_ref(pNdef) : NULL;
+
+		//Records left pending are exported from the new message on first access
+		if( !pTag->recordsPending )
+		{
+			tag_update_records(pTag, pOldNDEF);
+		}
+		tag_check_agents(pTag);
+
+		if( pOldNDEF != NULL )
+		{
+			g_bytes_unref(pOldNDEF);
+		}
+	}
+
+	//Records kept as they were come back on D-Bus
+	tag_export_retained_records(pTag, TRUE);
+
+	hal_tag_set_timing(pAdapter->pHal, tagId, nfc_tag_timing_populate_end);
+
+	tag_update_properties(pTag);
+
+	//Export
+	dbus_daemon_export( pAdapter->pDaemon, G_DBUS_OBJECT_SKELETON(pTag->pObjectSkeleton) );
+	hal_tag_set_timing(pAdapter->pHal, tagId, nfc_tag_timing_exported);
+
+	neard_tag_set_timings(pTag->pNeardTag, tag_get_timings(pTag));
 }
 
 void tag_populate_records(Tag* pTag)
 {
-	//Get NDEF
-	guint8* buffer = NULL;
-	gsize bufferLength = 0;
-	hal_tag_get_ndef(RECORD_CONTAINER(pTag)->pAdapter->pDaemon->pHal, pTag->tagId, &buffer, &bufferLength);
+	//Agents have already seen the records of a tag exported lazily
+	gboolean checkAgents = !pTag->recordsPending;
+	pTag->recordsPending = FALSE;
 
-	if(buffer != NULL)
+	if(pTag->pRawNDEF != NULL)
 	{
-		GList* pList = ndef_message_parse(buffer, bufferLength);
-		pTag->pRawNDEF = g_bytes_new_take(buffer, bufferLength); //buffer is now owned by pRawNDEF
+		GList* pList = ndef_message_parse(pTag->pRawNDEF);
 		gsize length = g_list_length(pList);
 
 		const gchar* objectPaths[length + 1];
@@ -206,7 +600,10 @@ void tag_populate_records(Tag* pTag)
 			NdefRecord* pNdefRecord = (NdefRecord*) pList->data;
 
 			//Check various agents that might have been registered
-			dbus_daemon_check_ndef_record(RECORD_CONTAINER(pTag)->pAdapter->pDaemon, pNdefRecord);
+			if(checkAgents)
+			{
+				dbus_daemon_check_ndef_record(RECORD_CONTAINER(pTag)->pAdapter->pDaemon, pNdefRecord);
+			}
 
 			Record* pRecord = record_new();
 			record_register(pRecord, RECORD_CONTAINER(pTag), pNdefRecord, recordId);
@@ -231,29 +628,21 @@ void tag_populate_records(Tag* pTag)
 	}
 }
 
-void tag_unregister(Tag* pTag)
+void tag_export_records(Tag* pTag)
 {
-	g_dbus_object_manager_server_unexport( RECORD_CONTAINER(pTag)->pAdapter->pDaemon->pObjectManagerServer, RECORD_CONTAINER(pTag)->objectPath );
-
-	GHashTableIter iter;
-	guint* pRecordId;
-	Record* pRecord;
-
-	//Remove & free records
-	g_hash_table_iter_init (&iter, pTag->pRecordTable);
-	while (g_hash_table_iter_next(&iter, (gpointer*)&pRecordId, (gpointer*)&pRecord))
+	if(pTag->recordsPending)
 	{
-		record_unregister(pRecord);
+		tag_populate_records(pTag);
+	}
+}
 
-		//Remove from table
-		g_hash_table_iter_remove(&iter);
+void tag_unregister(Tag* pTag)
+{
+	dbus_daemon_unexport( RECORD_CONTAINER(pTag)->pAdapter->pDaemon, RECORD_CONTAINER(pTag)->objectPath );
 
-		//Free record
-		g_object_unref(pRecord);
-	}
+	tag_clear_records(pTag);
 
-	g_object_unref(pTag->pNeardTag);
-	g_object_unref(pTag->pObjectSkeleton);
+	tag_skeleton_release(pTag);
 
 	//g_dbus_connection_unregister_object(pAdapter->pDaemon->pConnection, pAdapter->registrationId);
 
@@ -263,6 +652,14 @@ void tag_unregister(Tag* pTag)
 		pTag->pRawNDEF = NULL;
 	}
 
+	if( pTag->pSnapshot != NULL )
+	{
+		hal_tag_snapshot_unref(pTag->pSnapshot);
+		pTag->pSnapshot = NULL;
+	}
+
+	pTag->stablePath = FALSE;
+
 	g_free(RECORD_CONTAINER(pTag)->objectPath);
 	RECORD_CONTAINER(pTag)->objectPath = NULL;
 
@@ -271,11 +668,63 @@ void tag_unregister(Tag* pTag)
 }
 
 //Local functions
+//Pending Write() call
+struct tag_write_request
+{
+	Tag* pTag;
+	GDBusMethodInvocation* pInvocation;
+};
+typedef struct tag_write_request tag_write_request_t;
+
+static void tag_on_write_done_cb(hal_t* pHal, guint tagId, nfc_tag_write_result_t result, gint64 duration,
+		gsize bytesSent, gpointer pUserData)
+{
+	tag_write_request_t* pRequest = (tag_write_request_t*) pUserData;
+	Tag* pTag = pRequest->pTag;
+
+	//Tag might have been lost in the meantime
+	if( pTag->pSnapshot != NULL )
+	{
+		neard_tag_set_timings(pTag->pNeardTag, tag_get_timings(pTag));
+	}
+
+	switch(result)
+	{
+	case nfc_tag_write_success:
+		g_info("Tag written in %" G_GINT64_FORMAT " us, %" G_GSIZE_FORMAT " bytes sent", duration, bytesSent);
+		neard_tag_complete_write(pTag->pNeardTag, pRequest->pInvocation);
+		break;
+	case nfc_tag_write_not_connected:
+		g_dbus_method_invocation_return_dbus_error(pRequest->pInvocation, DBUS_ERROR_DOES_NOT_EXIST, "Tag is not in the field anymore");
+		break;
+	case nfc_tag_write_read_only:
+		g_dbus_method_invocation_return_dbus_error(pRequest->pInvocation, DBUS_ERROR_PERMISSION_DENIED, "Tag is read only");
+		break;
+	case nfc_tag_write_verify_failed:
+		g_dbus_method_invocation_return_dbus_error(pRequest->pInvocation, DBUS_ERROR_FAILED, "Message read back differs from the one written");
+		break;
+	case nfc_tag_write_busy:
+		g_dbus_method_invocation_return_dbus_error(pRequest->pInvocation, DBUS_ERROR_IN_PROGRESS, "Too many pending operations");
+		break;
+	case nfc_tag_write_failed:
+	default:
+		g_dbus_method_invocation_return_dbus_error(pRequest->pInvocation, DBUS_ERROR_FAILED, "Could not write tag");
+		break;
+	}
+
+	g_object_unref(pTag);
+	g_free(pRequest);
+}
+
 gboolean on_write (NeardTag *pInterfaceSkeleton, GDBusMethodInvocation *pInvocation,
 							GVariant *arg_attributes, gpointer pUserData)
 {
 	Tag* pTag = (Tag*) pUserData;
 
+	//Optional read back, not part of the record itself
+	gboolean verify = FALSE;
+	g_variant_lookup(arg_attributes, "Verify", "b", &verify);
+
 	//Build NdefRecord instance based on array of dictionaries
 	NdefRecord* pNdefRecord = ndef_record_from_dictionary(arg_attributes);
 
@@ -285,16 +734,25 @@ gboolean on_write (NeardTag *pInterfaceSkeleton, GDBusMethodInvocation *pInvocat
 	guint8* buffer = NULL;
 	gsize bufferLength = 0;
 	ndef_message_generate(pList, &buffer, &bufferLength);
-	hal_tag_write_ndef(RECORD_CONTAINER(pTag)->pAdapter->pDaemon->pHal, pTag->tagId, buffer, bufferLength);
 
 	g_list_free(pList);
 
-	if( buffer != NULL )
+	if( buffer == NULL )
 	{
-		g_free(buffer);
+		g_dbus_method_invocation_return_dbus_error(pInvocation, DBUS_ERROR_INVALID_ARGUMENTS, "Invalid record");
+		return TRUE;
 	}
 
-	neard_tag_complete_write(pInterfaceSkeleton, pInvocation);
+	//Reply once the HAL thread is done with the tag
+	tag_write_request_t* pRequest = g_malloc(sizeof(tag_write_request_t));
+	pRequest->pTag = g_object_ref(pTag);
+	pRequest->pInvocation = pInvocation;
+
+	hal_tag_write_ndef(RECORD_CONTAINER(pTag)->pAdapter->pHal, pTag->tagId, buffer, bufferLength,
+			verify, tag_on_write_done_cb, pRequest);
+
+	g_free(buffer);
+
 	return TRUE;
 }
 
@@ -318,8 +776,23 @@ gboolean on_get_raw_ndef (NeardTag *pInterfaceSkeleton, GDBusMethodInvocation *p
 
 	neard_tag_complete_get_raw_ndef(pInterfaceSkeleton, pInvocation, pNdefVariant);
 
-	g_object_unref(pNdefVariant);
+	//The floating variant was consumed by the reply, which references pRawNDEF without copying it
 	g_bytes_unref(pRawNDEF);
 
 	return TRUE;
 }
+
+gboolean on_get_records (NeardTag *pInterfaceSkeleton, GDBusMethodInvocation *pInvocation,
+							gpointer pUserData)
+{
+	Tag* pTag = (Tag*) pUserData;
+
+	tag_export_records(pTag);
+
+	const gchar* const* records = neard_tag_get_records(pInterfaceSkeleton);
+	const gchar* noRecords[] = { NULL };
+
+	neard_tag_complete_get_records(pInterfaceSkeleton, pInvocation, (records != NULL) ? records : noRecords);
+
+	return TRUE;
+}
@@ -32,6 +32,10 @@
 struct adapter;
 typedef struct adapter Adapter;
 
+struct nfc_tag_snapshot;
+
+#define TAG_UID_MAX_LENGTH 10 ///< Longest UID (or Felica IDm)
+
 #define TYPE_TAG   (tag_get_type               ())
 #define TAG(obj)   (G_TYPE_CHECK_INSTANCE_CAST ((obj), TYPE_TAG, Tag))
 #define TAG_CLASS(cls)     (G_TYPE_CHECK_CLASS_CAST    ((cls), TYPE_TAG, TagClass))
@@ -85,7 +89,10 @@ struct tag
 	NeardObjectSkeleton* pObjectSkeleton; ///< DBUS Object Skeleton
 	NeardTag* pNeardTag; ///< DBUS tag interface
 
+	const struct nfc_tag_snapshot* pSnapshot; ///< Properties and NDEF message, as read by the HAL
 	GBytes* pRawNDEF; ///< Raw NDEF message on tag
+	gboolean recordsPending; ///< Records not exported yet, they will be on first access
+	gboolean stablePath; ///< Object path derived from the UID, the same every time the tag is seen
 
 	GHashTable* pRecordTable; ///< Table of records
 };
@@ -108,6 +115,15 @@ typedef struct tag_class TagClass; ///< Tag class
  */
 Tag* tag_new();
 
+/** Build the object path of a tag
+ * Derived from the tag's UID if enabled and available, from its id otherwise
+ * \param pAdapter Adapter on which the tag will be registered
+ * \param tagId id of tag
+ * \param pStable set to TRUE if the path is derived from the UID
+ * \return object path, free with g_free()
+ */
+gchar* tag_object_path_new(Adapter* pAdapter, guint tagId, gboolean* pStable);
+
 /** Register the tag on the following Adapter
  * \param pTag Tag to register
  * \param pAdapter Adapter on which to register
@@ -121,6 +137,38 @@ void tag_register(Tag* pTag, Adapter* pAdapter, guint tagId);
  */
 void tag_populate_records(Tag* pTag);
 
+/** Export records if they were left pending
+ * With lazy record export, called when a client first accesses the tag's records
+ * \param pTag Tag for which to export records
+ */
+void tag_export_records(Tag* pTag);
+
+/** Get the tag's type, UID and parsed records in one dictionary
+ * \param pTag Tag, must be in the field
+ * \return floating variant dictionary (a{sv}) with "Type", "Protocol", "ReadOnly", "Uid" (if any) and "Records" (aa{sv})
+ */
+GVariant* tag_get_snapshot_dictionary(Tag* pTag);
+
+/** Get the UID of the tag, or the IDm of a Felica card
+ * \param pTag Tag instance
+ * \param uid buffer of TAG_UID_MAX_LENGTH bytes
+ * \return UID length, 0 if unknown
+ */
+gsize tag_get_uid(Tag* pTag, guint8* uid);
+
+/** Keep a tag which left the field
+ * The tag object and its records are unexported but kept until tag_resume() or tag_unregister()
+ * \param pTag Tag to retain
+ */
+void tag_retain(Tag* pTag);
+
+/** Bring back a retained tag
+ * Records which did not change keep their objects, only changed, added or removed ones are registered again
+ * \param pTag Tag retained with tag_retain()
+ * \param tagId new id of tag
+ */
+void tag_resume(Tag* pTag, guint tagId);
+
 /** Unregister the tag from Adapter
  * \param pTag Tag to unregister
  */